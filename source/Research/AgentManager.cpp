@@ -1,6 +1,5 @@
 #include "stdafx.h"
 #include "AgentManager.h"
-#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAstar.h"
 
 AgentManager::AgentManager(Elite::InfluenceMap<InfluenceGrid>* pInfluenceGrid, const std::vector<Elite::Vector2>& worldMaxima)
 {
@@ -9,6 +8,9 @@ AgentManager::AgentManager(Elite::InfluenceMap<InfluenceGrid>* pInfluenceGrid, c
 
 	// Init influenceGrid
 	m_pInfluenceGrid = pInfluenceGrid;
+
+	// Init planners, the D* Lite planners are made when they are first needed
+	m_pPathRequestService = new Elite::PathRequestService();
 }
 
 AgentManager::~AgentManager()
@@ -24,10 +26,20 @@ AgentManager::~AgentManager()
 
 	SAFE_DELETE(m_pPlayerArriveBehavior);
 	SAFE_DELETE(m_pPlayerSeekingBehavior);
+
+	// Delete planners
+	SAFE_DELETE(m_pPlayerPlanner);
+	SAFE_DELETE(m_pGuardPlanner);
+	SAFE_DELETE(m_pPathRequestService);
 }
 
 void AgentManager::Update(float deltaTime, bool algorithmIsBusy)
 {
+	// Pick up the paths the workers finished
+	m_pPathRequestService->Update();
+	TakeReadyPath(m_PlayerPathRequest, m_vPlayerPath);
+	TakeReadyPath(m_GuardPathRequest, m_vGuardPath);
+
 	// Update Player
 	UpdatePlayer(deltaTime);
 
@@ -61,6 +73,9 @@ void AgentManager::SetPlayerTarget(const Elite::Vector2& newTarget)
 
 	m_pPlayerAgent->SetSteeringBehavior(m_pPlayerSeekingBehavior);
 	m_pPlayerSeekingBehavior->SetTarget(newTarget);
+
+	// The old path leads to the old target, the agent seeks the new one until its path is ready
+	m_vPlayerPath.clear();
 	CalculatePath(m_pPlayerAgent->GetPosition(), newTarget, m_vPlayerPath, true);
 }
 void AgentManager::SetGuardTarget(const Elite::Vector2& newTarget)
@@ -81,6 +96,29 @@ Elite::Vector2 AgentManager::GetPlayerVelocity() const
 	return m_pPlayerAgent->GetLinearVelocity();
 }
 
+bool AgentManager::GetUseAnyAnglePaths() const
+{
+	return m_UseAnyAnglePaths;
+}
+void AgentManager::SetUseAnyAnglePaths(bool useAnyAnglePaths)
+{
+	if (m_UseAnyAnglePaths == useAnyAnglePaths)
+		return;
+
+	m_UseAnyAnglePaths = useAnyAnglePaths;
+
+	// The paths that are being followed came from the other planner
+	if (m_vPlayerPath.empty() == false)
+		CalculatePath(m_pPlayerAgent->GetPosition(), m_PlayerTarget, m_vPlayerPath, true);
+	if (m_vGuardPath.empty() == false)
+		CalculatePath(m_pGuardAgent->GetPosition(), m_GuardTarget, m_vGuardPath, false);
+}
+
+Elite::PathCacheStats AgentManager::GetPathCacheStats() const
+{
+	return m_pPathRequestService->GetPathCacheStats(m_pInfluenceGrid);
+}
+
 AgentManager::GuardBehavior AgentManager::GetCurrentGuardBehavior() const
 {
 	return m_CurrentGuardBehavior;
@@ -150,6 +188,10 @@ void AgentManager::UpdatePlayer(float deltaTime)
 	// Player Agent
 	// ============
 
+	// Repair Path
+	// -----------
+	ReplanPath(m_pPlayerAgent, m_PlayerTarget, m_vPlayerPath, true);
+
 	// Follow Path
 	// -----------
 	FollowPath(m_pPlayerAgent, m_pPlayerSeekingBehavior, m_pPlayerArriveBehavior, m_vPlayerPath);
@@ -197,6 +239,15 @@ void AgentManager::UpdateGuard(float deltaTime, bool algorithmIsBusy)
 
 	if (originalBehavior != m_CurrentGuardBehavior)
 	{
+		// The chase path is only followed while chasing
+		if (originalBehavior == Chasing)
+		{
+			m_pPathRequestService->Cancel(m_GuardPathRequest);
+			m_GuardPathRequest = Elite::invalid_path_request;
+			m_GuardPathTargetIdx = invalid_node_index;
+			m_vGuardPath.clear();
+		}
+
 		switch (m_CurrentGuardBehavior)
 		{
 		case AgentManager::OnGuard:
@@ -233,7 +284,34 @@ void AgentManager::UpdateGuard(float deltaTime, bool algorithmIsBusy)
 		}
 	}
 
-	if (m_CurrentGuardBehavior == Chasing) m_pGuardSeekingBehavior->SetTarget(m_GuardTarget);
+	// Repair Path
+	// -----------
+	ReplanPath(m_pGuardAgent, m_GuardTarget, m_vGuardPath, false);
+
+	// Chase along a path to the guard target
+	// --------------------------------------
+	// A new path is only requested when the target moved to another cell and the last request is done.
+	// The target hovers around the same cells and the guard walks along its old paths, so most requests are answered by the path cache of the service.
+	if (m_CurrentGuardBehavior == Chasing)
+	{
+		const int targetIdx{ m_pInfluenceGrid->GetNodeIdxAtWorldPos(m_GuardTarget) };
+		if (targetIdx != m_GuardPathTargetIdx && m_GuardPathRequest == Elite::invalid_path_request)
+		{
+			m_GuardPathTargetIdx = targetIdx;
+			CalculatePath(guardPos, m_GuardTarget, m_vGuardPath, false);
+		}
+
+		if (m_vGuardPath.empty() == false)
+		{
+			FollowPath(m_pGuardAgent, m_pGuardSeekingBehavior, m_pGuardSeekingBehavior, m_vGuardPath);
+		}
+		else if (m_GuardPathRequest != Elite::invalid_path_request)
+		{
+			// Head for the target until the first path is ready
+			m_pGuardAgent->SetSteeringBehavior(m_pGuardSeekingBehavior);
+			m_pGuardSeekingBehavior->SetTarget(m_GuardTarget);
+		}
+	}
 	if (m_CurrentGuardBehavior == Alert) m_pGuardSeekingBehavior->SetTarget(m_pPlayerAgent->GetPosition());
 
 	// Update Guard
@@ -241,8 +319,23 @@ void AgentManager::UpdateGuard(float deltaTime, bool algorithmIsBusy)
 	m_pGuardAgent->Update(deltaTime);
 }
 
+Elite::DStarLite<Elite::InfluenceNode, Elite::GraphConnection>* AgentManager::GetGridPlanner(bool isPlayer)
+{
+	// A planner listens to every grid change from the moment it exists, so it isn't made while only Theta* is used
+	auto& pPlanner = isPlayer ? m_pPlayerPlanner : m_pGuardPlanner;
+	if (pPlanner == nullptr)
+		pPlanner = new Elite::DStarLite<Elite::InfluenceNode, Elite::GraphConnection>(m_pInfluenceGrid, Elite::HeuristicFunctions::Chebyshev);
+
+	return pPlanner;
+}
 void AgentManager::CalculatePath(const Elite::Vector2& startPos, const Elite::Vector2& endPos, std::vector<Elite::InfluenceNode*>& path, bool isPlayer)
 {
+	// A request that is still open is outdated now
+	// --------------------------------------------
+	auto& pathRequest = isPlayer ? m_PlayerPathRequest : m_GuardPathRequest;
+	m_pPathRequestService->Cancel(pathRequest);
+	pathRequest = Elite::invalid_path_request;
+
 	// Check if start- and end-pos are valid
 	// ------------------------------------
 	const int startPathIdx{ m_pInfluenceGrid->GetNodeIdxAtWorldPos(startPos) };
@@ -251,15 +344,27 @@ void AgentManager::CalculatePath(const Elite::Vector2& startPos, const Elite::Ve
 	const bool areValidPositions{ startPathIdx != invalid_node_index && endPathIdx != invalid_node_index && startPathIdx != endPathIdx };
 	if (areValidPositions)
 	{
-		// A* Pathfinding
-		// --------------
-		const Elite::Heuristic heuristicFunction = Elite::HeuristicFunctions::Chebyshev;
-
-		auto pathFinder = Elite::AStar<Elite::InfluenceNode, Elite::GraphConnection>(m_pInfluenceGrid, heuristicFunction);
 		auto startNode = m_pInfluenceGrid->GetNode(startPathIdx);
 		auto endNode = m_pInfluenceGrid->GetNode(endPathIdx);
 
-		path = pathFinder.FindPath(startNode, endNode);
+		if (m_UseAnyAnglePaths)
+		{
+			// A* Pathfinding on the Workers
+			// -----------------------------
+			// The path is string pulled when it is picked up, until then the agent keeps its current path
+			// The player's requests go first, they answer a click
+			pathRequest = m_pPathRequestService->RequestPath(m_pInfluenceGrid, startNode, endNode, Elite::HeuristicFunctions::Chebyshev, isPlayer ? 1 : 0);
+			if (isPlayer) m_PlayerPathVersion = m_pInfluenceGrid->GetVersion();
+			else m_GuardPathVersion = m_pInfluenceGrid->GetVersion();
+		}
+		else
+		{
+			// D* Lite Pathfinding
+			// -------------------
+			// Stays on the main thread, the planner repairs its own search tree
+			path = GetGridPlanner(isPlayer)->FindPath(startNode, endNode);
+			PullString(path);
+		}
 	}
 	else
 	{
@@ -275,6 +380,50 @@ void AgentManager::CalculatePath(const Elite::Vector2& startPos, const Elite::Ve
 		path.clear();
 	}
 }
+void AgentManager::TakeReadyPath(Elite::PathRequestHandle& pathRequest, std::vector<Elite::InfluenceNode*>& path)
+{
+	if (m_pPathRequestService->TakePath(pathRequest, m_pInfluenceGrid, path))
+	{
+		pathRequest = Elite::invalid_path_request;
+		PullString(path);
+	}
+}
+void AgentManager::PullString(std::vector<Elite::InfluenceNode*>& path)
+{
+	if (m_Passability.IsUpToDate(*m_pInfluenceGrid) == false)
+		m_Passability.Build(*m_pInfluenceGrid);
+
+	std::vector<Elite::InfluenceNode*> waypoints{};
+	for (int waypoint : Elite::GridStringPulling::FindWaypoints(path, m_Passability))
+		waypoints.push_back(path[waypoint]);
+	path = std::move(waypoints);
+}
+void AgentManager::ReplanPath(SteeringAgent* pAgent, const Elite::Vector2& endPos, std::vector<Elite::InfluenceNode*>& path, bool isPlayer)
+{
+	// Only a path that is being followed can go stale
+	// -----------------------------------------------
+	if (path.empty())
+		return;
+
+	if (m_UseAnyAnglePaths)
+	{
+		// Segments between turning points can cross any cell, so every grid change can block them
+		// ---------------------------------------------------------------------------------------
+		// An open request was made for the current version already
+		const int pathVersion{ isPlayer ? m_PlayerPathVersion : m_GuardPathVersion };
+		if (pathVersion == m_pInfluenceGrid->GetVersion())
+			return;
+	}
+	else
+	{
+		// The planner kept its search tree, so this only repairs the part the grid changes affected
+		// -----------------------------------------------------------------------------------------
+		if (GetGridPlanner(isPlayer)->NeedsReplanning() == false)
+			return;
+	}
+
+	CalculatePath(pAgent->GetPosition(), endPos, path, isPlayer);
+}
 void AgentManager::FollowPath(SteeringAgent* pAgent, ISteeringBehavior* pSeekingBehavior, ISteeringBehavior* pArriveBehavior, std::vector<Elite::InfluenceNode*>& path)
 {
 	//Check if a path exist and move to the following point
@@ -286,7 +435,7 @@ void AgentManager::FollowPath(SteeringAgent* pAgent, ISteeringBehavior* pSeeking
 
 		if (path.size() == 1)
 		{
-			//We have reached the last node
+			//We have reached the last node (or turning point for any-angle paths)
 			pAgent->SetSteeringBehavior(pArriveBehavior);
 			pArriveBehavior->SetTarget(firstPathPos);
 		}
@@ -6,6 +6,9 @@
 #include "framework\EliteAI\EliteGraphs\EGridGraph.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphEditor.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphRenderer.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EDStarLite.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EPathRequestService.h"
+#include "framework\EliteAI\EliteNavigation\Algorithms\EPathSmoothing.h"
 
 #include "projects/Movement/SteeringBehaviors/SteeringAgent.h"
 #include "projects/Movement/SteeringBehaviors/Steering/SteeringBehaviors.h"
@@ -47,6 +50,11 @@ public:
 	Elite::Vector2 GetPlayerPos() const;
 	Elite::Vector2 GetPlayerVelocity() const;
 
+	// Any-angle paths only hold the cells where the path turns, otherwise the agents follow the D* Lite path cell by cell
+	bool GetUseAnyAnglePaths() const;
+	void SetUseAnyAnglePaths(bool useAnyAnglePaths);
+	Elite::PathCacheStats GetPathCacheStats() const;
+
 	GuardBehavior GetCurrentGuardBehavior() const;
 
 private:
@@ -58,6 +66,23 @@ private:
 	// -------------
 	Elite::InfluenceMap<InfluenceGrid>* m_pInfluenceGrid{ nullptr };
 
+	// Every agent has its own planner, they follow the grid changes and only repair their search tree where connections changed
+	// They are only made once any-angle paths are turned off, see GetGridPlanner
+	Elite::DStarLite<Elite::InfluenceNode, Elite::GraphConnection>* m_pPlayerPlanner{ nullptr };
+	Elite::DStarLite<Elite::InfluenceNode, Elite::GraphConnection>* m_pGuardPlanner{ nullptr };
+
+	// Any-angle paths are searched by the workers of the path request service and picked up in Update once they are ready
+	// They are replanned when the grid version changed since they were requested, the old path is followed until then
+	bool m_UseAnyAnglePaths{ true };
+	Elite::PathRequestService* m_pPathRequestService{ nullptr };
+	Elite::PathRequestHandle m_PlayerPathRequest{ Elite::invalid_path_request };
+	Elite::PathRequestHandle m_GuardPathRequest{ Elite::invalid_path_request };
+	int m_GuardPathTargetIdx{ invalid_node_index }; // Cell of the guard target the last chase path was requested for
+	int m_PlayerPathVersion{ -1 };
+	int m_GuardPathVersion{ -1 };
+
+	// All paths are string pulled, so they only keep the waypoints that can't be seen from the previous one
+	Elite::GridPassability m_Passability{};
 
 	// Agents
 	// --------
@@ -113,7 +138,11 @@ private:
 	void UpdatePlayer(float deltaTime);
 	void UpdateGuard(float deltaTime, bool algorithmIsBusy);
 
+	Elite::DStarLite<Elite::InfluenceNode, Elite::GraphConnection>* GetGridPlanner(bool isPlayer);
 	void CalculatePath(const Elite::Vector2& startPos, const Elite::Vector2& endPos, std::vector<Elite::InfluenceNode*>& path, bool isPlayer);
+	void TakeReadyPath(Elite::PathRequestHandle& pathRequest, std::vector<Elite::InfluenceNode*>& path);
+	void PullString(std::vector<Elite::InfluenceNode*>& path);
+	void ReplanPath(SteeringAgent* pAgent, const Elite::Vector2& endPos, std::vector<Elite::InfluenceNode*>& path, bool isPlayer);
 	void FollowPath(SteeringAgent* pAgent, ISteeringBehavior* pSeekingBehavior, ISteeringBehavior* pArriveBehavior, std::vector<Elite::InfluenceNode*>& path);
 };
 
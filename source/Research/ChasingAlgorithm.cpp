@@ -6,9 +6,12 @@ ChasingAlgorithm::ChasingAlgorithm(int cellAmount, int cellSize, bool isDirectio
 	// Set InfluenceGrid
 	m_pInfluenceGrid = new Elite::InfluenceMap<InfluenceGrid>(false);
 
-	m_pInfluenceGrid->InitializeGrid(cellAmount, cellAmount, cellSize, isDirectionalGraph, isConnectedDiagonally);
+	// Loaded from the file of an earlier run when it has the same layout
+	Elite::LoadOrInitializeGrid(m_InfluenceGridFile, *m_pInfluenceGrid, cellAmount, cellAmount, cellSize, isDirectionalGraph, isConnectedDiagonally);
 	m_pInfluenceGrid->InitializeBuffer();
 
+	m_BlockadeSearch.SetGraph(m_pInfluenceGrid);
+
 	m_GraphRenderer.SetNumberPrintPrecision(0);
 }
 
@@ -100,7 +103,7 @@ void ChasingAlgorithm::StartAlgorithm(const Elite::Vector2& startPos, const Elit
 
 
 				//Else, put in blockedNodes and color
-				pToNode->SetColor(m_BarrierNodeColor);
+				m_pInfluenceGrid->SetNodeColor(pToNode->GetIndex(), m_BarrierNodeColor);
 				blockedNodes.push_back(pToNode);
 
 				m_AlgorithmBlockade.push_back(pToNode);
@@ -121,10 +124,7 @@ void ChasingAlgorithm::StopAlgorithm()
 
 	// Clear Influence
 	// ---------------
-	for (auto& currentNode : m_pInfluenceGrid->GetAllNodes())
-	{
-		currentNode->SetInfluence(0.f);
-	}
+	m_pInfluenceGrid->ClearInfluence();
 
 	// Reset Algorithm
 	// ---------------
@@ -251,10 +251,10 @@ void ChasingAlgorithm::HandleAlgorithmStopping(float deltaTime)
 
 	// Else, reset after all Nodes have 0 influence
 	bool noMoreInfluence{ true };
-	for (auto& currentNode : m_pInfluenceGrid->GetAllNodes())
+	for (float influence : m_pInfluenceGrid->GetNodeStore().GetPayloads())
 	{
 		// If still has influence, break
-		if (currentNode->GetInfluence() != 0)
+		if (influence != 0)
 		{
 			noMoreInfluence = false;
 			break;
@@ -292,60 +292,34 @@ void ChasingAlgorithm::HandleBarrierPropagation(float deltaTime)
 		// ----------------
 		auto blockedNodes{ m_pInfluenceGrid->GetBlockedNodes() };
 
+		// Get blockadeNeighbors
+		// --------------------
+
+		// Grid connections always come in pairs, so the nodes the blockade connects to are the nodes that connect to the blockade
+		m_BlockadeSources.clear();
+		for (const auto& currentBlockadeNode : m_AlgorithmBlockade)
+		{
+			m_BlockadeSources.push_back(currentBlockadeNode->GetIndex());
+		}
+
+		m_BlockadeSearch.GetDistanceField(m_BlockadeSources, m_BlockadeDistances, nullptr, 1);
+
+		const auto playerStartNode{ m_pInfluenceGrid->GetNodeAtWorldPos(m_StartPos) };
+
 		// Loop over the Nodes
 		for (auto& currentNode : m_pInfluenceGrid->GetAllNodes())
 		{
 			// Check if is playerStartNode
 			// ---------------------------
 
-			const auto playerStartNode{ m_pInfluenceGrid->GetNodeAtWorldPos(m_StartPos) };
 			const bool isPlayerStartNode{ currentNode == playerStartNode };
 			if (isPlayerStartNode) continue;
 
-			// Check if is blockade
-			// --------------------
-			bool isBlockadeNode{ false };
-
-			// Loop through blockade
-			for (const auto& currentBlockadeNode : blockedNodes)
-			{
-				const bool isSameNode{ currentNode == currentBlockadeNode };
-				if (isSameNode)
-				{
-					isBlockadeNode = true;
-					break;
-				}
-			}
-
-			// If is blockadeNode, continue
-			if (isBlockadeNode) continue;
-
-
 			// Check if has blockadeNeighbors
 			// ------------------------------
-			bool hasBlockadeNeighbor{ false };
-
-			// Loop through nodeConnections
-			const auto nodeConnections{ m_pInfluenceGrid->GetNodeConnections(currentNode) };
-
-			for (const auto& currentNodeConnection : nodeConnections)
-			{
-				const Elite::InfluenceNode* pNextNode{ m_pInfluenceGrid->GetNode(currentNodeConnection->GetTo()) };
-				
-				// Loop through blockade
-				for (const auto& currentBlockadeNode : m_AlgorithmBlockade)
-				{
-					// If is same node, currentNode has a blockadeNeighbor
-					const bool isSameNode{ pNextNode->GetIndex() == currentBlockadeNode->GetIndex()};
-					if (isSameNode)
-					{
-						hasBlockadeNeighbor = true;
-						break;
-					}
-				}
 
-				if (hasBlockadeNeighbor) break;
-			}
+			// Blockade nodes are sources and blocked nodes have no connections left, so neither is ever 1 step away
+			const bool hasBlockadeNeighbor{ m_BlockadeDistances[currentNode->GetIndex()] == 1 };
 
 			// If doesn't have blockadeNeighbor, continue
 			if (hasBlockadeNeighbor == false) continue;
@@ -367,6 +341,9 @@ void ChasingAlgorithm::HandleBarrierPropagation(float deltaTime)
 		// Set new blockade
 		// ----------------
 
+		// Remove all connections in one transaction
+		m_pInfluenceGrid->BeginEdit();
+
 		// Loop through Buffer
 		for (auto& currentBufferNode : m_BlockadeBuffer)
 		{
@@ -375,12 +352,14 @@ void ChasingAlgorithm::HandleBarrierPropagation(float deltaTime)
 			m_AlgorithmBlockade.push_back(currentBufferNode);
 
 			// Set new Color
-			currentBufferNode->SetColor(m_BarrierNodeColor);
+			m_pInfluenceGrid->SetNodeColor(currentBufferNode->GetIndex(), m_BarrierNodeColor);
 
 			// Remove Connections
 			m_pInfluenceGrid->RemoveConnectionsToAdjacentNodes(currentBufferNode->GetIndex());
 		}
 
+		m_pInfluenceGrid->EndEdit();
+
 		// Set new blockade
 		m_pInfluenceGrid->SetBlockedNodes(blockedNodes);
 	}
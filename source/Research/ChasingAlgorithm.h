@@ -10,7 +10,9 @@
 #include "framework\EliteAI\EliteGraphs\EGraph2D.h"
 #include "framework\EliteAI\EliteGraphs\EGridGraph.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphEditor.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphFile.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphRenderer.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EBFS.h"
 
 using InfluenceGrid = Elite::GridGraph<Elite::InfluenceNode, Elite::GraphConnection>;
 
@@ -65,6 +67,7 @@ private:
 
 	// Copy of InfluenceGrid
 	Elite::InfluenceMap<InfluenceGrid>* m_pInfluenceGrid{ nullptr };
+	const std::string m_InfluenceGridFile{ "ChasingAlgorithm.graph" };
 	Elite::GraphRenderer m_GraphRenderer{};
 
 	// Algorithm blockade
@@ -73,6 +76,11 @@ private:
 	float m_TimeSinceLastPropagation{};
 	std::vector<Elite::InfluenceNode*> m_BlockadeBuffer{};
 
+	// Multi-source search from the whole blockade, finds the nodes next to it in one pass
+	Elite::BFS<Elite::InfluenceNode, Elite::GraphConnection> m_BlockadeSearch{ nullptr };
+	std::vector<int> m_BlockadeSources{};
+	std::vector<int> m_BlockadeDistances{};
+
 	const Elite::Color m_BarrierNodeColor{ 1.f,0.8f,0.f };
 	const float m_MaxAngleInRadians{ Elite::ToRadians(75.f) };
 
@@ -95,6 +95,19 @@ void InfluenceChasing::SetRenderAgents(bool renderAgents)
 	m_RenderAgents = renderAgents;
 }
 
+bool InfluenceChasing::GetUseAnyAnglePaths() const
+{
+	return m_pAgentManager->GetUseAnyAnglePaths();
+}
+void InfluenceChasing::SetUseAnyAnglePaths(bool useAnyAnglePaths)
+{
+	m_pAgentManager->SetUseAnyAnglePaths(useAnyAnglePaths);
+}
+Elite::PathCacheStats InfluenceChasing::GetPathCacheStats() const
+{
+	return m_pAgentManager->GetPathCacheStats();
+}
+
 std::vector<Elite::InfluenceNode*> InfluenceChasing::UpdateGraphNodes(Elite::GraphEditor& m_GridEditor)
 {
 	// Change Color of Nodes with no Connections
@@ -180,23 +193,22 @@ void InfluenceChasing::HandleAgents(float deltaTime)
 
 	if (m_pChasingAlgorithm->GetStartedAlgorithm())
 	{
-		// Get all Nodes
-		const auto pInfluenceGrid{ m_pChasingAlgorithm->GetInfluenceGrid() };
-		const auto allNodes{ pInfluenceGrid->GetAllNodes() };
+		// Get the influence columns of all nodes
+		const auto& nodeStore{ m_pChasingAlgorithm->GetInfluenceGrid()->GetNodeStore() };
 
 		// Weighter Average Position
 		Elite::Vector2 weightedAveragePosition{};
 		std::vector<Elite::Vector2> heatedNodesPos{};
 
 		// Loop through all nodes
-		for (const auto& currentNode : allNodes)
+		for (int nodeIdx{}; nodeIdx < nodeStore.GetSize(); ++nodeIdx)
 		{
 			// Heat counts as Weight
-			const float currentHeat{ currentNode->GetInfluence() };
+			const float currentHeat{ nodeStore.GetPayload(nodeIdx) };
 
-			if (currentHeat != 0.f)
+			if (currentHeat != 0.f && nodeStore.IsValid(nodeIdx))
 			{
-				Elite::Vector2 currentPosition{ pInfluenceGrid->GetNodeWorldPos(currentNode) };
+				const Elite::Vector2& currentPosition{ nodeStore.GetPosition(nodeIdx) };
 				weightedAveragePosition += currentHeat * currentPosition;
 
 				heatedNodesPos.push_back(currentPosition);
@@ -267,7 +279,7 @@ void InfluenceChasing::AddBlockedNodes(Elite::InfluenceMap<InfluenceGrid>* pInfl
 		if (hasNoConnections)
 		{
 			// Set Color white and put in blockedNodes
-			currentNode->SetColor(blockedNodeColor);
+			pInfluenceGrid->SetNodeColor(currentNode->GetIndex(), blockedNodeColor);
 
 			// Store, when asked to
 			if (storeInBlockedNodes) blockedNodes.push_back(currentNode);
@@ -11,6 +11,7 @@
 #include "framework\EliteAI\EliteGraphs\EGridGraph.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphEditor.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphRenderer.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EPathCache.h"
 
 #include "projects/Movement/SteeringBehaviors/SteeringAgent.h"
 #include "projects/Movement/SteeringBehaviors/Steering/SteeringBehaviors.h"
@@ -54,6 +55,10 @@ public:
 
 	void SetRenderAgents(bool renderAgents);
 
+	bool GetUseAnyAnglePaths() const;
+	void SetUseAnyAnglePaths(bool useAnyAnglePaths);
+	Elite::PathCacheStats GetPathCacheStats() const;
+
 private:
 
 	// Grid-Variables
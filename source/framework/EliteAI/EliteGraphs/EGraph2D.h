@@ -9,6 +9,7 @@
 #include "EIGraph.h"
 #include "EGraphConnectionTypes.h"
 #include "EGraphNodeTypes.h"
+#include "EliteGraphUtilities/EGraphSpatialHash.h"
 #include <iomanip>
 
 namespace Elite
@@ -27,15 +28,47 @@ namespace Elite
 		virtual int GetNodeIdxAtWorldPos(const Elite::Vector2& pos) const override;
 		T_ConnectionType* GetConnectionAtPosition(const Vector2& pos) const;
 
+		// Returns the closest valid node within maxDistance, or invalid_node_index
+		int GetClosestNodeIdx(const Vector2& pos, float maxDistance) const;
+
+		// Moves a node and keeps the spatial hash up to date. Nodes that are part of the graph have to be moved through here,
+		// the picking queries assert when a node was moved on the node itself (GraphNode2D::SetPosition) and the hash is stale
+		void SetNodePosition(int idx, const Vector2& pos);
+
 		void SetConnectionCostsToDistance();
 		void SetNodesColor(const std::vector<GraphNode2D*>& nodes, const Color& color);
 
+	protected:
+		virtual void OnGraphChanged(const GraphChangeSet& changes) override;
+
 	private:
 		// variables
 		int m_SelectedNodeIdx = -1;
 		bool m_IsLeftMouseButtonDown = false;
 		Vector2 m_MousePos;
 		const float m_ConnectionSelectionOffset = 1.f;
+
+		// Spatial hash of the node positions and of the cells the connections cross
+		// Connections are hashed with the node positions at the time they were inserted, those are kept in m_HashedNodePositions
+		// The cells are about as large as the average connection, the hash is rebuilt when that drifts too far away
+		using ConnectionKey = long long;
+		SpatialHash<int> m_NodeHash{ DEFAULT_NODE_RADIUS * 3.f };
+		SpatialHash<ConnectionKey> m_ConnectionHash{ DEFAULT_NODE_RADIUS * 3.f };
+		std::vector<Vector2> m_HashedNodePositions;
+		std::vector<bool> m_IsNodeHashed;
+		std::vector<std::vector<int>> m_HashedOutgoing; // per node, the 'to' of the hashed connections starting there
+		std::vector<std::vector<int>> m_HashedIncoming; // per node, the 'from' of the hashed connections ending there
+		double m_HashedConnectionLength = 0.0;
+		int m_NrOfHashedConnections = 0;
+
+		ConnectionKey GetConnectionKey(int from, int to) const { return (ConnectionKey(from) << 32) | ConnectionKey(static_cast<unsigned int>(to)); }
+		float GetCellSizeForLength(float averageConnectionLength) const { return std::max(averageConnectionLength, DEFAULT_NODE_RADIUS); }
+		void ResizeSpatialHash();
+		void RebuildSpatialHash();
+		void UpdateNodeInSpatialHash(int idx);
+		void UpdateConnectionInSpatialHash(int from, int to);
+		void RemoveConnectionFromSpatialHash(int from, int to);
+		void InsertConnectionInSpatialHash(int from, int to);
 	};
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -47,6 +80,14 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline Graph2D<T_NodeType, T_ConnectionType>::Graph2D(const Graph2D& other)
 		: IGraph<T_NodeType, T_ConnectionType>(other)
+		, m_NodeHash(other.m_NodeHash)
+		, m_ConnectionHash(other.m_ConnectionHash)
+		, m_HashedNodePositions(other.m_HashedNodePositions)
+		, m_IsNodeHashed(other.m_IsNodeHashed)
+		, m_HashedOutgoing(other.m_HashedOutgoing)
+		, m_HashedIncoming(other.m_HashedIncoming)
+		, m_HashedConnectionLength(other.m_HashedConnectionLength)
+		, m_NrOfHashedConnections(other.m_NrOfHashedConnections)
 	{
 	}
 
@@ -59,15 +100,66 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline int Graph2D<T_NodeType, T_ConnectionType>::GetNodeIdxAtWorldPos(const Elite::Vector2& pos) const
 	{
-		float posErrorMargin = 1.5f;
-		auto foundIt = find_if(m_Nodes.begin(), m_Nodes.end(),
-			[pos, posErrorMargin, this](T_NodeType* pNode)
-		{ return pNode->GetIndex() != invalid_node_index && (pNode->GetPosition() - pos).MagnitudeSquared() < pow(posErrorMargin * GetNodeRadius(pNode), 2); });
+		const float posErrorMargin = 1.5f;
+		const float pickRadius = posErrorMargin * DEFAULT_NODE_RADIUS;
+		const Vector2 extents{ pickRadius, pickRadius };
 
-		if (foundIt != m_Nodes.end())
-			return (*foundIt)->GetIndex();
-		else
-			return invalid_node_index;
+		// Return the lowest index within range, same as walking over the nodes in order
+		int foundIdx = invalid_node_index;
+		m_NodeHash.Query(pos - extents, pos + extents, [&](int idx)
+		{
+			if (foundIdx != invalid_node_index && idx >= foundIdx)
+				return;
+
+			const T_NodeType* pNode = m_Nodes[idx];
+			assert(m_HashedNodePositions[idx] == pNode->GetPosition() && "<Graph2D::GetNodeIdxAtWorldPos>: node was moved without SetNodePosition");
+			const float radius = posErrorMargin * GetNodeRadius(m_Nodes[idx]);
+			if ((pNode->GetPosition() - pos).MagnitudeSquared() < radius * radius)
+				foundIdx = idx;
+		});
+
+		return foundIdx;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int Graph2D<T_NodeType, T_ConnectionType>::GetClosestNodeIdx(const Vector2& pos, float maxDistance) const
+	{
+		int closestIdx = invalid_node_index;
+		float closestDistanceSquared = maxDistance * maxDistance;
+
+		// Grow the searched area until a node is found that is guaranteed to be the closest
+		float searchRadius = m_NodeHash.GetCellSize();
+		while (true)
+		{
+			searchRadius = std::min(searchRadius, maxDistance);
+			const Vector2 extents{ searchRadius, searchRadius };
+
+			m_NodeHash.Query(pos - extents, pos + extents, [&](int idx)
+			{
+				assert(m_HashedNodePositions[idx] == m_Nodes[idx]->GetPosition() && "<Graph2D::GetClosestNodeIdx>: node was moved without SetNodePosition");
+				const float distanceSquared = (m_Nodes[idx]->GetPosition() - pos).MagnitudeSquared();
+				if (distanceSquared < closestDistanceSquared || (distanceSquared == closestDistanceSquared && idx < closestIdx))
+				{
+					closestDistanceSquared = distanceSquared;
+					closestIdx = idx;
+				}
+			});
+
+			const bool isClosestInsideSearchRadius = closestIdx != invalid_node_index && closestDistanceSquared <= searchRadius * searchRadius;
+			if (isClosestInsideSearchRadius || searchRadius >= maxDistance)
+				return closestIdx;
+
+			searchRadius *= 2.f;
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void Graph2D<T_NodeType, T_ConnectionType>::SetNodePosition(int idx, const Vector2& pos)
+	{
+		assert(IsNodeValid(idx) && "<Graph2D::SetNodePosition>: invalid node index");
+
+		m_Nodes[idx]->SetPosition(pos);
+		UpdateNodeInSpatialHash(idx);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -98,20 +190,215 @@ namespace Elite
 	T_ConnectionType* Graph2D<T_NodeType, T_ConnectionType>::GetConnectionAtPosition(const Vector2& pos) const
 	{
 		T_ConnectionType* result = nullptr;
-		for (auto connectionList : m_Connections)
+		float closestDistanceSquared = m_ConnectionSelectionOffset;
+
+		const Vector2 extents{ m_ConnectionSelectionOffset, m_ConnectionSelectionOffset };
+		m_ConnectionHash.Query(pos - extents, pos + extents, [&](ConnectionKey key)
 		{
-			for (auto connection : connectionList)
+			const int from = int(key >> 32);
+			const int to = int(key & 0xFFFFFFFF);
+
+			auto segmentStart = GetNodePos(to);
+			auto segmentEnd = GetNodePos(from);
+
+			auto projectedPoint = ProjectOnLineSegment(segmentStart, segmentEnd, pos);
+
+			// Keep the closest connection, the same connection can be visited from several cells
+			const float distanceSquared = DistanceSquared(projectedPoint, pos);
+			if (distanceSquared < closestDistanceSquared)
 			{
-				auto segmentStart = GetNodePos(connection->GetTo());
-				auto segmentEnd =	GetNodePos(connection->GetFrom());
+				closestDistanceSquared = distanceSquared;
+				result = GetConnection(from, to);
+			}
+		});
 
-				auto projectedPoint = ProjectOnLineSegment(segmentStart, segmentEnd, pos);
+		return result;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void Graph2D<T_NodeType, T_ConnectionType>::OnGraphChanged(const GraphChangeSet& changes)
+	{
+		// A change without touched nodes means the graph was cleared or reset as a whole
+		if (changes.touchedNodes.empty())
+		{
+			RebuildSpatialHash();
+		}
+		else
+		{
+			ResizeSpatialHash();
 
-				if (DistanceSquared(projectedPoint, pos) < m_ConnectionSelectionOffset)
-					result = connection;
+			if (changes.nrOfNodesChanged)
+			{
+				for (int idx : changes.touchedNodes)
+					UpdateNodeInSpatialHash(idx);
+			}
+
+			for (const auto& connection : changes.touchedConnections)
+			{
+				UpdateConnectionInSpatialHash(connection.first, connection.second);
+
+				// Undirected connections get added and removed in pairs
+				if (!m_IsDirectionalGraph)
+					UpdateConnectionInSpatialHash(connection.second, connection.first);
+			}
+
+			// Pick a new cell size once the connections got twice as long or short as the cells on average
+			if (m_NrOfHashedConnections > 0)
+			{
+				const float cellSize = GetCellSizeForLength(float(m_HashedConnectionLength / m_NrOfHashedConnections));
+				if (cellSize > 2.f * m_ConnectionHash.GetCellSize() || 2.f * cellSize < m_ConnectionHash.GetCellSize())
+					RebuildSpatialHash();
 			}
 		}
 
-		return result;
+		IGraph::OnGraphChanged(changes);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void Graph2D<T_NodeType, T_ConnectionType>::ResizeSpatialHash()
+	{
+		// Connections can lead to nodes that were added in the same edit and aren't hashed yet
+		if (m_HashedNodePositions.size() < m_Nodes.size())
+		{
+			m_HashedNodePositions.resize(m_Nodes.size(), ZeroVector2);
+			m_IsNodeHashed.resize(m_Nodes.size(), false);
+			m_HashedOutgoing.resize(m_Nodes.size());
+			m_HashedIncoming.resize(m_Nodes.size());
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void Graph2D<T_NodeType, T_ConnectionType>::RebuildSpatialHash()
+	{
+		double totalConnectionLength = 0.0;
+		int nrOfConnections = 0;
+		for (auto& connectionList : m_Connections)
+		{
+			for (auto& connection : connectionList)
+			{
+				if (m_Nodes[connection->GetFrom()]->GetIndex() == invalid_node_index || m_Nodes[connection->GetTo()]->GetIndex() == invalid_node_index)
+					continue;
+
+				totalConnectionLength += Distance(m_Nodes[connection->GetFrom()]->GetPosition(), m_Nodes[connection->GetTo()]->GetPosition());
+				++nrOfConnections;
+			}
+		}
+
+		const float cellSize = nrOfConnections > 0 ? GetCellSizeForLength(float(totalConnectionLength / nrOfConnections)) : DEFAULT_NODE_RADIUS * 3.f;
+		m_NodeHash.SetCellSize(cellSize);
+		m_ConnectionHash.SetCellSize(cellSize);
+
+		m_HashedNodePositions.assign(m_Nodes.size(), ZeroVector2);
+		m_IsNodeHashed.assign(m_Nodes.size(), false);
+		m_HashedOutgoing.assign(m_Nodes.size(), {});
+		m_HashedIncoming.assign(m_Nodes.size(), {});
+		m_HashedConnectionLength = 0.0;
+		m_NrOfHashedConnections = 0;
+
+		for (int idx = 0; idx < (int)m_Nodes.size(); ++idx)
+		{
+			if (m_Nodes[idx]->GetIndex() == invalid_node_index)
+				continue;
+
+			m_HashedNodePositions[idx] = m_Nodes[idx]->GetPosition();
+			m_IsNodeHashed[idx] = true;
+			m_NodeHash.Insert(idx, m_HashedNodePositions[idx]);
+		}
+
+		for (auto& connectionList : m_Connections)
+		{
+			for (auto& connection : connectionList)
+				InsertConnectionInSpatialHash(connection->GetFrom(), connection->GetTo());
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void Graph2D<T_NodeType, T_ConnectionType>::UpdateNodeInSpatialHash(int idx)
+	{
+		ResizeSpatialHash();
+
+		const bool isValid = IsNodeValid(idx) && m_Nodes[idx]->GetIndex() != invalid_node_index;
+		if (m_IsNodeHashed[idx] && isValid && m_HashedNodePositions[idx] == m_Nodes[idx]->GetPosition())
+			return;
+
+		// The hashed connections of this node have to be moved along with it, a removed node takes them along
+		std::vector<std::pair<int, int>> movedConnections;
+		for (int to : m_HashedOutgoing[idx])
+			movedConnections.push_back({ idx, to });
+		for (int from : m_HashedIncoming[idx])
+			movedConnections.push_back({ from, idx });
+
+		for (const auto& connection : movedConnections)
+			RemoveConnectionFromSpatialHash(connection.first, connection.second);
+
+		if (m_IsNodeHashed[idx])
+		{
+			m_NodeHash.Remove(idx, m_HashedNodePositions[idx]);
+			m_IsNodeHashed[idx] = false;
+		}
+
+		if (isValid)
+		{
+			m_HashedNodePositions[idx] = m_Nodes[idx]->GetPosition();
+			m_IsNodeHashed[idx] = true;
+			m_NodeHash.Insert(idx, m_HashedNodePositions[idx]);
+
+			for (const auto& connection : movedConnections)
+				InsertConnectionInSpatialHash(connection.first, connection.second);
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void Graph2D<T_NodeType, T_ConnectionType>::UpdateConnectionInSpatialHash(int from, int to)
+	{
+		RemoveConnectionFromSpatialHash(from, to);
+
+		const bool nodesAreValid = IsNodeValid(from) && IsNodeValid(to)
+			&& m_Nodes[from]->GetIndex() != invalid_node_index && m_Nodes[to]->GetIndex() != invalid_node_index;
+		if (nodesAreValid && GetConnection(from, to) != nullptr)
+			InsertConnectionInSpatialHash(from, to);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void Graph2D<T_NodeType, T_ConnectionType>::RemoveConnectionFromSpatialHash(int from, int to)
+	{
+		auto& outgoing = m_HashedOutgoing[from];
+		auto outgoingIt = std::find(outgoing.begin(), outgoing.end(), to);
+		if (outgoingIt == outgoing.end())
+			return;
+
+		*outgoingIt = outgoing.back();
+		outgoing.pop_back();
+
+		auto& incoming = m_HashedIncoming[to];
+		auto incomingIt = std::find(incoming.begin(), incoming.end(), from);
+		*incomingIt = incoming.back();
+		incoming.pop_back();
+
+		const Vector2& fromPos = m_HashedNodePositions[from];
+		const Vector2& toPos = m_HashedNodePositions[to];
+		m_ConnectionHash.RemoveSegment(GetConnectionKey(from, to), fromPos, toPos);
+
+		m_HashedConnectionLength -= Distance(fromPos, toPos);
+		--m_NrOfHashedConnections;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void Graph2D<T_NodeType, T_ConnectionType>::InsertConnectionInSpatialHash(int from, int to)
+	{
+		auto& outgoing = m_HashedOutgoing[from];
+		if (std::find(outgoing.begin(), outgoing.end(), to) != outgoing.end())
+			return;
+
+		outgoing.push_back(to);
+		m_HashedIncoming[to].push_back(from);
+
+		// Both nodes are hashed before their connections, so the hashed positions are up to date
+		const Vector2& fromPos = m_HashedNodePositions[from];
+		const Vector2& toPos = m_HashedNodePositions[to];
+		m_ConnectionHash.InsertSegment(GetConnectionKey(from, to), fromPos, toPos);
+
+		m_HashedConnectionLength += Distance(fromPos, toPos);
+		++m_NrOfHashedConnections;
 	}
 }
@@ -0,0 +1,122 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// EGraphNodeStore.h: Structure-of-arrays node data of a graph, used by algorithms that sweep over all nodes every frame
+/*=============================================================================*/
+#pragma once
+
+#include "EIGraph.h"
+#include "EGraphNodeTypes.h"
+
+namespace Elite
+{
+	// Columns indexed by node index. The store is the only owner of the payload (e.g. influence) and the color of a node,
+	// the node objects keep their index and position, which the store mirrors so sweeps never have to touch the nodes.
+	// Every slot of the graph has an entry, removed nodes have an invalid index and keep the default payload.
+	template<class T_Payload>
+	class GraphNodeStore final
+	{
+	public:
+		using Payload = T_Payload;
+
+		explicit GraphNodeStore(const Payload& defaultPayload = {}, const Color& defaultColor = DEFAULT_NODE_COLOR)
+			: m_DefaultPayload(defaultPayload)
+			, m_DefaultColor(defaultColor)
+		{
+		}
+
+		// Mirrors the index and position of every node, payloads and colors of nodes that still exist are kept
+		template<class T_NodeType, class T_ConnectionType>
+		void Build(const IGraph<T_NodeType, T_ConnectionType>& graph);
+
+		// Only mirrors the nodes that were touched, unless the amount of nodes changed
+		template<class T_NodeType, class T_ConnectionType>
+		void Update(const IGraph<T_NodeType, T_ConnectionType>& graph, const GraphChangeSet& changes);
+
+		void FillPayloads(const Payload& payload) { std::fill(m_Payloads.begin(), m_Payloads.end(), payload); }
+
+		int GetSize() const { return int(m_Indices.size()); }
+		bool IsValid(int idx) const { return idx >= 0 && idx < GetSize() && m_Indices[idx] != invalid_node_index; }
+
+		int GetIndex(int idx) const { return m_Indices[idx]; }
+		const Vector2& GetPosition(int idx) const { return m_Positions[idx]; }
+		const Color& GetColor(int idx) const { return m_Colors[idx]; }
+		void SetColor(int idx, const Color& color) { m_Colors[idx] = color; }
+		const Payload& GetPayload(int idx) const { return m_Payloads[idx]; }
+		void SetPayload(int idx, const Payload& payload) { m_Payloads[idx] = payload; }
+
+		// Raw columns, for loops that sweep over every node
+		const std::vector<int>& GetIndices() const { return m_Indices; }
+		const std::vector<Vector2>& GetPositions() const { return m_Positions; }
+		std::vector<Color>& GetColors() { return m_Colors; }
+		const std::vector<Color>& GetColors() const { return m_Colors; }
+		std::vector<Payload>& GetPayloads() { return m_Payloads; }
+		const std::vector<Payload>& GetPayloads() const { return m_Payloads; }
+
+	private:
+		Payload m_DefaultPayload;
+		Color m_DefaultColor;
+
+		std::vector<int> m_Indices;
+		std::vector<Vector2> m_Positions;
+		std::vector<Color> m_Colors;
+		std::vector<Payload> m_Payloads;
+
+		template<class T_NodeType, class T_ConnectionType>
+		void MirrorNode(const IGraph<T_NodeType, T_ConnectionType>& graph, int idx);
+	};
+
+	template<class T_Payload>
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GraphNodeStore<T_Payload>::Build(const IGraph<T_NodeType, T_ConnectionType>& graph)
+	{
+		const size_t size{ size_t(graph.GetNrOfNodes()) };
+		m_Indices.resize(size);
+		m_Positions.resize(size);
+		m_Colors.resize(size, m_DefaultColor);
+		m_Payloads.resize(size, m_DefaultPayload);
+
+		for (int idx = 0; idx < GetSize(); ++idx)
+			MirrorNode(graph, idx);
+	}
+
+	template<class T_Payload>
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GraphNodeStore<T_Payload>::Update(const IGraph<T_NodeType, T_ConnectionType>& graph, const GraphChangeSet& changes)
+	{
+		// Connections are not part of the store
+		if (!changes.nrOfNodesChanged)
+			return;
+
+		// A cleared graph doesn't list its touched nodes
+		if (GetSize() != graph.GetNrOfNodes() || changes.touchedNodes.empty())
+		{
+			Build(graph);
+			return;
+		}
+
+		for (int idx : changes.touchedNodes)
+		{
+			if (idx >= 0 && idx < GetSize())
+				MirrorNode(graph, idx);
+		}
+	}
+
+	template<class T_Payload>
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GraphNodeStore<T_Payload>::MirrorNode(const IGraph<T_NodeType, T_ConnectionType>& graph, int idx)
+	{
+		const int oldIndex{ m_Indices[idx] };
+		m_Indices[idx] = graph.GetNode(idx)->GetIndex();
+
+		// A node that was removed or put in a free slot starts over
+		if (m_Indices[idx] == invalid_node_index || oldIndex == invalid_node_index)
+		{
+			m_Colors[idx] = m_DefaultColor;
+			m_Payloads[idx] = m_DefaultPayload;
+		}
+
+		if (m_Indices[idx] != invalid_node_index)
+			m_Positions[idx] = graph.GetNodeWorldPos(idx);
+	}
+}
@@ -39,6 +39,7 @@ namespace Elite
 		virtual ~GraphNode2D() = default;
 
 		Elite::Vector2 GetPosition() const { return m_Position; }
+		// Only for nodes that aren't part of a graph yet, Graph2D hashes its nodes by position (see Graph2D::SetNodePosition)
 		void SetPosition(const Elite::Vector2& newPos) { m_Position = newPos; }
 
 		Elite::Color GetColor() const { return m_Color; }
@@ -100,13 +101,11 @@ namespace Elite
 	class InfluenceNode final : public Elite::GraphNode2D
 	{
 	public:
-		InfluenceNode(int index, Elite::Vector2 pos = { 0,0 }, float influence = 0.f)
-			: GraphNode2D(index, pos), m_Influence(influence) {}
+		// The influence and the color are kept by the InfluenceMap the node belongs to (see InfluenceMap::SetNodeColor)
+		InfluenceNode(int index, Elite::Vector2 pos = { 0,0 })
+			: GraphNode2D(index, pos) {}
 
-		float GetInfluence() const { return m_Influence; }
-		void SetInfluence(float influence) { m_Influence = influence; }
-
-	private:
-		float m_Influence;
+		Elite::Color GetColor() const = delete;
+		void SetColor(const Elite::Color& color) = delete;
 	};
 }
\ No newline at end of file
@@ -20,6 +20,9 @@ namespace Elite
 		GridGraph(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5);
 		void InitializeGrid(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5);
 
+		// Only sets the dimensions and costs, without creating nodes or connections (used when loading a grid from file)
+		void SetGridLayout(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5);
+
 		using IGraph::GetNode;
 		T_NodeType* GetNode(int col, int row) const { return m_Nodes[GetIndex(col, row)]; }
 		const ConnectionList& GetConnections(const T_NodeType& node) const { return m_Connections[node.GetIndex()]; }
@@ -27,6 +30,10 @@ namespace Elite
 
 		int GetRows() const { return m_NrOfRows; }
 		int GetColumns() const { return m_NrOfColumns; }
+		int GetCellSize() const { return m_CellSize; }
+		bool IsConnectedDiagonally() const { return m_IsConnectedDiagonally; }
+		float GetDefaultCostStraight() const { return m_DefaultCostStraight; }
+		float GetDefaultCostDiagonal() const { return m_DefaultCostDiagonal; }
 
 		bool IsWithinBounds(int col, int row) const;
 		int GetIndex(int col, int row) const { return row * m_NrOfColumns + col; }
@@ -117,6 +124,9 @@ namespace Elite
 		m_DefaultCostStraight = costStraight;
 		m_DefaultCostDiagonal = costDiagonal;
 
+		// Build the whole grid in one transaction, derived graphs only get notified once
+		BeginEdit();
+
 		// Create all nodes
 		for (auto r = 0; r < m_NrOfRows; ++r)
 		{
@@ -135,6 +145,30 @@ namespace Elite
 				AddConnectionsToAdjacentCells(c, r);
 			}
 		}
+
+		EndEdit();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridGraph<T_NodeType, T_ConnectionType>::SetGridLayout(
+		int columns,
+		int rows,
+		int cellSize,
+		bool isDirectionalGraph,
+		bool isConnectedDiagonally,
+		float costStraight /* = 1.f*/,
+		float costDiagonal /* = 1.5f */)
+	{
+		m_IsDirectionalGraph = isDirectionalGraph;
+		m_NrOfColumns = columns;
+		m_NrOfRows = rows;
+		m_CellSize = cellSize;
+		m_IsConnectedDiagonally = isConnectedDiagonally;
+		m_DefaultCostStraight = costStraight;
+		m_DefaultCostDiagonal = costDiagonal;
+
+		// Nodes without connections are blocked from here on
+		m_StartUp = false;
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -149,6 +183,8 @@ namespace Elite
 	{
 		int idx = GetIndex(col, row);
 
+		BeginEdit();
+
 		// Add connections in all directions, taking into account the dimensions of the grid
 		AddConnectionsInDirections(idx, col, row, m_StraightDirections);
 
@@ -157,7 +193,7 @@ namespace Elite
 			AddConnectionsInDirections(idx, col, row, m_DiagonalDirections);
 		}
 
-		OnGraphModified(false, true);
+		EndEdit();
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
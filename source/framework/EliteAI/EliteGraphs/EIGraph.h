@@ -10,9 +10,31 @@
 #include "EGraphNodeTypes.h"
 #include "EGraphConnectionTypes.h"
 #include <memory>
+#include <functional>
 
 namespace Elite
 {
+	// Summary of the modifications made to a graph, handed to OnGraphChanged
+	// Single modifications produce a change set of their own, BeginEdit/EndEdit bundles everything in between into one
+	struct GraphChangeSet
+	{
+		bool nrOfNodesChanged = false;
+		bool nrOfConnectionsChanged = false;
+
+		// Both lists are empty when the graph was cleared as a whole
+		std::vector<int> touchedNodes; // nodes that were added, removed or had their connections changed (sorted, unique)
+		std::vector<std::pair<int, int>> touchedConnections; // (from, to) of every added or removed connection
+
+		bool IsEmpty() const { return !nrOfNodesChanged && !nrOfConnectionsChanged; }
+		void Clear()
+		{
+			nrOfNodesChanged = false;
+			nrOfConnectionsChanged = false;
+			touchedNodes.clear();
+			touchedConnections.clear();
+		}
+	};
+
 	template <class T_NodeType, class T_ConnectionType>
 	class IGraph
 	{
@@ -61,6 +83,26 @@ namespace Elite
 		void Clear();
 		void RemoveConnections();
 
+		// Edit transactions
+		// -----------------
+		// Every modification between BeginEdit and the matching EndEdit is collected in one change set,
+		// derived graphs get notified once when the outermost EndEdit is reached. Transactions can be nested.
+		void BeginEdit() { ++m_EditDepth; }
+		void EndEdit();
+		bool IsEditing() const { return m_EditDepth > 0; }
+
+		// Increases every time derived graphs get notified of a modification
+		int GetVersion() const { return m_Version; }
+
+		// Listeners get the same change sets as OnGraphChanged, after the graph itself has handled them
+		// Used by structures that are built on top of a graph without deriving from it (e.g. a pathfinding abstraction)
+		using ChangeListener = std::function<void(const GraphChangeSet&)>;
+		int AddChangeListener(const ChangeListener& listener);
+		void RemoveChangeListener(int listenerId);
+
+		// Expires when the graph is destroyed, so something that outlives the graph can tell it is gone (see ChangeListenerHandle)
+		std::weak_ptr<const void> GetLifetime() const { return m_pLifetime; }
+
 		// Visualization
 		// -------------
 		float GetNodeRadius(T_NodeType* pNode) const;
@@ -93,11 +135,66 @@ namespace Elite
 		// Called whenever the graph is modified, to be overriden by derived classes
 		virtual void OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged) {}
 
+		// Called once per modification or once per edit transaction with everything that changed
+		// Override this instead of OnGraphModified to update derived data incrementally
+		virtual void OnGraphChanged(const GraphChangeSet& changes) { OnGraphModified(changes.nrOfNodesChanged, changes.nrOfConnectionsChanged); }
+
+		// Records a modification, notifies immediately when not inside an edit transaction
+		void RegisterModification(bool nrOfNodesChanged, bool nrOfConnectionsChanged, int from = invalid_node_index, int to = invalid_node_index);
+
 	private:
 		int m_NextNodeIndex;
 
+		int m_EditDepth = 0;
+		int m_Version = 0;
+		GraphChangeSet m_PendingChanges;
+
+		// Not copied along with the graph, listeners belong to the graph they registered on
+		std::vector<std::pair<int, ChangeListener>> m_ChangeListeners;
+		int m_NextListenerId = 0;
+		std::shared_ptr<const void> m_pLifetime{ std::make_shared<int>(0) };
+
 		// private functions
 		void CullInvalidEdges();
+		void FlushModifications();
+		void DeleteNodesAndConnections();
+	};
+
+	// Registration of a change listener that is removed again when the handle is destroyed or reset
+	// The graph can be destroyed first, the handle then leaves it alone instead of touching the freed graph
+	template<class T_NodeType, class T_ConnectionType>
+	class ChangeListenerHandle final
+	{
+	public:
+		using Graph = IGraph<T_NodeType, T_ConnectionType>;
+
+		ChangeListenerHandle() = default;
+		ChangeListenerHandle(Graph* pGraph, const typename Graph::ChangeListener& listener)
+			: m_pGraph(pGraph)
+			, m_Lifetime(pGraph->GetLifetime())
+			, m_ListenerId(pGraph->AddChangeListener(listener))
+		{
+		}
+		~ChangeListenerHandle() { Reset(); }
+
+		void Reset()
+		{
+			if (IsGraphAlive())
+				m_pGraph->RemoveChangeListener(m_ListenerId);
+
+			m_pGraph = nullptr;
+			m_Lifetime.reset();
+		}
+
+		bool IsGraphAlive() const { return m_pGraph != nullptr && !m_Lifetime.expired(); }
+
+	private:
+		Graph* m_pGraph = nullptr;
+		std::weak_ptr<const void> m_Lifetime;
+		int m_ListenerId = 0;
+
+		ChangeListenerHandle(const ChangeListenerHandle&) = delete;
+		ChangeListenerHandle& operator=(const ChangeListenerHandle&) = delete;
 	};
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -132,12 +229,15 @@ namespace Elite
 
 		m_IsDirectionalGraph = other.m_IsDirectionalGraph;
 		m_NextNodeIndex = other.m_NextNodeIndex;
+		m_Version = other.m_Version;
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
 	inline IGraph<T_NodeType, T_ConnectionType>::~IGraph()
 	{
-		Clear();
+		// Nobody gets notified about a graph that is being destroyed, the derived part is already gone
+		m_ChangeListeners.clear();
+		DeleteNodesAndConnections();
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -207,7 +307,7 @@ namespace Elite
 
 			m_Nodes[pNode->GetIndex()] = pNode;
 
-			OnGraphModified(true, false);
+			RegisterModification(true, false, pNode->GetIndex());
 			return m_NextNodeIndex;
 		}
 		else
@@ -218,7 +318,7 @@ namespace Elite
 			m_Nodes.push_back(pNode);
 			m_Connections.push_back(ConnectionList());
 
-			OnGraphModified(true, false);
+			RegisterModification(true, false, pNode->GetIndex());
 			return m_NextNodeIndex++;
 		}
 
@@ -253,6 +353,7 @@ namespace Elite
 					if ((*currentEdgeOnToNode)->GetTo() == idx)
 					{
 						hadConnections = true;
+						RegisterModification(false, true, (*currentConnection)->GetTo(), idx);
 
 						auto conPtr = *currentEdgeOnToNode;
 						currentEdgeOnToNode = m_Connections[(*currentConnection)->GetTo()].erase(currentEdgeOnToNode);
@@ -268,11 +369,12 @@ namespace Elite
 		for (auto& connection : m_Connections[idx])
 		{
 			hadConnections = true;
+			RegisterModification(false, true, idx, connection->GetTo());
 			SAFE_DELETE(connection);
 		}
 		m_Connections[idx].clear();
 
-		OnGraphModified(true, hadConnections);
+		RegisterModification(true, hadConnections, idx);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -307,9 +409,10 @@ namespace Elite
 					m_Connections[pConnection->GetTo()].push_back(oppositeDirEdge);
 				}
 			}
+
+			// Nothing was added when one of the nodes is removed, so nothing to notify either
+			RegisterModification(false, true, pConnection->GetFrom(), pConnection->GetTo());
 		}
-		
-		OnGraphModified(false, true);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -349,7 +452,7 @@ namespace Elite
 		SAFE_DELETE(conFromTo);
 		SAFE_DELETE(conToFrom);
 
-		OnGraphModified(false, true);
+		RegisterModification(false, true, from, to);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -361,24 +464,43 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::RemoveConnectionsToAdjacentNodes(int idx)
 	{
-		// remove and delete connections from this pNode
-		for (auto c : m_Connections[idx])
-			delete c;
-		m_Connections[idx].clear();
+		BeginEdit();
 
 		// remove and delete connections from other nodes to this pNode
 		auto isConnectionToThisNode = [idx](T_ConnectionType* pCon) { return pCon->GetTo() == idx; };
-		for (auto& c : m_Connections)
+		auto removeConnectionsToThisNode = [this, idx, &isConnectionToThisNode](int fromIdx)
 		{
+			auto& c = m_Connections[fromIdx];
 			std::list<T_ConnectionType*>::iterator foundIt;
 			while ((foundIt = std::find_if(c.begin(), c.end(), isConnectionToThisNode))	!= c.end())
 			{
+				RegisterModification(false, true, fromIdx, idx);
 				delete *foundIt;
 				c.erase(foundIt);
 			}
+		};
+
+		// connections are mirrored in undirected graphs, so only the neighbours can point back to this pNode
+		if (!m_IsDirectionalGraph)
+		{
+			for (auto c : m_Connections[idx])
+				removeConnectionsToThisNode(c->GetTo());
+		}
+		else
+		{
+			for (int fromIdx = 0; fromIdx < (int)m_Connections.size(); ++fromIdx)
+				removeConnectionsToThisNode(fromIdx);
 		}
 
-		OnGraphModified(false, true);
+		// remove and delete connections from this pNode
+		for (auto c : m_Connections[idx])
+		{
+			RegisterModification(false, true, idx, c->GetTo());
+			delete c;
+		}
+		m_Connections[idx].clear();
+
+		EndEdit();
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -430,6 +552,14 @@ namespace Elite
 
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::Clear()
+	{
+		DeleteNodesAndConnections();
+
+		RegisterModification(true, true);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::DeleteNodesAndConnections()
 	{
 		for (auto& n : m_Nodes)
 			SAFE_DELETE(n);
@@ -450,6 +580,73 @@ namespace Elite
 	{
 		for (auto& connectionList : m_Connections)
 			connectionList.clear();
+
+		RegisterModification(false, true);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::EndEdit()
+	{
+		assert(m_EditDepth > 0 && "<Graph::EndEdit>: EndEdit called without matching BeginEdit");
+
+		if (--m_EditDepth == 0)
+			FlushModifications();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::RegisterModification(bool nrOfNodesChanged, bool nrOfConnectionsChanged, int from /*= invalid_node_index*/, int to /*= invalid_node_index*/)
+	{
+		m_PendingChanges.nrOfNodesChanged |= nrOfNodesChanged;
+		m_PendingChanges.nrOfConnectionsChanged |= nrOfConnectionsChanged;
+
+		if (from != invalid_node_index)
+			m_PendingChanges.touchedNodes.push_back(from);
+
+		if (to != invalid_node_index)
+		{
+			m_PendingChanges.touchedNodes.push_back(to);
+			m_PendingChanges.touchedConnections.push_back({ from, to });
+		}
+
+		if (m_EditDepth == 0)
+			FlushModifications();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::FlushModifications()
+	{
+		if (m_PendingChanges.IsEmpty())
+			return;
+
+		auto& nodes = m_PendingChanges.touchedNodes;
+		std::sort(nodes.begin(), nodes.end());
+		nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+		++m_Version;
+
+		// Swap out first, derived classes are allowed to modify the graph again while handling the notification
+		GraphChangeSet changes{};
+		std::swap(changes, m_PendingChanges);
+		OnGraphChanged(changes);
+
+		// Iterate over a copy, listeners are allowed to remove themselves
+		const auto listeners = m_ChangeListeners;
+		for (const auto& listener : listeners)
+			listener.second(changes);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int IGraph<T_NodeType, T_ConnectionType>::AddChangeListener(const ChangeListener& listener)
+	{
+		m_ChangeListeners.push_back({ m_NextListenerId, listener });
+		return m_NextListenerId++;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::RemoveChangeListener(int listenerId)
+	{
+		m_ChangeListeners.erase(std::remove_if(m_ChangeListeners.begin(), m_ChangeListeners.end(),
+			[listenerId](const std::pair<int, ChangeListener>& listener) { return listener.first == listenerId; }), m_ChangeListeners.end());
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -2,6 +2,7 @@
 #include "EIGraph.h"
 #include "EGraphNodeTypes.h"
 #include "EGraphConnectionTypes.h"
+#include "EGraphNodeStore.h"
 
 namespace Elite
 {
@@ -13,11 +14,19 @@ namespace Elite
 		void InitializeBuffer() { m_InfluenceDoubleBuffer = std::vector<float>(m_Nodes.size()); }
 		void PropagateInfluence(float deltaTime);
 
+		// The influence of every node lives in the node store of the map, not in the nodes
+		float GetInfluence(int nodeIdx) const { return m_NodeStore.IsValid(nodeIdx) ? m_NodeStore.GetPayload(nodeIdx) : 0.f; }
+		void SetInfluence(int nodeIdx, float influence);
 		void SetInfluenceAtPosition(Elite::Vector2 pos, float influence);
+		void ClearInfluence();
 
 		void Render() const {}
 		void SetNodeColorsBasedOnInfluence();
 
+		// The color of every node lives in the node store too, blockedNodes keep the color they were given here
+		Elite::Color GetNodeColor(int nodeIdx) const { return m_NodeStore.IsValid(nodeIdx) ? m_NodeStore.GetColor(nodeIdx) : m_NeutralColor; }
+		void SetNodeColor(int nodeIdx, const Elite::Color& color);
+
 		float GetMomentum() const { return m_Momentum; }
 		void SetMomentum(float momentum) { m_Momentum = momentum; }
 
@@ -42,8 +51,11 @@ namespace Elite
 		float GetMaxPropagationSteps() const { return m_MaxPropagationSteps / 30.f; };
 		void SetMaxPropagationSteps(float maxPropagationSteps) { m_MaxPropagationSteps = int(maxPropagationSteps * 30.f); };
 
+		// Influence and color of every node in contiguous columns, the renderer draws the map straight from them
+		const GraphNodeStore<float>& GetNodeStore() const { return m_NodeStore; }
+
 	protected:
-		virtual void OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged) override;
+		virtual void OnGraphChanged(const GraphChangeSet& changes) override;
 
 	private:
 		Elite::Color m_NegativeColor{ 1.f, 0.2f, 0.f};
@@ -57,6 +69,8 @@ namespace Elite
 		float m_TimeSinceLastPropagation = 0.0f;
 
 		std::vector<float> m_InfluenceDoubleBuffer;
+		std::vector<bool> m_IsBlockedBuffer; // Blocked flag per node, refilled from m_BlockedNodes every propagation
+		GraphNodeStore<float> m_NodeStore{ 0.f, m_NeutralColor };
 
 		// Own Stuff
 		std::vector<Elite::InfluenceNode*> m_BlockedNodes{};
@@ -67,6 +81,10 @@ namespace Elite
 		float m_MaxHeat{ 9.f };
 		int m_MaxAmountOfHeatedCells{ 15 };
 		int m_MaxPropagationSteps{ 20 };
+
+		// Nodes can be added before the map gets notified (e.g. while the grid is being initialized)
+		void SyncNodeStore() { if (m_NodeStore.GetSize() != int(m_Nodes.size())) m_NodeStore.Build(*this); }
+		void UpdateBlockedFlags();
 	};
 
 	template <class T_GraphType>
@@ -88,31 +106,44 @@ namespace Elite
 				++m_CurrentPropagationSteps;
 			}
 
-			// Remove Connections off blockedNodes
-			for (const auto& currentBlockedNode : m_BlockedNodes)
-			{
-				RemoveConnectionsToAdjacentNodes(currentBlockedNode->GetIndex());
-			}
+			SyncNodeStore();
+			if (m_InfluenceDoubleBuffer.size() != m_Nodes.size())
+				InitializeBuffer();
+
+			// Heat doesn't spread to or from blockedNodes, they are skipped instead of disconnected so the graph itself doesn't change
+			UpdateBlockedFlags();
+
+			const auto& influences{ m_NodeStore.GetPayloads() };
 
 			// Keep count of cellsHeated
 			int cellsHeated{};
 
 			// Loop over the Nodes
-			for (const auto& currentNode : m_Nodes)
+			for (int nodeIdx{}; nodeIdx < m_NodeStore.GetSize(); ++nodeIdx)
 			{
-				const bool isCold{ currentNode->GetInfluence() <= 0.f };			
+				if (m_NodeStore.IsValid(nodeIdx) == false)
+				{
+					m_InfluenceDoubleBuffer[nodeIdx] = 0.f;
+					continue;
+				}
+
+				const float currentNodeInfluence{ influences[nodeIdx] };
+				const bool isCold{ currentNodeInfluence <= 0.f };
 
 				// Check if Neighbor is Heated or Blocked
 				// --------------------------------------
 
 				bool neighborIsHeated{ false };
 
-				// Loop over the connections from currentNode
-				const auto nodeConnections{ GetNodeConnections(currentNode) };
-				for (const auto& currentConnection : nodeConnections)
+				// Loop over the connections from currentNode, a blockedNode has no neighbors to take heat from
+				for (const auto& currentConnection : m_Connections[nodeIdx])
 				{
-					const auto getToNode{ GetNode(currentConnection->GetTo()) };
-					const float toNodeInfluence{ getToNode->GetInfluence() };
+					if (m_IsBlockedBuffer[nodeIdx])
+						break;
+					if (m_IsBlockedBuffer[currentConnection->GetTo()])
+						continue;
+
+					const float toNodeInfluence{ influences[currentConnection->GetTo()] };
 
 					// Check if Neighbor has maxInfluence (= Heated)
 					const bool isHeated{ toNodeInfluence >= m_MaxHeat };
@@ -136,28 +167,17 @@ namespace Elite
 				// If have been effected already, lower Influence
 				else if (isCold == false)
 				{
-					const float currentNodeInfluence{ currentNode->GetInfluence() };
 					desiredHeat = currentNodeInfluence - 1;
 					desiredHeat =Elite::Clamp(desiredHeat, 0.f, m_MaxHeat);
 				}
 
 				// Put in Buffer
 				// -------------
-				m_InfluenceDoubleBuffer[currentNode->GetIndex()] = desiredHeat;
-			}
-
-			// Re-Add Connections off blockedNodes
-			for (const auto& currentBlockedNode : m_BlockedNodes)
-			{
-				AddConnectionsToAdjacentCells(currentBlockedNode->GetIndex());
+				m_InfluenceDoubleBuffer[nodeIdx] = desiredHeat;
 			}
 
-			// Loop over the nodes
-			for (size_t idx{}; idx < m_Nodes.size(); ++idx)
-			{
-				// Set Influence
-				m_Nodes[idx]->SetInfluence(m_InfluenceDoubleBuffer[idx]);
-			}
+			// Set Influence
+			std::swap(m_InfluenceDoubleBuffer, m_NodeStore.GetPayloads());
 
 			// Check if should stop Algorithm
 			const bool maxHeatedCellsReached{ cellsHeated >= m_MaxAmountOfHeatedCells };
@@ -171,12 +191,35 @@ namespace Elite
 		}
 	}
 
+	template <class T_GraphType>
+	inline void InfluenceMap<T_GraphType>::SetInfluence(int nodeIdx, float influence)
+	{
+		SyncNodeStore();
+		if (m_NodeStore.IsValid(nodeIdx))
+			m_NodeStore.SetPayload(nodeIdx, influence);
+	}
+
 	template <class T_GraphType>
 	inline void InfluenceMap<T_GraphType>::SetInfluenceAtPosition(Elite::Vector2 pos, float influence)
 	{
 		auto idx = GetNodeIdxAtWorldPos(pos);
 		if (IsNodeValid(idx))
-			GetNode(idx)->SetInfluence(influence);
+			SetInfluence(idx, influence);
+	}
+
+	template <class T_GraphType>
+	inline void InfluenceMap<T_GraphType>::SetNodeColor(int nodeIdx, const Elite::Color& color)
+	{
+		SyncNodeStore();
+		if (m_NodeStore.IsValid(nodeIdx))
+			m_NodeStore.SetColor(nodeIdx, color);
+	}
+
+	template <class T_GraphType>
+	inline void InfluenceMap<T_GraphType>::ClearInfluence()
+	{
+		SyncNodeStore();
+		m_NodeStore.FillPayloads(0.f);
 	}
 
 	template<class T_GraphType>
@@ -184,24 +227,22 @@ namespace Elite
 	{
 		const float half = .5f;
 
-		for (auto& pNode : m_Nodes)
-		{
-			// Ignore nodes on blockedList
-			bool isOnBlockedNodes{ false };
-			for (const auto& currentBlockedNode : m_BlockedNodes)
-			{
-				if (pNode->GetIndex() == currentBlockedNode->GetIndex())
-				{
-					isOnBlockedNodes = true;
-				}
-			}
+		SyncNodeStore();
+		UpdateBlockedFlags();
+
+		const auto& influences{ m_NodeStore.GetPayloads() };
+		auto& colors{ m_NodeStore.GetColors() };
 
-			if(isOnBlockedNodes) continue;
+		for (int nodeIdx{}; nodeIdx < m_NodeStore.GetSize(); ++nodeIdx)
+		{
+			// Ignore nodes on blockedList, they keep the color they were given through SetNodeColor
+			if (m_IsBlockedBuffer[nodeIdx])
+				continue;
 
 			// Framework
 
 			Color nodeColor{};
-			float influence = pNode->GetInfluence();
+			float influence = influences[nodeIdx];
 			float relativeInfluence = abs(influence) / m_MaxHeat;
 
 			if (influence < 0)
@@ -221,16 +262,33 @@ namespace Elite
 				};
 			}
 
-			pNode->SetColor(nodeColor);
+			colors[nodeIdx] = nodeColor;
 		}
 	}
 
 	template<class T_GraphType>
-	inline void InfluenceMap<T_GraphType>::OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged)
+	inline void InfluenceMap<T_GraphType>::UpdateBlockedFlags()
 	{
-		if (nrOfConnectionsChanged == 0)
+		m_IsBlockedBuffer.assign(m_Nodes.size(), false);
+		for (const auto& currentBlockedNode : m_BlockedNodes)
+		{
+			const int blockedIdx{ currentBlockedNode->GetIndex() };
+			if (blockedIdx >= 0 && blockedIdx < int(m_IsBlockedBuffer.size()))
+				m_IsBlockedBuffer[blockedIdx] = true;
+		}
+	}
+
+	template<class T_GraphType>
+	inline void InfluenceMap<T_GraphType>::OnGraphChanged(const GraphChangeSet& changes)
+	{
+		T_GraphType::OnGraphChanged(changes);
+
+		// Connection changes don't affect the buffer, only resize it when nodes were added or removed
+		if (changes.nrOfNodesChanged && m_InfluenceDoubleBuffer.size() != m_Nodes.size())
 		{
 			InitializeBuffer();
 		}
+
+		m_NodeStore.Update(*this, changes);
 	}
 }
\ No newline at end of file
@@ -4,9 +4,10 @@
 
 using namespace Elite;
 
-Elite::NavGraph::NavGraph(const Polygon& contourMesh, float playerRadius = 1.0f) :
+Elite::NavGraph::NavGraph(const Polygon& contourMesh, float playerRadius = 1.0f, const std::string& graphFilePath) :
 	Graph2D(false),
-	m_pNavMeshPolygon(nullptr)
+	m_pNavMeshPolygon(nullptr),
+	m_PlayerRadius(playerRadius)
 {
 	//Create the navigation mesh (polygon of navigatable area= Contour - Static Shapes)
 	m_pNavMeshPolygon = new Polygon(contourMesh); // Create copy on heap
@@ -24,25 +25,46 @@ Elite::NavGraph::NavGraph(const Polygon& contourMesh, float playerRadius = 1.0f)
 	//Triangulate
 	m_pNavMeshPolygon->Triangulate();
 
-	//Create the actual graph (nodes & connections) from the navigation mesh
-	CreateNavigationGraph();
+	//Load the actual graph (nodes & connections) of this navigation mesh, or create it and save it for the next time
+	bool isLoaded{ false };
+	if (!graphFilePath.empty() && GraphFile::Exists(graphFilePath))
+	{
+		GraphFile graphFile{};
+		isLoaded = graphFile.Open(graphFilePath) && LoadNavigationGraph(graphFile);
+	}
+
+	if (!isLoaded)
+	{
+		CreateNavigationGraph();
+		if (!graphFilePath.empty())
+			WriteGraphFile(graphFilePath, *this);
+	}
 }
 
 Elite::NavGraph::~NavGraph()
 {
 	delete m_pNavMeshPolygon; 
 	m_pNavMeshPolygon = nullptr;
+
+	for (auto pNode : m_SpareNodes)
+		SAFE_DELETE(pNode);
+	m_SpareNodes.clear();
 }
 
 int Elite::NavGraph::GetNodeIdxFromLineIdx(int lineIdx) const
 {
-	auto nodeIt = std::find_if(m_Nodes.begin(), m_Nodes.end(), [lineIdx](const NavGraphNode* n) { return n->GetLineIndex() == lineIdx; });
-	if (nodeIt != m_Nodes.end())
-	{
-		return (*nodeIt)->GetIndex();
-	}
+	if (lineIdx < 0 || lineIdx >= int(m_LineToNodeIndices.size()))
+		return invalid_node_index;
+
+	return m_LineToNodeIndices[lineIdx];
+}
+
+int Elite::NavGraph::GetLineIdxFromNodeIdx(int nodeIdx) const
+{
+	if (nodeIdx < 0 || nodeIdx >= int(m_NodeToLineIndices.size()))
+		return invalid_node_index;
 
-	return invalid_node_index;
+	return m_NodeToLineIndices[nodeIdx];
 }
 
 Elite::Polygon* Elite::NavGraph::GetNavMeshPolygon() const
@@ -50,21 +72,87 @@ Elite::Polygon* Elite::NavGraph::GetNavMeshPolygon() const
 	return m_pNavMeshPolygon;
 }
 
+int Elite::NavGraph::AddObstacle(const Polygon& shape)
+{
+	Polygon obstacle{ shape };
+	obstacle.ExpandShape(m_PlayerRadius);
+
+	TriangulationChange change{};
+	if (!m_pNavMeshPolygon->AddChildToTriangulation(obstacle, change))
+		return invalid_obstacle_id;
+
+	PatchNavigationGraph(change);
+
+	m_Obstacles.push_back(obstacle);
+	return int(m_Obstacles.size()) - 1;
+}
+
+bool Elite::NavGraph::MoveObstacle(int obstacleId, const Polygon& shape)
+{
+	if (obstacleId < 0 || obstacleId >= int(m_Obstacles.size()) || m_Obstacles[obstacleId].GetAmountVertices() == 0)
+		return false;
+
+	Polygon obstacle{ shape };
+	obstacle.ExpandShape(m_PlayerRadius);
+
+	// Take the old shape out first, the new one is allowed to overlap it
+	TriangulationChange change{};
+	if (!m_pNavMeshPolygon->RemoveChildFromTriangulation(m_Obstacles[obstacleId], change))
+		return false;
+
+	PatchNavigationGraph(change);
+
+	if (!m_pNavMeshPolygon->AddChildToTriangulation(obstacle, change))
+	{
+		// The old shape fitted before, so it should fit again, otherwise the obstacle is gone
+		const bool isRestored{ m_pNavMeshPolygon->AddChildToTriangulation(m_Obstacles[obstacleId], change) };
+		assert(isRestored && "<NavGraph::MoveObstacle>: the old shape of the obstacle doesn't fit anymore");
+		if (isRestored)
+			PatchNavigationGraph(change);
+		else
+			m_Obstacles[obstacleId] = Polygon{};
+		return false;
+	}
+
+	PatchNavigationGraph(change);
+
+	m_Obstacles[obstacleId] = obstacle;
+	return true;
+}
+
+bool Elite::NavGraph::RemoveObstacle(int obstacleId)
+{
+	if (obstacleId < 0 || obstacleId >= int(m_Obstacles.size()) || m_Obstacles[obstacleId].GetAmountVertices() == 0)
+		return false;
+
+	TriangulationChange change{};
+	if (!m_pNavMeshPolygon->RemoveChildFromTriangulation(m_Obstacles[obstacleId], change))
+		return false;
+
+	PatchNavigationGraph(change);
+
+	m_Obstacles[obstacleId] = Polygon{};
+	return true;
+}
+
 void Elite::NavGraph::CreateNavigationGraph()
 {
+	// Build the graph in one transaction, so it only results in one notification
+	this->BeginEdit();
+
 	//1. Go over all the edges of the navigationmesh and create nodes
+	const auto& lines = m_pNavMeshPolygon->GetLines();
+	m_LineToNodeIndices.assign(lines.size(), invalid_node_index);
+	m_NodeToLineIndices.clear();
+	m_FreeNodeIndices.clear();
+
 	int nodeIndex{};
-	for (const auto& line : m_pNavMeshPolygon->GetLines())
+	for (const auto& line : lines)
 	{
 		// Check if is connected to another triangle
-		if (m_pNavMeshPolygon->GetTrianglesFromLineIndex(line->index).size() > 1)
+		if (m_pNavMeshPolygon->GetTriangleIndicesFromLineIndex(line.index)[1] != -1)
 		{
-			const Vector2 middlePos{ (line->p2 + line->p1) / 2 };
-
-			// Create NavGraphNode to the graph
-			NavGraphNode* pNewGraphNode = new NavGraphNode{ nodeIndex,line->index,middlePos };
-			this->AddNode(pNewGraphNode);
-
+			AddLineNode(line.index, nodeIndex);
 			++nodeIndex;
 		}
 	}
@@ -75,10 +163,10 @@ void Elite::NavGraph::CreateNavigationGraph()
 	for (const auto& triangle : m_pNavMeshPolygon->GetTriangles())
 	{
 		// Loop over line indexes
-		for (size_t idx{}; idx < triangle->metaData.IndexLines.size(); ++idx)
+		for (size_t idx{}; idx < triangle.metaData.IndexLines.size(); ++idx)
 		{
 			// Check if valid node for that lineIdx exists
-			const int nodeIdx{ this->GetNodeIdxFromLineIdx(triangle->metaData.IndexLines[idx]) };
+			const int nodeIdx{ this->GetNodeIdxFromLineIdx(triangle.metaData.IndexLines[idx]) };
 			if (nodeIdx != invalid_node_index)
 			{		
 				// Add node to vector for connection later
@@ -138,5 +226,149 @@ void Elite::NavGraph::CreateNavigationGraph()
 
 	//3. Set the connections cost to the actual distance
 	this->SetConnectionCostsToDistance();
+
+	this->EndEdit();
 }
 
+bool Elite::NavGraph::LoadNavigationGraph(const GraphFile& file)
+{
+	const GraphFileHeader& header{ file.GetHeader() };
+	if (header.layout != GraphFileLayout::Graph || header.nodeType != GraphFileNodeType::NavGraph)
+		return false;
+
+	//1. The file is only used when it has a node in the middle of every line between two triangles, like CreateNavigationGraph would make
+	const auto& lines = m_pNavMeshPolygon->GetLines();
+	int nrOfLineNodes{};
+	for (const auto& line : lines)
+	{
+		if (m_pNavMeshPolygon->GetTriangleIndicesFromLineIndex(line.index)[1] != -1)
+			++nrOfLineNodes;
+	}
+
+	if (header.nrOfNodes != nrOfLineNodes)
+		return false;
+
+	const GraphFileNode* pNodes{ file.GetNodes() };
+	std::vector<bool> hasLineNode(lines.size(), false);
+	for (int nodeIdx{}; nodeIdx < header.nrOfNodes; ++nodeIdx)
+	{
+		const int lineIdx{ pNodes[nodeIdx].extra };
+		if (pNodes[nodeIdx].index != nodeIdx || lineIdx < 0 || lineIdx >= int(lines.size()) || hasLineNode[lineIdx]
+			|| m_pNavMeshPolygon->GetTriangleIndicesFromLineIndex(lineIdx)[1] == -1)
+			return false;
+
+		const Vector2 middlePos{ (lines[lineIdx].p2 + lines[lineIdx].p1) / 2 };
+		if (middlePos != Vector2{ pNodes[nodeIdx].x, pNodes[nodeIdx].y })
+			return false;
+
+		hasLineNode[lineIdx] = true;
+	}
+
+	//2. Nodes and connections, in one transaction
+	if (!LoadGraphFile(file, static_cast<IGraph<NavGraphNode, GraphConnection2D>&>(*this)))
+		return false;
+
+	//3. Tables between lines and nodes
+	m_LineToNodeIndices.assign(lines.size(), invalid_node_index);
+	m_NodeToLineIndices.assign(header.nrOfNodes, invalid_node_index);
+	m_FreeNodeIndices.clear();
+	for (int nodeIdx{}; nodeIdx < header.nrOfNodes; ++nodeIdx)
+	{
+		m_LineToNodeIndices[pNodes[nodeIdx].extra] = nodeIdx;
+		m_NodeToLineIndices[nodeIdx] = pNodes[nodeIdx].extra;
+	}
+
+	return true;
+}
+
+void Elite::NavGraph::PatchNavigationGraph(const TriangulationChange& change)
+{
+	this->BeginEdit();
+
+	//1. Connections through the replaced triangles, the ones between lines that stay would be left behind otherwise
+	for (const auto& lineIndices : change.removedTriangles)
+	{
+		for (size_t idx{}; idx < lineIndices.size(); ++idx)
+		{
+			const int fromIdx{ this->GetNodeIdxFromLineIdx(lineIndices[idx]) };
+			const int toIdx{ this->GetNodeIdxFromLineIdx(lineIndices[(idx + 1) % lineIndices.size()]) };
+			if (fromIdx != invalid_node_index && toIdx != invalid_node_index && !this->IsUniqueConnection(fromIdx, toIdx))
+				this->RemoveConnection(fromIdx, toIdx);
+		}
+	}
+
+	//2. Nodes of the lines that are gone
+	for (const int lineIdx : change.removedLines)
+	{
+		const int nodeIdx{ this->GetNodeIdxFromLineIdx(lineIdx) };
+		if (nodeIdx == invalid_node_index)
+			continue;
+
+		this->RemoveNode(nodeIdx);
+		m_LineToNodeIndices[lineIdx] = invalid_node_index;
+		m_NodeToLineIndices[nodeIdx] = invalid_node_index;
+		m_FreeNodeIndices.push_back(nodeIdx);
+	}
+
+	//3. Nodes of the new lines between two triangles, in the slots of removed nodes first
+	m_LineToNodeIndices.resize(m_pNavMeshPolygon->GetLines().size(), invalid_node_index);
+	for (const int lineIdx : change.addedLines)
+	{
+		if (m_pNavMeshPolygon->GetTriangleIndicesFromLineIndex(lineIdx)[1] == -1)
+			continue;
+
+		int nodeIdx{ this->GetNextFreeNodeIndex() };
+		if (!m_FreeNodeIndices.empty())
+		{
+			nodeIdx = m_FreeNodeIndices.back();
+			m_FreeNodeIndices.pop_back();
+		}
+		AddLineNode(lineIdx, nodeIdx);
+	}
+
+	//4. Connections through the new triangles
+	for (const auto& lineIndices : change.addedTriangles)
+	{
+		for (size_t idx{}; idx < lineIndices.size(); ++idx)
+		{
+			const int fromIdx{ this->GetNodeIdxFromLineIdx(lineIndices[idx]) };
+			const int toIdx{ this->GetNodeIdxFromLineIdx(lineIndices[(idx + 1) % lineIndices.size()]) };
+			if (fromIdx == invalid_node_index || toIdx == invalid_node_index || !this->IsUniqueConnection(fromIdx, toIdx))
+				continue;
+
+			const float cost{ Distance(this->GetNode(fromIdx)->GetPosition(), this->GetNode(toIdx)->GetPosition()) };
+			this->AddConnection(new GraphConnection2D{ fromIdx, toIdx, cost });
+		}
+	}
+
+	this->EndEdit();
+}
+
+void Elite::NavGraph::AddLineNode(int lineIdx, int nodeIdx)
+{
+	const Line& line{ m_pNavMeshPolygon->GetLines()[lineIdx] };
+	const Vector2 middlePos{ (line.p2 + line.p1) / 2 };
+
+	// Create NavGraphNode to the graph, a spare node is taken first
+	NavGraphNode* pNewGraphNode{ nullptr };
+	if (m_SpareNodes.empty())
+	{
+		pNewGraphNode = new NavGraphNode{ nodeIdx,lineIdx,middlePos };
+	}
+	else
+	{
+		pNewGraphNode = m_SpareNodes.back();
+		m_SpareNodes.pop_back();
+		*pNewGraphNode = NavGraphNode{ nodeIdx,lineIdx,middlePos };
+	}
+
+	// The graph doesn't delete the removed node that is in a reused slot, it becomes a spare
+	if (nodeIdx < this->GetNrOfNodes())
+		m_SpareNodes.push_back(this->GetNode(nodeIdx));
+	this->AddNode(pNewGraphNode);
+
+	m_LineToNodeIndices[lineIdx] = nodeIdx;
+	if (nodeIdx >= int(m_NodeToLineIndices.size()))
+		m_NodeToLineIndices.resize(nodeIdx + 1, invalid_node_index);
+	m_NodeToLineIndices[nodeIdx] = lineIdx;
+}
@@ -3,23 +3,48 @@
 #include "framework/EliteAI/EliteGraphs/EGraph2D.h"
 #include "framework/EliteAI/EliteGraphs/EGraphConnectionTypes.h"
 #include "framework/EliteAI/EliteGraphs/EGraphNodeTypes.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphUtilities/EGraphFile.h"
 
 namespace Elite
 {
+	const int invalid_obstacle_id = -1;
+
 	class NavGraph final: public Graph2D<NavGraphNode, GraphConnection2D>
 	{
 	public:
-		NavGraph(const Polygon& baseMesh, float playerRadius );
+		// With a graph file the nodes and connections are read from it when they still match the triangulation of the level,
+		// otherwise they are built and written to it. The triangulation itself is always built from the level.
+		NavGraph(const Polygon& baseMesh, float playerRadius, const std::string& graphFilePath = "");
 		~NavGraph();
 
+		// Both are lookups in tables filled by CreateNavigationGraph, invalid_node_index when the line has no node (and the other way around)
 		int GetNodeIdxFromLineIdx(int lineIdx) const;
+		int GetLineIdxFromNodeIdx(int nodeIdx) const;
 		Polygon* GetNavMeshPolygon() const;
 
+		// Dynamic obstacles, the shape gets expanded by the player radius like the static colliders.
+		// Only the triangles around the obstacle are retriangulated and only the nodes and connections of their lines change,
+		// so the cost depends on the size of the obstacle instead of the size of the world.
+		// An obstacle that doesn't fit inside the mesh (it overlaps the border or another obstacle) is refused: invalid_obstacle_id or false, nothing changes.
+		// A refused move puts the old shape back, in the unexpected case that fails as well the obstacle is removed.
+		int AddObstacle(const Polygon& shape);
+		bool MoveObstacle(int obstacleId, const Polygon& shape);
+		bool RemoveObstacle(int obstacleId);
+
 	private:
 		//--- Datamembers ---
 		Polygon* m_pNavMeshPolygon = nullptr; //Polygon that represents navigation mesh
+		float m_PlayerRadius;
+		std::vector<int> m_LineToNodeIndices; //Node per line of the navigation mesh
+		std::vector<int> m_NodeToLineIndices; //Line per node
+		std::vector<int> m_FreeNodeIndices; //Removed by PatchNavigationGraph, reused for the next nodes
+		std::vector<NavGraphNode*> m_SpareNodes; //Removed nodes that lost their slot, reused for the next nodes so pointers to them stay valid
+		std::vector<Polygon> m_Obstacles; //Expanded shape per obstacle id, empty once removed
 
 		void CreateNavigationGraph();
+		bool LoadNavigationGraph(const GraphFile& file);
+		void PatchNavigationGraph(const TriangulationChange& change);
+		void AddLineNode(int lineIdx, int nodeIdx);
 
 
 	private:
@@ -0,0 +1,207 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// EOverlayGraph.h: Temporary edits layered on top of a graph without copying it, e.g. extra start and end nodes for a path query
+/*=============================================================================*/
+#pragma once
+
+#include "EIGraph.h"
+#include <unordered_map>
+
+namespace Elite
+{
+	// The overlay exposes the same query functions as IGraph, so the graph algorithms can run on it through their T_GraphType parameter.
+	// Nodes of the base graph keep their index, added nodes get the indices after the last node of the base graph.
+	// Connection lists of untouched nodes are the lists of the base graph, edited nodes get their own merged copy.
+	// The base graph can't be modified while an overlay on top of it is in use.
+	template<class T_NodeType, class T_ConnectionType>
+	class OverlayGraph final
+	{
+	public:
+		using ConnectionList = std::list<T_ConnectionType*>;
+
+		explicit OverlayGraph(const IGraph<T_NodeType, T_ConnectionType>* pBaseGraph);
+		~OverlayGraph();
+
+		// Queries
+		// -------
+		T_NodeType* GetNode(int idx) const;
+		bool IsNodeValid(int idx) const { return (idx < GetNrOfNodes() && idx != invalid_node_index); }
+		int GetNrOfNodes() const { return m_BaseNrOfNodes + int(m_AddedNodes.size()); }
+		int GetNextFreeNodeIndex() const { return GetNrOfNodes(); }
+		bool IsDirectionalGraph() const { return m_pBaseGraph->IsDirectionalGraph(); }
+
+		T_ConnectionType* GetConnection(int from, int to) const;
+		const ConnectionList& GetNodeConnections(int idx) const;
+		const ConnectionList& GetNodeConnections(T_NodeType* pNode) const { return GetNodeConnections(pNode->GetIndex()); }
+		bool IsUniqueConnection(int from, int to) const { return GetConnection(from, to) == nullptr; }
+
+		Vector2 GetNodePos(T_NodeType* pNode) const { return m_pBaseGraph->GetNodePos(pNode); }
+		Vector2 GetNodePos(int idx) const { return GetNodePos(GetNode(idx)); }
+		Vector2 GetNodeWorldPos(int idx) const;
+
+		const IGraph<T_NodeType, T_ConnectionType>* GetBaseGraph() const { return m_pBaseGraph; }
+
+		// Edits, the overlay takes ownership of the added nodes and connections
+		// ----------------------------------------------------------------------
+		int AddNode(T_NodeType* pNode);
+		void AddConnection(T_ConnectionType* pConnection);
+		void RemoveConnection(int from, int to);
+		void RemoveConnection(T_ConnectionType* pConnection) { RemoveConnection(pConnection->GetFrom(), pConnection->GetTo()); }
+
+		// Drops all edits, the overlay shows the base graph again
+		void Reset();
+
+	private:
+		const IGraph<T_NodeType, T_ConnectionType>* m_pBaseGraph;
+		int m_BaseNrOfNodes;
+		int m_BaseVersion;
+
+		std::vector<T_NodeType*> m_AddedNodes;
+		std::vector<T_ConnectionType*> m_OwnedConnections;
+		std::unordered_map<int, ConnectionList> m_EditedConnections;
+
+		ConnectionList& GetEditableConnections(int idx);
+
+		OverlayGraph(const OverlayGraph&) = delete;
+		OverlayGraph& operator=(const OverlayGraph&) = delete;
+	};
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline OverlayGraph<T_NodeType, T_ConnectionType>::OverlayGraph(const IGraph<T_NodeType, T_ConnectionType>* pBaseGraph)
+		: m_pBaseGraph(pBaseGraph)
+		, m_BaseNrOfNodes(pBaseGraph->GetNrOfNodes())
+		, m_BaseVersion(pBaseGraph->GetVersion())
+	{
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline OverlayGraph<T_NodeType, T_ConnectionType>::~OverlayGraph()
+	{
+		Reset();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline T_NodeType* OverlayGraph<T_NodeType, T_ConnectionType>::GetNode(int idx) const
+	{
+		assert((idx < GetNrOfNodes()) && (idx >= 0) && "<OverlayGraph::GetNode>: invalid index");
+
+		if (idx < m_BaseNrOfNodes)
+			return m_pBaseGraph->GetNode(idx);
+
+		return m_AddedNodes[idx - m_BaseNrOfNodes];
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline T_ConnectionType* OverlayGraph<T_NodeType, T_ConnectionType>::GetConnection(int from, int to) const
+	{
+		for (auto pConnection : GetNodeConnections(from))
+		{
+			if (pConnection->GetTo() == to)
+				return pConnection;
+		}
+
+		return nullptr;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline const std::list<T_ConnectionType*>& OverlayGraph<T_NodeType, T_ConnectionType>::GetNodeConnections(int idx) const
+	{
+		assert(m_pBaseGraph->GetVersion() == m_BaseVersion && "<OverlayGraph>: base graph was modified while the overlay is in use");
+
+		if (!m_EditedConnections.empty())
+		{
+			auto editedIt = m_EditedConnections.find(idx);
+			if (editedIt != m_EditedConnections.end())
+				return editedIt->second;
+		}
+
+		return m_pBaseGraph->GetNodeConnections(idx);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline Vector2 OverlayGraph<T_NodeType, T_ConnectionType>::GetNodeWorldPos(int idx) const
+	{
+		if (idx < m_BaseNrOfNodes)
+			return m_pBaseGraph->GetNodeWorldPos(idx);
+
+		// Added nodes are unknown to the base graph, only their own position can be used
+		return GetNodePos(idx);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int OverlayGraph<T_NodeType, T_ConnectionType>::AddNode(T_NodeType* pNode)
+	{
+		assert(pNode->GetIndex() == GetNextFreeNodeIndex() && "<OverlayGraph::AddNode>: invalid index");
+
+		m_AddedNodes.push_back(pNode);
+		m_EditedConnections[pNode->GetIndex()] = ConnectionList();
+
+		return pNode->GetIndex();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void OverlayGraph<T_NodeType, T_ConnectionType>::AddConnection(T_ConnectionType* pConnection)
+	{
+		assert((pConnection->GetFrom() < GetNrOfNodes()) && (pConnection->GetTo() < GetNrOfNodes()) && (pConnection->GetTo() != pConnection->GetFrom()) &&
+			"<OverlayGraph::AddConnection>: invalid node index");
+		assert(IsUniqueConnection(pConnection->GetFrom(), pConnection->GetTo()) && "Connection already exists on this graph");
+
+		m_OwnedConnections.push_back(pConnection);
+		GetEditableConnections(pConnection->GetFrom()).push_back(pConnection);
+
+		// Same as IGraph, undirected graphs get the connection in the opposite direction as well
+		if (!IsDirectionalGraph() && IsUniqueConnection(pConnection->GetTo(), pConnection->GetFrom()))
+		{
+			T_ConnectionType* oppositeDirEdge = new T_ConnectionType();
+
+			oppositeDirEdge->SetCost(pConnection->GetCost());
+			oppositeDirEdge->SetTo(pConnection->GetFrom());
+			oppositeDirEdge->SetFrom(pConnection->GetTo());
+
+			m_OwnedConnections.push_back(oppositeDirEdge);
+			GetEditableConnections(pConnection->GetTo()).push_back(oppositeDirEdge);
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void OverlayGraph<T_NodeType, T_ConnectionType>::RemoveConnection(int from, int to)
+	{
+		auto removeConnectionsTo = [this](int fromIdx, int toIdx)
+		{
+			// Connections stay alive until the overlay is reset, only the merged list forgets about them
+			auto& connections = GetEditableConnections(fromIdx);
+			connections.remove_if([toIdx](T_ConnectionType* pConnection) { return pConnection->GetTo() == toIdx; });
+		};
+
+		removeConnectionsTo(from, to);
+
+		if (!IsDirectionalGraph())
+			removeConnectionsTo(to, from);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void OverlayGraph<T_NodeType, T_ConnectionType>::Reset()
+	{
+		for (auto& pNode : m_AddedNodes)
+			SAFE_DELETE(pNode);
+		m_AddedNodes.clear();
+
+		for (auto& pConnection : m_OwnedConnections)
+			SAFE_DELETE(pConnection);
+		m_OwnedConnections.clear();
+
+		m_EditedConnections.clear();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline std::list<T_ConnectionType*>& OverlayGraph<T_NodeType, T_ConnectionType>::GetEditableConnections(int idx)
+	{
+		auto editedIt = m_EditedConnections.find(idx);
+		if (editedIt != m_EditedConnections.end())
+			return editedIt->second;
+
+		// First edit of a node of the base graph, start from a copy of its connections
+		return m_EditedConnections[idx] = m_pBaseGraph->GetNodeConnections(idx);
+	}
+}
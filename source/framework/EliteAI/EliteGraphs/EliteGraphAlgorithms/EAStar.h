@@ -3,258 +3,287 @@
 
 namespace Elite
 {
+	enum class SearchStatus
+	{
+		Idle, // no search started
+		InProgress,
+		Found,
+		NotFound
+	};
 
-	template <class T_NodeType, class T_ConnectionType>
+	// T_GraphType can be any graph that offers the query functions of IGraph (GetNode, GetNodeConnections, GetNodePos), e.g. an OverlayGraph
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType = IGraph<T_NodeType, T_ConnectionType>>
 	class AStar
 	{
 	public:
-		AStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction);
+		AStar(T_GraphType* pGraph, Heuristic hFunction);
 
-		// stores the optimal connection to a node and its total costs related to the start and end node of the path
-		struct NodeRecord
-		{
-			T_NodeType* pNode = nullptr;
-			T_ConnectionType* pConnection = nullptr;
-			float costSoFar = 0.f; // accumulated g-costs of all the connections leading up to this one
-			float estimatedTotalCost = 0.f; // f-cost (= costSoFar + h-cost)
+		// Returns the nodes from start to destination, or an empty path when the destination can't be reached
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
 
-			bool operator==(const NodeRecord& other) const
-			{
-				return pNode == other.pNode
-					&& pConnection == other.pConnection
-					&& costSoFar == other.costSoFar
-					&& estimatedTotalCost == other.estimatedTotalCost;
-			};
+		// Time-sliced search: BeginSearch, then Step until the status is no longer InProgress, the open list and arrays are kept in between
+		// The graph shouldn't change while a search is in progress, start a new search when it did
+		bool BeginSearch(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+		// Expands at most maxExpansions nodes (outdated open list entries don't count)
+		SearchStatus Step(int maxExpansions);
+		SearchStatus GetStatus() const { return m_Status; }
 
-			bool operator<(const NodeRecord& other) const
-			{
-				return estimatedTotalCost < other.estimatedTotalCost;
-			};
-		};
+		// Full path once the status is Found, empty otherwise
+		std::vector<T_NodeType*> GetPath() const;
+		// Path towards the expanded node with the lowest heuristic cost so far, something to start moving along while the search continues
+		std::vector<T_NodeType*> GetPartialPath() const;
 
-		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+		// The search arrays are kept between queries, the graph can be swapped as long as the node indices stay valid
+		void SetGraph(T_GraphType* pGraph) { m_pGraph = pGraph; }
+		void SetHeuristic(Heuristic hFunction) { m_HeuristicFunction = hFunction; }
+		// Combined with the heuristic function by taking the largest estimate, so both have to be admissible for optimal paths
+		void SetNodeHeuristic(const NodeHeuristic& nodeHeuristic) { m_NodeHeuristic = nodeHeuristic; }
+
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
 
 	private:
-		float GetHeuristicCost(T_NodeType* pStartNode, T_NodeType* pEndNode) const;
+		// Entry on the open list, entries that became outdated after a cheaper path was found are skipped when popped
+		struct OpenEntry
+		{
+			float estimatedTotalCost; // f-cost (= costSoFar + h-cost)
+			float costSoFar; // g-cost at the time the entry was pushed
+			int nodeIdx;
+
+			// Sorts the heap on the lowest f-cost, on equal f-costs the node furthest along the path goes first
+			bool operator<(const OpenEntry& other) const
+			{
+				if (estimatedTotalCost != other.estimatedTotalCost)
+					return estimatedTotalCost > other.estimatedTotalCost;
+				return costSoFar < other.costSoFar;
+			}
+		};
 
-		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		float GetHeuristicCost(T_NodeType* pNode, int goalIdx, const Vector2& goalPos) const;
+		void PrepareSearch();
+		void VisitNode(int idx);
+		std::vector<T_NodeType*> ReconstructPath(int idx) const;
+
+		T_GraphType* m_pGraph;
 		Heuristic m_HeuristicFunction;
+		NodeHeuristic m_NodeHeuristic;
+
+		// Per node index, only valid for nodes whose m_VisitedGeneration matches the current search
+		std::vector<float> m_CostSoFar;
+		std::vector<int> m_Parent;
+		std::vector<bool> m_IsClosed;
+		std::vector<unsigned int> m_VisitedGeneration;
+		unsigned int m_Generation = 0;
+
+		std::vector<OpenEntry> m_OpenList;
+		int m_NrOfExpandedNodes = 0;
+
+		// Current search
+		SearchStatus m_Status = SearchStatus::Idle;
+		int m_GoalIdx = invalid_node_index;
+		Vector2 m_GoalPos{};
+		int m_ClosestNodeIdx = invalid_node_index;
+		float m_ClosestHeuristicCost = FLT_MAX;
 	};
 
-	template <class T_NodeType, class T_ConnectionType>
-	AStar<T_NodeType, T_ConnectionType>::AStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction)
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	AStar<T_NodeType, T_ConnectionType, T_GraphType>::AStar(T_GraphType* pGraph, Heuristic hFunction)
 		: m_pGraph(pGraph)
 		, m_HeuristicFunction(hFunction)
 	{
 	}
 
-	template <class T_NodeType, class T_ConnectionType>
-	std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType, T_GraphType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
 	{
-		// StartVariables
-		std::vector<T_NodeType*> path;
-		std::vector<NodeRecord> openList;
-		std::vector<NodeRecord> closedList;
-		NodeRecord currentRecord;
+		if (!BeginSearch(pStartNode, pGoalNode))
+			return {};
 
-		// StartRecord
-		NodeRecord startRecord;
-		startRecord.pNode = pStartNode;
-		startRecord.pConnection = nullptr;
-		startRecord.costSoFar = 0;
-		startRecord.estimatedTotalCost = GetHeuristicCost(pStartNode, pGoalNode);
+		Step((std::numeric_limits<int>::max)());
+		return GetPath();
+	}
 
-		openList.push_back(startRecord);
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	bool AStar<T_NodeType, T_ConnectionType, T_GraphType>::BeginSearch(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		PrepareSearch();
 
-		bool goToNextConnection{ false };
-		NodeRecord existingRecord;
-		existingRecord.pNode = nullptr;
+		if (pStartNode == nullptr || pGoalNode == nullptr)
+		{
+			m_Status = SearchStatus::NotFound;
+			return false;
+		}
 
-		bool hasSameNode{};
-		bool hasSameConnection{};
+		const int startIdx{ pStartNode->GetIndex() };
+		m_GoalIdx = pGoalNode->GetIndex();
+		m_GoalPos = m_pGraph->GetNodePos(pGoalNode);
 
-		// Start the loop
-		while (openList.empty() == false)
+		// StartRecord
+		const float heuristicCost{ GetHeuristicCost(pStartNode, m_GoalIdx, m_GoalPos) };
+		VisitNode(startIdx);
+		m_CostSoFar[startIdx] = 0.f;
+		m_OpenList.push_back({ heuristicCost, 0.f, startIdx });
+
+		m_ClosestNodeIdx = startIdx;
+		m_ClosestHeuristicCost = heuristicCost;
+		m_Status = SearchStatus::InProgress;
+		return true;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	SearchStatus AStar<T_NodeType, T_ConnectionType, T_GraphType>::Step(int maxExpansions)
+	{
+		if (m_Status != SearchStatus::InProgress)
+			return m_Status;
+
+		int nrOfExpansions{};
+		while (nrOfExpansions < maxExpansions)
 		{
+			if (m_OpenList.empty())
+			{
+				m_Status = SearchStatus::NotFound;
+				break;
+			}
+
 			// Get lowestCost node from openList
-			currentRecord = *std::min_element(openList.begin(), openList.end());
+			std::pop_heap(m_OpenList.begin(), m_OpenList.end());
+			const OpenEntry currentEntry{ m_OpenList.back() };
+			m_OpenList.pop_back();
+
+			const int currentIdx{ currentEntry.nodeIdx };
+
+			// Skip outdated entries
+			if (m_IsClosed[currentIdx] || currentEntry.costSoFar > m_CostSoFar[currentIdx])
+				continue;
+
+			m_IsClosed[currentIdx] = true;
+			++m_NrOfExpandedNodes;
+			++nrOfExpansions;
 
 			// Check if lowestCost node is endNode
-			if (currentRecord.pNode == pGoalNode)
+			if (currentIdx == m_GoalIdx)
 			{
+				m_Status = SearchStatus::Found;
 				break;
 			}
 
+			// Remember the node that got closest to the goal for the partial path
+			const float heuristicCost{ currentEntry.estimatedTotalCost - currentEntry.costSoFar };
+			if (heuristicCost < m_ClosestHeuristicCost)
+			{
+				m_ClosestNodeIdx = currentIdx;
+				m_ClosestHeuristicCost = heuristicCost;
+			}
+
 			// Get all connections
-			for (auto& connection : m_pGraph->GetNodeConnections(currentRecord.pNode))
+			for (auto& connection : m_pGraph->GetNodeConnections(currentIdx))
 			{
-				// Get node that connections is pointing to
-				T_NodeType* pNextNode{ m_pGraph->GetNode(connection->GetTo()) };
-
-
-				//---------------//
-				//--First Check--//
-				//---------------//
-
-				// Check if node is already on closedList
-				for (auto& nodeRecord : closedList)
-				{
-					if (pNextNode == nodeRecord.pNode)
-					{
-						// If connection is cheaper, replace with old connection
-						if (currentRecord.estimatedTotalCost < nodeRecord.estimatedTotalCost)
-						{
-							existingRecord = nodeRecord;
-						}
-						// Else just leave it
-						else
-						{
-							goToNextConnection = true;
-						}
-
-						break;
-					}
-				}
-
-				// Remove from closedList if necesarry
-				if (existingRecord.pNode)
-				{
-					for (size_t idx{}; idx < closedList.size(); ++idx)
-					{
-						hasSameNode = closedList[idx].pNode == currentRecord.pNode;
-						hasSameConnection = closedList[idx].pConnection == currentRecord.pConnection;
-
-						if (hasSameNode && hasSameConnection)
-						{
-							closedList.erase(closedList.begin() + idx);
-							break;
-						}
-					}
-
-					// Reset variables
-					existingRecord = {};
-					existingRecord.pNode = nullptr;
-				}
-
-				// Go next if needed
-				if (goToNextConnection)
-				{
-					goToNextConnection = false;
-					continue;
-				}
-
-
-				//----------------//
-				//--Second Check--//
-				//----------------//
-
-				// Check if node is already on openList
-				for (auto& nodeRecord : openList)
-				{
-					if (pNextNode == nodeRecord.pNode)
-					{
-						// If connection is cheaper, replace with old connection
-						if (currentRecord.estimatedTotalCost < nodeRecord.estimatedTotalCost)
-						{
-							existingRecord = nodeRecord;
-						}
-						// Else just leave it
-						else
-						{
-							goToNextConnection = true;
-						}
-
-						break;
-					}
-				}
-
-				// Remove from openList if necesarry
-				if (existingRecord.pNode)
-				{
-					for (size_t idx{}; idx < openList.size(); ++idx)
-					{
-						hasSameNode = openList[idx].pNode == currentRecord.pNode;
-						hasSameConnection = openList[idx].pConnection == currentRecord.pConnection;
-
-						if (hasSameNode && hasSameConnection)
-						{
-							openList.erase(openList.begin() + idx);
-							break;
-						}
-					}
-
-					// Reset variables
-					existingRecord = {};
-					existingRecord.pNode = nullptr;
-				}
-
-				// Go next if needed
-				if (goToNextConnection)
-				{
-					goToNextConnection = false;
+				const int nextIdx{ connection->GetTo() };
+				VisitNode(nextIdx);
+
+				// Only keep the cheapest way to reach a node, a closed node gets reopened when a cheaper way is found
+				const float costSoFar{ m_CostSoFar[currentIdx] + connection->GetCost() };
+				if (costSoFar >= m_CostSoFar[nextIdx])
 					continue;
-				}
 
+				m_CostSoFar[nextIdx] = costSoFar;
+				m_Parent[nextIdx] = currentIdx;
+				m_IsClosed[nextIdx] = false;
 
-				//-------------------//
-				//--Add to openList--//
-				//-------------------//
+				const float estimatedTotalCost{ costSoFar + GetHeuristicCost(m_pGraph->GetNode(nextIdx), m_GoalIdx, m_GoalPos) };
+				m_OpenList.push_back({ estimatedTotalCost, costSoFar, nextIdx });
+				std::push_heap(m_OpenList.begin(), m_OpenList.end());
+			}
+		}
 
-				NodeRecord newRecord;
-				newRecord.pNode = pNextNode;
-				newRecord.pConnection = connection;
-				newRecord.costSoFar = currentRecord.costSoFar + connection->GetCost();
-				newRecord.estimatedTotalCost = GetHeuristicCost(newRecord.pNode, pGoalNode) + newRecord.costSoFar;
+		return m_Status;
+	}
 
-				openList.push_back(newRecord);
-			}
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	inline std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType, T_GraphType>::GetPath() const
+	{
+		if (m_Status != SearchStatus::Found)
+			return {};
 
-			// Remove from openList and add to closedList
-			for (size_t idx{}; idx < openList.size(); ++idx)
-			{
-				hasSameNode = openList[idx].pNode == currentRecord.pNode;
-				hasSameConnection = openList[idx].pConnection == currentRecord.pConnection;
-
-				if (hasSameNode && hasSameConnection)
-				{
-					openList.erase(openList.begin() + idx);
-					break;
-				}
-			}
-			closedList.push_back(currentRecord);
-		}
+		return ReconstructPath(m_GoalIdx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	inline std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType, T_GraphType>::GetPartialPath() const
+	{
+		if (m_Status == SearchStatus::Found)
+			return ReconstructPath(m_GoalIdx);
 
+		if (m_Status == SearchStatus::Idle || m_ClosestNodeIdx == invalid_node_index)
+			return {};
 
+		return ReconstructPath(m_ClosestNodeIdx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	inline std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType, T_GraphType>::ReconstructPath(int idx) const
+	{
 		//--------------------//
 		//--Reconstruct Path--//
 		//--------------------//
 
-		// Do until currentNode is startNode
-		while (currentRecord.pNode != pStartNode)
+		std::vector<T_NodeType*> path;
+		for (; idx != invalid_node_index; idx = m_Parent[idx])
 		{
-			// Add node to path
-			path.push_back(currentRecord.pNode);
-
-			for (auto& records : closedList)
-			{
-				// TrackBack
-				if (records.pNode == m_pGraph->GetNode(currentRecord.pConnection->GetFrom()))
-				{
-					currentRecord = records;
-					break;
-				}
-			}
+			path.push_back(m_pGraph->GetNode(idx));
 		}
 
-		path.push_back(pStartNode);
 		std::reverse(path.begin(), path.end());
 		return path;
 	}
 
-	template <class T_NodeType, class T_ConnectionType>
-	float Elite::AStar<T_NodeType, T_ConnectionType>::GetHeuristicCost(T_NodeType* pStartNode, T_NodeType* pEndNode) const
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	inline void AStar<T_NodeType, T_ConnectionType, T_GraphType>::PrepareSearch()
 	{
-		Vector2 toDestination = m_pGraph->GetNodePos(pEndNode) - m_pGraph->GetNodePos(pStartNode);
-		return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+		// Arrays only grow, so they get reused by every query on the same graph
+		const size_t nrOfNodes{ size_t(m_pGraph->GetNrOfNodes()) };
+		if (m_VisitedGeneration.size() < nrOfNodes)
+		{
+			m_CostSoFar.resize(nrOfNodes);
+			m_Parent.resize(nrOfNodes);
+			m_IsClosed.resize(nrOfNodes);
+			m_VisitedGeneration.resize(nrOfNodes, 0);
+		}
+
+		// A new generation invalidates the data of the previous search without clearing the arrays
+		++m_Generation;
+		if (m_Generation == 0)
+		{
+			std::fill(m_VisitedGeneration.begin(), m_VisitedGeneration.end(), 0);
+			m_Generation = 1;
+		}
+
+		m_OpenList.clear();
+		m_NrOfExpandedNodes = 0;
+		m_Status = SearchStatus::Idle;
+		m_ClosestNodeIdx = invalid_node_index;
+		m_ClosestHeuristicCost = FLT_MAX;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	inline void AStar<T_NodeType, T_ConnectionType, T_GraphType>::VisitNode(int idx)
+	{
+		if (m_VisitedGeneration[idx] == m_Generation)
+			return;
+
+		m_VisitedGeneration[idx] = m_Generation;
+		m_CostSoFar[idx] = FLT_MAX;
+		m_Parent[idx] = invalid_node_index;
+		m_IsClosed[idx] = false;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	float Elite::AStar<T_NodeType, T_ConnectionType, T_GraphType>::GetHeuristicCost(T_NodeType* pNode, int goalIdx, const Vector2& goalPos) const
+	{
+		Vector2 toDestination = goalPos - m_pGraph->GetNodePos(pNode);
+		const float hCost{ m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y)) };
+		if (!m_NodeHeuristic)
+			return hCost;
+
+		return std::max(hCost, m_NodeHeuristic(pNode->GetIndex(), goalIdx));
 	}
-}
\ No newline at end of file
+}
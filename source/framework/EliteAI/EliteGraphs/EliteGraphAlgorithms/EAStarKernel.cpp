@@ -0,0 +1,14 @@
+#include "stdafx.h"
+#include "EAStarKernel.h"
+
+namespace Elite
+{
+	// The prebuilt searches, so the apps that use them don't each compile the kernel
+	template class AStarKernel<GridHeuristic<OctileDistance>, GridStencilNeighbors>;
+	template class AStarKernel<PositionHeuristic<EuclideanDistance>, OverlayNeighbors<CSRNeighbors>>;
+	template class AStarKernel<GridHeuristic<OctileDistance>, CSRNeighbors>;
+	template class GridGraphAStar<GridTerrainNode, GraphConnection>;
+	template class GridGraphAStar<InfluenceNode, GraphConnection>;
+	template void GridStencilNeighbors::Build(const GridGraph<GridTerrainNode, GraphConnection>& grid);
+	template void GridStencilNeighbors::Build(const GridGraph<InfluenceNode, GraphConnection>& grid);
+}
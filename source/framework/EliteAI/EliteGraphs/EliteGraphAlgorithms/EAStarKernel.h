@@ -0,0 +1,543 @@
+#pragma once
+#include "framework/EliteAI/EliteNavigation/ENavigation.h"
+#include "framework/EliteAI/EliteGraphs/EGridGraph.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphUtilities/EGraphSnapshot.h"
+
+namespace Elite
+{
+	// A* search kernel with the heuristic, the cost model and the neighbour enumeration as template policies instead of function pointers and virtual graph calls,
+	// so the whole inner loop inlines. Nodes are plain indices, the policies are built from a graph once and reused for every query until the graph changes.
+	//
+	// T_Heuristic:  void SetGoal(int goalIdx), float operator()(int idx) const
+	// T_Neighbors:  int GetNrOfNodes() const, void ForEachNeighbor(int idx, T_Function function) const, which calls function(nextIdx, connectionCost)
+	// T_CostModel:  float operator()(int fromIdx, int toIdx, float connectionCost) const
+
+	//------------------//
+	//--Distance terms--//
+	//------------------//
+
+	// Same formulas as HeuristicFunctions, as types so the call can be inlined
+	struct ManhattanDistance
+	{
+		float operator()(float x, float y) const { return x + y; }
+	};
+
+	struct EuclideanDistance
+	{
+		float operator()(float x, float y) const { return sqrtf(x * x + y * y); }
+	};
+
+	struct OctileDistance
+	{
+		float operator()(float x, float y) const { return (x < y) ? 0.414213562373095048801f * x + y : 0.414213562373095048801f * y + x; }
+	};
+
+	struct ChebyshevDistance
+	{
+		float operator()(float x, float y) const { return (x < y) ? y : x; }
+	};
+
+	//--------------//
+	//--Heuristics--//
+	//--------------//
+
+	// Distance in columns and rows, derived from the index (GridGraph::GetNodePos without the virtual call)
+	template<class T_Distance>
+	class GridHeuristic final
+	{
+	public:
+		explicit GridHeuristic(int columns = 1) : m_Columns(columns) {}
+
+		void SetGoal(int goalIdx) { m_GoalCol = goalIdx % m_Columns; m_GoalRow = goalIdx / m_Columns; }
+		float operator()(int idx) const { return m_Distance(float(abs(idx % m_Columns - m_GoalCol)), float(abs(idx / m_Columns - m_GoalRow))); }
+
+	private:
+		int m_Columns;
+		int m_GoalCol = 0;
+		int m_GoalRow = 0;
+		T_Distance m_Distance{};
+	};
+
+	// Distance between positions that are copied out of the graph once, for graphs without a layout (e.g. a NavGraph)
+	template<class T_Distance>
+	class PositionHeuristic final
+	{
+	public:
+		PositionHeuristic() = default;
+		explicit PositionHeuristic(std::vector<Vector2> positions) : m_Positions(std::move(positions)) {}
+		explicit PositionHeuristic(const GraphSnapshot& snapshot);
+
+		// Grows the positions when needed, e.g. for the extra nodes of OverlayNeighbors
+		void SetNodePos(int idx, const Vector2& pos);
+
+		void SetGoal(int goalIdx) { m_GoalPos = m_Positions[goalIdx]; }
+		float operator()(int idx) const { return m_Distance(abs(m_Positions[idx].x - m_GoalPos.x), abs(m_Positions[idx].y - m_GoalPos.y)); }
+
+	private:
+		std::vector<Vector2> m_Positions;
+		Vector2 m_GoalPos{};
+		T_Distance m_Distance{};
+	};
+
+	//---------------//
+	//--Cost models--//
+	//---------------//
+
+	// The cost stored on the connection
+	struct ConnectionCost
+	{
+		float operator()(int, int, float connectionCost) const { return connectionCost; }
+	};
+
+	// Every connection costs the same, finds the paths with the fewest connections
+	struct UniformCost
+	{
+		float operator()(int, int, float) const { return 1.f; }
+	};
+
+	//-------------------------//
+	//--Neighbour enumeration--//
+	//-------------------------//
+
+	// The 8 cells around a cell, with a bit per direction for the connections that exist and the cost of each
+	// Takes the connections (and so the walls and terrain costs) of a GridGraph without touching its connection lists during the search
+	class GridStencilNeighbors final
+	{
+	public:
+		GridStencilNeighbors() = default;
+
+		template<class T_NodeType, class T_ConnectionType>
+		void Build(const GridGraph<T_NodeType, T_ConnectionType>& grid);
+		template<class T_NodeType, class T_ConnectionType>
+		bool IsUpToDate(const GridGraph<T_NodeType, T_ConnectionType>& grid) const { return m_GraphVersion == grid.GetVersion() && m_NrOfNodes == grid.GetNrOfNodes(); }
+
+		int GetNrOfNodes() const { return m_NrOfNodes; }
+		int GetColumns() const { return m_Columns; }
+
+		template<class T_Function>
+		void ForEachNeighbor(int idx, T_Function function) const;
+
+	private:
+		static const int nrOfDirections = 8;
+
+		int m_Columns = 0;
+		int m_Rows = 0;
+		int m_NrOfNodes = 0;
+		int m_GraphVersion = -1;
+
+		// Per cell
+		std::vector<uint8_t> m_DirectionMasks;
+		std::vector<float> m_Costs; // nrOfDirections per cell
+
+		int m_IndexOffsets[nrOfDirections]{};
+	};
+
+	// Compressed adjacency, e.g. of a GraphSnapshot or a GraphFile
+	class CSRNeighbors final
+	{
+	public:
+		explicit CSRNeighbors(const GraphCSRView& view = {}) : m_View(view) {}
+
+		int GetNrOfNodes() const { return m_View.nrOfNodes; }
+
+		template<class T_Function>
+		void ForEachNeighbor(int idx, T_Function function) const
+		{
+			const int lastConnection{ m_View.GetFirstConnection(idx) + m_View.GetNrOfConnections(idx) };
+			for (int connectionIdx{ m_View.GetFirstConnection(idx) }; connectionIdx < lastConnection; ++connectionIdx)
+				function(m_View.GetTarget(connectionIdx), m_View.GetCost(connectionIdx));
+		}
+
+	private:
+		GraphCSRView m_View;
+	};
+
+	// Extra nodes layered on top of other neighbours without copying them, like an OverlayGraph (e.g. the start and end node of a navmesh query)
+	template<class T_BaseNeighbors>
+	class OverlayNeighbors final
+	{
+	public:
+		explicit OverlayNeighbors(const T_BaseNeighbors* pBase = nullptr) : m_pBase(pBase) {}
+
+		void SetBase(const T_BaseNeighbors* pBase) { m_pBase = pBase; Clear(); }
+
+		// Adds a node after the nodes of the base and returns its index, the connections (nodeIdx, cost) are used in both directions
+		int AddNode(const std::vector<std::pair<int, float>>& connections);
+		void Clear();
+
+		int GetNrOfNodes() const { return m_pBase->GetNrOfNodes() + int(m_ExtraNodes.size()); }
+
+		template<class T_Function>
+		void ForEachNeighbor(int idx, T_Function function) const;
+
+	private:
+		struct ExtraConnection
+		{
+			int from;
+			int to;
+			float cost;
+		};
+
+		const T_BaseNeighbors* m_pBase;
+		std::vector<std::vector<std::pair<int, float>>> m_ExtraNodes;
+		// Connections from base nodes towards the extra nodes, only a few so they are scanned
+		std::vector<ExtraConnection> m_ExtraConnections;
+	};
+
+	//----------//
+	//--Kernel--//
+	//----------//
+
+	template<class T_Heuristic, class T_Neighbors, class T_CostModel = ConnectionCost>
+	class AStarKernel final
+	{
+	public:
+		AStarKernel(const T_Neighbors* pNeighbors, const T_Heuristic& heuristic, const T_CostModel& costModel = T_CostModel{});
+
+		// Fills the node indices from start to goal, returns false (and an empty path) when the goal can't be reached
+		bool FindPath(int startIdx, int goalIdx, std::vector<int>& path);
+
+		void SetNeighbors(const T_Neighbors* pNeighbors) { m_pNeighbors = pNeighbors; }
+		T_Heuristic& GetHeuristic() { return m_Heuristic; }
+
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+
+	private:
+		// Same ordering as AStar
+		struct OpenEntry
+		{
+			float estimatedTotalCost;
+			float costSoFar;
+			int nodeIdx;
+
+			bool operator<(const OpenEntry& other) const
+			{
+				if (estimatedTotalCost != other.estimatedTotalCost)
+					return estimatedTotalCost > other.estimatedTotalCost;
+				return costSoFar < other.costSoFar;
+			}
+		};
+
+		// Everything the search needs of a node next to each other, only valid when the generation matches the current search
+		struct NodeRecord
+		{
+			float costSoFar;
+			int parent;
+			unsigned int generation;
+			bool isClosed;
+		};
+
+		void PrepareSearch();
+		NodeRecord& VisitNode(int idx);
+
+		const T_Neighbors* m_pNeighbors;
+		T_Heuristic m_Heuristic;
+		T_CostModel m_CostModel;
+
+		std::vector<NodeRecord> m_Records;
+		unsigned int m_Generation = 0;
+		std::vector<OpenEntry> m_OpenList;
+		int m_NrOfExpandedNodes = 0;
+	};
+
+	//----------------------//
+	//--Prebuilt searches--//
+	//----------------------//
+
+	// GridGraph<GridTerrainNode> and the InfluenceGrid (GridGraph<InfluenceNode>) share the stencil, only building it depends on the node type
+	using GridAStarKernel = AStarKernel<GridHeuristic<OctileDistance>, GridStencilNeighbors>;
+	// NavGraph through its snapshot, with the start and end node of the query layered on top
+	using NavGraphAStarKernel = AStarKernel<PositionHeuristic<EuclideanDistance>, OverlayNeighbors<CSRNeighbors>>;
+	// Grid files opened with GraphFile, searched on the mapped CSR arrays without building a graph first
+	// They only need their columns for the heuristic, the costs in the file are in cells as well
+	using GridFileAStarKernel = AStarKernel<GridHeuristic<OctileDistance>, CSRNeighbors>;
+
+	// A GridGraph searched with the GridAStarKernel, the stencil is rebuilt on the first query after the grid changed
+	template<class T_NodeType, class T_ConnectionType>
+	class GridGraphAStar final
+	{
+	public:
+		explicit GridGraphAStar(const GridGraph<T_NodeType, T_ConnectionType>* pGrid);
+
+		GridGraphAStar(const GridGraphAStar&) = delete;
+		GridGraphAStar& operator=(const GridGraphAStar&) = delete;
+
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode);
+		// Rebuilds the stencil if the grid changed, FindPath does this as well
+		void Update();
+
+		int GetNrOfExpandedNodes() const { return m_Kernel.GetNrOfExpandedNodes(); }
+
+	private:
+		const GridGraph<T_NodeType, T_ConnectionType>* m_pGrid;
+		GridStencilNeighbors m_Neighbors{};
+		GridAStarKernel m_Kernel;
+		std::vector<int> m_Path{};
+	};
+
+	//-------------------//
+	//--Implementations--//
+	//-------------------//
+
+	template<class T_Distance>
+	inline PositionHeuristic<T_Distance>::PositionHeuristic(const GraphSnapshot& snapshot)
+	{
+		m_Positions.reserve(snapshot.GetNrOfNodes());
+		for (int idx{}; idx < snapshot.GetNrOfNodes(); ++idx)
+			m_Positions.push_back(snapshot.GetNodePos(idx));
+	}
+
+	template<class T_Distance>
+	inline void PositionHeuristic<T_Distance>::SetNodePos(int idx, const Vector2& pos)
+	{
+		if (idx >= int(m_Positions.size()))
+			m_Positions.resize(idx + 1);
+
+		m_Positions[idx] = pos;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline GridGraphAStar<T_NodeType, T_ConnectionType>::GridGraphAStar(const GridGraph<T_NodeType, T_ConnectionType>* pGrid)
+		: m_pGrid(pGrid)
+		, m_Kernel(&m_Neighbors, GridHeuristic<OctileDistance>(pGrid->GetColumns()))
+	{
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> GridGraphAStar<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		Update();
+
+		std::vector<T_NodeType*> path{};
+		if (m_Kernel.FindPath(pStartNode->GetIndex(), pGoalNode->GetIndex(), m_Path) == false)
+			return path;
+
+		path.reserve(m_Path.size());
+		for (int idx : m_Path)
+			path.push_back(m_pGrid->GetNode(idx));
+		return path;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridGraphAStar<T_NodeType, T_ConnectionType>::Update()
+	{
+		if (m_Neighbors.IsUpToDate(*m_pGrid) == false)
+		{
+			m_Neighbors.Build(*m_pGrid);
+			m_Kernel.GetHeuristic() = GridHeuristic<OctileDistance>(m_pGrid->GetColumns());
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridStencilNeighbors::Build(const GridGraph<T_NodeType, T_ConnectionType>& grid)
+	{
+		m_Columns = grid.GetColumns();
+		m_Rows = grid.GetRows();
+		m_NrOfNodes = grid.GetNrOfNodes();
+		m_GraphVersion = grid.GetVersion();
+
+		// Straight directions first, the same order as the grid adds its connections
+		const int colOffsets[nrOfDirections]{ 1, 0, -1, 0, 1, -1, -1, 1 };
+		const int rowOffsets[nrOfDirections]{ 0, 1, 0, -1, 1, 1, -1, -1 };
+		for (int direction{}; direction < nrOfDirections; ++direction)
+			m_IndexOffsets[direction] = rowOffsets[direction] * m_Columns + colOffsets[direction];
+
+		m_DirectionMasks.assign(m_NrOfNodes, 0);
+		m_Costs.assign(size_t(m_NrOfNodes) * nrOfDirections, 0.f);
+
+		for (int idx{}; idx < m_NrOfNodes; ++idx)
+		{
+			if (grid.GetNode(idx)->GetIndex() == invalid_node_index)
+				continue;
+
+			const int col{ idx % m_Columns };
+			const int row{ idx / m_Columns };
+			for (auto pConnection : grid.GetNodeConnections(idx))
+			{
+				const int toIdx{ pConnection->GetTo() };
+				const int colOffset{ toIdx % m_Columns - col };
+				const int rowOffset{ toIdx / m_Columns - row };
+
+				for (int direction{}; direction < nrOfDirections; ++direction)
+				{
+					if (colOffsets[direction] != colOffset || rowOffsets[direction] != rowOffset)
+						continue;
+
+					m_DirectionMasks[idx] |= uint8_t(1 << direction);
+					m_Costs[size_t(idx) * nrOfDirections + direction] = pConnection->GetCost();
+					break;
+				}
+			}
+		}
+	}
+
+	template<class T_Function>
+	inline void GridStencilNeighbors::ForEachNeighbor(int idx, T_Function function) const
+	{
+		// Cells on the border never have a bit set towards the outside, so the offsets need no bounds checks
+		const uint8_t mask{ m_DirectionMasks[idx] };
+		const float* pCosts{ &m_Costs[size_t(idx) * nrOfDirections] };
+		for (int direction{}; direction < nrOfDirections; ++direction)
+		{
+			if (mask & (1 << direction))
+				function(idx + m_IndexOffsets[direction], pCosts[direction]);
+		}
+	}
+
+	template<class T_BaseNeighbors>
+	inline int OverlayNeighbors<T_BaseNeighbors>::AddNode(const std::vector<std::pair<int, float>>& connections)
+	{
+		const int idx{ GetNrOfNodes() };
+		const int nrOfBaseNodes{ m_pBase->GetNrOfNodes() };
+		m_ExtraNodes.push_back(connections);
+
+		// The way back, extra nodes keep their own lists
+		for (const auto& connection : connections)
+		{
+			if (connection.first >= nrOfBaseNodes)
+				m_ExtraNodes[connection.first - nrOfBaseNodes].push_back({ idx, connection.second });
+			else
+				m_ExtraConnections.push_back({ connection.first, idx, connection.second });
+		}
+
+		return idx;
+	}
+
+	template<class T_BaseNeighbors>
+	inline void OverlayNeighbors<T_BaseNeighbors>::Clear()
+	{
+		m_ExtraNodes.clear();
+		m_ExtraConnections.clear();
+	}
+
+	template<class T_BaseNeighbors>
+	template<class T_Function>
+	inline void OverlayNeighbors<T_BaseNeighbors>::ForEachNeighbor(int idx, T_Function function) const
+	{
+		const int nrOfBaseNodes{ m_pBase->GetNrOfNodes() };
+		if (idx >= nrOfBaseNodes)
+		{
+			for (const auto& connection : m_ExtraNodes[idx - nrOfBaseNodes])
+				function(connection.first, connection.second);
+			return;
+		}
+
+		m_pBase->ForEachNeighbor(idx, function);
+		for (const ExtraConnection& connection : m_ExtraConnections)
+		{
+			if (connection.from == idx)
+				function(connection.to, connection.cost);
+		}
+	}
+
+	template<class T_Heuristic, class T_Neighbors, class T_CostModel>
+	inline AStarKernel<T_Heuristic, T_Neighbors, T_CostModel>::AStarKernel(const T_Neighbors* pNeighbors, const T_Heuristic& heuristic, const T_CostModel& costModel)
+		: m_pNeighbors(pNeighbors)
+		, m_Heuristic(heuristic)
+		, m_CostModel(costModel)
+	{
+	}
+
+	template<class T_Heuristic, class T_Neighbors, class T_CostModel>
+	bool AStarKernel<T_Heuristic, T_Neighbors, T_CostModel>::FindPath(int startIdx, int goalIdx, std::vector<int>& path)
+	{
+		path.clear();
+		PrepareSearch();
+		m_Heuristic.SetGoal(goalIdx);
+
+		NodeRecord& startRecord = VisitNode(startIdx);
+		startRecord.costSoFar = 0.f;
+		m_OpenList.push_back({ m_Heuristic(startIdx), 0.f, startIdx });
+
+		bool hasFoundGoal{ false };
+		while (m_OpenList.empty() == false)
+		{
+			std::pop_heap(m_OpenList.begin(), m_OpenList.end());
+			const OpenEntry currentEntry{ m_OpenList.back() };
+			m_OpenList.pop_back();
+
+			const int currentIdx{ currentEntry.nodeIdx };
+			NodeRecord& currentRecord = m_Records[currentIdx];
+
+			// Skip outdated entries
+			if (currentRecord.isClosed || currentEntry.costSoFar > currentRecord.costSoFar)
+				continue;
+
+			currentRecord.isClosed = true;
+			++m_NrOfExpandedNodes;
+
+			if (currentIdx == goalIdx)
+			{
+				hasFoundGoal = true;
+				break;
+			}
+
+			const float currentCostSoFar{ currentRecord.costSoFar };
+			m_pNeighbors->ForEachNeighbor(currentIdx, [this, currentIdx, currentCostSoFar](int nextIdx, float connectionCost)
+			{
+				NodeRecord& nextRecord = VisitNode(nextIdx);
+
+				// Only keep the cheapest way to reach a node, a closed node gets reopened when a cheaper way is found
+				const float costSoFar{ currentCostSoFar + m_CostModel(currentIdx, nextIdx, connectionCost) };
+				if (costSoFar >= nextRecord.costSoFar)
+					return;
+
+				nextRecord.costSoFar = costSoFar;
+				nextRecord.parent = currentIdx;
+				nextRecord.isClosed = false;
+
+				m_OpenList.push_back({ costSoFar + m_Heuristic(nextIdx), costSoFar, nextIdx });
+				std::push_heap(m_OpenList.begin(), m_OpenList.end());
+			});
+		}
+
+		if (hasFoundGoal == false)
+			return false;
+
+		for (int idx{ goalIdx }; idx != invalid_node_index; idx = m_Records[idx].parent)
+			path.push_back(idx);
+
+		std::reverse(path.begin(), path.end());
+		return true;
+	}
+
+	template<class T_Heuristic, class T_Neighbors, class T_CostModel>
+	inline void AStarKernel<T_Heuristic, T_Neighbors, T_CostModel>::PrepareSearch()
+	{
+		// Records only grow, so they get reused by every query
+		const size_t nrOfNodes{ size_t(m_pNeighbors->GetNrOfNodes()) };
+		if (m_Records.size() < nrOfNodes)
+			m_Records.resize(nrOfNodes, NodeRecord{ FLT_MAX, invalid_node_index, 0, false });
+
+		// A new generation invalidates the records of the previous search without clearing them
+		++m_Generation;
+		if (m_Generation == 0)
+		{
+			for (NodeRecord& record : m_Records)
+				record.generation = 0;
+			m_Generation = 1;
+		}
+
+		m_OpenList.clear();
+		m_NrOfExpandedNodes = 0;
+	}
+
+	template<class T_Heuristic, class T_Neighbors, class T_CostModel>
+	inline typename AStarKernel<T_Heuristic, T_Neighbors, T_CostModel>::NodeRecord& AStarKernel<T_Heuristic, T_Neighbors, T_CostModel>::VisitNode(int idx)
+	{
+		NodeRecord& record = m_Records[idx];
+		if (record.generation != m_Generation)
+			record = NodeRecord{ FLT_MAX, invalid_node_index, m_Generation, false };
+
+		return record;
+	}
+
+	// Compiled once in EAStarKernel.cpp
+	extern template class AStarKernel<GridHeuristic<OctileDistance>, GridStencilNeighbors>;
+	extern template class AStarKernel<PositionHeuristic<EuclideanDistance>, OverlayNeighbors<CSRNeighbors>>;
+	extern template class AStarKernel<GridHeuristic<OctileDistance>, CSRNeighbors>;
+	extern template class GridGraphAStar<GridTerrainNode, GraphConnection>;
+	extern template class GridGraphAStar<InfluenceNode, GraphConnection>;
+	extern template void GridStencilNeighbors::Build(const GridGraph<GridTerrainNode, GraphConnection>& grid);
+	extern template void GridStencilNeighbors::Build(const GridGraph<InfluenceNode, GraphConnection>& grid);
+}
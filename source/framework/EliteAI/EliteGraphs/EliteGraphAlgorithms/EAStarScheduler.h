@@ -0,0 +1,241 @@
+#pragma once
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EAStar.h"
+
+namespace Elite
+{
+	using AStarSearchHandle = unsigned int;
+	const AStarSearchHandle invalid_search_handle = 0;
+
+	// Runs any number of A* searches a slice at a time on the main thread.
+	// Update divides a fixed number of expansions per frame over the searches in progress, so the frame time doesn't depend on how many agents repath at once.
+	// Searches that are still in progress when the graph version changes start over, finished paths are left as they are.
+	template<class T_NodeType, class T_ConnectionType>
+	class AStarScheduler final
+	{
+	public:
+		AStarScheduler(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, int expansionsPerFrame = 2000);
+		~AStarScheduler();
+
+		AStarSearchHandle RequestPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+		void Cancel(AStarSearchHandle handle);
+
+		// Spends the expansions of one frame and returns how many were used
+		int Update();
+
+		// Idle for handles that are unknown, cancelled or already taken
+		SearchStatus GetStatus(AStarSearchHandle handle) const;
+
+		// Moves the path of a finished search out (empty when the destination can't be reached) and forgets the search
+		bool TakePath(AStarSearchHandle handle, std::vector<T_NodeType*>& path);
+		// Path towards the node closest to the destination so far, while the search is still in progress
+		std::vector<T_NodeType*> GetPartialPath(AStarSearchHandle handle) const;
+
+		// Used by the searches that are requested afterwards
+		void SetHeuristic(Heuristic hFunction) { m_HeuristicFunction = hFunction; }
+		void SetNodeHeuristic(const NodeHeuristic& nodeHeuristic) { m_NodeHeuristic = nodeHeuristic; }
+
+		void SetExpansionsPerFrame(int expansionsPerFrame) { m_ExpansionsPerFrame = std::max(expansionsPerFrame, 1); }
+		int GetExpansionsPerFrame() const { return m_ExpansionsPerFrame; }
+		int GetNrOfExpansionsLastFrame() const { return m_NrOfExpansionsLastFrame; }
+		int GetNrOfPendingSearches() const;
+
+	private:
+		using SearchType = AStar<T_NodeType, T_ConnectionType>;
+
+		struct Search
+		{
+			AStarSearchHandle handle;
+			int startIdx;
+			int destinationIdx;
+			SearchType* pAStar;
+		};
+
+		typename std::vector<Search>::iterator FindSearch(AStarSearchHandle handle);
+		typename std::vector<Search>::const_iterator FindSearch(AStarSearchHandle handle) const;
+		void BeginSearch(Search& search);
+		void RemoveSearch(typename std::vector<Search>::iterator searchIt);
+
+		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		Heuristic m_HeuristicFunction;
+		NodeHeuristic m_NodeHeuristic;
+		int m_ExpansionsPerFrame;
+		int m_NrOfExpansionsLastFrame = 0;
+		int m_GraphVersion;
+
+		// In the order they were requested
+		std::vector<Search> m_Searches;
+		// Searches keep their arrays, so finished ones are reused for new requests
+		std::vector<SearchType*> m_FreeSearches;
+		AStarSearchHandle m_NextHandle = 1;
+		// Rotates every frame, so the search that gets the rounded up share changes
+		size_t m_FirstSearch = 0;
+
+		AStarScheduler(const AStarScheduler&) = delete;
+		AStarScheduler& operator=(const AStarScheduler&) = delete;
+	};
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline AStarScheduler<T_NodeType, T_ConnectionType>::AStarScheduler(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, int expansionsPerFrame)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+		, m_ExpansionsPerFrame(std::max(expansionsPerFrame, 1))
+		, m_GraphVersion(pGraph->GetVersion())
+	{
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline AStarScheduler<T_NodeType, T_ConnectionType>::~AStarScheduler()
+	{
+		for (Search& search : m_Searches)
+			SAFE_DELETE(search.pAStar);
+
+		for (SearchType*& pAStar : m_FreeSearches)
+			SAFE_DELETE(pAStar);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline AStarSearchHandle AStarScheduler<T_NodeType, T_ConnectionType>::RequestPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode)
+	{
+		if (pStartNode == nullptr || pDestinationNode == nullptr)
+			return invalid_search_handle;
+
+		SearchType* pAStar{ nullptr };
+		if (m_FreeSearches.empty())
+		{
+			pAStar = new SearchType(m_pGraph, m_HeuristicFunction);
+		}
+		else
+		{
+			pAStar = m_FreeSearches.back();
+			m_FreeSearches.pop_back();
+			pAStar->SetHeuristic(m_HeuristicFunction);
+		}
+		pAStar->SetNodeHeuristic(m_NodeHeuristic);
+
+		m_Searches.push_back(Search{ m_NextHandle++, pStartNode->GetIndex(), pDestinationNode->GetIndex(), pAStar });
+		BeginSearch(m_Searches.back());
+		return m_Searches.back().handle;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void AStarScheduler<T_NodeType, T_ConnectionType>::Cancel(AStarSearchHandle handle)
+	{
+		auto searchIt = FindSearch(handle);
+		if (searchIt != m_Searches.end())
+			RemoveSearch(searchIt);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int AStarScheduler<T_NodeType, T_ConnectionType>::Update()
+	{
+		// The open lists of the running searches were built on the old graph
+		if (m_GraphVersion != m_pGraph->GetVersion())
+		{
+			m_GraphVersion = m_pGraph->GetVersion();
+			for (Search& search : m_Searches)
+			{
+				if (search.pAStar->GetStatus() == SearchStatus::InProgress)
+					BeginSearch(search);
+			}
+		}
+
+		std::vector<Search*> pendingSearches{};
+		for (Search& search : m_Searches)
+		{
+			if (search.pAStar->GetStatus() == SearchStatus::InProgress)
+				pendingSearches.push_back(&search);
+		}
+
+		m_NrOfExpansionsLastFrame = 0;
+		if (pendingSearches.empty())
+			return 0;
+
+		// Every search gets an equal share of what is left, the budget of searches that finish early goes to the ones after them
+		const size_t nrOfSearches{ pendingSearches.size() };
+		m_FirstSearch = (m_FirstSearch + 1) % nrOfSearches;
+		int remainingExpansions{ m_ExpansionsPerFrame };
+		for (size_t i{}; i < nrOfSearches && remainingExpansions > 0; ++i)
+		{
+			SearchType* pAStar{ pendingSearches[(m_FirstSearch + i) % nrOfSearches]->pAStar };
+			const int nrOfSearchesLeft{ int(nrOfSearches - i) };
+			const int share{ (remainingExpansions + nrOfSearchesLeft - 1) / nrOfSearchesLeft };
+
+			const int nrOfExpandedNodes{ pAStar->GetNrOfExpandedNodes() };
+			pAStar->Step(share);
+			remainingExpansions -= pAStar->GetNrOfExpandedNodes() - nrOfExpandedNodes;
+		}
+
+		m_NrOfExpansionsLastFrame = m_ExpansionsPerFrame - remainingExpansions;
+		return m_NrOfExpansionsLastFrame;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline SearchStatus AStarScheduler<T_NodeType, T_ConnectionType>::GetStatus(AStarSearchHandle handle) const
+	{
+		auto searchIt = FindSearch(handle);
+		return searchIt != m_Searches.end() ? searchIt->pAStar->GetStatus() : SearchStatus::Idle;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool AStarScheduler<T_NodeType, T_ConnectionType>::TakePath(AStarSearchHandle handle, std::vector<T_NodeType*>& path)
+	{
+		auto searchIt = FindSearch(handle);
+		if (searchIt == m_Searches.end())
+			return false;
+
+		const SearchStatus status{ searchIt->pAStar->GetStatus() };
+		if (status != SearchStatus::Found && status != SearchStatus::NotFound)
+			return false;
+
+		path = searchIt->pAStar->GetPath();
+		RemoveSearch(searchIt);
+		return true;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline std::vector<T_NodeType*> AStarScheduler<T_NodeType, T_ConnectionType>::GetPartialPath(AStarSearchHandle handle) const
+	{
+		auto searchIt = FindSearch(handle);
+		return searchIt != m_Searches.end() ? searchIt->pAStar->GetPartialPath() : std::vector<T_NodeType*>{};
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int AStarScheduler<T_NodeType, T_ConnectionType>::GetNrOfPendingSearches() const
+	{
+		return int(std::count_if(m_Searches.begin(), m_Searches.end(),
+			[](const Search& search) { return search.pAStar->GetStatus() == SearchStatus::InProgress; }));
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline typename std::vector<typename AStarScheduler<T_NodeType, T_ConnectionType>::Search>::iterator AStarScheduler<T_NodeType, T_ConnectionType>::FindSearch(AStarSearchHandle handle)
+	{
+		return std::find_if(m_Searches.begin(), m_Searches.end(), [handle](const Search& search) { return search.handle == handle; });
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline typename std::vector<typename AStarScheduler<T_NodeType, T_ConnectionType>::Search>::const_iterator AStarScheduler<T_NodeType, T_ConnectionType>::FindSearch(AStarSearchHandle handle) const
+	{
+		return std::find_if(m_Searches.begin(), m_Searches.end(), [handle](const Search& search) { return search.handle == handle; });
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void AStarScheduler<T_NodeType, T_ConnectionType>::BeginSearch(Search& search)
+	{
+		// Nodes that were removed from the graph end the search without a path
+		auto getNode = [this](int idx) -> T_NodeType*
+		{
+			if (!m_pGraph->IsNodeValid(idx) || m_pGraph->GetNode(idx)->GetIndex() == invalid_node_index)
+				return nullptr;
+			return m_pGraph->GetNode(idx);
+		};
+
+		search.pAStar->BeginSearch(getNode(search.startIdx), getNode(search.destinationIdx));
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void AStarScheduler<T_NodeType, T_ConnectionType>::RemoveSearch(typename std::vector<Search>::iterator searchIt)
+	{
+		m_FreeSearches.push_back(searchIt->pAStar);
+		m_Searches.erase(searchIt);
+	}
+}
@@ -1,76 +1,328 @@
 #pragma once
 
-namespace Elite 
+namespace Elite
 {
-	template <class T_NodeType, class T_ConnectionType>
+	// Breadth first search, finds the paths with the fewest connections (costs are ignored)
+	// The search arrays are indexed by node index and kept between queries, a generation stamp resets them in O(1)
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType = IGraph<T_NodeType, T_ConnectionType>>
 	class BFS
 	{
 	public:
-		BFS(IGraph<T_NodeType, T_ConnectionType>* pGraph);
+		BFS(T_GraphType* pGraph);
 
+		// Returns the nodes from start to destination, or an empty path when the destination can't be reached
 		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+
+		// Same result as FindPath, but searches from both ends and meets in the middle, which visits far fewer nodes on large graphs
+		// Directional graphs search backwards over the incoming connections, these are collected again when the graph version changes
+		std::vector<T_NodeType*> FindPathBidirectional(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+
+		// Number of connections from the nearest source to every node, -1 for nodes that can't be reached within maxDistance
+		// pNearestSources receives the source every node was reached from (invalid_node_index when unreached), e.g. to split an area between guards
+		void GetDistanceField(const std::vector<int>& sourceIndices, std::vector<int>& distances, std::vector<int>* pNearestSources = nullptr, int maxDistance = (std::numeric_limits<int>::max)());
+
+		// The search arrays are kept between queries, the graph can be swapped as long as the node indices stay valid
+		void SetGraph(T_GraphType* pGraph) { m_pGraph = pGraph; }
+
+		int GetNrOfVisitedNodes() const { return m_NrOfVisitedNodes; }
+
 	private:
-		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		enum class SearchSide : unsigned char
+		{
+			Forward, Backward
+		};
+
+		void PrepareSearch();
+		bool IsVisited(int idx) const { return m_VisitedGeneration[idx] == m_Generation; }
+		void VisitNode(int idx, int parentIdx, int distance, SearchSide side);
+		void UpdateIncomingConnections();
+
+		// Expands one full level of one side of a bidirectional search, returns true when the sides met on this level
+		bool ExpandLevel(std::vector<int>& frontier, std::vector<int>& nextFrontier, SearchSide side);
+
+		T_GraphType* m_pGraph;
+
+		// Per node index, only valid for nodes whose m_VisitedGeneration matches the current search
+		std::vector<int> m_Parent; // towards the source of the search side that visited the node
+		std::vector<int> m_Distance;
+		std::vector<SearchSide> m_Side;
+		std::vector<unsigned int> m_VisitedGeneration;
+		unsigned int m_Generation = 0;
+
+		std::vector<int> m_Queue;
+		std::vector<int> m_Frontiers[2];
+		int m_NrOfVisitedNodes = 0;
+
+		// Shortest connection between the two sides of a bidirectional search
+		int m_MeetingLength = 0;
+		int m_ForwardMeetingIdx = invalid_node_index;
+		int m_BackwardMeetingIdx = invalid_node_index;
+
+		// Incoming connections in compressed form, only used by bidirectional searches on directional graphs
+		std::vector<int> m_IncomingOffsets;
+		std::vector<int> m_IncomingNodes;
+		int m_IncomingVersion = -1;
 	};
 
-	template <class T_NodeType, class T_ConnectionType>
-	BFS<T_NodeType, T_ConnectionType>::BFS(IGraph<T_NodeType, T_ConnectionType>* pGraph)
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	BFS<T_NodeType, T_ConnectionType, T_GraphType>::BFS(T_GraphType* pGraph)
 		: m_pGraph(pGraph)
 	{
 
 	}
 
-	template <class T_NodeType, class T_ConnectionType>
-	std::vector<T_NodeType*> BFS<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode)
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	std::vector<T_NodeType*> BFS<T_NodeType, T_ConnectionType, T_GraphType>::FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode)
 	{
-		std::queue<T_NodeType*> openList{};
-		std::map<T_NodeType*, T_NodeType*> closedList{};
+		std::vector<T_NodeType*> path{};
+		if (pStartNode == nullptr || pDestinationNode == nullptr)
+			return path;
+
+		PrepareSearch();
 
-		openList.push(pStartNode);
+		const int startIdx{ pStartNode->GetIndex() };
+		const int destinationIdx{ pDestinationNode->GetIndex() };
 
-		while (openList.empty() == false)
+		// The queue is a plain array, every node gets pushed at most once
+		VisitNode(startIdx, invalid_node_index, 0, SearchSide::Forward);
+		m_Queue.push_back(startIdx);
+
+		for (size_t queueIdx{}; queueIdx < m_Queue.size() && !IsVisited(destinationIdx); ++queueIdx)
 		{
-			T_NodeType* pCurrentNode{ openList.front() };
-			openList.pop();
+			const int currentIdx{ m_Queue[queueIdx] };
 
-			if (pCurrentNode == pDestinationNode)
+			for (auto& connection : m_pGraph->GetNodeConnections(currentIdx))
 			{
-				break;
-			}
+				const int nextIdx{ connection->GetTo() };
+				if (IsVisited(nextIdx))
+					continue;
 
-			for (auto& connection : m_pGraph->GetNodeConnections(pCurrentNode))
-			{
-				T_NodeType* pNextNode{ m_pGraph->GetNode(connection->GetTo()) };
-
-				// Check if in closedList, return end() if not find
-				if (closedList.find(pNextNode) == closedList.end())
-				{
-					openList.push(pNextNode);
-					closedList[pNextNode] = pCurrentNode;
-				}
+				VisitNode(nextIdx, currentIdx, m_Distance[currentIdx] + 1, SearchSide::Forward);
+				m_Queue.push_back(nextIdx);
 			}
 		}
 
 		// Check if we reached destination
-		if (closedList.find(pDestinationNode) == closedList.end())
-		{
-			return std::vector<T_NodeType*>();
-		}
+		if (!IsVisited(destinationIdx))
+			return path;
+
+		// Backtracking, end -> start
+		for (int idx{ destinationIdx }; idx != invalid_node_index; idx = m_Parent[idx])
+			path.push_back(m_pGraph->GetNode(idx));
 
-		// Backtracking
+		std::reverse(path.begin(), path.end());
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	std::vector<T_NodeType*> BFS<T_NodeType, T_ConnectionType, T_GraphType>::FindPathBidirectional(T_NodeType* pStartNode, T_NodeType* pDestinationNode)
+	{
 		std::vector<T_NodeType*> path{};
+		if (pStartNode == nullptr || pDestinationNode == nullptr)
+			return path;
+
+		const int startIdx{ pStartNode->GetIndex() };
+		const int destinationIdx{ pDestinationNode->GetIndex() };
+		if (startIdx == destinationIdx)
+			return { pStartNode };
+
+		if (m_pGraph->IsDirectionalGraph())
+			UpdateIncomingConnections();
+
+		PrepareSearch();
+
+		auto& forwardFrontier = m_Frontiers[0];
+		auto& backwardFrontier = m_Frontiers[1];
+		forwardFrontier.assign(1, startIdx);
+		backwardFrontier.assign(1, destinationIdx);
+		VisitNode(startIdx, invalid_node_index, 0, SearchSide::Forward);
+		VisitNode(destinationIdx, invalid_node_index, 0, SearchSide::Backward);
 
-		// Go through closedList, end -> start
-		T_NodeType* pCurrentNode{ pDestinationNode };
-		while (pCurrentNode != pStartNode)
+		// Always expand the smaller frontier by a full level, the first level on which the sides meet holds the shortest path
+		bool hasMet{ false };
+		while (!hasMet && !forwardFrontier.empty() && !backwardFrontier.empty())
 		{
-			path.push_back(pCurrentNode);
-			pCurrentNode = closedList[pCurrentNode];
+			if (forwardFrontier.size() <= backwardFrontier.size())
+				hasMet = ExpandLevel(forwardFrontier, m_Queue, SearchSide::Forward);
+			else
+				hasMet = ExpandLevel(backwardFrontier, m_Queue, SearchSide::Backward);
 		}
-		path.push_back(pStartNode);
+
+		if (!hasMet)
+			return path;
+
+		// Backtracking, forward meeting node -> start, then backward meeting node -> end
+		for (int idx{ m_ForwardMeetingIdx }; idx != invalid_node_index; idx = m_Parent[idx])
+			path.push_back(m_pGraph->GetNode(idx));
 
 		std::reverse(path.begin(), path.end());
+		for (int idx{ m_BackwardMeetingIdx }; idx != invalid_node_index; idx = m_Parent[idx])
+			path.push_back(m_pGraph->GetNode(idx));
+
 		return path;
 	}
-}
 
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	void BFS<T_NodeType, T_ConnectionType, T_GraphType>::GetDistanceField(const std::vector<int>& sourceIndices, std::vector<int>& distances, std::vector<int>* pNearestSources, int maxDistance)
+	{
+		PrepareSearch();
+
+		const int nrOfNodes{ m_pGraph->GetNrOfNodes() };
+		distances.assign(nrOfNodes, -1);
+		if (pNearestSources)
+			pNearestSources->assign(nrOfNodes, invalid_node_index);
+
+		// All sources start on the same level, so every node is reached from its nearest source first
+		for (int sourceIdx : sourceIndices)
+		{
+			if (!m_pGraph->IsNodeValid(sourceIdx) || IsVisited(sourceIdx))
+				continue;
+
+			VisitNode(sourceIdx, invalid_node_index, 0, SearchSide::Forward);
+			m_Queue.push_back(sourceIdx);
+			distances[sourceIdx] = 0;
+			if (pNearestSources)
+				(*pNearestSources)[sourceIdx] = sourceIdx;
+		}
+
+		for (size_t queueIdx{}; queueIdx < m_Queue.size(); ++queueIdx)
+		{
+			const int currentIdx{ m_Queue[queueIdx] };
+			if (distances[currentIdx] >= maxDistance)
+				continue;
+
+			for (auto& connection : m_pGraph->GetNodeConnections(currentIdx))
+			{
+				const int nextIdx{ connection->GetTo() };
+				if (IsVisited(nextIdx))
+					continue;
+
+				VisitNode(nextIdx, currentIdx, distances[currentIdx] + 1, SearchSide::Forward);
+				m_Queue.push_back(nextIdx);
+				distances[nextIdx] = distances[currentIdx] + 1;
+				if (pNearestSources)
+					(*pNearestSources)[nextIdx] = (*pNearestSources)[currentIdx];
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	inline void BFS<T_NodeType, T_ConnectionType, T_GraphType>::PrepareSearch()
+	{
+		// Arrays only grow, so they get reused by every query on the same graph
+		const size_t nrOfNodes{ size_t(m_pGraph->GetNrOfNodes()) };
+		if (m_VisitedGeneration.size() < nrOfNodes)
+		{
+			m_Parent.resize(nrOfNodes);
+			m_Distance.resize(nrOfNodes);
+			m_Side.resize(nrOfNodes);
+			m_VisitedGeneration.resize(nrOfNodes, 0);
+		}
+
+		// A new generation invalidates the data of the previous search without clearing the arrays
+		++m_Generation;
+		if (m_Generation == 0)
+		{
+			std::fill(m_VisitedGeneration.begin(), m_VisitedGeneration.end(), 0);
+			m_Generation = 1;
+		}
+
+		m_Queue.clear();
+		m_NrOfVisitedNodes = 0;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	inline void BFS<T_NodeType, T_ConnectionType, T_GraphType>::VisitNode(int idx, int parentIdx, int distance, SearchSide side)
+	{
+		m_VisitedGeneration[idx] = m_Generation;
+		m_Parent[idx] = parentIdx;
+		m_Distance[idx] = distance;
+		m_Side[idx] = side;
+		++m_NrOfVisitedNodes;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	bool BFS<T_NodeType, T_ConnectionType, T_GraphType>::ExpandLevel(std::vector<int>& frontier, std::vector<int>& nextFrontier, SearchSide side)
+	{
+		const bool isDirectional{ m_pGraph->IsDirectionalGraph() };
+		const bool isBackward{ side == SearchSide::Backward };
+
+		bool hasMet{ false };
+		nextFrontier.clear();
+
+		auto expand = [&](int currentIdx, int nextIdx)
+		{
+			if (!IsVisited(nextIdx))
+			{
+				VisitNode(nextIdx, currentIdx, m_Distance[currentIdx] + 1, side);
+				nextFrontier.push_back(nextIdx);
+				return;
+			}
+
+			// Reached a node of the other side, keep the shortest connection between the two sides on this level
+			if (m_Side[nextIdx] == side)
+				return;
+
+			const int length{ m_Distance[currentIdx] + 1 + m_Distance[nextIdx] };
+			if (hasMet && length >= m_MeetingLength)
+				return;
+
+			hasMet = true;
+			m_MeetingLength = length;
+			m_ForwardMeetingIdx = isBackward ? nextIdx : currentIdx;
+			m_BackwardMeetingIdx = isBackward ? currentIdx : nextIdx;
+		};
+
+		for (int currentIdx : frontier)
+		{
+			if (isBackward && isDirectional)
+			{
+				for (int i{ m_IncomingOffsets[currentIdx] }; i < m_IncomingOffsets[currentIdx + 1]; ++i)
+					expand(currentIdx, m_IncomingNodes[i]);
+			}
+			else
+			{
+				for (auto& connection : m_pGraph->GetNodeConnections(currentIdx))
+					expand(currentIdx, connection->GetTo());
+			}
+		}
+
+		std::swap(frontier, nextFrontier);
+		return hasMet;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	void BFS<T_NodeType, T_ConnectionType, T_GraphType>::UpdateIncomingConnections()
+	{
+		const int nrOfNodes{ m_pGraph->GetNrOfNodes() };
+		if (m_IncomingVersion == m_pGraph->GetVersion() && int(m_IncomingOffsets.size()) == nrOfNodes + 1)
+			return;
+
+		m_IncomingVersion = m_pGraph->GetVersion();
+		m_IncomingOffsets.assign(nrOfNodes + 1, 0);
+
+		// Count, prefix sum, then fill
+		for (int idx{}; idx < nrOfNodes; ++idx)
+		{
+			if (m_pGraph->GetNode(idx)->GetIndex() == invalid_node_index)
+				continue;
+
+			for (auto& connection : m_pGraph->GetNodeConnections(idx))
+				++m_IncomingOffsets[connection->GetTo() + 1];
+		}
+
+		for (int idx{}; idx < nrOfNodes; ++idx)
+			m_IncomingOffsets[idx + 1] += m_IncomingOffsets[idx];
+
+		m_IncomingNodes.resize(m_IncomingOffsets[nrOfNodes]);
+		std::vector<int> fillOffsets{ m_IncomingOffsets.begin(), m_IncomingOffsets.end() - 1 };
+		for (int idx{}; idx < nrOfNodes; ++idx)
+		{
+			if (m_pGraph->GetNode(idx)->GetIndex() == invalid_node_index)
+				continue;
+
+			for (auto& connection : m_pGraph->GetNodeConnections(idx))
+				m_IncomingNodes[fillOffsets[connection->GetTo()]++] = idx;
+		}
+	}
+}
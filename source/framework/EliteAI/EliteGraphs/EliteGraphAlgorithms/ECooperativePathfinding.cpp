@@ -0,0 +1,139 @@
+#include "stdafx.h"
+#include "ECooperativePathfinding.h"
+
+using namespace Elite;
+
+Elite::ReservationTable::ReservationTable(int depth)
+	: m_Depth(std::max(depth, 1))
+{
+	Clear();
+}
+
+void Elite::ReservationTable::Reserve(int cellIdx, int time, int agentId)
+{
+	assert(IsWithinTable(time) && "<ReservationTable::Reserve>: time outside of the table");
+
+	// Keep every time step at most half full, so the probe sequences stay short
+	if (2 * (m_SlotSizes[time % m_Depth] + 1) > m_Capacity)
+		Grow();
+
+	Entry* pSlot{ GetSlot(time) };
+	const int mask{ m_Capacity - 1 };
+	for (int i{ GetHome(cellIdx) }; ; i = (i + 1) & mask)
+	{
+		if (pSlot[i].cellIdx == cellIdx)
+		{
+			pSlot[i].agentId = agentId;
+			return;
+		}
+
+		if (pSlot[i].cellIdx == invalid_node_index)
+		{
+			pSlot[i] = Entry{ cellIdx, agentId };
+			++m_SlotSizes[time % m_Depth];
+			return;
+		}
+	}
+}
+
+void Elite::ReservationTable::Release(int cellIdx, int time, int agentId)
+{
+	if (!IsWithinTable(time))
+		return;
+
+	Entry* pSlot{ GetSlot(time) };
+	int i{ FindEntry(pSlot, cellIdx) };
+	if (i == invalid_node_index || pSlot[i].agentId != agentId)
+		return;
+
+	// Shift the entries after it back, so no entry ends up behind an empty one in its probe sequence
+	const int mask{ m_Capacity - 1 };
+	for (int j{ (i + 1) & mask }; pSlot[j].cellIdx != invalid_node_index; j = (j + 1) & mask)
+	{
+		const int home{ GetHome(pSlot[j].cellIdx) };
+		const bool canMove{ (j > i) ? (home <= i || home > j) : (home <= i && home > j) };
+		if (canMove)
+		{
+			pSlot[i] = pSlot[j];
+			i = j;
+		}
+	}
+
+	pSlot[i] = Entry{ invalid_node_index, invalid_agent_id };
+	--m_SlotSizes[time % m_Depth];
+}
+
+int Elite::ReservationTable::GetAgent(int cellIdx, int time) const
+{
+	if (!IsWithinTable(time))
+		return invalid_agent_id;
+
+	const Entry* pSlot{ GetSlot(time) };
+	const int i{ FindEntry(pSlot, cellIdx) };
+	return i != invalid_node_index ? pSlot[i].agentId : invalid_agent_id;
+}
+
+bool Elite::ReservationTable::IsFree(int cellIdx, int time, int agentId) const
+{
+	const int reservingAgentId{ GetAgent(cellIdx, time) };
+	return reservingAgentId == invalid_agent_id || reservingAgentId == agentId;
+}
+
+void Elite::ReservationTable::Advance()
+{
+	// The time step that fell behind becomes the last one of the table
+	Entry* pSlot{ GetSlot(m_CurrentTime) };
+	std::fill(pSlot, pSlot + m_Capacity, Entry{ invalid_node_index, invalid_agent_id });
+	m_SlotSizes[m_CurrentTime % m_Depth] = 0;
+
+	++m_CurrentTime;
+}
+
+void Elite::ReservationTable::Clear()
+{
+	m_Entries.assign(size_t(m_Depth) * m_Capacity, Entry{ invalid_node_index, invalid_agent_id });
+	m_SlotSizes.assign(m_Depth, 0);
+}
+
+int Elite::ReservationTable::GetNrOfReservations() const
+{
+	int nrOfReservations{};
+	for (int slotSize : m_SlotSizes)
+		nrOfReservations += slotSize;
+
+	return nrOfReservations;
+}
+
+int Elite::ReservationTable::FindEntry(const Entry* pSlot, int cellIdx) const
+{
+	const int mask{ m_Capacity - 1 };
+	for (int i{ GetHome(cellIdx) }; pSlot[i].cellIdx != invalid_node_index; i = (i + 1) & mask)
+	{
+		if (pSlot[i].cellIdx == cellIdx)
+			return i;
+	}
+
+	return invalid_node_index;
+}
+
+void Elite::ReservationTable::Grow()
+{
+	std::vector<Entry> oldEntries{};
+	std::swap(oldEntries, m_Entries);
+	const int oldCapacity{ m_Capacity };
+
+	m_Capacity *= 2;
+	Clear();
+
+	// Reinsert every time step into the slot it came from
+	for (int slotIdx{}; slotIdx < m_Depth; ++slotIdx)
+	{
+		const int time{ m_CurrentTime + ((slotIdx - m_CurrentTime % m_Depth) + m_Depth) % m_Depth };
+		for (int i{}; i < oldCapacity; ++i)
+		{
+			const Entry& entry = oldEntries[size_t(slotIdx) * oldCapacity + i];
+			if (entry.cellIdx != invalid_node_index)
+				Reserve(entry.cellIdx, time, entry.agentId);
+		}
+	}
+}
@@ -0,0 +1,604 @@
+#pragma once
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EFlowField.h"
+
+namespace Elite
+{
+	const int invalid_agent_id = -1;
+
+	// Which agent occupies a cell at a time step, for the next depth time steps.
+	// Every time step has its own open addressing table (linear probing) keyed by the cell, the time steps form a ring,
+	// so moving time forward only clears the step that fell behind.
+	class ReservationTable final
+	{
+	public:
+		explicit ReservationTable(int depth = 32);
+
+		// Times have to lie within [GetCurrentTime(), GetCurrentTime() + GetDepth()), a reservation by another agent gets overwritten
+		void Reserve(int cellIdx, int time, int agentId);
+		// Only removes the reservation when it belongs to the agent
+		void Release(int cellIdx, int time, int agentId);
+
+		// invalid_agent_id when the cell is free or the time lies outside of the table
+		int GetAgent(int cellIdx, int time) const;
+		bool IsFree(int cellIdx, int time, int agentId) const;
+
+		// Moves to the next time step
+		void Advance();
+		void Clear();
+
+		int GetCurrentTime() const { return m_CurrentTime; }
+		int GetDepth() const { return m_Depth; }
+		int GetNrOfReservations() const;
+
+	private:
+		struct Entry
+		{
+			int cellIdx; // invalid_node_index when empty
+			int agentId;
+		};
+
+		bool IsWithinTable(int time) const { return time >= m_CurrentTime && time < m_CurrentTime + m_Depth; }
+		Entry* GetSlot(int time) { return &m_Entries[size_t(time % m_Depth) * m_Capacity]; }
+		const Entry* GetSlot(int time) const { return &m_Entries[size_t(time % m_Depth) * m_Capacity]; }
+		int GetHome(int cellIdx) const { return int((uint32_t(cellIdx) * 2654435761u) & uint32_t(m_Capacity - 1)); }
+		int FindEntry(const Entry* pSlot, int cellIdx) const;
+		void Grow();
+
+		int m_Depth;
+		int m_Capacity = 16; // per time step, a power of two
+		int m_CurrentTime = 0;
+
+		std::vector<Entry> m_Entries;
+		std::vector<int> m_SlotSizes;
+	};
+
+	// Windowed hierarchical cooperative A* (WHCA*) on a grid: every agent searches the next window time steps in space-time,
+	// around the cells the other agents reserved, and reserves its own plan. Beyond the window the true distance to the goal
+	// on the empty grid (a cached flow field per goal) guides the search.
+	// Every Step the agents move one cell along their plan and the plans are extended by waiting at their last cell, or by stepping
+	// aside to a free neighbour when another agent claimed it, so every agent holds the reservations of the whole window. A plan that
+	// can't be extended stays short and its agent replans before all others. An agent whose plan ran out keeps its cell,
+	// an agent that planned to move onto it stays where it is as well and replans. Agents replan once half of the window has passed since their last search,
+	// at most maxReplansPerStep per Step and the longest waiting ones first, so the cost of a step is bounded and the searches
+	// of agents that started together spread out over the steps. Agents that don't get a search in time wait instead of colliding.
+	template<class T_NodeType, class T_ConnectionType>
+	class CooperativePathfinder final
+	{
+	public:
+		CooperativePathfinder(GridGraph<T_NodeType, T_ConnectionType>* pGrid, int window = 8, int maxReplansPerStep = 16, int maxExpansionsPerSearch = 1024);
+
+		// The agent stands still on its cell until it gets a goal, the cell can't hold another agent
+		// Agents that planned to pass the cell give way to it and replan
+		int AddAgent(int cellIdx);
+		void RemoveAgent(int agentId);
+		// Replanned on the next Step, before the agents whose search only got old
+		void SetGoal(int agentId, int goalIdx);
+
+		void Step();
+
+		int GetCell(int agentId) const { return m_Agents[agentId].cellIdx; }
+		int GetGoal(int agentId) const { return m_Agents[agentId].goalIdx; }
+		// Cell the agent moves to on the next Step
+		int GetNextCell(int agentId) const;
+		bool HasReachedGoal(int agentId) const { return m_Agents[agentId].cellIdx == m_Agents[agentId].goalIdx; }
+		bool IsAgentValid(int agentId) const { return agentId >= 0 && agentId < int(m_Agents.size()) && m_Agents[agentId].isActive; }
+
+		// Cells from the current time step on, one per time step
+		std::vector<int> GetPlannedCells(int agentId) const;
+
+		const ReservationTable& GetReservationTable() const { return m_Reservations; }
+		int GetWindow() const { return m_Window; }
+		int GetNrOfAgents() const { return int(m_Agents.size() - m_FreeAgentIds.size()); }
+		int GetNrOfReplansLastStep() const { return m_NrOfReplansLastStep; }
+		int GetNrOfExpansionsLastStep() const { return m_NrOfExpansionsLastStep; }
+
+	private:
+		struct Agent
+		{
+			bool isActive;
+			bool hasNewGoal;
+			bool isBlocked; // the plan couldn't be extended to the end of the window
+			int cellIdx;
+			int goalIdx;
+			// plannedCells[i] is the cell at time planTime + i
+			int planTime;
+			int searchTime;
+			std::vector<int> plannedCells;
+		};
+
+		// Same ordering as AStar
+		struct OpenEntry
+		{
+			float estimatedTotalCost;
+			float costSoFar;
+			int stateIdx;
+
+			bool operator<(const OpenEntry& other) const
+			{
+				if (estimatedTotalCost != other.estimatedTotalCost)
+					return estimatedTotalCost > other.estimatedTotalCost;
+				return costSoFar < other.costSoFar;
+			}
+		};
+
+		int GetPlanEndTime(const Agent& agent) const { return agent.planTime + int(agent.plannedCells.size()) - 1; }
+		void ReleasePlan(int agentId);
+		void ReservePlan(int agentId);
+		// Adds and reserves one time step at the end of the plan, false when the agent can neither wait nor step aside
+		bool ExtendPlan(int agentId);
+		// Releases the plan from the time on and lets the agent replan first, Step extends the rest of the plan
+		void TruncatePlan(int agentId, int time);
+		// For a plan that ran out: the agent stays on its cell for the current time step, or steps aside when another agent claimed it
+		// When it can't, it keeps the cell, every agent that planned to move onto it stays where it is as well
+		void HoldCell(int agentId);
+		void Replan(int agentId);
+		bool CanMove(int agentId, int fromIdx, int toIdx, int time) const;
+
+		// Space-time states: cellIdx * (window + 1) + time offset
+		void PrepareSearch();
+		void VisitState(int stateIdx);
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGrid;
+		int m_Window;
+		int m_MaxReplansPerStep;
+		int m_MaxExpansionsPerSearch;
+
+		ReservationTable m_Reservations;
+		FlowFieldCache<T_NodeType, T_ConnectionType> m_DistanceFields;
+
+		std::vector<Agent> m_Agents;
+		std::vector<int> m_FreeAgentIds;
+		std::vector<int> m_ReplanCandidates;
+
+		// Per state, only valid for states whose m_VisitedGeneration matches the current search
+		std::vector<float> m_CostSoFar;
+		std::vector<int> m_Parent;
+		std::vector<bool> m_IsClosed;
+		std::vector<unsigned int> m_VisitedGeneration;
+		unsigned int m_Generation = 0;
+		std::vector<OpenEntry> m_OpenList;
+
+		int m_NrOfReplansLastStep = 0;
+		int m_NrOfExpansionsLastStep = 0;
+
+		CooperativePathfinder(const CooperativePathfinder&) = delete;
+		CooperativePathfinder& operator=(const CooperativePathfinder&) = delete;
+	};
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline CooperativePathfinder<T_NodeType, T_ConnectionType>::CooperativePathfinder(GridGraph<T_NodeType, T_ConnectionType>* pGrid, int window, int maxReplansPerStep, int maxExpansionsPerSearch)
+		: m_pGrid(pGrid)
+		, m_Window(std::max(window, 1))
+		, m_MaxReplansPerStep(std::max(maxReplansPerStep, 1))
+		, m_MaxExpansionsPerSearch(std::max(maxExpansionsPerSearch, 1))
+		, m_Reservations(2 * std::max(window, 1) + 1)
+		, m_DistanceFields(pGrid, 16)
+	{
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int CooperativePathfinder<T_NodeType, T_ConnectionType>::AddAgent(int cellIdx)
+	{
+		assert(m_pGrid->IsNodeValid(cellIdx) && "<CooperativePathfinder::AddAgent>: invalid cell");
+		assert(m_Reservations.GetAgent(cellIdx, m_Reservations.GetCurrentTime()) == invalid_agent_id && "<CooperativePathfinder::AddAgent>: cell holds another agent");
+
+		// Agents that planned to pass the cell wait or step aside before it
+		for (int time{ m_Reservations.GetCurrentTime() + 1 }; time <= m_Reservations.GetCurrentTime() + m_Window; ++time)
+		{
+			const int otherAgentId{ m_Reservations.GetAgent(cellIdx, time) };
+			if (otherAgentId != invalid_agent_id)
+				TruncatePlan(otherAgentId, time);
+		}
+
+		int agentId{ invalid_agent_id };
+		if (m_FreeAgentIds.empty())
+		{
+			agentId = int(m_Agents.size());
+			m_Agents.push_back(Agent{});
+		}
+		else
+		{
+			agentId = m_FreeAgentIds.back();
+			m_FreeAgentIds.pop_back();
+		}
+
+		// Waits on its cell for the whole window
+		Agent& agent = m_Agents[agentId];
+		agent.isActive = true;
+		agent.hasNewGoal = false;
+		agent.isBlocked = false;
+		agent.cellIdx = cellIdx;
+		agent.goalIdx = cellIdx;
+		agent.planTime = m_Reservations.GetCurrentTime();
+		agent.searchTime = agent.planTime;
+		agent.plannedCells.assign(m_Window + 1, cellIdx);
+		ReservePlan(agentId);
+
+		return agentId;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void CooperativePathfinder<T_NodeType, T_ConnectionType>::RemoveAgent(int agentId)
+	{
+		if (!IsAgentValid(agentId))
+			return;
+
+		ReleasePlan(agentId);
+		m_Agents[agentId].isActive = false;
+		m_Agents[agentId].plannedCells.clear();
+		m_FreeAgentIds.push_back(agentId);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void CooperativePathfinder<T_NodeType, T_ConnectionType>::SetGoal(int agentId, int goalIdx)
+	{
+		if (!IsAgentValid(agentId) || !m_pGrid->IsNodeValid(goalIdx))
+			return;
+
+		m_Agents[agentId].goalIdx = goalIdx;
+		m_Agents[agentId].hasNewGoal = true;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	void CooperativePathfinder<T_NodeType, T_ConnectionType>::Step()
+	{
+		m_Reservations.Advance();
+		const int currentTime{ m_Reservations.GetCurrentTime() };
+
+		//Move every agent to the cell it planned for this time step
+		for (int agentId{}; agentId < int(m_Agents.size()); ++agentId)
+		{
+			Agent& agent = m_Agents[agentId];
+			if (agent.isActive == false)
+				continue;
+
+			// A blocked agent that didn't get its search in time, the end of its plan already left the table
+			// so extending it couldn't see the agents coming the other way
+			if (GetPlanEndTime(agent) < currentTime)
+				HoldCell(agentId);
+
+			// The time step that just entered the window, a short plan can have let another agent claim its last cell
+			while (GetPlanEndTime(agent) < currentTime + m_Window)
+			{
+				if (!ExtendPlan(agentId))
+				{
+					agent.isBlocked = true;
+					break;
+				}
+			}
+		}
+
+		// Only moved once every plan holds the current time step, holding a cell can change the plans of agents that came before
+		for (Agent& agent : m_Agents)
+		{
+			if (agent.isActive == false)
+				continue;
+
+			// Drop the time steps that have passed once in a while
+			if (currentTime - agent.planTime > m_Window)
+			{
+				agent.plannedCells.erase(agent.plannedCells.begin(), agent.plannedCells.begin() + (currentTime - agent.planTime));
+				agent.planTime = currentTime;
+			}
+
+			agent.cellIdx = agent.plannedCells[currentTime - agent.planTime];
+		}
+
+		//Agents with a new goal first, then the ones that searched the longest ago
+		//Agents that wait at their goal keep doing so without searching
+		m_ReplanCandidates.clear();
+		for (int agentId{}; agentId < int(m_Agents.size()); ++agentId)
+		{
+			const Agent& agent = m_Agents[agentId];
+			if (agent.isActive == false)
+				continue;
+
+			const bool isSearchOutdated{ currentTime - agent.searchTime >= (m_Window + 1) / 2 && agent.cellIdx != agent.goalIdx };
+			if (agent.hasNewGoal || agent.isBlocked || isSearchOutdated)
+				m_ReplanCandidates.push_back(agentId);
+		}
+
+		auto getPriority = [this](int agentId)
+		{
+			const Agent& agent = m_Agents[agentId];
+			return (agent.hasNewGoal || agent.isBlocked) ? (std::numeric_limits<int>::min)() : agent.searchTime;
+		};
+
+		const size_t nrOfReplans{ std::min(m_ReplanCandidates.size(), size_t(m_MaxReplansPerStep)) };
+		std::partial_sort(m_ReplanCandidates.begin(), m_ReplanCandidates.begin() + nrOfReplans, m_ReplanCandidates.end(),
+			[&getPriority](int a, int b) { return getPriority(a) < getPriority(b); });
+
+		m_NrOfReplansLastStep = int(nrOfReplans);
+		m_NrOfExpansionsLastStep = 0;
+		for (size_t i{}; i < nrOfReplans; ++i)
+			Replan(m_ReplanCandidates[i]);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int CooperativePathfinder<T_NodeType, T_ConnectionType>::GetNextCell(int agentId) const
+	{
+		const Agent& agent = m_Agents[agentId];
+		const int nextTime{ m_Reservations.GetCurrentTime() + 1 };
+		return nextTime <= GetPlanEndTime(agent) ? agent.plannedCells[nextTime - agent.planTime] : agent.cellIdx;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline std::vector<int> CooperativePathfinder<T_NodeType, T_ConnectionType>::GetPlannedCells(int agentId) const
+	{
+		const Agent& agent = m_Agents[agentId];
+		const int currentOffset{ m_Reservations.GetCurrentTime() - agent.planTime };
+		if (currentOffset >= int(agent.plannedCells.size()))
+			return { agent.cellIdx };
+
+		return std::vector<int>(agent.plannedCells.begin() + currentOffset, agent.plannedCells.end());
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void CooperativePathfinder<T_NodeType, T_ConnectionType>::ReleasePlan(int agentId)
+	{
+		const Agent& agent = m_Agents[agentId];
+		for (int time{ m_Reservations.GetCurrentTime() }; time <= GetPlanEndTime(agent); ++time)
+			m_Reservations.Release(agent.plannedCells[time - agent.planTime], time, agentId);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void CooperativePathfinder<T_NodeType, T_ConnectionType>::ReservePlan(int agentId)
+	{
+		const Agent& agent = m_Agents[agentId];
+		for (int time{ std::max(agent.planTime, m_Reservations.GetCurrentTime()) }; time <= GetPlanEndTime(agent); ++time)
+			m_Reservations.Reserve(agent.plannedCells[time - agent.planTime], time, agentId);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool CooperativePathfinder<T_NodeType, T_ConnectionType>::ExtendPlan(int agentId)
+	{
+		Agent& agent = m_Agents[agentId];
+		const int lastCellIdx{ agent.plannedCells.back() };
+		const int endTime{ GetPlanEndTime(agent) };
+
+		// Wait when possible, step aside otherwise
+		int nextCellIdx{ invalid_node_index };
+		if (CanMove(agentId, lastCellIdx, lastCellIdx, endTime))
+		{
+			nextCellIdx = lastCellIdx;
+		}
+		else
+		{
+			for (auto& connection : m_pGrid->GetNodeConnections(lastCellIdx))
+			{
+				if (CanMove(agentId, lastCellIdx, connection->GetTo(), endTime))
+				{
+					nextCellIdx = connection->GetTo();
+					break;
+				}
+			}
+		}
+
+		if (nextCellIdx == invalid_node_index)
+			return false;
+
+		agent.plannedCells.push_back(nextCellIdx);
+		m_Reservations.Reserve(nextCellIdx, endTime + 1, agentId);
+		return true;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void CooperativePathfinder<T_NodeType, T_ConnectionType>::TruncatePlan(int agentId, int time)
+	{
+		Agent& agent = m_Agents[agentId];
+		for (int releaseTime{ time }; releaseTime <= GetPlanEndTime(agent); ++releaseTime)
+			m_Reservations.Release(agent.plannedCells[releaseTime - agent.planTime], releaseTime, agentId);
+
+		agent.plannedCells.resize(time - agent.planTime);
+		agent.isBlocked = true;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	void CooperativePathfinder<T_NodeType, T_ConnectionType>::HoldCell(int agentId)
+	{
+		const int currentTime{ m_Reservations.GetCurrentTime() };
+
+		// Agents haven't moved yet, so cellIdx is the cell of the previous time step
+		Agent& agent = m_Agents[agentId];
+		const int ownerId{ m_Reservations.GetAgent(agent.cellIdx, currentTime) };
+		int nextCellIdx{ invalid_node_index };
+		if (ownerId == invalid_agent_id || ownerId == agentId)
+		{
+			nextCellIdx = agent.cellIdx;
+		}
+		else
+		{
+			// The previous time step already left the table, the agent that claimed the cell can't come from the neighbour
+			for (auto& connection : m_pGrid->GetNodeConnections(agent.cellIdx))
+			{
+				const int toIdx{ connection->GetTo() };
+				if (m_Reservations.GetAgent(toIdx, currentTime) == invalid_agent_id && m_Agents[ownerId].cellIdx != toIdx)
+				{
+					nextCellIdx = toIdx;
+					break;
+				}
+			}
+		}
+
+		if (nextCellIdx != invalid_node_index)
+		{
+			agent.plannedCells.assign({ agent.cellIdx, nextCellIdx });
+			agent.planTime = currentTime - 1;
+			m_Reservations.Reserve(nextCellIdx, currentTime, agentId);
+			return;
+		}
+
+		// Every agent in the chain stays on the cell of the previous time step, those are all different so the chain ends
+		for (int holderId{ agentId }; holderId != invalid_agent_id;)
+		{
+			Agent& holder = m_Agents[holderId];
+			const int otherAgentId{ m_Reservations.GetAgent(holder.cellIdx, currentTime) };
+
+			ReleasePlan(holderId);
+			holder.plannedCells.assign(1, holder.cellIdx);
+			holder.planTime = currentTime;
+			holder.isBlocked = true;
+			m_Reservations.Reserve(holder.cellIdx, currentTime, holderId);
+
+			holderId = otherAgentId == holderId ? invalid_agent_id : otherAgentId;
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool CooperativePathfinder<T_NodeType, T_ConnectionType>::CanMove(int agentId, int fromIdx, int toIdx, int time) const
+	{
+		// The cell has to be free when the agent arrives
+		if (!m_Reservations.IsFree(toIdx, time + 1, agentId))
+			return false;
+
+		// And no agent can come the other way at the same time
+		if (fromIdx == toIdx)
+			return true;
+
+		const int otherAgentId{ m_Reservations.GetAgent(toIdx, time) };
+		return otherAgentId == invalid_agent_id || otherAgentId == agentId || m_Reservations.GetAgent(fromIdx, time + 1) != otherAgentId;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	void CooperativePathfinder<T_NodeType, T_ConnectionType>::Replan(int agentId)
+	{
+		ReleasePlan(agentId);
+
+		Agent& agent = m_Agents[agentId];
+		agent.hasNewGoal = false;
+
+		const int currentTime{ m_Reservations.GetCurrentTime() };
+		const int nrOfTimes{ m_Window + 1 };
+		const float waitCost{ m_pGrid->GetDefaultCostStraight() };
+		const FlowField* pDistanceField{ m_DistanceFields.GetFlowField(agent.goalIdx) };
+
+		PrepareSearch();
+
+		const int startState{ agent.cellIdx * nrOfTimes };
+		VisitState(startState);
+		m_CostSoFar[startState] = 0.f;
+		m_OpenList.push_back({ pDistanceField->GetCost(agent.cellIdx), 0.f, startState });
+
+		// When the expansions run out, the state that got furthest in time (and then closest to the goal) is used
+		int endState{ startState };
+		int nrOfExpansions{};
+		while (m_OpenList.empty() == false && nrOfExpansions < m_MaxExpansionsPerSearch)
+		{
+			std::pop_heap(m_OpenList.begin(), m_OpenList.end());
+			const OpenEntry currentEntry{ m_OpenList.back() };
+			m_OpenList.pop_back();
+
+			const int currentState{ currentEntry.stateIdx };
+			if (m_IsClosed[currentState] || currentEntry.costSoFar > m_CostSoFar[currentState])
+				continue;
+
+			m_IsClosed[currentState] = true;
+			++nrOfExpansions;
+
+			const int cellIdx{ currentState / nrOfTimes };
+			const int timeOffset{ currentState % nrOfTimes };
+
+			const int endTimeOffset{ endState % nrOfTimes };
+			if (timeOffset > endTimeOffset || (timeOffset == endTimeOffset && pDistanceField->GetCost(cellIdx) < pDistanceField->GetCost(endState / nrOfTimes)))
+				endState = currentState;
+
+			// The end of the window, or the goal when the agent can stay there until the end of the window
+			if (timeOffset == m_Window)
+				break;
+
+			if (cellIdx == agent.goalIdx)
+			{
+				bool canStay{ true };
+				for (int time{ currentTime + timeOffset + 1 }; time <= currentTime + m_Window && canStay; ++time)
+					canStay = m_Reservations.IsFree(cellIdx, time, agentId);
+
+				if (canStay)
+				{
+					endState = currentState;
+					break;
+				}
+			}
+
+			auto openState = [&](int nextCellIdx, float moveCost)
+			{
+				// Cells that can't reach the goal on the empty grid are never part of a way towards it
+				const float distance{ pDistanceField->GetCost(nextCellIdx) };
+				if (distance == FLT_MAX || !CanMove(agentId, cellIdx, nextCellIdx, currentTime + timeOffset))
+					return;
+
+				const int nextState{ nextCellIdx * nrOfTimes + timeOffset + 1 };
+				VisitState(nextState);
+
+				const float costSoFar{ m_CostSoFar[currentState] + moveCost };
+				if (costSoFar >= m_CostSoFar[nextState])
+					return;
+
+				m_CostSoFar[nextState] = costSoFar;
+				m_Parent[nextState] = currentState;
+				m_OpenList.push_back({ costSoFar + distance, costSoFar, nextState });
+				std::push_heap(m_OpenList.begin(), m_OpenList.end());
+			};
+
+			// Waiting is free once the goal is reached
+			openState(cellIdx, cellIdx == agent.goalIdx ? 0.f : waitCost);
+			for (auto& connection : m_pGrid->GetNodeConnections(cellIdx))
+				openState(connection->GetTo(), connection->GetCost());
+		}
+		m_NrOfExpansionsLastStep += nrOfExpansions;
+
+		//--------------------//
+		//--Reconstruct Plan--//
+		//--------------------//
+
+		agent.planTime = currentTime;
+		agent.searchTime = currentTime;
+		agent.plannedCells.clear();
+		for (int state{ endState }; state != startState; state = m_Parent[state])
+			agent.plannedCells.push_back(state / nrOfTimes);
+		agent.plannedCells.push_back(agent.cellIdx);
+		std::reverse(agent.plannedCells.begin(), agent.plannedCells.end());
+
+		ReservePlan(agentId);
+
+		// Wait at the last cell for the rest of the window, or step aside when another agent claimed it
+		agent.isBlocked = false;
+		while (int(agent.plannedCells.size()) < nrOfTimes && agent.isBlocked == false)
+			agent.isBlocked = !ExtendPlan(agentId);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void CooperativePathfinder<T_NodeType, T_ConnectionType>::PrepareSearch()
+	{
+		// Arrays only grow, so they get reused by every search on the same grid
+		const size_t nrOfStates{ size_t(m_pGrid->GetNrOfNodes()) * size_t(m_Window + 1) };
+		if (m_VisitedGeneration.size() < nrOfStates)
+		{
+			m_CostSoFar.resize(nrOfStates);
+			m_Parent.resize(nrOfStates);
+			m_IsClosed.resize(nrOfStates);
+			m_VisitedGeneration.resize(nrOfStates, 0);
+		}
+
+		// A new generation invalidates the data of the previous search without clearing the arrays
+		++m_Generation;
+		if (m_Generation == 0)
+		{
+			std::fill(m_VisitedGeneration.begin(), m_VisitedGeneration.end(), 0);
+			m_Generation = 1;
+		}
+
+		m_OpenList.clear();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void CooperativePathfinder<T_NodeType, T_ConnectionType>::VisitState(int stateIdx)
+	{
+		if (m_VisitedGeneration[stateIdx] == m_Generation)
+			return;
+
+		m_VisitedGeneration[stateIdx] = m_Generation;
+		m_CostSoFar[stateIdx] = FLT_MAX;
+		m_Parent[stateIdx] = invalid_node_index;
+		m_IsClosed[stateIdx] = false;
+	}
+}
@@ -0,0 +1,436 @@
+#pragma once
+#include "framework/EliteAI/EliteNavigation/ENavigation.h"
+
+namespace Elite
+{
+	// D* Lite: incremental replanning towards a fixed goal while the start moves and the graph changes.
+	// The search runs backwards from the goal, so the search tree stays valid while the agent walks along the path.
+	// The planner listens to the graph, changed connections only make their nodes inconsistent and the next query repairs the tree from there.
+	// Every agent needs its own planner, the search tree belongs to one goal.
+	template <class T_NodeType, class T_ConnectionType>
+	class DStarLite final
+	{
+	public:
+		DStarLite(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction);
+
+		// Returns the nodes from start to destination, or an empty path when the destination can't be reached
+		// Queries towards the same destination reuse the search tree, a new destination starts a new search
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+
+		// True when a graph change affected the search tree since the last query, the last returned path might be stale
+		bool NeedsReplanning() const { return m_NeedsReplanning; }
+
+		// The heuristic is part of the stored keys, changing it starts a new search on the next query
+		void SetHeuristic(Heuristic hFunction);
+
+		// Drops the search tree, the next query starts from scratch
+		void Reset();
+
+		// Nodes expanded by the last query, only the repaired part of the tree for incremental queries
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+
+	private:
+		struct Key
+		{
+			float primary; // min(g, rhs) + h-cost from the start + key modifier
+			float secondary; // min(g, rhs)
+
+			bool operator<(const Key& other) const
+			{
+				if (primary != other.primary)
+					return primary < other.primary;
+				return secondary < other.secondary;
+			}
+			bool operator==(const Key& other) const { return primary == other.primary && secondary == other.secondary; }
+		};
+
+		// Entry on the open list, entries whose key no longer matches the key of their node are skipped when popped
+		struct OpenEntry
+		{
+			Key key;
+			int nodeIdx;
+
+			bool operator<(const OpenEntry& other) const { return other.key < key; }
+		};
+
+		void OnGraphChanged(const GraphChangeSet& changes);
+
+		void Initialize(int goalIdx);
+		void ComputeShortestPath();
+		void UpdateNode(int idx);
+		void PushNode(int idx);
+		bool PopOutdatedEntries();
+
+		Key CalculateKey(int idx) const;
+		float ComputeRhs(int idx) const;
+		float GetHeuristicCost(int fromIdx, int toIdx) const;
+		float GetConnectionCost(int from, int to) const;
+		bool IsActiveNode(int idx) const { return m_pGraph->GetNode(idx)->GetIndex() != invalid_node_index; }
+
+		template <typename T_Function>
+		void ForEachPredecessor(int idx, T_Function function) const;
+
+		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		Heuristic m_HeuristicFunction;
+
+		int m_StartIdx = invalid_node_index;
+		int m_GoalIdx = invalid_node_index;
+		float m_KeyModifier = 0.f; // sum of the h-costs between all starts, keeps the old keys valid as lower bounds when the start moves
+
+		// Per node index
+		std::vector<float> m_CostSoFar; // g: cost to the goal
+		std::vector<float> m_LookAheadCost; // rhs: one step look-ahead of g
+		std::vector<Key> m_OpenKey;
+		std::vector<bool> m_IsOpen;
+
+		// Only used by directional graphs, undirected graphs use the connections of the node itself
+		std::vector<std::vector<int>> m_Predecessors;
+
+		std::vector<OpenEntry> m_OpenList;
+		bool m_NeedsReplanning = false;
+		int m_NrOfExpandedNodes = 0;
+
+		// Last member, so it is unregistered before the rest of the planner is destroyed
+		ChangeListenerHandle<T_NodeType, T_ConnectionType> m_ListenerHandle;
+
+		DStarLite(const DStarLite&) = delete;
+		DStarLite& operator=(const DStarLite&) = delete;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	DStarLite<T_NodeType, T_ConnectionType>::DStarLite(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+		, m_ListenerHandle(pGraph, [this](const GraphChangeSet& changes) { OnGraphChanged(changes); })
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> DStarLite<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		std::vector<T_NodeType*> path;
+		m_NrOfExpandedNodes = 0;
+
+		if (pStartNode == nullptr || pGoalNode == nullptr)
+			return path;
+
+		const int startIdx{ pStartNode->GetIndex() };
+		const int goalIdx{ pGoalNode->GetIndex() };
+
+		if (goalIdx != m_GoalIdx || m_CostSoFar.size() != size_t(m_pGraph->GetNrOfNodes()))
+		{
+			m_StartIdx = startIdx;
+			Initialize(goalIdx);
+		}
+		else if (startIdx != m_StartIdx)
+		{
+			// The keys on the open list were calculated for the old start, raising all new keys by the distance moved keeps the order valid
+			m_KeyModifier += GetHeuristicCost(m_StartIdx, startIdx);
+			m_StartIdx = startIdx;
+		}
+
+		ComputeShortestPath();
+		m_NeedsReplanning = false;
+
+		if (m_CostSoFar[startIdx] == FLT_MAX)
+			return path;
+
+		//--------------------//
+		//--Reconstruct Path--//
+		//--------------------//
+
+		// Follow the cheapest successor, the search tree points towards the goal
+		path.push_back(pStartNode);
+		for (int currentIdx{ startIdx }; currentIdx != goalIdx;)
+		{
+			int nextIdx{ invalid_node_index };
+			float lowestCost{ FLT_MAX };
+			for (auto& connection : m_pGraph->GetNodeConnections(currentIdx))
+			{
+				const float costToGoal{ m_CostSoFar[connection->GetTo()] };
+				if (costToGoal == FLT_MAX)
+					continue;
+
+				const float cost{ connection->GetCost() + costToGoal };
+				if (cost < lowestCost)
+				{
+					lowestCost = cost;
+					nextIdx = connection->GetTo();
+				}
+			}
+
+			// A path can never be longer than the graph, anything else means the tree is broken
+			if (nextIdx == invalid_node_index || int(path.size()) > m_pGraph->GetNrOfNodes())
+			{
+				path.clear();
+				return path;
+			}
+
+			currentIdx = nextIdx;
+			path.push_back(m_pGraph->GetNode(currentIdx));
+		}
+
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DStarLite<T_NodeType, T_ConnectionType>::SetHeuristic(Heuristic hFunction)
+	{
+		m_HeuristicFunction = hFunction;
+		Reset();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DStarLite<T_NodeType, T_ConnectionType>::Reset()
+	{
+		m_GoalIdx = invalid_node_index;
+		m_StartIdx = invalid_node_index;
+		m_OpenList.clear();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DStarLite<T_NodeType, T_ConnectionType>::OnGraphChanged(const GraphChangeSet& changes)
+	{
+		if (m_GoalIdx == invalid_node_index)
+			return;
+
+		// Added or removed nodes (or a cleared graph) invalidate the indices, start over on the next query
+		if (changes.nrOfNodesChanged || changes.touchedNodes.empty())
+		{
+			Reset();
+			m_NeedsReplanning = true;
+			return;
+		}
+
+		if (m_pGraph->IsDirectionalGraph())
+		{
+			for (const auto& connection : changes.touchedConnections)
+			{
+				auto& predecessors = m_Predecessors[connection.second];
+				auto predecessorIt = std::find(predecessors.begin(), predecessors.end(), connection.first);
+				const bool exists{ m_pGraph->GetConnection(connection.first, connection.second) != nullptr };
+
+				if (exists && predecessorIt == predecessors.end())
+					predecessors.push_back(connection.first);
+				else if (!exists && predecessorIt != predecessors.end())
+					predecessors.erase(predecessorIt);
+			}
+		}
+
+		// Only the outgoing connections of a touched node changed, so its look-ahead cost is the only value to recalculate
+		for (int idx : changes.touchedNodes)
+		{
+			if (idx == m_GoalIdx || !IsActiveNode(idx))
+				continue;
+
+			const float lookAheadCost{ ComputeRhs(idx) };
+			if (lookAheadCost == m_LookAheadCost[idx])
+				continue;
+
+			m_LookAheadCost[idx] = lookAheadCost;
+			UpdateNode(idx);
+			m_NeedsReplanning = true;
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DStarLite<T_NodeType, T_ConnectionType>::Initialize(int goalIdx)
+	{
+		const size_t nrOfNodes{ size_t(m_pGraph->GetNrOfNodes()) };
+
+		m_CostSoFar.assign(nrOfNodes, FLT_MAX);
+		m_LookAheadCost.assign(nrOfNodes, FLT_MAX);
+		m_OpenKey.assign(nrOfNodes, Key{ FLT_MAX, FLT_MAX });
+		m_IsOpen.assign(nrOfNodes, false);
+		m_OpenList.clear();
+		m_KeyModifier = 0.f;
+
+		if (m_pGraph->IsDirectionalGraph())
+		{
+			m_Predecessors.assign(nrOfNodes, {});
+			for (int idx{}; idx < int(nrOfNodes); ++idx)
+			{
+				if (!IsActiveNode(idx))
+					continue;
+
+				for (auto& connection : m_pGraph->GetNodeConnections(idx))
+					m_Predecessors[connection->GetTo()].push_back(idx);
+			}
+		}
+
+		m_GoalIdx = goalIdx;
+		m_LookAheadCost[goalIdx] = 0.f;
+		PushNode(goalIdx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DStarLite<T_NodeType, T_ConnectionType>::ComputeShortestPath()
+	{
+		const int startIdx{ m_StartIdx };
+
+		// Stop once the start is consistent and nothing on the open list can still improve it
+		while (PopOutdatedEntries() && (m_OpenList.front().key < CalculateKey(startIdx) || m_LookAheadCost[startIdx] != m_CostSoFar[startIdx]))
+		{
+			const OpenEntry currentEntry{ m_OpenList.front() };
+			const int currentIdx{ currentEntry.nodeIdx };
+
+			// The key was calculated for an older start, push it again with the current key
+			const Key newKey{ CalculateKey(currentIdx) };
+			if (currentEntry.key < newKey)
+			{
+				PushNode(currentIdx);
+				continue;
+			}
+
+			std::pop_heap(m_OpenList.begin(), m_OpenList.end());
+			m_OpenList.pop_back();
+			m_IsOpen[currentIdx] = false;
+			++m_NrOfExpandedNodes;
+
+			if (m_CostSoFar[currentIdx] > m_LookAheadCost[currentIdx])
+			{
+				// Overconsistent: the node got cheaper, its predecessors might get cheaper through it
+				const float costSoFar{ m_LookAheadCost[currentIdx] };
+				m_CostSoFar[currentIdx] = costSoFar;
+
+				ForEachPredecessor(currentIdx, [this, currentIdx, costSoFar](int predecessorIdx)
+					{
+						if (predecessorIdx == m_GoalIdx)
+							return;
+
+						const float cost{ GetConnectionCost(predecessorIdx, currentIdx) };
+						if (cost == FLT_MAX)
+							return;
+
+						if (cost + costSoFar < m_LookAheadCost[predecessorIdx])
+						{
+							m_LookAheadCost[predecessorIdx] = cost + costSoFar;
+							UpdateNode(predecessorIdx);
+						}
+					});
+			}
+			else
+			{
+				// Underconsistent: the node got more expensive, everything that depended on it has to look for another way
+				m_CostSoFar[currentIdx] = FLT_MAX;
+
+				if (currentIdx != m_GoalIdx)
+					m_LookAheadCost[currentIdx] = ComputeRhs(currentIdx);
+				UpdateNode(currentIdx);
+
+				ForEachPredecessor(currentIdx, [this](int predecessorIdx)
+					{
+						if (predecessorIdx == m_GoalIdx)
+							return;
+
+						m_LookAheadCost[predecessorIdx] = ComputeRhs(predecessorIdx);
+						UpdateNode(predecessorIdx);
+					});
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline void DStarLite<T_NodeType, T_ConnectionType>::UpdateNode(int idx)
+	{
+		if (m_CostSoFar[idx] != m_LookAheadCost[idx])
+		{
+			PushNode(idx);
+		}
+		else
+		{
+			// Consistent nodes leave the open list, their entries become outdated
+			m_IsOpen[idx] = false;
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline void DStarLite<T_NodeType, T_ConnectionType>::PushNode(int idx)
+	{
+		const Key key{ CalculateKey(idx) };
+		if (m_IsOpen[idx] && m_OpenKey[idx] == key)
+			return;
+
+		m_OpenKey[idx] = key;
+		m_IsOpen[idx] = true;
+
+		m_OpenList.push_back({ key, idx });
+		std::push_heap(m_OpenList.begin(), m_OpenList.end());
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline bool DStarLite<T_NodeType, T_ConnectionType>::PopOutdatedEntries()
+	{
+		// Returns whether a valid entry is left on top of the open list
+		while (m_OpenList.empty() == false)
+		{
+			const OpenEntry& topEntry{ m_OpenList.front() };
+			if (m_IsOpen[topEntry.nodeIdx] && m_OpenKey[topEntry.nodeIdx] == topEntry.key)
+				return true;
+
+			std::pop_heap(m_OpenList.begin(), m_OpenList.end());
+			m_OpenList.pop_back();
+		}
+
+		return false;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline typename DStarLite<T_NodeType, T_ConnectionType>::Key DStarLite<T_NodeType, T_ConnectionType>::CalculateKey(int idx) const
+	{
+		const float cost{ std::min(m_CostSoFar[idx], m_LookAheadCost[idx]) };
+		if (cost == FLT_MAX)
+			return Key{ FLT_MAX, FLT_MAX };
+
+		return Key{ cost + GetHeuristicCost(m_StartIdx, idx) + m_KeyModifier, cost };
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline float DStarLite<T_NodeType, T_ConnectionType>::ComputeRhs(int idx) const
+	{
+		float lowestCost{ FLT_MAX };
+		for (auto& connection : m_pGraph->GetNodeConnections(idx))
+		{
+			const float costToGoal{ m_CostSoFar[connection->GetTo()] };
+			if (costToGoal != FLT_MAX)
+				lowestCost = std::min(lowestCost, connection->GetCost() + costToGoal);
+		}
+
+		return lowestCost;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline float DStarLite<T_NodeType, T_ConnectionType>::GetHeuristicCost(int fromIdx, int toIdx) const
+	{
+		const Vector2 toDestination{ m_pGraph->GetNodePos(toIdx) - m_pGraph->GetNodePos(fromIdx) };
+		return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline float DStarLite<T_NodeType, T_ConnectionType>::GetConnectionCost(int from, int to) const
+	{
+		for (auto& connection : m_pGraph->GetNodeConnections(from))
+		{
+			if (connection->GetTo() == to)
+				return connection->GetCost();
+		}
+
+		return FLT_MAX;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	template <typename T_Function>
+	inline void DStarLite<T_NodeType, T_ConnectionType>::ForEachPredecessor(int idx, T_Function function) const
+	{
+		if (m_pGraph->IsDirectionalGraph())
+		{
+			for (int predecessorIdx : m_Predecessors[idx])
+				function(predecessorIdx);
+		}
+		else
+		{
+			for (auto& connection : m_pGraph->GetNodeConnections(idx))
+				function(connection->GetTo());
+		}
+	}
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <stack>
+#include "framework\EliteAI\EliteGraphs\EOverlayGraph.h"
 
 namespace Elite
 {
@@ -77,10 +78,10 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline std::vector<T_NodeType*> EulerianPath<T_NodeType, T_ConnectionType>::FindPath(Eulerianity& eulerianity) const
 	{
-		// Get a copy of the graph because this algorithm involves removing edges
-		auto graphCopy = m_pGraph->Clone();
+		// This algorithm involves removing edges, an overlay keeps track of them without copying the graph
+		OverlayGraph<T_NodeType, T_ConnectionType> graphCopy{ m_pGraph };
 		auto path = std::vector<T_NodeType*>();
-		int nrOfNodes = graphCopy->GetNrOfNodes();
+		int nrOfNodes = graphCopy.GetNrOfNodes();
 
 		// Check if there can be an Euler path
 		// If this graph is not eulerian, return the empty path
@@ -123,24 +124,24 @@ namespace Elite
 		T_ConnectionType* currentConnection;
 
 		// Loop while Node still has connections or stack is still not empty
-		bool stillHasConnections{ graphCopy->GetNodeConnections(currentNodeIdx).size() > 0 };
+		bool stillHasConnections{ graphCopy.GetNodeConnections(currentNodeIdx).size() > 0 };
 		bool stackNotEmpty{ nodeStack.size() > 0 };
 		while (stillHasConnections || stackNotEmpty)
 		{
 			// If node has neighbors
-			if (graphCopy->GetNodeConnections(currentNodeIdx).size() > 0)
+			if (graphCopy.GetNodeConnections(currentNodeIdx).size() > 0)
 			{
 				// Add node to stack
 				nodeStack.push(currentNodeIdx);
 
 				// Take a neighbor
-				currentConnection = graphCopy->GetNodeConnections(currentNodeIdx).front();
+				currentConnection = graphCopy.GetNodeConnections(currentNodeIdx).front();
 
 				// Set neighbor as new node
 				currentNodeIdx = currentConnection->GetTo();
 
 				// Remove connection
-				graphCopy->RemoveConnection(currentConnection);
+				graphCopy.RemoveConnection(currentConnection);
 			}
 			else
 			{
@@ -155,7 +156,7 @@ namespace Elite
 			}
 
 			// Re-assign bools
-			stillHasConnections = graphCopy->GetNodeConnections(currentNodeIdx).size() > 0;
+			stillHasConnections = graphCopy.GetNodeConnections(currentNodeIdx).size() > 0;
 			stackNotEmpty = nodeStack.size() > 0;
 		}
 
@@ -0,0 +1,253 @@
+#pragma once
+#include "framework/EliteAI/EliteGraphs/EGridGraph.h"
+
+namespace Elite
+{
+	// Cost to the goal and direction to follow for every cell of a grid, built with one Dijkstra pass from the goal.
+	// Any number of agents heading to the same goal sample the field in O(1) instead of searching a path each.
+	// The field only keeps the layout of the grid, so sampling doesn't need the graph (and the field isn't a template).
+	class FlowField final
+	{
+	public:
+		FlowField() = default;
+
+		// Integrates the costs backwards from the goal over the connections of the grid
+		template<class T_NodeType, class T_ConnectionType>
+		void Build(const GridGraph<T_NodeType, T_ConnectionType>& grid, int goalIdx);
+
+		// True when the field was built for this goal on the current version of the grid
+		template<class T_NodeType, class T_ConnectionType>
+		bool IsUpToDate(const GridGraph<T_NodeType, T_ConnectionType>& grid, int goalIdx) const;
+
+		// Sampling, positions outside of the grid or in cells that can't reach the goal give FLT_MAX costs and zero directions
+		int GetCellIdx(const Vector2& worldPos) const;
+		float GetCost(const Vector2& worldPos) const;
+		bool IsReachable(const Vector2& worldPos) const { return GetCost(worldPos) != FLT_MAX; }
+		bool IsGoalCell(const Vector2& worldPos) const { return m_GoalIdx != invalid_node_index && GetCellIdx(worldPos) == m_GoalIdx; }
+
+		// Unit direction from the center of the cell to the center of the next cell on the way to the goal
+		Vector2 GetDirection(const Vector2& worldPos) const;
+		// Center of the next cell on the way to the goal, the goal cell returns its own center
+		Vector2 GetNextWaypoint(const Vector2& worldPos) const;
+
+		float GetCost(int idx) const { return m_Costs[idx]; }
+		int GetNextCellIdx(int idx) const { return m_NextCells[idx]; }
+		const Vector2& GetDirection(int idx) const { return m_Directions[idx]; }
+
+		int GetGoalIdx() const { return m_GoalIdx; }
+		int GetGraphVersion() const { return m_GraphVersion; }
+		int GetNrOfCells() const { return int(m_Costs.size()); }
+
+	private:
+		Vector2 GetCellCenter(int idx) const;
+
+		int m_Columns = 0;
+		int m_Rows = 0;
+		int m_CellSize = 0;
+
+		int m_GoalIdx = invalid_node_index;
+		int m_GraphVersion = -1;
+
+		// Per cell
+		std::vector<float> m_Costs;
+		std::vector<int> m_NextCells;
+		std::vector<Vector2> m_Directions;
+	};
+
+	// One flow field per goal, rebuilt when the version of the grid changed since it was built
+	// Keeps the most recently requested goals, older fields get rebuilt when they are needed again
+	template<class T_NodeType, class T_ConnectionType>
+	class FlowFieldCache final
+	{
+	public:
+		explicit FlowFieldCache(const GridGraph<T_NodeType, T_ConnectionType>* pGrid, size_t capacity = 8);
+
+		// The field stays valid until its goal gets evicted by requests for other goals
+		const FlowField* GetFlowField(int goalIdx);
+
+		int GetNrOfBuilds() const { return m_NrOfBuilds; }
+		void Clear() { m_Fields.clear(); }
+
+	private:
+		struct CachedField
+		{
+			int goalIdx;
+			unsigned int lastRequest;
+			FlowField field;
+		};
+
+		const GridGraph<T_NodeType, T_ConnectionType>* m_pGrid;
+		size_t m_Capacity;
+		std::vector<CachedField> m_Fields;
+		unsigned int m_NrOfRequests = 0;
+		int m_NrOfBuilds = 0;
+	};
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void FlowField::Build(const GridGraph<T_NodeType, T_ConnectionType>& grid, int goalIdx)
+	{
+		assert(grid.IsNodeValid(goalIdx) && "<FlowField::Build>: invalid goal");
+
+		const int nrOfCells{ grid.GetNrOfNodes() };
+		m_Columns = grid.GetColumns();
+		m_Rows = grid.GetRows();
+		m_CellSize = grid.GetCellSize();
+		m_GoalIdx = goalIdx;
+		m_GraphVersion = grid.GetVersion();
+
+		m_Costs.assign(nrOfCells, FLT_MAX);
+		m_NextCells.assign(nrOfCells, invalid_node_index);
+		m_Directions.assign(nrOfCells, ZeroVector2);
+
+		// Dijkstra from the goal, a cell is settled with the cost of its cheapest way to the goal
+		using OpenEntry = std::pair<float, int>;
+		std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> openList{};
+
+		m_Costs[goalIdx] = 0.f;
+		openList.push({ 0.f, goalIdx });
+
+		while (openList.empty() == false)
+		{
+			const OpenEntry currentEntry{ openList.top() };
+			openList.pop();
+
+			const int currentIdx{ currentEntry.second };
+			if (currentEntry.first > m_Costs[currentIdx])
+				continue;
+
+			// The way back to the goal uses the connections towards this cell
+			auto relaxPredecessor = [this, &openList, currentIdx](int predecessorIdx, float connectionCost)
+			{
+				const float cost{ m_Costs[currentIdx] + connectionCost };
+				if (cost >= m_Costs[predecessorIdx])
+					return;
+
+				m_Costs[predecessorIdx] = cost;
+				m_NextCells[predecessorIdx] = currentIdx;
+				openList.push({ cost, predecessorIdx });
+			};
+
+			if (grid.IsDirectionalGraph())
+			{
+				// Only neighboring cells can have a connection towards this cell
+				const Vector2 colRow{ grid.GetNodePos(currentIdx) };
+				for (int rowOffset{ -1 }; rowOffset <= 1; ++rowOffset)
+				{
+					for (int colOffset{ -1 }; colOffset <= 1; ++colOffset)
+					{
+						const int col{ int(colRow.x) + colOffset };
+						const int row{ int(colRow.y) + rowOffset };
+						if ((colOffset == 0 && rowOffset == 0) || !grid.IsWithinBounds(col, row))
+							continue;
+
+						const int neighborIdx{ grid.GetIndex(col, row) };
+						const T_ConnectionType* pConnection{ grid.GetConnection(neighborIdx, currentIdx) };
+						if (pConnection != nullptr)
+							relaxPredecessor(neighborIdx, pConnection->GetCost());
+					}
+				}
+			}
+			else
+			{
+				for (auto pConnection : grid.GetNodeConnections(currentIdx))
+					relaxPredecessor(pConnection->GetTo(), pConnection->GetCost());
+			}
+		}
+
+		for (int idx{}; idx < nrOfCells; ++idx)
+		{
+			if (m_NextCells[idx] != invalid_node_index)
+				m_Directions[idx] = (GetCellCenter(m_NextCells[idx]) - GetCellCenter(idx)).GetNormalized();
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool FlowField::IsUpToDate(const GridGraph<T_NodeType, T_ConnectionType>& grid, int goalIdx) const
+	{
+		return m_GoalIdx == goalIdx && m_GraphVersion == grid.GetVersion() && GetNrOfCells() == grid.GetNrOfNodes();
+	}
+
+	inline int FlowField::GetCellIdx(const Vector2& worldPos) const
+	{
+		if (worldPos.x < 0 || worldPos.y < 0 || m_CellSize == 0)
+			return invalid_node_index;
+
+		const int col{ int(worldPos.x / m_CellSize) };
+		const int row{ int(worldPos.y / m_CellSize) };
+		if (col >= m_Columns || row >= m_Rows)
+			return invalid_node_index;
+
+		return row * m_Columns + col;
+	}
+
+	inline float FlowField::GetCost(const Vector2& worldPos) const
+	{
+		const int idx{ GetCellIdx(worldPos) };
+		return idx != invalid_node_index ? m_Costs[idx] : FLT_MAX;
+	}
+
+	inline Vector2 FlowField::GetDirection(const Vector2& worldPos) const
+	{
+		const int idx{ GetCellIdx(worldPos) };
+		return idx != invalid_node_index ? m_Directions[idx] : ZeroVector2;
+	}
+
+	inline Vector2 FlowField::GetNextWaypoint(const Vector2& worldPos) const
+	{
+		const int idx{ GetCellIdx(worldPos) };
+		if (idx == invalid_node_index || m_Costs[idx] == FLT_MAX)
+			return worldPos;
+
+		return idx == m_GoalIdx ? GetCellCenter(idx) : GetCellCenter(m_NextCells[idx]);
+	}
+
+	inline Vector2 FlowField::GetCellCenter(int idx) const
+	{
+		const float halfCellSize{ m_CellSize / 2.f };
+		return Vector2{ float(idx % m_Columns) * m_CellSize + halfCellSize, float(idx / m_Columns) * m_CellSize + halfCellSize };
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline FlowFieldCache<T_NodeType, T_ConnectionType>::FlowFieldCache(const GridGraph<T_NodeType, T_ConnectionType>* pGrid, size_t capacity)
+		: m_pGrid(pGrid)
+		, m_Capacity(std::max(capacity, size_t(1)))
+	{
+		// Fields never move, only the field of an evicted goal gets overwritten
+		m_Fields.reserve(m_Capacity);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline const FlowField* FlowFieldCache<T_NodeType, T_ConnectionType>::GetFlowField(int goalIdx)
+	{
+		if (!m_pGrid->IsNodeValid(goalIdx))
+			return nullptr;
+
+		++m_NrOfRequests;
+
+		auto fieldIt = std::find_if(m_Fields.begin(), m_Fields.end(), [goalIdx](const CachedField& cachedField) { return cachedField.goalIdx == goalIdx; });
+		if (fieldIt == m_Fields.end())
+		{
+			// Reuse the field of the least recently requested goal when the cache is full
+			if (m_Fields.size() < m_Capacity)
+			{
+				m_Fields.push_back(CachedField{ goalIdx, 0, FlowField{} });
+				fieldIt = std::prev(m_Fields.end());
+			}
+			else
+			{
+				fieldIt = std::min_element(m_Fields.begin(), m_Fields.end(),
+					[](const CachedField& a, const CachedField& b) { return a.lastRequest < b.lastRequest; });
+				fieldIt->goalIdx = goalIdx;
+			}
+		}
+
+		fieldIt->lastRequest = m_NrOfRequests;
+		if (!fieldIt->field.IsUpToDate(*m_pGrid, goalIdx))
+		{
+			fieldIt->field.Build(*m_pGrid, goalIdx);
+			++m_NrOfBuilds;
+		}
+
+		return &fieldIt->field;
+	}
+}
@@ -0,0 +1,884 @@
+#pragma once
+#include "framework/EliteAI/EliteGraphs/EGridGraph.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EAStar.h"
+#include <unordered_map>
+
+namespace Elite
+{
+	struct HierarchicalPathStats
+	{
+		// Abstraction
+		int nrOfClusters = 0;
+		int nrOfAbstractNodes = 0;
+		int nrOfAbstractEdges = 0;
+		int nrOfRepairedClusters = 0; // re-abstracted before the last query
+
+		// Last query
+		int nrOfExpandedAbstractNodes = 0;
+		float pathCost = 0.f;
+		float optimalCost = -1.f; // only known when validating against A*, -1 otherwise
+		float suboptimality = 1.f; // pathCost / optimalCost
+		float worstSuboptimality = 1.f; // over all validated queries
+	};
+
+	// HPA*: the grid is split into square clusters, neighboring clusters are linked through transitions on their shared border
+	// (one in the middle of every free border segment, one on both ends of long segments, and one on every connected corner).
+	// The costs between the transitions of a cluster are precomputed, a query searches this abstract graph and only refines the clusters on the abstract path.
+	// Paths are optimal inside every cluster and between neighboring clusters, longer paths can be longer than optimal by the detours to the transitions.
+	// The stats report how much when validating against A*.
+	// The abstraction follows the graph through a change listener, modified cells only get their own cluster (and the borders around it) re-abstracted on the next query.
+	template <class T_NodeType, class T_ConnectionType>
+	class HierarchicalPathfinder final
+	{
+	public:
+		HierarchicalPathfinder(GridGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, int clusterSize = 10);
+
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+
+		void SetHeuristic(Heuristic hFunction) { m_HeuristicFunction = hFunction; }
+
+		// Also runs a regular A* for every query to measure the suboptimality (debugging only, costs a full search)
+		void SetValidateAgainstAStar(bool validate) { m_ValidateAgainstAStar = validate; }
+
+		// Cells of the transitions on the last path, including start and destination
+		const std::vector<int>& GetAbstractPath() const { return m_AbstractPath; }
+		const HierarchicalPathStats& GetStats() const { return m_Stats; }
+		int GetClusterSize() const { return m_ClusterSize; }
+
+		// Drops the abstraction, it gets rebuilt on the next query
+		void Invalidate() { m_NeedsFullRebuild = true; }
+
+	private:
+		enum BorderType
+		{
+			Right, Down, DownRight, DownLeft, NrOfBorderTypes
+		};
+
+		struct CellBounds
+		{
+			int minCol, minRow, maxCol, maxRow;
+			bool Contains(int col, int row) const { return col >= minCol && col <= maxCol && row >= minRow && row <= maxRow; }
+		};
+
+		struct AbstractEdge
+		{
+			int toCell;
+			float cost;
+		};
+
+		struct AbstractNode
+		{
+			std::vector<AbstractEdge> intraEdges; // to the other transitions of the same cluster
+			std::vector<AbstractEdge> interEdges; // across a border
+			int nrOfTransitions = 0;
+		};
+
+		struct OpenEntry
+		{
+			float estimatedTotalCost;
+			float costSoFar;
+			int cell;
+
+			bool operator<(const OpenEntry& other) const
+			{
+				if (estimatedTotalCost != other.estimatedTotalCost)
+					return estimatedTotalCost > other.estimatedTotalCost;
+				return costSoFar < other.costSoFar;
+			}
+		};
+
+		// Search state per cell, stamped with a generation so it doesn't have to be cleared between searches
+		struct SearchArrays
+		{
+			std::vector<float> costSoFar;
+			std::vector<int> parent;
+			std::vector<bool> isClosed;
+			std::vector<unsigned int> visitedGeneration;
+			unsigned int generation = 0;
+			std::vector<OpenEntry> openList;
+
+			void Prepare(int nrOfCells);
+			void Visit(int cell);
+			bool IsVisited(int cell) const { return visitedGeneration[cell] == generation; }
+		};
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		Heuristic m_HeuristicFunction;
+		int m_ClusterSize;
+
+		int m_NrOfColumns = 0;
+		int m_NrOfRows = 0;
+		int m_NrOfClustersX = 0;
+		int m_NrOfClustersY = 0;
+
+		// Abstraction
+		std::unordered_map<int, AbstractNode> m_AbstractNodes; // key is the cell of the transition
+		std::vector<std::vector<std::pair<int, int>>> m_BorderTransitions; // per cluster and border type
+		std::vector<bool> m_IsClusterDirty;
+		std::vector<int> m_DirtyClusters;
+		bool m_NeedsFullRebuild = true;
+		std::vector<int> m_UnusedCells;
+
+		// Query
+		SearchArrays m_ClusterSearch;
+		SearchArrays m_AbstractSearch;
+		std::vector<AbstractEdge> m_StartEdges;
+		std::unordered_map<int, float> m_GoalCosts;
+		std::vector<int> m_TransitionCells;
+		std::vector<int> m_AbstractPath;
+		CellBounds m_QueryBounds{};
+
+		bool m_ValidateAgainstAStar = false;
+		AStar<T_NodeType, T_ConnectionType> m_AStar;
+		HierarchicalPathStats m_Stats{};
+
+		// Last member, so it is unregistered before the rest of the pathfinder is destroyed
+		ChangeListenerHandle<T_NodeType, T_ConnectionType> m_ListenerHandle;
+
+		void OnGraphChanged(const GraphChangeSet& changes);
+		void Repair();
+		void RebuildAll();
+		bool RebuildBorder(int cluster, BorderType border);
+		void RebuildIntraEdges(int cluster);
+		void GetTransitionCells(int cluster, std::vector<int>& transitionCells) const;
+		void AddTransition(int cell, int otherCell, std::vector<std::pair<int, int>>& transitions);
+		void RemoveTransition(const std::pair<int, int>& transition);
+		void RemoveUnusedNodes();
+
+		int GetCluster(int cell) const { return (cell / m_NrOfColumns / m_ClusterSize) * m_NrOfClustersX + (cell % m_NrOfColumns) / m_ClusterSize; }
+		int GetBorderNeighbor(int cluster, BorderType border) const;
+		CellBounds GetClusterBounds(int cluster) const;
+		CellBounds GetQueryBounds(int startCluster, int goalCluster) const;
+		float GetConnectionCost(int from, int to) const;
+
+		// Dijkstra that doesn't leave the bounds, stops early when the target is reached
+		void SearchBounds(const CellBounds& bounds, int sourceCell, bool isReversed, int targetCell = invalid_node_index);
+		bool SearchAbstractGraph(int startCell, int goalCell, int goalCluster);
+		std::vector<T_NodeType*> RefinePath();
+
+		HierarchicalPathfinder(const HierarchicalPathfinder&) = delete;
+		HierarchicalPathfinder& operator=(const HierarchicalPathfinder&) = delete;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	HierarchicalPathfinder<T_NodeType, T_ConnectionType>::HierarchicalPathfinder(GridGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, int clusterSize)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+		, m_ClusterSize(clusterSize)
+		, m_AStar(pGraph, hFunction)
+		, m_ListenerHandle(pGraph, [this](const GraphChangeSet& changes) { OnGraphChanged(changes); })
+	{
+		assert(clusterSize > 1 && "<HierarchicalPathfinder>: clusters need to be at least 2 cells wide");
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> HierarchicalPathfinder<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		m_AbstractPath.clear();
+		m_Stats.nrOfExpandedAbstractNodes = 0;
+		m_Stats.pathCost = 0.f;
+		m_Stats.optimalCost = -1.f;
+		m_Stats.suboptimality = 1.f;
+
+		if (pStartNode == nullptr || pGoalNode == nullptr)
+			return {};
+
+		Repair();
+
+		// The graph isn't a complete grid
+		if (m_NeedsFullRebuild)
+			return {};
+
+		const int startCell{ pStartNode->GetIndex() };
+		const int goalCell{ pGoalNode->GetIndex() };
+		if (startCell == goalCell)
+			return { pStartNode };
+
+		// Temporarily link start and goal to the transitions of their clusters
+		const int startCluster{ GetCluster(startCell) };
+		const int goalCluster{ GetCluster(goalCell) };
+
+		m_StartEdges.clear();
+		SearchBounds(GetClusterBounds(startCluster), startCell, false);
+		GetTransitionCells(startCluster, m_TransitionCells);
+		for (int cell : m_TransitionCells)
+		{
+			if (cell != startCell && m_ClusterSearch.IsVisited(cell) && m_ClusterSearch.costSoFar[cell] < FLT_MAX)
+				m_StartEdges.push_back({ cell, m_ClusterSearch.costSoFar[cell] });
+		}
+
+		// Start and goal in the same or neighboring clusters also get linked directly, otherwise short paths could make big detours to the transitions.
+		// The abstract search decides if going through the transitions is cheaper.
+		m_QueryBounds = GetQueryBounds(startCluster, goalCluster);
+		if (m_QueryBounds.maxCol >= m_QueryBounds.minCol)
+		{
+			SearchBounds(m_QueryBounds, startCell, false, goalCell);
+			if (m_ClusterSearch.IsVisited(goalCell) && m_ClusterSearch.costSoFar[goalCell] < FLT_MAX)
+				m_StartEdges.push_back({ goalCell, m_ClusterSearch.costSoFar[goalCell] });
+		}
+
+		m_GoalCosts.clear();
+		SearchBounds(GetClusterBounds(goalCluster), goalCell, true);
+		GetTransitionCells(goalCluster, m_TransitionCells);
+		for (int cell : m_TransitionCells)
+		{
+			if (cell != goalCell && m_ClusterSearch.IsVisited(cell) && m_ClusterSearch.costSoFar[cell] < FLT_MAX)
+				m_GoalCosts[cell] = m_ClusterSearch.costSoFar[cell];
+		}
+
+		if (SearchAbstractGraph(startCell, goalCell, goalCluster) == false)
+		{
+			// One-way connections can cut a border segment in ways the transitions don't cover, so directional grids get a second opinion
+			if (m_pGraph->IsDirectionalGraph() == false)
+				return {};
+
+			auto path = m_AStar.FindPath(pStartNode, pGoalNode);
+			for (size_t i{ 1 }; i < path.size(); ++i)
+				m_Stats.pathCost += GetConnectionCost(path[i - 1]->GetIndex(), path[i]->GetIndex());
+			return path;
+		}
+
+		auto path = RefinePath();
+
+		// Measure against the optimal path
+		if (m_ValidateAgainstAStar)
+		{
+			const auto optimalPath = m_AStar.FindPath(pStartNode, pGoalNode);
+
+			float optimalCost{};
+			for (size_t i{ 1 }; i < optimalPath.size(); ++i)
+				optimalCost += GetConnectionCost(optimalPath[i - 1]->GetIndex(), optimalPath[i]->GetIndex());
+
+			m_Stats.optimalCost = optimalCost;
+			m_Stats.suboptimality = optimalCost > 0.f ? m_Stats.pathCost / optimalCost : 1.f;
+			m_Stats.worstSuboptimality = std::max(m_Stats.worstSuboptimality, m_Stats.suboptimality);
+		}
+
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HierarchicalPathfinder<T_NodeType, T_ConnectionType>::OnGraphChanged(const GraphChangeSet& changes)
+	{
+		// Nodes added or removed, or the graph was cleared as a whole
+		if (changes.nrOfNodesChanged || changes.touchedNodes.empty())
+		{
+			m_NeedsFullRebuild = true;
+			return;
+		}
+
+		if (m_NeedsFullRebuild)
+			return;
+
+		for (int cell : changes.touchedNodes)
+		{
+			if (cell < 0 || cell >= m_NrOfColumns * m_NrOfRows)
+				continue;
+
+			const int cluster{ GetCluster(cell) };
+			if (m_IsClusterDirty[cluster] == false)
+			{
+				m_IsClusterDirty[cluster] = true;
+				m_DirtyClusters.push_back(cluster);
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HierarchicalPathfinder<T_NodeType, T_ConnectionType>::Repair()
+	{
+		if (m_NeedsFullRebuild || m_NrOfColumns != m_pGraph->GetColumns() || m_NrOfRows != m_pGraph->GetRows())
+		{
+			RebuildAll();
+			return;
+		}
+
+		m_Stats.nrOfRepairedClusters = 0;
+		if (m_DirtyClusters.empty())
+			return;
+
+		// Every border of a dirty cluster, also the ones stored on its neighbors
+		std::vector<std::pair<int, BorderType>> borders;
+		for (int cluster : m_DirtyClusters)
+		{
+			const int clusterX{ cluster % m_NrOfClustersX };
+			const int clusterY{ cluster / m_NrOfClustersX };
+
+			for (int border{}; border < NrOfBorderTypes; ++border)
+				borders.push_back({ cluster, BorderType(border) });
+
+			if (clusterX > 0)
+				borders.push_back({ cluster - 1, Right });
+			if (clusterY > 0)
+				borders.push_back({ cluster - m_NrOfClustersX, Down });
+			if (clusterX > 0 && clusterY > 0)
+				borders.push_back({ cluster - m_NrOfClustersX - 1, DownRight });
+			if (clusterX < m_NrOfClustersX - 1 && clusterY > 0)
+				borders.push_back({ cluster - m_NrOfClustersX + 1, DownLeft });
+		}
+
+		std::sort(borders.begin(), borders.end());
+		borders.erase(std::unique(borders.begin(), borders.end()), borders.end());
+
+		// Neighbors only need their intra edges rebuilt when the transitions on the shared border moved
+		std::vector<int> clustersToRebuild{ m_DirtyClusters };
+		for (const auto& border : borders)
+		{
+			if (RebuildBorder(border.first, border.second))
+			{
+				clustersToRebuild.push_back(border.first);
+				clustersToRebuild.push_back(GetBorderNeighbor(border.first, border.second));
+			}
+		}
+
+		RemoveUnusedNodes();
+
+		std::sort(clustersToRebuild.begin(), clustersToRebuild.end());
+		clustersToRebuild.erase(std::unique(clustersToRebuild.begin(), clustersToRebuild.end()), clustersToRebuild.end());
+
+		for (int cluster : clustersToRebuild)
+			RebuildIntraEdges(cluster);
+
+		for (int cluster : m_DirtyClusters)
+			m_IsClusterDirty[cluster] = false;
+		m_DirtyClusters.clear();
+
+		m_Stats.nrOfRepairedClusters = int(clustersToRebuild.size());
+		m_Stats.nrOfAbstractNodes = int(m_AbstractNodes.size());
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HierarchicalPathfinder<T_NodeType, T_ConnectionType>::RebuildAll()
+	{
+		m_NrOfColumns = m_pGraph->GetColumns();
+		m_NrOfRows = m_pGraph->GetRows();
+		m_NrOfClustersX = (m_NrOfColumns + m_ClusterSize - 1) / m_ClusterSize;
+		m_NrOfClustersY = (m_NrOfRows + m_ClusterSize - 1) / m_ClusterSize;
+
+		const int nrOfClusters{ m_NrOfClustersX * m_NrOfClustersY };
+
+		m_AbstractNodes.clear();
+		m_UnusedCells.clear();
+		m_Stats.nrOfAbstractEdges = 0;
+		m_BorderTransitions.assign(size_t(nrOfClusters) * NrOfBorderTypes, {});
+		m_IsClusterDirty.assign(nrOfClusters, false);
+		m_DirtyClusters.clear();
+		m_NeedsFullRebuild = false;
+
+		// Not a complete grid (yet), nothing to abstract
+		if (m_pGraph->GetNrOfNodes() != m_NrOfColumns * m_NrOfRows)
+		{
+			m_NeedsFullRebuild = true;
+			return;
+		}
+
+		for (int cluster{}; cluster < nrOfClusters; ++cluster)
+		{
+			for (int border{}; border < NrOfBorderTypes; ++border)
+				RebuildBorder(cluster, BorderType(border));
+		}
+
+		for (int cluster{}; cluster < nrOfClusters; ++cluster)
+			RebuildIntraEdges(cluster);
+
+		m_Stats.nrOfClusters = nrOfClusters;
+		m_Stats.nrOfRepairedClusters = nrOfClusters;
+		m_Stats.nrOfAbstractNodes = int(m_AbstractNodes.size());
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool HierarchicalPathfinder<T_NodeType, T_ConnectionType>::RebuildBorder(int cluster, BorderType border)
+	{
+		auto& transitions = m_BorderTransitions[size_t(cluster) * NrOfBorderTypes + border];
+		const auto oldTransitions = transitions;
+
+		for (const auto& transition : transitions)
+			RemoveTransition(transition);
+		transitions.clear();
+
+		if (GetBorderNeighbor(cluster, border) == invalid_node_index)
+			return oldTransitions.empty() == false;
+
+		const CellBounds bounds{ GetClusterBounds(cluster) };
+
+		auto isCrossable = [this](int cell, int otherCell)
+		{
+			return GetConnectionCost(cell, otherCell) < FLT_MAX || GetConnectionCost(otherCell, cell) < FLT_MAX;
+		};
+
+		if (border == DownRight || border == DownLeft)
+		{
+			// Corners only have one pair of cells that can be connected diagonally
+			const int col{ border == DownRight ? bounds.maxCol : bounds.minCol };
+			const int cell{ m_pGraph->GetIndex(col, bounds.maxRow) };
+			const int otherCell{ m_pGraph->GetIndex(border == DownRight ? col + 1 : col - 1, bounds.maxRow + 1) };
+
+			if (isCrossable(cell, otherCell))
+				AddTransition(cell, otherCell, transitions);
+		}
+		else
+		{
+			// Walk along the border and split it into segments of crossable cell pairs
+			const int length{ border == Right ? bounds.maxRow - bounds.minRow + 1 : bounds.maxCol - bounds.minCol + 1 };
+			auto getCell = [&](int i) { return border == Right ? m_pGraph->GetIndex(bounds.maxCol, bounds.minRow + i) : m_pGraph->GetIndex(bounds.minCol + i, bounds.maxRow); };
+			auto getOtherCell = [&](int i) { return border == Right ? m_pGraph->GetIndex(bounds.maxCol + 1, bounds.minRow + i) : m_pGraph->GetIndex(bounds.minCol + i, bounds.maxRow + 1); };
+
+			// Directional graphs get separate segments for both crossing directions
+			const int nrOfDirections{ m_pGraph->IsDirectionalGraph() ? 2 : 1 };
+			for (int direction{}; direction < nrOfDirections; ++direction)
+			{
+				auto canCross = [&](int cell, int otherCell)
+				{
+					if (nrOfDirections == 1)
+						return isCrossable(cell, otherCell);
+					return direction == 0 ? GetConnectionCost(cell, otherCell) < FLT_MAX : GetConnectionCost(otherCell, cell) < FLT_MAX;
+				};
+
+				// Cells can also cross the border diagonally, the straight crossing is preferred
+				auto getCrossingCell = [&](int i)
+				{
+					if (canCross(getCell(i), getOtherCell(i)))
+						return getOtherCell(i);
+					if (i + 1 < length && canCross(getCell(i), getOtherCell(i + 1)))
+						return getOtherCell(i + 1);
+					if (i > 0 && canCross(getCell(i), getOtherCell(i - 1)))
+						return getOtherCell(i - 1);
+					return int(invalid_node_index);
+				};
+
+				// Every crossing in a segment has to be able to walk to the transitions along both sides of the border
+				auto isLinked = [&](int cell, int otherCell)
+				{
+					return cell == otherCell || (GetConnectionCost(cell, otherCell) < FLT_MAX && GetConnectionCost(otherCell, cell) < FLT_MAX);
+				};
+
+				auto addTransition = [&](int i)
+				{
+					const std::pair<int, int> transition{ getCell(i), getCrossingCell(i) };
+					if (std::find(transitions.begin(), transitions.end(), transition) == transitions.end())
+						AddTransition(transition.first, transition.second, transitions);
+				};
+
+				// Short segments get one transition in the middle, longer ones one at each end
+				const int splitLength{ 6 };
+
+				int segmentStart{ invalid_node_index };
+				int previousCrossingCell{ invalid_node_index };
+				for (int i{}; i <= length; ++i)
+				{
+					const int crossingCell{ i < length ? getCrossingCell(i) : int(invalid_node_index) };
+					const bool continuesSegment{ crossingCell != invalid_node_index && segmentStart != invalid_node_index
+						&& isLinked(getCell(i - 1), getCell(i)) && isLinked(previousCrossingCell, crossingCell) };
+
+					if (segmentStart != invalid_node_index && continuesSegment == false)
+					{
+						const int segmentEnd{ i - 1 };
+						if (segmentEnd - segmentStart + 1 < splitLength)
+						{
+							addTransition((segmentStart + segmentEnd) / 2);
+						}
+						else
+						{
+							addTransition(segmentStart);
+							addTransition(segmentEnd);
+						}
+
+						segmentStart = invalid_node_index;
+					}
+
+					if (crossingCell != invalid_node_index && segmentStart == invalid_node_index)
+						segmentStart = i;
+
+					previousCrossingCell = crossingCell;
+				}
+			}
+		}
+
+		return transitions != oldTransitions;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HierarchicalPathfinder<T_NodeType, T_ConnectionType>::RebuildIntraEdges(int cluster)
+	{
+		std::vector<int> transitionCells;
+		GetTransitionCells(cluster, transitionCells);
+
+		for (int cell : transitionCells)
+		{
+			auto& intraEdges = m_AbstractNodes[cell].intraEdges;
+			m_Stats.nrOfAbstractEdges -= int(intraEdges.size());
+			intraEdges.clear();
+
+			SearchBounds(GetClusterBounds(cluster), cell, false);
+			for (int otherCell : transitionCells)
+			{
+				if (otherCell != cell && m_ClusterSearch.IsVisited(otherCell) && m_ClusterSearch.costSoFar[otherCell] < FLT_MAX)
+					intraEdges.push_back({ otherCell, m_ClusterSearch.costSoFar[otherCell] });
+			}
+
+			m_Stats.nrOfAbstractEdges += int(intraEdges.size());
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HierarchicalPathfinder<T_NodeType, T_ConnectionType>::GetTransitionCells(int cluster, std::vector<int>& transitionCells) const
+	{
+		transitionCells.clear();
+
+		const CellBounds bounds{ GetClusterBounds(cluster) };
+
+		// Transitions only lie on the edge of the cluster
+		for (int row{ bounds.minRow }; row <= bounds.maxRow; ++row)
+		{
+			const bool isEdgeRow{ row == bounds.minRow || row == bounds.maxRow };
+			for (int col{ bounds.minCol }; col <= bounds.maxCol; col += (isEdgeRow || col == bounds.maxCol) ? 1 : bounds.maxCol - bounds.minCol)
+			{
+				const int cell{ m_pGraph->GetIndex(col, row) };
+				if (m_AbstractNodes.find(cell) != m_AbstractNodes.end())
+					transitionCells.push_back(cell);
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HierarchicalPathfinder<T_NodeType, T_ConnectionType>::AddTransition(int cell, int otherCell, std::vector<std::pair<int, int>>& transitions)
+	{
+		transitions.push_back({ cell, otherCell });
+
+		auto& node = m_AbstractNodes[cell];
+		auto& otherNode = m_AbstractNodes[otherCell];
+		++node.nrOfTransitions;
+		++otherNode.nrOfTransitions;
+
+		const float cost{ GetConnectionCost(cell, otherCell) };
+		if (cost < FLT_MAX)
+		{
+			node.interEdges.push_back({ otherCell, cost });
+			++m_Stats.nrOfAbstractEdges;
+		}
+
+		const float otherCost{ GetConnectionCost(otherCell, cell) };
+		if (otherCost < FLT_MAX)
+		{
+			otherNode.interEdges.push_back({ cell, otherCost });
+			++m_Stats.nrOfAbstractEdges;
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HierarchicalPathfinder<T_NodeType, T_ConnectionType>::RemoveTransition(const std::pair<int, int>& transition)
+	{
+		auto removeNodeTransition = [this](int cell, int otherCell)
+		{
+			auto nodeIt = m_AbstractNodes.find(cell);
+			if (nodeIt == m_AbstractNodes.end())
+				return;
+
+			auto& interEdges = nodeIt->second.interEdges;
+			const size_t nrOfEdges{ interEdges.size() };
+			interEdges.erase(std::remove_if(interEdges.begin(), interEdges.end(), [otherCell](const AbstractEdge& edge) { return edge.toCell == otherCell; }), interEdges.end());
+			m_Stats.nrOfAbstractEdges -= int(nrOfEdges - interEdges.size());
+
+			// Unused nodes are only removed once all borders are rebuilt, the border might add the same transition again and the intra edges have to survive that
+			if (--nodeIt->second.nrOfTransitions == 0)
+				m_UnusedCells.push_back(cell);
+		};
+
+		removeNodeTransition(transition.first, transition.second);
+		removeNodeTransition(transition.second, transition.first);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HierarchicalPathfinder<T_NodeType, T_ConnectionType>::RemoveUnusedNodes()
+	{
+		for (int cell : m_UnusedCells)
+		{
+			auto nodeIt = m_AbstractNodes.find(cell);
+			if (nodeIt != m_AbstractNodes.end() && nodeIt->second.nrOfTransitions == 0)
+			{
+				m_Stats.nrOfAbstractEdges -= int(nodeIt->second.intraEdges.size());
+				m_AbstractNodes.erase(nodeIt);
+			}
+		}
+
+		m_UnusedCells.clear();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int HierarchicalPathfinder<T_NodeType, T_ConnectionType>::GetBorderNeighbor(int cluster, BorderType border) const
+	{
+		const int clusterX{ cluster % m_NrOfClustersX };
+		const int clusterY{ cluster / m_NrOfClustersX };
+		const bool hasRight{ clusterX < m_NrOfClustersX - 1 };
+		const bool hasLeft{ clusterX > 0 };
+		const bool hasDown{ clusterY < m_NrOfClustersY - 1 };
+
+		switch (border)
+		{
+		case Right:
+			return hasRight ? cluster + 1 : invalid_node_index;
+		case Down:
+			return hasDown ? cluster + m_NrOfClustersX : invalid_node_index;
+		case DownRight:
+			return hasRight && hasDown ? cluster + m_NrOfClustersX + 1 : invalid_node_index;
+		case DownLeft:
+			return hasLeft && hasDown ? cluster + m_NrOfClustersX - 1 : invalid_node_index;
+		default:
+			return invalid_node_index;
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline typename HierarchicalPathfinder<T_NodeType, T_ConnectionType>::CellBounds HierarchicalPathfinder<T_NodeType, T_ConnectionType>::GetClusterBounds(int cluster) const
+	{
+		const int minCol{ (cluster % m_NrOfClustersX) * m_ClusterSize };
+		const int minRow{ (cluster / m_NrOfClustersX) * m_ClusterSize };
+		return { minCol, minRow, std::min(minCol + m_ClusterSize, m_NrOfColumns) - 1, std::min(minRow + m_ClusterSize, m_NrOfRows) - 1 };
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline typename HierarchicalPathfinder<T_NodeType, T_ConnectionType>::CellBounds HierarchicalPathfinder<T_NodeType, T_ConnectionType>::GetQueryBounds(int startCluster, int goalCluster) const
+	{
+		// Only clusters that touch each other, the bounds are empty otherwise
+		if (abs(startCluster % m_NrOfClustersX - goalCluster % m_NrOfClustersX) > 1 || abs(startCluster / m_NrOfClustersX - goalCluster / m_NrOfClustersX) > 1)
+			return { 0, 0, -1, -1 };
+
+		const CellBounds startBounds{ GetClusterBounds(startCluster) };
+		const CellBounds goalBounds{ GetClusterBounds(goalCluster) };
+		return { std::min(startBounds.minCol, goalBounds.minCol), std::min(startBounds.minRow, goalBounds.minRow),
+			std::max(startBounds.maxCol, goalBounds.maxCol), std::max(startBounds.maxRow, goalBounds.maxRow) };
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline float HierarchicalPathfinder<T_NodeType, T_ConnectionType>::GetConnectionCost(int from, int to) const
+	{
+		const auto pConnection = m_pGraph->GetConnection(from, to);
+		return pConnection != nullptr ? pConnection->GetCost() : FLT_MAX;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HierarchicalPathfinder<T_NodeType, T_ConnectionType>::SearchBounds(const CellBounds& bounds, int sourceCell, bool isReversed, int targetCell)
+	{
+		auto& search = m_ClusterSearch;
+		search.Prepare(m_NrOfColumns * m_NrOfRows);
+
+		auto relax = [&](int fromCell, int toCell, float cost)
+		{
+			search.Visit(toCell);
+
+			const float costSoFar{ search.costSoFar[fromCell] + cost };
+			if (costSoFar >= search.costSoFar[toCell])
+				return;
+
+			search.costSoFar[toCell] = costSoFar;
+			search.parent[toCell] = fromCell;
+			search.openList.push_back({ costSoFar, costSoFar, toCell });
+			std::push_heap(search.openList.begin(), search.openList.end());
+		};
+
+		search.Visit(sourceCell);
+		search.costSoFar[sourceCell] = 0.f;
+		search.openList.push_back({ 0.f, 0.f, sourceCell });
+
+		// Undirected graphs have every connection in both directions, only directional graphs need to look for incoming connections
+		const bool useIncomingConnections{ isReversed && m_pGraph->IsDirectionalGraph() };
+
+		while (search.openList.empty() == false)
+		{
+			std::pop_heap(search.openList.begin(), search.openList.end());
+			const OpenEntry currentEntry{ search.openList.back() };
+			search.openList.pop_back();
+
+			const int currentCell{ currentEntry.cell };
+			if (search.isClosed[currentCell] || currentEntry.costSoFar > search.costSoFar[currentCell])
+				continue;
+
+			search.isClosed[currentCell] = true;
+			if (currentCell == targetCell)
+				return;
+
+			const int col{ currentCell % m_NrOfColumns };
+			const int row{ currentCell / m_NrOfColumns };
+
+			if (useIncomingConnections)
+			{
+				for (int neighborRow{ std::max(row - 1, bounds.minRow) }; neighborRow <= std::min(row + 1, bounds.maxRow); ++neighborRow)
+				{
+					for (int neighborCol{ std::max(col - 1, bounds.minCol) }; neighborCol <= std::min(col + 1, bounds.maxCol); ++neighborCol)
+					{
+						const int neighborCell{ m_pGraph->GetIndex(neighborCol, neighborRow) };
+						const float cost{ neighborCell != currentCell ? GetConnectionCost(neighborCell, currentCell) : FLT_MAX };
+						if (cost < FLT_MAX)
+							relax(currentCell, neighborCell, cost);
+					}
+				}
+				continue;
+			}
+
+			for (const auto& connection : m_pGraph->GetConnections(currentCell))
+			{
+				if (bounds.Contains(connection->GetTo() % m_NrOfColumns, connection->GetTo() / m_NrOfColumns) == false)
+					continue;
+
+				relax(currentCell, connection->GetTo(), connection->GetCost());
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool HierarchicalPathfinder<T_NodeType, T_ConnectionType>::SearchAbstractGraph(int startCell, int goalCell, int goalCluster)
+	{
+		auto& search = m_AbstractSearch;
+		search.Prepare(m_NrOfColumns * m_NrOfRows);
+
+		const Vector2 goalPos{ m_pGraph->GetNodePos(goalCell) };
+		auto getHeuristicCost = [&](int cell)
+		{
+			const Vector2 toDestination{ goalPos - m_pGraph->GetNodePos(cell) };
+			return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+		};
+
+		auto relax = [&](int fromCell, const AbstractEdge& edge)
+		{
+			search.Visit(edge.toCell);
+
+			const float costSoFar{ search.costSoFar[fromCell] + edge.cost };
+			if (costSoFar >= search.costSoFar[edge.toCell])
+				return;
+
+			search.costSoFar[edge.toCell] = costSoFar;
+			search.parent[edge.toCell] = fromCell;
+			search.isClosed[edge.toCell] = false;
+			search.openList.push_back({ costSoFar + getHeuristicCost(edge.toCell), costSoFar, edge.toCell });
+			std::push_heap(search.openList.begin(), search.openList.end());
+		};
+
+		search.Visit(startCell);
+		search.costSoFar[startCell] = 0.f;
+		search.openList.push_back({ getHeuristicCost(startCell), 0.f, startCell });
+
+		while (search.openList.empty() == false)
+		{
+			std::pop_heap(search.openList.begin(), search.openList.end());
+			const OpenEntry currentEntry{ search.openList.back() };
+			search.openList.pop_back();
+
+			const int currentCell{ currentEntry.cell };
+			if (search.isClosed[currentCell] || currentEntry.costSoFar > search.costSoFar[currentCell])
+				continue;
+
+			search.isClosed[currentCell] = true;
+			++m_Stats.nrOfExpandedAbstractNodes;
+
+			if (currentCell == goalCell)
+			{
+				for (int cell{ goalCell }; cell != invalid_node_index; cell = search.parent[cell])
+					m_AbstractPath.push_back(cell);
+
+				std::reverse(m_AbstractPath.begin(), m_AbstractPath.end());
+				m_Stats.pathCost = search.costSoFar[goalCell];
+				return true;
+			}
+
+			// The start might not be a transition, it only knows the temporary edges
+			if (currentCell == startCell)
+			{
+				for (const auto& edge : m_StartEdges)
+					relax(currentCell, edge);
+			}
+
+			const auto nodeIt = m_AbstractNodes.find(currentCell);
+			if (nodeIt != m_AbstractNodes.end())
+			{
+				// The start edges already cover every transition in the start cluster
+				if (currentCell != startCell)
+				{
+					for (const auto& edge : nodeIt->second.intraEdges)
+						relax(currentCell, edge);
+				}
+
+				for (const auto& edge : nodeIt->second.interEdges)
+					relax(currentCell, edge);
+			}
+
+			// Transitions of the goal cluster are linked to the goal
+			if (GetCluster(currentCell) == goalCluster)
+			{
+				const auto goalIt = m_GoalCosts.find(currentCell);
+				if (goalIt != m_GoalCosts.end())
+					relax(currentCell, { goalCell, goalIt->second });
+			}
+		}
+
+		return false;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> HierarchicalPathfinder<T_NodeType, T_ConnectionType>::RefinePath()
+	{
+		std::vector<T_NodeType*> path{ m_pGraph->GetNode(m_AbstractPath.front()) };
+		std::vector<int> segment;
+
+		for (size_t i{ 1 }; i < m_AbstractPath.size(); ++i)
+		{
+			const int fromCell{ m_AbstractPath[i - 1] };
+			const int toCell{ m_AbstractPath[i] };
+			const int cluster{ GetCluster(fromCell) };
+
+			// The direct link between start and goal, searched again in the same bounds
+			const bool isDirectLink{ m_AbstractPath.size() == 2 && m_QueryBounds.maxCol >= m_QueryBounds.minCol };
+
+			// Crossing a border is a single connection
+			if (isDirectLink == false && cluster != GetCluster(toCell))
+			{
+				path.push_back(m_pGraph->GetNode(toCell));
+				continue;
+			}
+
+			// Inside a cluster the path is searched again, only for the clusters on the abstract path
+			SearchBounds(isDirectLink ? m_QueryBounds : GetClusterBounds(cluster), fromCell, false, toCell);
+
+			segment.clear();
+			for (int cell{ toCell }; cell != fromCell; cell = m_ClusterSearch.parent[cell])
+				segment.push_back(cell);
+
+			for (auto it = segment.rbegin(); it != segment.rend(); ++it)
+				path.push_back(m_pGraph->GetNode(*it));
+		}
+
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HierarchicalPathfinder<T_NodeType, T_ConnectionType>::SearchArrays::Prepare(int nrOfCells)
+	{
+		if (int(visitedGeneration.size()) < nrOfCells)
+		{
+			costSoFar.resize(nrOfCells);
+			parent.resize(nrOfCells);
+			isClosed.resize(nrOfCells);
+			visitedGeneration.resize(nrOfCells, 0);
+		}
+
+		++generation;
+		if (generation == 0)
+		{
+			std::fill(visitedGeneration.begin(), visitedGeneration.end(), 0);
+			generation = 1;
+		}
+
+		openList.clear();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline void HierarchicalPathfinder<T_NodeType, T_ConnectionType>::SearchArrays::Visit(int cell)
+	{
+		if (visitedGeneration[cell] == generation)
+			return;
+
+		visitedGeneration[cell] = generation;
+		costSoFar[cell] = FLT_MAX;
+		parent[cell] = invalid_node_index;
+		isClosed[cell] = false;
+	}
+}
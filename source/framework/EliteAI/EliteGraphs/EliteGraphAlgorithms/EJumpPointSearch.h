@@ -0,0 +1,558 @@
+#pragma once
+#include "framework/EliteAI/EliteGraphs/EGridGraph.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EAStar.h"
+
+namespace Elite
+{
+	// Jump Point Search on a GridGraph that is connected diagonally with uniform costs (every connection has the default straight or diagonal cost).
+	// A cell without connections is an obstacle, every other cell has to be connected to all of its free neighbors (moving diagonally past an obstacle is allowed, like the GridGraph does).
+	// Grids that don't have this shape (terrain costs, removed single connections, no diagonals) are searched with a regular A* instead, so the result is always an optimal path.
+	// With precomputed jumps (JPS+) the jump distances are stored per cell and direction, they get rebuilt whenever the graph version changes, so only use it on static grids.
+	template <class T_NodeType, class T_ConnectionType>
+	class JumpPointSearch
+	{
+	public:
+		JumpPointSearch(GridGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, bool usePrecomputedJumps = false);
+
+		// Returns every node from start to destination (the cells between the jump points are filled in), or an empty path when the destination can't be reached
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+
+		void SetHeuristic(Heuristic hFunction) { m_HeuristicFunction = hFunction; m_AStar.SetHeuristic(hFunction); }
+		void SetUsePrecomputedJumps(bool usePrecomputedJumps) { m_UsePrecomputedJumps = usePrecomputedJumps; }
+
+		// False when the last query had to fall back on A*
+		bool IsGridSupported();
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+
+	private:
+		static const int NR_OF_DIRECTIONS = 8;
+		static const int NO_DIRECTION = -1;
+
+		// Straight directions first, same order as the GridGraph uses
+		const int m_DirectionX[NR_OF_DIRECTIONS] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+		const int m_DirectionY[NR_OF_DIRECTIONS] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+
+		struct OpenEntry
+		{
+			float estimatedTotalCost;
+			float costSoFar;
+			int nodeIdx;
+
+			bool operator<(const OpenEntry& other) const
+			{
+				if (estimatedTotalCost != other.estimatedTotalCost)
+					return estimatedTotalCost > other.estimatedTotalCost;
+				return costSoFar < other.costSoFar;
+			}
+		};
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		Heuristic m_HeuristicFunction;
+		bool m_UsePrecomputedJumps;
+
+		// Fallback for grids that aren't uniform
+		AStar<T_NodeType, T_ConnectionType> m_AStar;
+
+		// Grid layout, validated once per graph version
+		int m_ValidatedVersion = -1;
+		bool m_IsGridSupported = false;
+		int m_NrOfColumns = 0;
+		int m_NrOfRows = 0;
+		float m_CostStraight = 1.f;
+		float m_CostDiagonal = 1.5f;
+		std::vector<bool> m_IsFree;
+
+		// JPS+ tables, per cell and direction: > 0 steps to the next jump point, <= 0 minus the free steps before an obstacle
+		int m_PrecomputedVersion = -1;
+		std::vector<int> m_JumpDistances;
+
+		// Search state, only valid for nodes whose m_VisitedGeneration matches the current search
+		std::vector<float> m_CostSoFar;
+		std::vector<int> m_Parent;
+		std::vector<bool> m_IsClosed;
+		std::vector<unsigned int> m_VisitedGeneration;
+		unsigned int m_Generation = 0;
+		std::vector<OpenEntry> m_OpenList;
+		int m_NrOfExpandedNodes = 0;
+
+		int m_GoalCol = 0;
+		int m_GoalRow = 0;
+		Vector2 m_GoalPos{};
+
+		void ValidateGrid();
+		void PrecomputeJumps();
+		void PrepareSearch();
+		void VisitNode(int idx);
+
+		bool IsFree(int col, int row) const { return col >= 0 && col < m_NrOfColumns && row >= 0 && row < m_NrOfRows && m_IsFree[row * m_NrOfColumns + col]; }
+		bool IsDiagonal(int dir) const { return dir >= 4; }
+		bool HasForcedNeighbor(int col, int row, int dir) const;
+		int GetDirection(int dx, int dy) const;
+		int GetPrunedDirections(int idx, int directions[NR_OF_DIRECTIONS]) const;
+
+		// Online jumping, returns the jump point or invalid_node_index
+		int Jump(int col, int row, int dir) const;
+		// JPS+ jumping, uses the tables and only checks where the goal is
+		int JumpPrecomputed(int col, int row, int dir) const;
+
+		void AddSuccessor(int fromIdx, int toIdx, int nrOfSteps, bool isDiagonal);
+		std::vector<T_NodeType*> ReconstructPath(int goalIdx) const;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	JumpPointSearch<T_NodeType, T_ConnectionType>::JumpPointSearch(GridGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction, bool usePrecomputedJumps)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+		, m_UsePrecomputedJumps(usePrecomputedJumps)
+		, m_AStar(pGraph, hFunction)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> JumpPointSearch<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		if (pStartNode == nullptr || pGoalNode == nullptr)
+			return {};
+
+		if (IsGridSupported() == false)
+		{
+			auto path = m_AStar.FindPath(pStartNode, pGoalNode);
+			m_NrOfExpandedNodes = m_AStar.GetNrOfExpandedNodes();
+			return path;
+		}
+
+		if (m_UsePrecomputedJumps && m_PrecomputedVersion != m_pGraph->GetVersion())
+			PrecomputeJumps();
+
+		PrepareSearch();
+
+		const int startIdx{ pStartNode->GetIndex() };
+		const int goalIdx{ pGoalNode->GetIndex() };
+		m_GoalCol = goalIdx % m_NrOfColumns;
+		m_GoalRow = goalIdx / m_NrOfColumns;
+		m_GoalPos = m_pGraph->GetNodePos(pGoalNode);
+
+		if (startIdx == goalIdx)
+			return { pStartNode };
+
+		// Obstacles don't have connections to leave or enter them
+		if (m_IsFree[startIdx] == false || m_IsFree[goalIdx] == false)
+			return {};
+
+		// StartRecord
+		VisitNode(startIdx);
+		m_CostSoFar[startIdx] = 0.f;
+		m_OpenList.push_back({ 0.f, 0.f, startIdx });
+
+		int directions[NR_OF_DIRECTIONS]{};
+
+		while (m_OpenList.empty() == false)
+		{
+			std::pop_heap(m_OpenList.begin(), m_OpenList.end());
+			const OpenEntry currentEntry{ m_OpenList.back() };
+			m_OpenList.pop_back();
+
+			const int currentIdx{ currentEntry.nodeIdx };
+			if (m_IsClosed[currentIdx] || currentEntry.costSoFar > m_CostSoFar[currentIdx])
+				continue;
+
+			m_IsClosed[currentIdx] = true;
+			++m_NrOfExpandedNodes;
+
+			if (currentIdx == goalIdx)
+				return ReconstructPath(goalIdx);
+
+			const int col{ currentIdx % m_NrOfColumns };
+			const int row{ currentIdx / m_NrOfColumns };
+
+			// Only jump in the directions that can't be reached cheaper through the parent
+			const int nrOfDirections{ GetPrunedDirections(currentIdx, directions) };
+			for (int i{}; i < nrOfDirections; ++i)
+			{
+				const int dir{ directions[i] };
+				const int jumpIdx{ m_UsePrecomputedJumps ? JumpPrecomputed(col, row, dir) : Jump(col, row, dir) };
+				if (jumpIdx == invalid_node_index)
+					continue;
+
+				// Jump points always lie on a straight line or a diagonal, the longest axis is the amount of steps
+				const int nrOfSteps{ std::max(abs(jumpIdx % m_NrOfColumns - col), abs(jumpIdx / m_NrOfColumns - row)) };
+				AddSuccessor(currentIdx, jumpIdx, nrOfSteps, IsDiagonal(dir));
+			}
+		}
+
+		return {};
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline bool JumpPointSearch<T_NodeType, T_ConnectionType>::IsGridSupported()
+	{
+		if (m_ValidatedVersion != m_pGraph->GetVersion() || m_NrOfColumns * m_NrOfRows != m_pGraph->GetNrOfNodes())
+			ValidateGrid();
+
+		return m_IsGridSupported;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void JumpPointSearch<T_NodeType, T_ConnectionType>::ValidateGrid()
+	{
+		m_ValidatedVersion = m_pGraph->GetVersion();
+		m_NrOfColumns = m_pGraph->GetColumns();
+		m_NrOfRows = m_pGraph->GetRows();
+		m_CostStraight = m_pGraph->GetDefaultCostStraight();
+		m_CostDiagonal = m_pGraph->GetDefaultCostDiagonal();
+
+		const int nrOfNodes{ m_NrOfColumns * m_NrOfRows };
+		m_IsGridSupported = false;
+		m_PrecomputedVersion = -1;
+
+		// Jumping skips cells, which is only optimal when a diagonal step is at least as expensive as a straight one and cheaper than two straight ones
+		if (m_pGraph->IsConnectedDiagonally() == false || nrOfNodes != m_pGraph->GetNrOfNodes()
+			|| m_CostDiagonal < m_CostStraight || m_CostDiagonal >= 2.f * m_CostStraight)
+			return;
+
+		m_IsFree.assign(nrOfNodes, false);
+		for (int idx{}; idx < nrOfNodes; ++idx)
+		{
+			if (m_pGraph->IsNodeValid(idx) == false)
+				return;
+
+			m_IsFree[idx] = m_pGraph->GetConnections(idx).empty() == false;
+		}
+
+		// Every free cell has to be connected to all of its free neighbors, with the default costs and nothing else
+		for (int idx{}; idx < nrOfNodes; ++idx)
+		{
+			if (m_IsFree[idx] == false)
+				continue;
+
+			const int col{ idx % m_NrOfColumns };
+			const int row{ idx / m_NrOfColumns };
+
+			int nrOfFreeNeighbors{};
+			for (int dir{}; dir < NR_OF_DIRECTIONS; ++dir)
+			{
+				if (IsFree(col + m_DirectionX[dir], row + m_DirectionY[dir]))
+					++nrOfFreeNeighbors;
+			}
+
+			const auto& connections = m_pGraph->GetConnections(idx);
+			if (int(connections.size()) != nrOfFreeNeighbors)
+				return;
+
+			for (const auto& connection : connections)
+			{
+				const int toIdx{ connection->GetTo() };
+				const int dx{ toIdx % m_NrOfColumns - col };
+				const int dy{ toIdx / m_NrOfColumns - row };
+
+				if (abs(dx) > 1 || abs(dy) > 1 || m_IsFree[toIdx] == false)
+					return;
+
+				const float expectedCost{ (dx != 0 && dy != 0) ? m_CostDiagonal : m_CostStraight };
+				if (connection->GetCost() != expectedCost)
+					return;
+			}
+		}
+
+		m_IsGridSupported = true;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void JumpPointSearch<T_NodeType, T_ConnectionType>::PrecomputeJumps()
+	{
+		m_PrecomputedVersion = m_pGraph->GetVersion();
+
+		const int nrOfNodes{ m_NrOfColumns * m_NrOfRows };
+		m_JumpDistances.assign(size_t(nrOfNodes) * NR_OF_DIRECTIONS, 0);
+
+		// Sweep every direction so the cell in front has been handled before the current one
+		for (int dir{}; dir < NR_OF_DIRECTIONS; ++dir)
+		{
+			const int dx{ m_DirectionX[dir] };
+			const int dy{ m_DirectionY[dir] };
+
+			for (int rowStep{}; rowStep < m_NrOfRows; ++rowStep)
+			{
+				const int row{ dy > 0 ? m_NrOfRows - 1 - rowStep : rowStep };
+
+				for (int colStep{}; colStep < m_NrOfColumns; ++colStep)
+				{
+					const int col{ dx > 0 ? m_NrOfColumns - 1 - colStep : colStep };
+					const int idx{ row * m_NrOfColumns + col };
+					if (m_IsFree[idx] == false)
+						continue;
+
+					const int nextCol{ col + dx };
+					const int nextRow{ row + dy };
+					int& distance{ m_JumpDistances[size_t(idx) * NR_OF_DIRECTIONS + dir] };
+
+					if (IsFree(nextCol, nextRow) == false)
+					{
+						distance = 0;
+						continue;
+					}
+
+					const int nextIdx{ nextRow * m_NrOfColumns + nextCol };
+					bool isJumpPoint{ HasForcedNeighbor(nextCol, nextRow, dir) };
+
+					// A diagonal jump also stops where one of its straight parts finds a jump point, the straight tables are already filled in
+					if (isJumpPoint == false && IsDiagonal(dir))
+					{
+						isJumpPoint = m_JumpDistances[size_t(nextIdx) * NR_OF_DIRECTIONS + GetDirection(dx, 0)] > 0
+							|| m_JumpDistances[size_t(nextIdx) * NR_OF_DIRECTIONS + GetDirection(0, dy)] > 0;
+					}
+
+					if (isJumpPoint)
+					{
+						distance = 1;
+					}
+					else
+					{
+						const int nextDistance{ m_JumpDistances[size_t(nextIdx) * NR_OF_DIRECTIONS + dir] };
+						distance = nextDistance > 0 ? nextDistance + 1 : nextDistance - 1;
+					}
+				}
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline void JumpPointSearch<T_NodeType, T_ConnectionType>::PrepareSearch()
+	{
+		const size_t nrOfNodes{ size_t(m_pGraph->GetNrOfNodes()) };
+		if (m_VisitedGeneration.size() < nrOfNodes)
+		{
+			m_CostSoFar.resize(nrOfNodes);
+			m_Parent.resize(nrOfNodes);
+			m_IsClosed.resize(nrOfNodes);
+			m_VisitedGeneration.resize(nrOfNodes, 0);
+		}
+
+		++m_Generation;
+		if (m_Generation == 0)
+		{
+			std::fill(m_VisitedGeneration.begin(), m_VisitedGeneration.end(), 0);
+			m_Generation = 1;
+		}
+
+		m_OpenList.clear();
+		m_NrOfExpandedNodes = 0;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline void JumpPointSearch<T_NodeType, T_ConnectionType>::VisitNode(int idx)
+	{
+		if (m_VisitedGeneration[idx] == m_Generation)
+			return;
+
+		m_VisitedGeneration[idx] = m_Generation;
+		m_CostSoFar[idx] = FLT_MAX;
+		m_Parent[idx] = invalid_node_index;
+		m_IsClosed[idx] = false;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline bool JumpPointSearch<T_NodeType, T_ConnectionType>::HasForcedNeighbor(int col, int row, int dir) const
+	{
+		const int dx{ m_DirectionX[dir] };
+		const int dy{ m_DirectionY[dir] };
+
+		// Diagonal: an obstacle behind one of the sides makes the cell on the other side of it only reachable through this cell
+		if (IsDiagonal(dir))
+		{
+			return (IsFree(col - dx, row) == false && IsFree(col - dx, row + dy))
+				|| (IsFree(col, row - dy) == false && IsFree(col + dx, row - dy));
+		}
+
+		// Straight: an obstacle next to the cell makes the cell diagonally in front of it only reachable through this cell
+		if (dx != 0)
+		{
+			return (IsFree(col, row + 1) == false && IsFree(col + dx, row + 1))
+				|| (IsFree(col, row - 1) == false && IsFree(col + dx, row - 1));
+		}
+
+		return (IsFree(col + 1, row) == false && IsFree(col + 1, row + dy))
+			|| (IsFree(col - 1, row) == false && IsFree(col - 1, row + dy));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline int JumpPointSearch<T_NodeType, T_ConnectionType>::GetDirection(int dx, int dy) const
+	{
+		for (int dir{}; dir < NR_OF_DIRECTIONS; ++dir)
+		{
+			if (m_DirectionX[dir] == dx && m_DirectionY[dir] == dy)
+				return dir;
+		}
+
+		return NO_DIRECTION;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JumpPointSearch<T_NodeType, T_ConnectionType>::GetPrunedDirections(int idx, int directions[NR_OF_DIRECTIONS]) const
+	{
+		const int col{ idx % m_NrOfColumns };
+		const int row{ idx / m_NrOfColumns };
+		const int parentIdx{ m_Parent[idx] };
+
+		int nrOfDirections{};
+		auto addDirection = [&](int dx, int dy)
+		{
+			if (IsFree(col + dx, row + dy))
+				directions[nrOfDirections++] = GetDirection(dx, dy);
+		};
+
+		// The start node looks in every direction
+		if (parentIdx == invalid_node_index)
+		{
+			for (int dir{}; dir < NR_OF_DIRECTIONS; ++dir)
+				addDirection(m_DirectionX[dir], m_DirectionY[dir]);
+			return nrOfDirections;
+		}
+
+		const int dx{ Clamp(col - parentIdx % m_NrOfColumns, -1, 1) };
+		const int dy{ Clamp(row - parentIdx / m_NrOfColumns, -1, 1) };
+
+		if (dx != 0 && dy != 0)
+		{
+			// Natural neighbors
+			addDirection(dx, 0);
+			addDirection(0, dy);
+			addDirection(dx, dy);
+
+			// Forced neighbors
+			if (IsFree(col - dx, row) == false)
+				addDirection(-dx, dy);
+			if (IsFree(col, row - dy) == false)
+				addDirection(dx, -dy);
+		}
+		else if (dx != 0)
+		{
+			addDirection(dx, 0);
+
+			if (IsFree(col, row + 1) == false)
+				addDirection(dx, 1);
+			if (IsFree(col, row - 1) == false)
+				addDirection(dx, -1);
+		}
+		else
+		{
+			addDirection(0, dy);
+
+			if (IsFree(col + 1, row) == false)
+				addDirection(1, dy);
+			if (IsFree(col - 1, row) == false)
+				addDirection(-1, dy);
+		}
+
+		return nrOfDirections;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JumpPointSearch<T_NodeType, T_ConnectionType>::Jump(int col, int row, int dir) const
+	{
+		const int dx{ m_DirectionX[dir] };
+		const int dy{ m_DirectionY[dir] };
+
+		while (true)
+		{
+			col += dx;
+			row += dy;
+
+			if (IsFree(col, row) == false)
+				return invalid_node_index;
+
+			if ((col == m_GoalCol && row == m_GoalRow) || HasForcedNeighbor(col, row, dir))
+				return row * m_NrOfColumns + col;
+
+			// A diagonal jump stops where one of its straight parts finds something
+			if (IsDiagonal(dir))
+			{
+				if (Jump(col, row, GetDirection(dx, 0)) != invalid_node_index || Jump(col, row, GetDirection(0, dy)) != invalid_node_index)
+					return row * m_NrOfColumns + col;
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JumpPointSearch<T_NodeType, T_ConnectionType>::JumpPrecomputed(int col, int row, int dir) const
+	{
+		const int dx{ m_DirectionX[dir] };
+		const int dy{ m_DirectionY[dir] };
+		const int distance{ m_JumpDistances[size_t(row * m_NrOfColumns + col) * NR_OF_DIRECTIONS + dir] };
+		const int maxSteps{ abs(distance) };
+
+		const int toGoalX{ m_GoalCol - col };
+		const int toGoalY{ m_GoalRow - row };
+
+		if (IsDiagonal(dir) == false)
+		{
+			// Goal lies on this line before the next jump point or obstacle
+			const bool isGoalAhead{ dx != 0 ? (toGoalY == 0 && toGoalX * dx > 0 && abs(toGoalX) <= maxSteps)
+				: (toGoalX == 0 && toGoalY * dy > 0 && abs(toGoalY) <= maxSteps) };
+			if (isGoalAhead)
+				return m_GoalRow * m_NrOfColumns + m_GoalCol;
+		}
+		else if (toGoalX * dx > 0 && toGoalY * dy > 0 && (abs(toGoalX) <= maxSteps || abs(toGoalY) <= maxSteps))
+		{
+			// Goal is in this quadrant, stop on the diagonal where the goal can be reached by a straight jump
+			const int nrOfSteps{ std::min(abs(toGoalX), abs(toGoalY)) };
+			return (row + nrOfSteps * dy) * m_NrOfColumns + col + nrOfSteps * dx;
+		}
+
+		if (distance <= 0)
+			return invalid_node_index;
+
+		return (row + distance * dy) * m_NrOfColumns + col + distance * dx;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline void JumpPointSearch<T_NodeType, T_ConnectionType>::AddSuccessor(int fromIdx, int toIdx, int nrOfSteps, bool isDiagonal)
+	{
+		VisitNode(toIdx);
+
+		const float costSoFar{ m_CostSoFar[fromIdx] + nrOfSteps * (isDiagonal ? m_CostDiagonal : m_CostStraight) };
+		if (costSoFar >= m_CostSoFar[toIdx])
+			return;
+
+		m_CostSoFar[toIdx] = costSoFar;
+		m_Parent[toIdx] = fromIdx;
+		m_IsClosed[toIdx] = false;
+
+		const Vector2 toDestination{ m_GoalPos - m_pGraph->GetNodePos(toIdx) };
+		const float estimatedTotalCost{ costSoFar + m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y)) };
+		m_OpenList.push_back({ estimatedTotalCost, costSoFar, toIdx });
+		std::push_heap(m_OpenList.begin(), m_OpenList.end());
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> JumpPointSearch<T_NodeType, T_ConnectionType>::ReconstructPath(int goalIdx) const
+	{
+		std::vector<T_NodeType*> path;
+
+		// Walk back over the jump points and add every cell in between
+		for (int idx{ goalIdx }; idx != invalid_node_index; idx = m_Parent[idx])
+		{
+			const int parentIdx{ m_Parent[idx] };
+			if (parentIdx == invalid_node_index)
+			{
+				path.push_back(m_pGraph->GetNode(idx));
+				break;
+			}
+
+			int col{ idx % m_NrOfColumns };
+			int row{ idx / m_NrOfColumns };
+			const int dx{ Clamp(parentIdx % m_NrOfColumns - col, -1, 1) };
+			const int dy{ Clamp(parentIdx / m_NrOfColumns - row, -1, 1) };
+
+			while (row * m_NrOfColumns + col != parentIdx)
+			{
+				path.push_back(m_pGraph->GetNode(col, row));
+				col += dx;
+				row += dy;
+			}
+		}
+
+		std::reverse(path.begin(), path.end());
+		return path;
+	}
+}
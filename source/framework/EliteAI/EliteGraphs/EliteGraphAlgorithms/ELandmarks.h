@@ -0,0 +1,447 @@
+#pragma once
+#include "framework/EliteAI/EliteGraphs/EIGraph.h"
+
+namespace Elite
+{
+	// ALT heuristic (A*, Landmarks, Triangle inequality): exact distances from (and to) a few landmark nodes are precomputed,
+	// for any node n and goal g the triangle inequality gives d(n, g) >= d(L, g) - d(L, n), which follows walls and detours that geometric heuristics can't see.
+	// Distances are stored per node as 16 bit fractions of the largest distance of their landmark (per direction), rounded down, the rounding is subtracted again so the estimate stays admissible.
+	// A table is only used on the graph version it was built for, Update rebuilds the outdated tables (all at once, or a few per call to spread the work).
+	template<class T_NodeType, class T_ConnectionType>
+	class LandmarkHeuristic final
+	{
+	public:
+		explicit LandmarkHeuristic(const IGraph<T_NodeType, T_ConnectionType>* pGraph, int nrOfLandmarks = 8);
+
+		// Rebuilds at most maxRebuilds outdated tables and returns how many were rebuilt
+		// Landmarks are kept as long as their node exists, new ones are picked as far as possible from the others
+		int Update(int maxRebuilds = (std::numeric_limits<int>::max)());
+		bool IsUpToDate() const { return GetNrOfUpToDateLandmarks() == int(m_Landmarks.size()); }
+
+		// Lower bound of the cost from node to goal, 0 when no table matches the current version of the graph
+		float GetHeuristicCost(int nodeIdx, int goalIdx) const;
+		// Bound to this heuristic, for AStar::SetNodeHeuristic
+		NodeHeuristic GetNodeHeuristic() const { return [this](int nodeIdx, int goalIdx) { return GetHeuristicCost(nodeIdx, goalIdx); }; }
+
+		// Nodes that aren't in the tables (e.g. the start and end node of an OverlayGraph) take their distances from the nodes they connect to
+		// The connections are used in both directions, (nodeIdx, cost)
+		void SetVirtualNode(int idx, const std::vector<std::pair<int, float>>& connections);
+		void ClearVirtualNodes();
+
+		const std::vector<int>& GetLandmarks() const { return m_Landmarks; }
+		int GetNrOfUpToDateLandmarks() const;
+		size_t GetTableSize() const { return (m_ForwardTable.size() + m_BackwardTable.size()) * sizeof(uint16_t); }
+
+	private:
+		enum : uint16_t { unreachable = 0xFFFF };
+
+		// Distance between a landmark and a node is somewhere in [lower, upper), lower < 0 when there is no path
+		struct DistanceBounds
+		{
+			float lower;
+			float upper;
+		};
+
+		// Forward: from the landmark to the node, backward: from the node to the landmark (only different on directional graphs)
+		struct NodeBounds
+		{
+			DistanceBounds forward;
+			DistanceBounds backward;
+		};
+
+		int SelectLandmark(int slot) const;
+		void BuildTable(int slot);
+		void CalculateDistances(int sourceIdx, bool isBackward, std::vector<float>& distances) const;
+		void UpdateIncomingConnections();
+
+		DistanceBounds GetTableBounds(bool isBackward, int nodeIdx, int slot) const;
+		NodeBounds GetNodeBounds(int nodeIdx, int slot) const;
+		void UpdateGoalCache(int goalIdx) const;
+
+		const IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		int m_NrOfNodes = 0;
+
+		// Per landmark
+		std::vector<int> m_Landmarks;
+		std::vector<int> m_LandmarkVersions;
+		std::vector<float> m_ForwardScales; // distance of one step in the table
+		std::vector<float> m_BackwardScales; // directional graphs only, the distances towards a landmark can be much longer than the ones from it
+
+		// Per node, the entries of all landmarks of a node are next to each other
+		std::vector<uint16_t> m_ForwardTable;
+		std::vector<uint16_t> m_BackwardTable; // directional graphs only
+
+		// Incoming connections in compressed form, directional graphs only
+		std::vector<int> m_IncomingOffsets;
+		std::vector<std::pair<int, float>> m_IncomingConnections;
+		int m_IncomingVersion = -1;
+
+		std::unordered_map<int, std::vector<std::pair<int, float>>> m_VirtualNodes;
+
+		// Bounds of the goal of the current search, per landmark, recalculated when the goal, the graph or the tables change
+		mutable std::vector<NodeBounds> m_GoalBounds;
+		mutable int m_CachedGoalIdx = invalid_node_index;
+		mutable int m_CachedGraphVersion = -1;
+		mutable bool m_IsGoalCacheDirty = true;
+	};
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline LandmarkHeuristic<T_NodeType, T_ConnectionType>::LandmarkHeuristic(const IGraph<T_NodeType, T_ConnectionType>* pGraph, int nrOfLandmarks)
+		: m_pGraph(pGraph)
+		, m_Landmarks(std::max(nrOfLandmarks, 1), invalid_node_index)
+		, m_LandmarkVersions(m_Landmarks.size(), -1)
+		, m_ForwardScales(m_Landmarks.size(), 1.f)
+		, m_BackwardScales(m_Landmarks.size(), 1.f)
+	{
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int LandmarkHeuristic<T_NodeType, T_ConnectionType>::Update(int maxRebuilds)
+	{
+		const int nrOfLandmarks{ int(m_Landmarks.size()) };
+
+		// Node indices moved, nothing in the tables can be used anymore
+		if (m_NrOfNodes != m_pGraph->GetNrOfNodes())
+		{
+			m_NrOfNodes = m_pGraph->GetNrOfNodes();
+			m_ForwardTable.assign(size_t(m_NrOfNodes) * nrOfLandmarks, unreachable);
+			m_BackwardTable.assign(m_pGraph->IsDirectionalGraph() ? m_ForwardTable.size() : 0, unreachable);
+			std::fill(m_LandmarkVersions.begin(), m_LandmarkVersions.end(), -1);
+		}
+
+		if (m_pGraph->IsDirectionalGraph())
+			UpdateIncomingConnections();
+
+		int nrOfRebuilds{};
+		for (int slot{}; slot < nrOfLandmarks && nrOfRebuilds < maxRebuilds; ++slot)
+		{
+			if (m_LandmarkVersions[slot] == m_pGraph->GetVersion())
+				continue;
+
+			const int landmarkIdx{ m_Landmarks[slot] };
+			if (!m_pGraph->IsNodeValid(landmarkIdx) || m_pGraph->GetNode(landmarkIdx)->GetIndex() == invalid_node_index)
+				m_Landmarks[slot] = SelectLandmark(slot);
+
+			BuildTable(slot);
+			++nrOfRebuilds;
+		}
+
+		if (nrOfRebuilds > 0)
+			m_IsGoalCacheDirty = true;
+
+		return nrOfRebuilds;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline float LandmarkHeuristic<T_NodeType, T_ConnectionType>::GetHeuristicCost(int nodeIdx, int goalIdx) const
+	{
+		UpdateGoalCache(goalIdx);
+
+		// Only the few virtual nodes need the lookup, every other node reads its table entries directly
+		const bool isVirtual{ !m_VirtualNodes.empty() && m_VirtualNodes.count(nodeIdx) > 0 };
+		if (!isVirtual && (nodeIdx < 0 || nodeIdx >= m_NrOfNodes))
+			return 0.f;
+
+		const bool isDirectional{ m_pGraph->IsDirectionalGraph() };
+		float hCost{};
+		for (int slot{}; slot < int(m_Landmarks.size()); ++slot)
+		{
+			const NodeBounds& goalBounds = m_GoalBounds[slot];
+			if (goalBounds.forward.lower < 0.f && goalBounds.backward.lower < 0.f)
+				continue;
+
+			NodeBounds nodeBounds{};
+			if (isVirtual)
+			{
+				nodeBounds = GetNodeBounds(nodeIdx, slot);
+			}
+			else
+			{
+				nodeBounds.forward = GetTableBounds(false, nodeIdx, slot);
+				nodeBounds.backward = isDirectional ? GetTableBounds(true, nodeIdx, slot) : nodeBounds.forward;
+			}
+
+			// d(n, g) >= d(L, g) - d(L, n)
+			if (goalBounds.forward.lower >= 0.f && nodeBounds.forward.lower >= 0.f)
+				hCost = std::max(hCost, goalBounds.forward.lower - nodeBounds.forward.upper);
+
+			// d(n, g) >= d(n, L) - d(g, L), without directions d(n, L) is d(L, n)
+			const DistanceBounds& goalToLandmark = isDirectional ? goalBounds.backward : goalBounds.forward;
+			const DistanceBounds& nodeToLandmark = isDirectional ? nodeBounds.backward : nodeBounds.forward;
+			if (goalToLandmark.lower >= 0.f && nodeToLandmark.lower >= 0.f)
+				hCost = std::max(hCost, nodeToLandmark.lower - goalToLandmark.upper);
+		}
+
+		return hCost;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void LandmarkHeuristic<T_NodeType, T_ConnectionType>::SetVirtualNode(int idx, const std::vector<std::pair<int, float>>& connections)
+	{
+		m_VirtualNodes[idx] = connections;
+		m_IsGoalCacheDirty = true;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void LandmarkHeuristic<T_NodeType, T_ConnectionType>::ClearVirtualNodes()
+	{
+		m_VirtualNodes.clear();
+		m_IsGoalCacheDirty = true;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int LandmarkHeuristic<T_NodeType, T_ConnectionType>::GetNrOfUpToDateLandmarks() const
+	{
+		return int(std::count(m_LandmarkVersions.begin(), m_LandmarkVersions.end(), m_pGraph->GetVersion()));
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int LandmarkHeuristic<T_NodeType, T_ConnectionType>::SelectLandmark(int slot) const
+	{
+		const int nrOfLandmarks{ int(m_Landmarks.size()) };
+
+		// Farthest point selection: the node with the largest distance to the closest landmark that is already up to date
+		// Nodes none of them can reach come first, so every part of a disconnected graph gets a landmark (isolated nodes, e.g. walls, are never picked)
+		std::vector<float> minDistances(m_NrOfNodes, FLT_MAX);
+		bool hasReference{ false };
+		for (int other{}; other < nrOfLandmarks; ++other)
+		{
+			if (other == slot || m_LandmarkVersions[other] != m_pGraph->GetVersion())
+				continue;
+
+			hasReference = true;
+			for (int idx{}; idx < m_NrOfNodes; ++idx)
+			{
+				const uint16_t distance{ m_ForwardTable[size_t(idx) * nrOfLandmarks + other] };
+				if (distance != unreachable)
+					minDistances[idx] = std::min(minDistances[idx], distance * m_ForwardScales[other]);
+			}
+		}
+
+		// Without any table, start from the node farthest away from an arbitrary node
+		if (!hasReference)
+		{
+			for (int idx{}; idx < m_NrOfNodes; ++idx)
+			{
+				if (m_pGraph->GetNode(idx)->GetIndex() != invalid_node_index && !m_pGraph->GetNodeConnections(idx).empty())
+				{
+					CalculateDistances(idx, false, minDistances);
+					break;
+				}
+			}
+			std::replace(minDistances.begin(), minDistances.end(), FLT_MAX, -1.f);
+		}
+
+		int bestIdx{ invalid_node_index };
+		float bestDistance{ -FLT_MAX };
+		for (int idx{}; idx < m_NrOfNodes; ++idx)
+		{
+			if (m_pGraph->GetNode(idx)->GetIndex() == invalid_node_index || minDistances[idx] <= bestDistance || m_pGraph->GetNodeConnections(idx).empty())
+				continue;
+
+			// Skip nodes that are a landmark already
+			if (std::find(m_Landmarks.begin(), m_Landmarks.end(), idx) != m_Landmarks.end())
+				continue;
+
+			bestIdx = idx;
+			bestDistance = minDistances[idx];
+		}
+
+		return bestIdx;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void LandmarkHeuristic<T_NodeType, T_ConnectionType>::BuildTable(int slot)
+	{
+		const int nrOfLandmarks{ int(m_Landmarks.size()) };
+		m_LandmarkVersions[slot] = m_pGraph->GetVersion();
+
+		std::vector<float> distances{};
+		for (int direction{}; direction < (m_pGraph->IsDirectionalGraph() ? 2 : 1); ++direction)
+		{
+			const bool isBackward{ direction == 1 };
+			std::vector<uint16_t>& table = isBackward ? m_BackwardTable : m_ForwardTable;
+			float& scale = isBackward ? m_BackwardScales[slot] : m_ForwardScales[slot];
+
+			distances.assign(m_NrOfNodes, FLT_MAX);
+			if (m_Landmarks[slot] != invalid_node_index)
+				CalculateDistances(m_Landmarks[slot], isBackward, distances);
+
+			// Every direction gets its own scale, so no distance has to be clamped to fit in the table
+			float maxDistance{};
+			for (float distance : distances)
+			{
+				if (distance != FLT_MAX)
+					maxDistance = std::max(maxDistance, distance);
+			}
+			scale = maxDistance > 0.f ? maxDistance / (unreachable - 1) : 1.f;
+
+			for (int idx{}; idx < m_NrOfNodes; ++idx)
+			{
+				uint16_t& entry = table[size_t(idx) * nrOfLandmarks + slot];
+				if (distances[idx] == FLT_MAX)
+					entry = unreachable;
+				else
+					entry = uint16_t(std::min(std::floor(double(distances[idx]) / scale), double(unreachable - 1)));
+			}
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void LandmarkHeuristic<T_NodeType, T_ConnectionType>::CalculateDistances(int sourceIdx, bool isBackward, std::vector<float>& distances) const
+	{
+		// Dijkstra, the backward search follows the connections towards a node
+		using OpenEntry = std::pair<float, int>;
+		std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> openList{};
+
+		distances[sourceIdx] = 0.f;
+		openList.push({ 0.f, sourceIdx });
+
+		while (openList.empty() == false)
+		{
+			const OpenEntry currentEntry{ openList.top() };
+			openList.pop();
+
+			const int currentIdx{ currentEntry.second };
+			if (currentEntry.first > distances[currentIdx])
+				continue;
+
+			auto relax = [&distances, &openList, &currentEntry](int nextIdx, float connectionCost)
+			{
+				const float distance{ currentEntry.first + connectionCost };
+				if (distance >= distances[nextIdx])
+					return;
+
+				distances[nextIdx] = distance;
+				openList.push({ distance, nextIdx });
+			};
+
+			if (isBackward)
+			{
+				for (int i{ m_IncomingOffsets[currentIdx] }; i < m_IncomingOffsets[currentIdx + 1]; ++i)
+					relax(m_IncomingConnections[i].first, m_IncomingConnections[i].second);
+			}
+			else
+			{
+				for (auto pConnection : m_pGraph->GetNodeConnections(currentIdx))
+					relax(pConnection->GetTo(), pConnection->GetCost());
+			}
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void LandmarkHeuristic<T_NodeType, T_ConnectionType>::UpdateIncomingConnections()
+	{
+		if (m_IncomingVersion == m_pGraph->GetVersion() && int(m_IncomingOffsets.size()) == m_NrOfNodes + 1)
+			return;
+
+		m_IncomingVersion = m_pGraph->GetVersion();
+		m_IncomingOffsets.assign(m_NrOfNodes + 1, 0);
+
+		// Count, prefix sum, then fill
+		for (int idx{}; idx < m_NrOfNodes; ++idx)
+		{
+			if (m_pGraph->GetNode(idx)->GetIndex() == invalid_node_index)
+				continue;
+
+			for (auto pConnection : m_pGraph->GetNodeConnections(idx))
+				++m_IncomingOffsets[pConnection->GetTo() + 1];
+		}
+
+		for (int idx{}; idx < m_NrOfNodes; ++idx)
+			m_IncomingOffsets[idx + 1] += m_IncomingOffsets[idx];
+
+		m_IncomingConnections.resize(m_IncomingOffsets[m_NrOfNodes]);
+		std::vector<int> fillOffsets{ m_IncomingOffsets.begin(), m_IncomingOffsets.end() - 1 };
+		for (int idx{}; idx < m_NrOfNodes; ++idx)
+		{
+			if (m_pGraph->GetNode(idx)->GetIndex() == invalid_node_index)
+				continue;
+
+			for (auto pConnection : m_pGraph->GetNodeConnections(idx))
+				m_IncomingConnections[fillOffsets[pConnection->GetTo()]++] = { idx, pConnection->GetCost() };
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline typename LandmarkHeuristic<T_NodeType, T_ConnectionType>::DistanceBounds LandmarkHeuristic<T_NodeType, T_ConnectionType>::GetTableBounds(bool isBackward, int nodeIdx, int slot) const
+	{
+		if (nodeIdx < 0 || nodeIdx >= m_NrOfNodes)
+			return { -1.f, -1.f };
+
+		const std::vector<uint16_t>& table = isBackward ? m_BackwardTable : m_ForwardTable;
+		const uint16_t distance{ table[size_t(nodeIdx) * m_Landmarks.size() + slot] };
+		if (distance == unreachable)
+			return { -1.f, -1.f };
+
+		// Rounding the largest distance of the table can still land on the last step, which has no known upper bound
+		const float scale{ isBackward ? m_BackwardScales[slot] : m_ForwardScales[slot] };
+		if (distance == unreachable - 1)
+			return { distance * scale, FLT_MAX };
+
+		return { distance * scale, (distance + 1) * scale };
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline typename LandmarkHeuristic<T_NodeType, T_ConnectionType>::NodeBounds LandmarkHeuristic<T_NodeType, T_ConnectionType>::GetNodeBounds(int nodeIdx, int slot) const
+	{
+		const bool isDirectional{ m_pGraph->IsDirectionalGraph() };
+
+		auto virtualIt = m_VirtualNodes.find(nodeIdx);
+		if (virtualIt == m_VirtualNodes.end())
+		{
+			const DistanceBounds forward{ GetTableBounds(false, nodeIdx, slot) };
+			return { forward, isDirectional ? GetTableBounds(true, nodeIdx, slot) : forward };
+		}
+
+		// The shortest way between the landmark and a virtual node passes through one of the nodes it connects to
+		NodeBounds bounds{ { -1.f, -1.f }, { -1.f, -1.f } };
+		auto addConnection = [](DistanceBounds& bounds, const DistanceBounds& throughBounds, float cost)
+		{
+			if (throughBounds.lower < 0.f)
+				return;
+
+			if (bounds.lower < 0.f)
+			{
+				bounds = { throughBounds.lower + cost, throughBounds.upper + cost };
+				return;
+			}
+
+			bounds.lower = std::min(bounds.lower, throughBounds.lower + cost);
+			bounds.upper = std::min(bounds.upper, throughBounds.upper + cost);
+		};
+
+		for (const auto& connection : virtualIt->second)
+		{
+			addConnection(bounds.forward, GetTableBounds(false, connection.first, slot), connection.second);
+			if (isDirectional)
+				addConnection(bounds.backward, GetTableBounds(true, connection.first, slot), connection.second);
+		}
+
+		if (!isDirectional)
+			bounds.backward = bounds.forward;
+
+		return bounds;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void LandmarkHeuristic<T_NodeType, T_ConnectionType>::UpdateGoalCache(int goalIdx) const
+	{
+		if (!m_IsGoalCacheDirty && m_CachedGoalIdx == goalIdx && m_CachedGraphVersion == m_pGraph->GetVersion())
+			return;
+
+		m_IsGoalCacheDirty = false;
+		m_CachedGoalIdx = goalIdx;
+		m_CachedGraphVersion = m_pGraph->GetVersion();
+
+		// Outdated tables are left out by giving the goal no distance to their landmark
+		m_GoalBounds.resize(m_Landmarks.size());
+		for (int slot{}; slot < int(m_Landmarks.size()); ++slot)
+		{
+			if (m_LandmarkVersions[slot] == m_CachedGraphVersion)
+				m_GoalBounds[slot] = GetNodeBounds(goalIdx, slot);
+			else
+				m_GoalBounds[slot] = { { -1.f, -1.f }, { -1.f, -1.f } };
+		}
+	}
+}
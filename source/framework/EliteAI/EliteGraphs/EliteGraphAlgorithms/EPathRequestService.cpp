@@ -0,0 +1,348 @@
+#include "stdafx.h"
+#include "EPathRequestService.h"
+
+using namespace Elite;
+
+namespace
+{
+	// Entry on the open list of a worker, entries that became outdated after a cheaper path was found are skipped when popped
+	struct OpenEntry
+	{
+		float estimatedTotalCost;
+		float costSoFar;
+		int nodeIdx;
+
+		bool operator<(const OpenEntry& other) const
+		{
+			if (estimatedTotalCost != other.estimatedTotalCost)
+				return estimatedTotalCost > other.estimatedTotalCost;
+			return costSoFar < other.costSoFar;
+		}
+	};
+
+	// Running requests check for cancellation every this many expansions
+	const int CANCEL_CHECK_INTERVAL = 256;
+}
+
+Elite::PathRequestService::PathRequestService(int nrOfWorkers, int maxCompletionsPerFrame)
+	: m_MaxCompletionsPerFrame(maxCompletionsPerFrame)
+{
+	if (nrOfWorkers <= 0)
+		nrOfWorkers = std::max(int(std::thread::hardware_concurrency()) - 1, 1);
+
+	for (int i = 0; i < nrOfWorkers; ++i)
+		m_Workers.emplace_back(&PathRequestService::RunWorker, this);
+}
+
+Elite::PathRequestService::~PathRequestService()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_IsStopping = true;
+
+		// Running requests stop early, queued requests are never started
+		for (auto& state : m_States)
+			*state.second.pIsCancelled = true;
+	}
+	m_RequestAdded.notify_all();
+
+	for (auto& worker : m_Workers)
+		worker.join();
+}
+
+PathRequestHandle Elite::PathRequestService::RequestPath(const std::shared_ptr<const GraphSnapshot>& pSnapshot, int startIdx, int destinationIdx, Heuristic hFunction, int priority)
+{
+	if (pSnapshot == nullptr || !pSnapshot->IsNodeValid(startIdx) || !pSnapshot->IsNodeValid(destinationIdx))
+		return invalid_path_request;
+
+	return AddRequest(Request{ invalid_path_request, priority, pSnapshot, startIdx, destinationIdx, hFunction, nullptr, nullptr }, nullptr);
+}
+
+PathRequestHandle Elite::PathRequestService::AddRequest(const Request& request, std::vector<int>* pCachedPath)
+{
+	PathRequestHandle handle{ invalid_path_request };
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		// Once the counter wraps, handles that are still open are skipped, so a handle never refers to two requests at once
+		do
+		{
+			handle = m_NextHandle++;
+			if (m_NextHandle == invalid_path_request)
+				m_NextHandle = 1;
+		} while (m_States.find(handle) != m_States.end() || m_ReadyPaths.find(handle) != m_ReadyPaths.end());
+
+		auto pIsCancelled = std::make_shared<std::atomic<bool>>(false);
+
+		// Cached paths are solved already, they only wait for the next Update
+		if (pCachedPath != nullptr)
+		{
+			m_States[handle] = RequestState{ PathRequestStatus::Solved, pIsCancelled };
+			m_Solved.push_back(SolvedRequest{ handle, request.priority, std::move(*pCachedPath), nullptr, request.startIdx, request.destinationIdx, request.heuristicFunction, 0, 0.f });
+			return handle;
+		}
+
+		m_States[handle] = RequestState{ PathRequestStatus::Queued, pIsCancelled };
+
+		Request queuedRequest{ request };
+		queuedRequest.handle = handle;
+		queuedRequest.pIsCancelled = pIsCancelled;
+		m_Queue.push(queuedRequest);
+	}
+	m_RequestAdded.notify_one();
+
+	return handle;
+}
+
+void Elite::PathRequestService::Cancel(PathRequestHandle handle)
+{
+	m_ReadyPaths.erase(handle);
+
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+
+	auto stateIt = m_States.find(handle);
+	if (stateIt == m_States.end())
+		return;
+
+	// Queued requests are skipped by the workers, running requests stop at their next check
+	*stateIt->second.pIsCancelled = true;
+	m_States.erase(stateIt);
+
+	m_Solved.erase(std::remove_if(m_Solved.begin(), m_Solved.end(),
+		[handle](const SolvedRequest& solved) { return solved.handle == handle; }), m_Solved.end());
+}
+
+int Elite::PathRequestService::Update()
+{
+	std::vector<SolvedRequest> published{};
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		if (m_Solved.empty())
+			return 0;
+
+		// Only the most important requests get through when more were solved than the frame allows
+		const size_t nrToPublish{ std::min(m_Solved.size(), size_t(std::max(m_MaxCompletionsPerFrame, 0))) };
+		std::stable_sort(m_Solved.begin(), m_Solved.end(),
+			[](const SolvedRequest& a, const SolvedRequest& b) { return a.priority > b.priority; });
+
+		published.reserve(nrToPublish);
+		for (size_t i = 0; i < nrToPublish; ++i)
+		{
+			m_States[m_Solved[i].handle].status = PathRequestStatus::Ready;
+			published.push_back(std::move(m_Solved[i]));
+		}
+		m_Solved.erase(m_Solved.begin(), m_Solved.begin() + nrToPublish);
+	}
+
+	for (auto& solved : published)
+	{
+		if (solved.pGraph != nullptr && m_PathCacheCapacity > 0)
+		{
+			auto cacheIt = m_PathCaches.find(solved.pGraph);
+			if (cacheIt == m_PathCaches.end())
+				cacheIt = m_PathCaches.emplace(solved.pGraph, PathCache{ m_PathCacheCapacity }).first;
+
+			cacheIt->second.Insert(solved.startIdx, solved.destinationIdx, solved.heuristicFunction, solved.graphVersion, solved.path, solved.searchTime);
+		}
+
+		m_ReadyPaths[solved.handle] = std::move(solved.path);
+	}
+
+	return int(published.size());
+}
+
+PathRequestStatus Elite::PathRequestService::GetStatus(PathRequestHandle handle) const
+{
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+
+	auto stateIt = m_States.find(handle);
+	if (stateIt == m_States.end())
+		return PathRequestStatus::Unknown;
+
+	return stateIt->second.status;
+}
+
+bool Elite::PathRequestService::TakePath(PathRequestHandle handle, std::vector<int>& path)
+{
+	auto pathIt = m_ReadyPaths.find(handle);
+	if (pathIt == m_ReadyPaths.end())
+		return false;
+
+	path = std::move(pathIt->second);
+	m_ReadyPaths.erase(pathIt);
+
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+	m_States.erase(handle);
+
+	return true;
+}
+
+void Elite::PathRequestService::ReleaseGraph(const void* pGraph)
+{
+	m_Snapshots.erase(pGraph);
+	m_PathCaches.erase(pGraph);
+}
+
+void Elite::PathRequestService::SetPathCacheCapacity(size_t capacity)
+{
+	m_PathCacheCapacity = capacity;
+	for (auto& pathCache : m_PathCaches)
+		pathCache.second.SetCapacity(capacity);
+}
+
+PathCacheStats Elite::PathRequestService::GetPathCacheStats(const void* pGraph) const
+{
+	auto cacheIt = m_PathCaches.find(pGraph);
+	return cacheIt != m_PathCaches.end() ? cacheIt->second.GetStats() : PathCacheStats{};
+}
+
+int Elite::PathRequestService::GetNrOfOpenRequests() const
+{
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+	return int(m_States.size());
+}
+
+void Elite::PathRequestService::RunWorker()
+{
+	SearchArrays searchArrays{};
+	std::vector<int> path{};
+
+	while (true)
+	{
+		Request request{};
+		{
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+			m_RequestAdded.wait(lock, [this]() { return m_IsStopping || !m_Queue.empty(); });
+
+			if (m_IsStopping)
+				return;
+
+			request = m_Queue.top();
+			m_Queue.pop();
+
+			auto stateIt = m_States.find(request.handle);
+			if (!IsStateOf(stateIt, request))
+				continue;
+
+			stateIt->second.status = PathRequestStatus::Running;
+		}
+
+		path.clear();
+		const auto startTime = std::chrono::steady_clock::now();
+		const bool isFinished{ SolveRequest(request, searchArrays, path) };
+		const float searchTime{ std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count() };
+		const int graphVersion{ request.pSnapshot->GetVersion() };
+
+		// The snapshot is released outside of the lock, the last reference frees the graph copy
+		request.pSnapshot.reset();
+
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		auto stateIt = m_States.find(request.handle);
+		if (!isFinished || !IsStateOf(stateIt, request))
+			continue;
+
+		stateIt->second.status = PathRequestStatus::Solved;
+		m_Solved.push_back(SolvedRequest{ request.handle, request.priority, std::move(path), request.pGraph, request.startIdx, request.destinationIdx, request.heuristicFunction, graphVersion, searchTime });
+	}
+}
+
+bool Elite::PathRequestService::SolveRequest(const Request& request, SearchArrays& searchArrays, std::vector<int>& path) const
+{
+	const GraphSnapshot& snapshot{ *request.pSnapshot };
+	const GraphCSRView connections{ snapshot.GetConnections() };
+
+	// Arrays only grow, so they get reused by every request the worker solves
+	const size_t nrOfNodes{ size_t(snapshot.GetNrOfNodes()) };
+	if (searchArrays.visitedGeneration.size() < nrOfNodes)
+	{
+		searchArrays.costSoFar.resize(nrOfNodes);
+		searchArrays.parent.resize(nrOfNodes);
+		searchArrays.isClosed.resize(nrOfNodes);
+		searchArrays.visitedGeneration.resize(nrOfNodes, 0);
+	}
+
+	// A new generation invalidates the data of the previous search without clearing the arrays
+	if (++searchArrays.generation == 0)
+	{
+		std::fill(searchArrays.visitedGeneration.begin(), searchArrays.visitedGeneration.end(), 0);
+		searchArrays.generation = 1;
+	}
+
+	auto visitNode = [&searchArrays](int idx)
+	{
+		if (searchArrays.visitedGeneration[idx] == searchArrays.generation)
+			return;
+
+		searchArrays.visitedGeneration[idx] = searchArrays.generation;
+		searchArrays.costSoFar[idx] = FLT_MAX;
+		searchArrays.parent[idx] = invalid_node_index;
+		searchArrays.isClosed[idx] = false;
+	};
+
+	const Vector2 goalPos{ snapshot.GetNodePos(request.destinationIdx) };
+	auto getHeuristicCost = [&snapshot, &request, &goalPos](int idx)
+	{
+		const Vector2 toDestination{ goalPos - snapshot.GetNodePos(idx) };
+		return request.heuristicFunction(abs(toDestination.x), abs(toDestination.y));
+	};
+
+	std::vector<OpenEntry> openList{};
+	visitNode(request.startIdx);
+	searchArrays.costSoFar[request.startIdx] = 0.f;
+	openList.push_back({ getHeuristicCost(request.startIdx), 0.f, request.startIdx });
+
+	bool hasFoundGoal{ false };
+	int nrOfExpandedNodes{};
+
+	while (openList.empty() == false)
+	{
+		if (++nrOfExpandedNodes % CANCEL_CHECK_INTERVAL == 0 && *request.pIsCancelled)
+			return false;
+
+		std::pop_heap(openList.begin(), openList.end());
+		const OpenEntry currentEntry{ openList.back() };
+		openList.pop_back();
+
+		const int currentIdx{ currentEntry.nodeIdx };
+		if (searchArrays.isClosed[currentIdx] || currentEntry.costSoFar > searchArrays.costSoFar[currentIdx])
+			continue;
+
+		searchArrays.isClosed[currentIdx] = true;
+
+		if (currentIdx == request.destinationIdx)
+		{
+			hasFoundGoal = true;
+			break;
+		}
+
+		const int firstConnection{ connections.GetFirstConnection(currentIdx) };
+		const int lastConnection{ firstConnection + connections.GetNrOfConnections(currentIdx) };
+		for (int connectionIdx{ firstConnection }; connectionIdx < lastConnection; ++connectionIdx)
+		{
+			const int nextIdx{ connections.GetTarget(connectionIdx) };
+			visitNode(nextIdx);
+
+			const float costSoFar{ searchArrays.costSoFar[currentIdx] + connections.GetCost(connectionIdx) };
+			if (costSoFar >= searchArrays.costSoFar[nextIdx])
+				continue;
+
+			searchArrays.costSoFar[nextIdx] = costSoFar;
+			searchArrays.parent[nextIdx] = currentIdx;
+			searchArrays.isClosed[nextIdx] = false;
+
+			openList.push_back({ costSoFar + getHeuristicCost(nextIdx), costSoFar, nextIdx });
+			std::push_heap(openList.begin(), openList.end());
+		}
+	}
+
+	// An unreachable destination is still a finished request, with an empty path
+	if (hasFoundGoal == false)
+		return true;
+
+	for (int idx{ request.destinationIdx }; idx != invalid_node_index; idx = searchArrays.parent[idx])
+		path.push_back(idx);
+
+	std::reverse(path.begin(), path.end());
+	return true;
+}
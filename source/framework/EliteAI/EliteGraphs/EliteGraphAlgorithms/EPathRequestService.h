@@ -0,0 +1,210 @@
+#pragma once
+#include "framework/EliteAI/EliteNavigation/ENavigation.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphUtilities/EGraphSnapshot.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphUtilities/EPathCache.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Elite
+{
+	using PathRequestHandle = unsigned int;
+	const PathRequestHandle invalid_path_request = 0;
+
+	enum class PathRequestStatus
+	{
+		Unknown, // never requested, cancelled or already taken
+		Queued,
+		Running,
+		Solved, // solved by a worker, waiting to be published by Update
+		Ready // published, the path can be taken
+	};
+
+	// Solves A* path requests on worker threads.
+	// Requests are searched on a read-only snapshot of the graph, the snapshot of a graph is shared by all requests until the graph version changes.
+	// Workers pick the highest priority first, solved paths are only handed to the main thread by Update, at most a fixed number per frame.
+	// Everything except the workers themselves runs on the main thread: requests, Update, Cancel and TakePath.
+	// Requests made with a graph go through a path cache of that graph first, cache hits skip the workers and are published by the next Update.
+	class PathRequestService final
+	{
+	public:
+		// 0 workers uses one thread less than the hardware offers, with a minimum of one
+		explicit PathRequestService(int nrOfWorkers = 0, int maxCompletionsPerFrame = 16);
+		~PathRequestService();
+
+		template<class T_NodeType, class T_ConnectionType>
+		PathRequestHandle RequestPath(const IGraph<T_NodeType, T_ConnectionType>* pGraph, T_NodeType* pStartNode, T_NodeType* pDestinationNode, Heuristic hFunction, int priority = 0);
+		// Snapshot requests don't know their graph, so they bypass the path cache
+		PathRequestHandle RequestPath(const std::shared_ptr<const GraphSnapshot>& pSnapshot, int startIdx, int destinationIdx, Heuristic hFunction, int priority = 0);
+
+		// Queued requests are dropped, running requests stop at their next check, solved paths are thrown away
+		void Cancel(PathRequestHandle handle);
+
+		// Publishes the solved requests of this frame, highest priority first, and returns how many were published
+		int Update();
+
+		PathRequestStatus GetStatus(PathRequestHandle handle) const;
+
+		// Moves the node indices of a ready path out of the service (empty when the destination can't be reached) and forgets the request
+		bool TakePath(PathRequestHandle handle, std::vector<int>& path);
+		template<class T_NodeType, class T_ConnectionType>
+		bool TakePath(PathRequestHandle handle, const IGraph<T_NodeType, T_ConnectionType>* pGraph, std::vector<T_NodeType*>& path);
+
+		// The snapshot of a graph is rebuilt on the first request after its version changed
+		template<class T_NodeType, class T_ConnectionType>
+		std::shared_ptr<const GraphSnapshot> GetSnapshot(const IGraph<T_NodeType, T_ConnectionType>* pGraph);
+		// Has to be called before a graph that was used for requests is deleted, drops its snapshot and path cache
+		void ReleaseGraph(const void* pGraph);
+
+		// Paths cached per graph, 0 disables the cache
+		void SetPathCacheCapacity(size_t capacity);
+		size_t GetPathCacheCapacity() const { return m_PathCacheCapacity; }
+		PathCacheStats GetPathCacheStats(const void* pGraph) const;
+
+		void SetMaxCompletionsPerFrame(int maxCompletionsPerFrame) { m_MaxCompletionsPerFrame = maxCompletionsPerFrame; }
+		int GetMaxCompletionsPerFrame() const { return m_MaxCompletionsPerFrame; }
+		int GetNrOfWorkers() const { return int(m_Workers.size()); }
+		int GetNrOfOpenRequests() const;
+
+	private:
+		struct Request
+		{
+			PathRequestHandle handle;
+			int priority;
+			std::shared_ptr<const GraphSnapshot> pSnapshot;
+			int startIdx;
+			int destinationIdx;
+			Heuristic heuristicFunction;
+			std::shared_ptr<std::atomic<bool>> pIsCancelled;
+			const void* pGraph; // nullptr for snapshot requests
+
+			// Highest priority first, requests with the same priority in the order they were made
+			bool operator<(const Request& other) const
+			{
+				if (priority != other.priority)
+					return priority < other.priority;
+				return handle > other.handle;
+			}
+		};
+
+		struct SolvedRequest
+		{
+			PathRequestHandle handle;
+			int priority;
+			std::vector<int> path;
+
+			// Only set for requests that have to be added to a path cache once published
+			const void* pGraph;
+			int startIdx;
+			int destinationIdx;
+			Heuristic heuristicFunction;
+			int graphVersion;
+			float searchTime;
+		};
+
+		struct RequestState
+		{
+			PathRequestStatus status;
+			std::shared_ptr<std::atomic<bool>> pIsCancelled;
+		};
+
+		// Per worker, reused by every request the worker solves
+		struct SearchArrays
+		{
+			std::vector<float> costSoFar;
+			std::vector<int> parent;
+			std::vector<bool> isClosed;
+			std::vector<unsigned int> visitedGeneration;
+			unsigned int generation = 0;
+		};
+
+		PathRequestHandle AddRequest(const Request& request, std::vector<int>* pCachedPath);
+		// A cancelled request can still be in the queue or on a worker after its handle was handed out again, the cancel flag tells them apart
+		bool IsStateOf(std::unordered_map<PathRequestHandle, RequestState>::const_iterator stateIt, const Request& request) const
+		{
+			return stateIt != m_States.end() && stateIt->second.pIsCancelled == request.pIsCancelled;
+		}
+		void RunWorker();
+		bool SolveRequest(const Request& request, SearchArrays& searchArrays, std::vector<int>& path) const;
+
+		std::vector<std::thread> m_Workers;
+		bool m_IsStopping = false;
+
+		// Guards everything below, the workers only hold it to take a request and to hand in a path
+		mutable std::mutex m_Mutex;
+		std::condition_variable m_RequestAdded;
+		std::priority_queue<Request> m_Queue;
+		std::vector<SolvedRequest> m_Solved;
+		std::unordered_map<PathRequestHandle, RequestState> m_States;
+		PathRequestHandle m_NextHandle = 1;
+
+		// Main thread only
+		std::unordered_map<const void*, std::shared_ptr<const GraphSnapshot>> m_Snapshots;
+		std::unordered_map<PathRequestHandle, std::vector<int>> m_ReadyPaths;
+		std::unordered_map<const void*, PathCache> m_PathCaches;
+		size_t m_PathCacheCapacity = 256;
+		int m_MaxCompletionsPerFrame;
+
+		PathRequestService(const PathRequestService&) = delete;
+		PathRequestService& operator=(const PathRequestService&) = delete;
+	};
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline PathRequestHandle PathRequestService::RequestPath(const IGraph<T_NodeType, T_ConnectionType>* pGraph, T_NodeType* pStartNode, T_NodeType* pDestinationNode, Heuristic hFunction, int priority)
+	{
+		if (pStartNode == nullptr || pDestinationNode == nullptr)
+			return invalid_path_request;
+
+		const int startIdx{ pStartNode->GetIndex() };
+		const int destinationIdx{ pDestinationNode->GetIndex() };
+		Request request{ invalid_path_request, priority, nullptr, startIdx, destinationIdx, hFunction, nullptr, pGraph };
+
+		if (m_PathCacheCapacity > 0)
+		{
+			std::vector<int> cachedPath{};
+			auto& pathCache = m_PathCaches.emplace(pGraph, PathCache{ m_PathCacheCapacity }).first->second;
+			if (pathCache.Find(startIdx, destinationIdx, hFunction, pGraph->GetVersion(), cachedPath))
+				return AddRequest(request, &cachedPath);
+		}
+
+		request.pSnapshot = GetSnapshot(pGraph);
+		if (!request.pSnapshot->IsNodeValid(startIdx) || !request.pSnapshot->IsNodeValid(destinationIdx))
+			return invalid_path_request;
+
+		return AddRequest(request, nullptr);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool PathRequestService::TakePath(PathRequestHandle handle, const IGraph<T_NodeType, T_ConnectionType>* pGraph, std::vector<T_NodeType*>& path)
+	{
+		std::vector<int> pathIndices{};
+		if (!TakePath(handle, pathIndices))
+			return false;
+
+		path.clear();
+		for (int idx : pathIndices)
+		{
+			// The graph might have lost the node since the snapshot was taken
+			if (!pGraph->IsNodeValid(idx) || pGraph->GetNode(idx)->GetIndex() == invalid_node_index)
+			{
+				path.clear();
+				break;
+			}
+
+			path.push_back(pGraph->GetNode(idx));
+		}
+
+		return true;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline std::shared_ptr<const GraphSnapshot> PathRequestService::GetSnapshot(const IGraph<T_NodeType, T_ConnectionType>* pGraph)
+	{
+		auto& pSnapshot = m_Snapshots[pGraph];
+		if (pSnapshot == nullptr || pSnapshot->GetVersion() != pGraph->GetVersion())
+			pSnapshot = GraphSnapshot::Create(*pGraph);
+
+		return pSnapshot;
+	}
+}
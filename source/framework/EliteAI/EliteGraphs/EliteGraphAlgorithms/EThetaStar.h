@@ -0,0 +1,296 @@
+#pragma once
+#include "framework/EliteAI/EliteNavigation/ENavigation.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphUtilities/EGridPassability.h"
+
+namespace Elite
+{
+	// Any-angle A* on a grid: a node takes the parent of the node it was reached from when the two can see each other,
+	// so the path only contains the cells where it turns and the segments in between can go in any direction.
+	// Costs are the straight line distances between cell centers (times the straight cost of the grid), terrain costs are not taken into account.
+	// Lazy Theta* assumes the line of sight and only checks it when a node is expanded, which saves most of the checks.
+	template <class T_NodeType, class T_ConnectionType>
+	class ThetaStar final
+	{
+	public:
+		explicit ThetaStar(GridGraph<T_NodeType, T_ConnectionType>* pGrid, bool isLazy = true);
+
+		// Returns the start, the turning points and the destination, or an empty path when the destination can't be reached
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+
+		void SetLazy(bool isLazy) { m_IsLazy = isLazy; }
+		bool IsLazy() const { return m_IsLazy; }
+
+		// Rebuilt by FindPath when the grid changed
+		const GridPassability& GetPassability() const { return m_Passability; }
+
+		// Of the last query
+		float GetPathCost() const { return m_PathCost; }
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+		int GetNrOfLineOfSightChecks() const { return m_NrOfLineOfSightChecks; }
+
+	private:
+		// Same ordering as AStar
+		struct OpenEntry
+		{
+			float estimatedTotalCost;
+			float costSoFar;
+			int nodeIdx;
+
+			bool operator<(const OpenEntry& other) const
+			{
+				if (estimatedTotalCost != other.estimatedTotalCost)
+					return estimatedTotalCost > other.estimatedTotalCost;
+				return costSoFar < other.costSoFar;
+			}
+		};
+
+		float GetDistance(int fromIdx, int toIdx) const;
+		bool HasLineOfSight(int fromIdx, int toIdx);
+
+		// Lazy Theta*: falls back to the cheapest closed neighbor with a connection towards the node when the assumed parent turns out to be out of sight
+		// Returns false when there is none, the node is then left to be opened again from another node
+		bool SetVertex(int idx);
+		void UpdateVertex(int idx, int nextIdx);
+		void OpenNode(int idx, float costSoFar, int parentIdx);
+
+		void PrepareSearch();
+		void VisitNode(int idx);
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGrid;
+		bool m_IsLazy;
+		GridPassability m_Passability;
+
+		// Per node index, only valid for nodes whose m_VisitedGeneration matches the current search
+		// The start is its own parent
+		std::vector<float> m_CostSoFar;
+		std::vector<int> m_Parent;
+		std::vector<bool> m_IsClosed;
+		std::vector<unsigned int> m_VisitedGeneration;
+		unsigned int m_Generation = 0;
+
+		std::vector<OpenEntry> m_OpenList;
+		int m_GoalIdx = invalid_node_index;
+
+		float m_PathCost = 0.f;
+		int m_NrOfExpandedNodes = 0;
+		int m_NrOfLineOfSightChecks = 0;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline ThetaStar<T_NodeType, T_ConnectionType>::ThetaStar(GridGraph<T_NodeType, T_ConnectionType>* pGrid, bool isLazy)
+		: m_pGrid(pGrid)
+		, m_IsLazy(isLazy)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> ThetaStar<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		PrepareSearch();
+		if (pStartNode == nullptr || pGoalNode == nullptr)
+			return {};
+
+		if (!m_Passability.IsUpToDate(*m_pGrid))
+			m_Passability.Build(*m_pGrid);
+
+		const int startIdx{ pStartNode->GetIndex() };
+		m_GoalIdx = pGoalNode->GetIndex();
+
+		// StartRecord
+		VisitNode(startIdx);
+		OpenNode(startIdx, 0.f, startIdx);
+
+		bool hasFoundGoal{ false };
+		while (m_OpenList.empty() == false)
+		{
+			std::pop_heap(m_OpenList.begin(), m_OpenList.end());
+			const OpenEntry currentEntry{ m_OpenList.back() };
+			m_OpenList.pop_back();
+
+			const int currentIdx{ currentEntry.nodeIdx };
+
+			// Skip outdated entries
+			if (m_IsClosed[currentIdx] || currentEntry.costSoFar > m_CostSoFar[currentIdx])
+				continue;
+
+			if (m_IsLazy && SetVertex(currentIdx) == false)
+				continue;
+
+			m_IsClosed[currentIdx] = true;
+			++m_NrOfExpandedNodes;
+
+			if (currentIdx == m_GoalIdx)
+			{
+				hasFoundGoal = true;
+				break;
+			}
+
+			for (auto& connection : m_pGrid->GetNodeConnections(currentIdx))
+			{
+				const int nextIdx{ connection->GetTo() };
+				VisitNode(nextIdx);
+
+				// Nodes are never reopened, the parent of a closed node is final
+				if (m_IsClosed[nextIdx] == false)
+					UpdateVertex(currentIdx, nextIdx);
+			}
+		}
+
+		if (hasFoundGoal == false)
+			return {};
+
+		//--------------------//
+		//--Reconstruct Path--//
+		//--------------------//
+
+		m_PathCost = m_CostSoFar[m_GoalIdx];
+
+		std::vector<T_NodeType*> path;
+		int idx{ m_GoalIdx };
+		for (; m_Parent[idx] != idx; idx = m_Parent[idx])
+		{
+			path.push_back(m_pGrid->GetNode(idx));
+		}
+		path.push_back(m_pGrid->GetNode(idx));
+
+		std::reverse(path.begin(), path.end());
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline float ThetaStar<T_NodeType, T_ConnectionType>::GetDistance(int fromIdx, int toIdx) const
+	{
+		const int columns{ m_pGrid->GetColumns() };
+		const float x{ float(abs(fromIdx % columns - toIdx % columns)) };
+		const float y{ float(abs(fromIdx / columns - toIdx / columns)) };
+		return HeuristicFunctions::Euclidean(x, y) * m_pGrid->GetDefaultCostStraight();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline bool ThetaStar<T_NodeType, T_ConnectionType>::HasLineOfSight(int fromIdx, int toIdx)
+	{
+		++m_NrOfLineOfSightChecks;
+		if (m_Passability.HasLineOfSight(fromIdx, toIdx) == false)
+			return false;
+
+		// Cells next to each other also need the connection, a directional grid can have it one way only
+		const int columns{ m_pGrid->GetColumns() };
+		const bool isNeighbor{ abs(fromIdx % columns - toIdx % columns) <= 1 && abs(fromIdx / columns - toIdx / columns) <= 1 };
+		return isNeighbor == false || m_pGrid->GetConnection(fromIdx, toIdx) != nullptr;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool ThetaStar<T_NodeType, T_ConnectionType>::SetVertex(int idx)
+	{
+		const int parentIdx{ m_Parent[idx] };
+		if (parentIdx == idx || HasLineOfSight(parentIdx, idx))
+			return true;
+
+		// The connections towards the node come from the cells around it, on directional grids those aren't the connections of the node itself
+		const int columns{ m_pGrid->GetColumns() };
+		const int col{ idx % columns };
+		const int row{ idx / columns };
+
+		float bestCostSoFar{ FLT_MAX };
+		int bestParentIdx{ invalid_node_index };
+		for (int neighborRow{ std::max(row - 1, 0) }; neighborRow <= std::min(row + 1, m_pGrid->GetRows() - 1); ++neighborRow)
+		{
+			for (int neighborCol{ std::max(col - 1, 0) }; neighborCol <= std::min(col + 1, columns - 1); ++neighborCol)
+			{
+				const int neighborIdx{ neighborRow * columns + neighborCol };
+				if (neighborIdx == idx || m_VisitedGeneration[neighborIdx] != m_Generation || m_IsClosed[neighborIdx] == false)
+					continue;
+
+				if (m_pGrid->GetConnection(neighborIdx, idx) == nullptr)
+					continue;
+
+				const float costSoFar{ m_CostSoFar[neighborIdx] + GetDistance(neighborIdx, idx) };
+				if (costSoFar < bestCostSoFar)
+				{
+					bestCostSoFar = costSoFar;
+					bestParentIdx = neighborIdx;
+				}
+			}
+		}
+
+		// Never keep a parent without line of sight, the node isn't closed so a later expansion can still reach it
+		if (bestParentIdx == invalid_node_index)
+		{
+			m_CostSoFar[idx] = FLT_MAX;
+			m_Parent[idx] = invalid_node_index;
+			return false;
+		}
+
+		m_CostSoFar[idx] = bestCostSoFar;
+		m_Parent[idx] = bestParentIdx;
+		return true;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void ThetaStar<T_NodeType, T_ConnectionType>::UpdateVertex(int idx, int nextIdx)
+	{
+		// Path 2: straight from the parent, Lazy Theta* checks the line of sight when nextIdx gets expanded
+		const int parentIdx{ m_Parent[idx] };
+		if (parentIdx != idx && (m_IsLazy || HasLineOfSight(parentIdx, nextIdx)))
+		{
+			const float costSoFar{ m_CostSoFar[parentIdx] + GetDistance(parentIdx, nextIdx) };
+			if (costSoFar < m_CostSoFar[nextIdx])
+				OpenNode(nextIdx, costSoFar, parentIdx);
+			return;
+		}
+
+		// Path 1: through the node itself, like A*
+		const float costSoFar{ m_CostSoFar[idx] + GetDistance(idx, nextIdx) };
+		if (costSoFar < m_CostSoFar[nextIdx])
+			OpenNode(nextIdx, costSoFar, idx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline void ThetaStar<T_NodeType, T_ConnectionType>::OpenNode(int idx, float costSoFar, int parentIdx)
+	{
+		m_CostSoFar[idx] = costSoFar;
+		m_Parent[idx] = parentIdx;
+
+		m_OpenList.push_back({ costSoFar + GetDistance(idx, m_GoalIdx), costSoFar, idx });
+		std::push_heap(m_OpenList.begin(), m_OpenList.end());
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline void ThetaStar<T_NodeType, T_ConnectionType>::PrepareSearch()
+	{
+		// Arrays only grow, so they get reused by every query on the same grid
+		const size_t nrOfNodes{ size_t(m_pGrid->GetNrOfNodes()) };
+		if (m_VisitedGeneration.size() < nrOfNodes)
+		{
+			m_CostSoFar.resize(nrOfNodes);
+			m_Parent.resize(nrOfNodes);
+			m_IsClosed.resize(nrOfNodes);
+			m_VisitedGeneration.resize(nrOfNodes, 0);
+		}
+
+		// A new generation invalidates the data of the previous search without clearing the arrays
+		++m_Generation;
+		if (m_Generation == 0)
+		{
+			std::fill(m_VisitedGeneration.begin(), m_VisitedGeneration.end(), 0);
+			m_Generation = 1;
+		}
+
+		m_OpenList.clear();
+		m_PathCost = 0.f;
+		m_NrOfExpandedNodes = 0;
+		m_NrOfLineOfSightChecks = 0;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline void ThetaStar<T_NodeType, T_ConnectionType>::VisitNode(int idx)
+	{
+		if (m_VisitedGeneration[idx] == m_Generation)
+			return;
+
+		m_VisitedGeneration[idx] = m_Generation;
+		m_CostSoFar[idx] = FLT_MAX;
+		m_Parent[idx] = invalid_node_index;
+		m_IsClosed[idx] = false;
+	}
+}
@@ -48,6 +48,7 @@ bool Elite::GraphEditor::UpdateGraph(GridGraph<GridTerrainNode, GraphConnection>
 
 			pGraph->GetNode(idx)->SetTerrainType(terrainTypeVec[m_SelectedTerrainType]);
 			
+			pGraph->BeginEdit();
 			switch (terrainTypeVec[m_SelectedTerrainType])
 			{
 			case TerrainType::Water:
@@ -58,6 +59,7 @@ bool Elite::GraphEditor::UpdateGraph(GridGraph<GridTerrainNode, GraphConnection>
 				pGraph->AddConnectionsToAdjacentCells(idx);
 				break;
 			}
+			pGraph->EndEdit();
 			return true;
 		}
 	}
@@ -35,6 +35,9 @@ namespace Elite
 		bool hasGraphChanged = false;
 		auto mouseMotionData = INPUTMANAGER->GetMouseData(Elite::InputType::eMouseMotion);
 
+		// Picks the node closest to the mouse, through the spatial hash of the graph
+		const float pickRadius = 1.5f * DEFAULT_NODE_RADIUS;
+
 		if (INPUTMANAGER->IsMouseMoving())
 			m_MousePos = DEBUGRENDERER2D->GetActiveCamera()->ConvertScreenToWorld({ (float)mouseMotionData.X, (float)mouseMotionData.Y });
 
@@ -48,7 +51,7 @@ namespace Elite
 		if (INPUTMANAGER->IsMouseButtonDown(InputMouseButton::eLeft))
 		{
 			m_IsLeftMouseBtnPressed = true;
-			int clickedIdx = pGraph->GetNodeIdxAtWorldPos(m_MousePos);
+			int clickedIdx = pGraph->GetClosestNodeIdx(m_MousePos, pickRadius);
 
 			if (m_SelectedNodeIdx != invalid_node_index)
 			{
@@ -86,7 +89,7 @@ namespace Elite
 				hasGraphChanged = true;
 			}
 
-			int clickedIdx = pGraph->GetNodeIdxAtWorldPos(m_MousePos);
+			int clickedIdx = pGraph->GetClosestNodeIdx(m_MousePos, pickRadius);
 			if (clickedIdx != invalid_node_index)
 			{
 				pGraph->RemoveNode(clickedIdx);
@@ -101,7 +104,7 @@ namespace Elite
 			if (m_IsLeftMouseBtnPressed)
 			{
 				DEBUGRENDERER2D->DrawCircle(nodePos, pGraph->GetNodeRadius(pGraph->GetNode(m_SelectedNodeIdx)), { 1,1,1 }, -1);
-				pGraph->GetNode(m_SelectedNodeIdx)->SetPosition(m_MousePos);
+				pGraph->SetNodePosition(m_SelectedNodeIdx, m_MousePos);
 				hasGraphChanged = true;
 			}
 
@@ -0,0 +1,212 @@
+#include "stdafx.h"
+#include "EGraphFile.h"
+
+#include <fstream>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+using namespace Elite;
+
+namespace
+{
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return (offset + 7) & ~uint64_t(7);
+	}
+
+	template<typename T>
+	void WriteSection(std::ofstream& stream, uint64_t offset, const std::vector<T>& values)
+	{
+		// Pad up to the start of the section
+		const uint64_t position = uint64_t(stream.tellp());
+		for (uint64_t i = position; i < offset; ++i)
+			stream.put(0);
+
+		if (!values.empty())
+			stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+	}
+}
+
+Elite::GraphFile::~GraphFile()
+{
+	Close();
+}
+
+bool Elite::GraphFile::Exists(const std::string& path)
+{
+	return std::ifstream{ path, std::ios::binary }.good();
+}
+
+bool Elite::GraphFile::Open(const std::string& path)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		printf("WARNING: Could not open graph file '%s' \n", path.c_str());
+		return false;
+	}
+	m_FileHandle = file;
+
+	LARGE_INTEGER fileSize{};
+	GetFileSizeEx(file, &fileSize);
+	m_Size = size_t(fileSize.QuadPart);
+
+	HANDLE mapping = m_Size > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	if (mapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+	m_MappingHandle = mapping;
+
+	m_pData = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+	m_FileDescriptor = open(path.c_str(), O_RDONLY);
+	if (m_FileDescriptor < 0)
+	{
+		printf("WARNING: Could not open graph file '%s' \n", path.c_str());
+		return false;
+	}
+
+	struct stat fileStat{};
+	fstat(m_FileDescriptor, &fileStat);
+	m_Size = size_t(fileStat.st_size);
+
+	void* pMapping = m_Size > 0 ? mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0) : MAP_FAILED;
+	m_pData = pMapping != MAP_FAILED ? static_cast<const char*>(pMapping) : nullptr;
+#endif
+
+	if (m_pData == nullptr || !Validate())
+	{
+		printf("WARNING: '%s' is not a valid graph file \n", path.c_str());
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void Elite::GraphFile::Close()
+{
+#ifdef _WIN32
+	if (m_pData)
+		UnmapViewOfFile(m_pData);
+	if (m_MappingHandle)
+		CloseHandle(m_MappingHandle);
+	if (m_FileHandle)
+		CloseHandle(m_FileHandle);
+#else
+	if (m_pData)
+		munmap(const_cast<char*>(m_pData), m_Size);
+	if (m_FileDescriptor >= 0)
+		close(m_FileDescriptor);
+#endif
+
+	m_pData = nullptr;
+	m_Size = 0;
+	m_FileHandle = nullptr;
+	m_MappingHandle = nullptr;
+	m_FileDescriptor = -1;
+}
+
+GraphCSRView Elite::GraphFile::GetConnections() const
+{
+	const GraphFileHeader& header = GetHeader();
+
+	GraphCSRView view{};
+	view.nrOfNodes = header.nrOfNodes;
+	view.pOffsets = reinterpret_cast<const uint32_t*>(m_pData + header.connectionOffsetsOffset);
+	view.pTargets = reinterpret_cast<const int32_t*>(m_pData + header.connectionTargetsOffset);
+	view.pCosts = reinterpret_cast<const float*>(m_pData + header.connectionCostsOffset);
+	return view;
+}
+
+bool Elite::GraphFile::Write(const std::string& path, GraphFileHeader header, const std::vector<GraphFileNode>& nodes,
+	const std::vector<uint32_t>& connectionOffsets, const std::vector<int32_t>& connectionTargets, const std::vector<float>& connectionCosts)
+{
+	assert(int(nodes.size()) == header.nrOfNodes && connectionOffsets.size() == nodes.size() + 1 && "<GraphFile::Write>: invalid node sections");
+	assert(int(connectionTargets.size()) == header.nrOfConnections && connectionCosts.size() == connectionTargets.size() && "<GraphFile::Write>: invalid connection sections");
+
+	header.magic = GRAPH_FILE_MAGIC;
+	header.version = GRAPH_FILE_VERSION;
+	header.nodesOffset = AlignOffset(sizeof(GraphFileHeader));
+	header.connectionOffsetsOffset = AlignOffset(header.nodesOffset + nodes.size() * sizeof(GraphFileNode));
+	header.connectionTargetsOffset = AlignOffset(header.connectionOffsetsOffset + connectionOffsets.size() * sizeof(uint32_t));
+	header.connectionCostsOffset = AlignOffset(header.connectionTargetsOffset + connectionTargets.size() * sizeof(int32_t));
+	header.fileSize = header.connectionCostsOffset + connectionCosts.size() * sizeof(float);
+
+	std::ofstream stream{ path, std::ios::binary | std::ios::trunc };
+	if (!stream)
+	{
+		printf("WARNING: Could not write graph file '%s' \n", path.c_str());
+		return false;
+	}
+
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(GraphFileHeader));
+	WriteSection(stream, header.nodesOffset, nodes);
+	WriteSection(stream, header.connectionOffsetsOffset, connectionOffsets);
+	WriteSection(stream, header.connectionTargetsOffset, connectionTargets);
+	WriteSection(stream, header.connectionCostsOffset, connectionCosts);
+
+	return stream.good();
+}
+
+bool Elite::GraphFile::Validate() const
+{
+	if (m_Size < sizeof(GraphFileHeader))
+		return false;
+
+	const GraphFileHeader& header = GetHeader();
+	if (header.magic != GRAPH_FILE_MAGIC || header.version != GRAPH_FILE_VERSION || header.fileSize != m_Size)
+		return false;
+
+	if (header.nrOfNodes < 0 || header.nrOfConnections < 0)
+		return false;
+
+	// Every section has to fit inside the file, the offsets come from the file so the sums can't be trusted not to wrap
+	const uint64_t nrOfNodes = uint64_t(header.nrOfNodes);
+	const uint64_t nrOfConnections = uint64_t(header.nrOfConnections);
+	if (!IsSectionInFile(header.nodesOffset, nrOfNodes, sizeof(GraphFileNode), alignof(GraphFileNode))
+		|| !IsSectionInFile(header.connectionOffsetsOffset, nrOfNodes + 1, sizeof(uint32_t), alignof(uint32_t))
+		|| !IsSectionInFile(header.connectionTargetsOffset, nrOfConnections, sizeof(int32_t), alignof(int32_t))
+		|| !IsSectionInFile(header.connectionCostsOffset, nrOfConnections, sizeof(float), alignof(float)))
+		return false;
+
+	// Offsets have to be ascending and every target has to be a node of the graph
+	const GraphCSRView connections = GetConnections();
+	if (connections.pOffsets[0] != 0 || connections.pOffsets[nrOfNodes] != nrOfConnections)
+		return false;
+
+	for (uint64_t idx = 0; idx < nrOfNodes; ++idx)
+	{
+		if (connections.pOffsets[idx] > connections.pOffsets[idx + 1])
+			return false;
+	}
+
+	for (uint64_t connectionIdx = 0; connectionIdx < nrOfConnections; ++connectionIdx)
+	{
+		if (connections.pTargets[connectionIdx] < 0 || connections.pTargets[connectionIdx] >= header.nrOfNodes)
+			return false;
+	}
+
+	return true;
+}
+
+bool Elite::GraphFile::IsSectionInFile(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t alignment) const
+{
+	// Compared without adding anything to the offset, so large values can't overflow
+	const uint64_t size = uint64_t(m_Size);
+	return offset % alignment == 0 && offset <= size && count <= (size - offset) / elementSize;
+}
@@ -0,0 +1,355 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// EGraphFile.h: Versioned binary graph format (node records + CSR adjacency), read back through a memory mapped view
+/*=============================================================================*/
+#pragma once
+
+#include "framework\EliteAI\EliteGraphs\EIGraph.h"
+#include "framework\EliteAI\EliteGraphs\EGridGraph.h"
+#include "framework\EliteAI\EliteGraphs\EGraphNodeTypes.h"
+#include <cstdint>
+
+namespace Elite
+{
+	//--- File layout ---
+	// [GraphFileHeader][GraphFileNode * nrOfNodes][uint32 offsets * (nrOfNodes + 1)][int32 targets * nrOfConnections][float costs * nrOfConnections]
+	// Every section starts at an 8 byte aligned offset stored in the header, all values are little endian
+	const uint32_t GRAPH_FILE_MAGIC = 0x46524745; // "EGRF"
+	const uint32_t GRAPH_FILE_VERSION = 1;
+
+	enum class GraphFileLayout : uint32_t
+	{
+		Graph,
+		Grid
+	};
+
+	enum class GraphFileNodeType : uint32_t
+	{
+		Basic,
+		Node2D,
+		Influence,
+		Terrain,
+		NavGraph
+	};
+
+	struct GraphFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		GraphFileLayout layout;
+		GraphFileNodeType nodeType;
+
+		uint32_t isDirectional;
+		int32_t nrOfNodes;
+		int32_t nrOfConnections;
+
+		// Grid metadata, only valid for GraphFileLayout::Grid
+		uint32_t isConnectedDiagonally;
+		int32_t columns;
+		int32_t rows;
+		int32_t cellSize;
+		float costStraight;
+		float costDiagonal;
+		uint32_t padding;
+
+		uint64_t nodesOffset;
+		uint64_t connectionOffsetsOffset;
+		uint64_t connectionTargetsOffset;
+		uint64_t connectionCostsOffset;
+		uint64_t fileSize;
+	};
+	static_assert(sizeof(GraphFileHeader) == 96, "GraphFileHeader is part of the file format, its size can't change");
+
+	// One record per node, payload and extra depend on the node type (terrain type, navmesh line index), payload is free for node types that need a float
+	struct GraphFileNode
+	{
+		int32_t index;
+		float x;
+		float y;
+		float payload;
+		int32_t extra;
+	};
+	static_assert(sizeof(GraphFileNode) == 20, "GraphFileNode is part of the file format, its size can't change");
+
+	// Read-only adjacency in compressed sparse row form
+	// The connections of node idx are targets/costs [offsets[idx], offsets[idx + 1])
+	struct GraphCSRView
+	{
+		int nrOfNodes = 0;
+		const uint32_t* pOffsets = nullptr;
+		const int32_t* pTargets = nullptr;
+		const float* pCosts = nullptr;
+
+		bool IsValid() const { return pOffsets != nullptr; }
+		int GetNrOfConnections() const { return nrOfNodes > 0 ? int(pOffsets[nrOfNodes]) : 0; }
+		int GetNrOfConnections(int idx) const { return int(pOffsets[idx + 1] - pOffsets[idx]); }
+		int GetFirstConnection(int idx) const { return int(pOffsets[idx]); }
+		int GetTarget(int connectionIdx) const { return pTargets[connectionIdx]; }
+		float GetCost(int connectionIdx) const { return pCosts[connectionIdx]; }
+	};
+
+	// Memory mapped graph file, the views point straight into the mapping and stay valid until Close
+	// Only the CSR kernels (GridFileAStarKernel) search the mapping itself,
+	// code that goes through IGraph gets its own copy with LoadGraphFile
+	class GraphFile final
+	{
+	public:
+		GraphFile() = default;
+		~GraphFile();
+
+		static bool Exists(const std::string& path);
+		bool Open(const std::string& path);
+		void Close();
+		bool IsOpen() const { return m_pData != nullptr; }
+
+		const GraphFileHeader& GetHeader() const { return *reinterpret_cast<const GraphFileHeader*>(m_pData); }
+		const GraphFileNode* GetNodes() const { return reinterpret_cast<const GraphFileNode*>(m_pData + GetHeader().nodesOffset); }
+		GraphCSRView GetConnections() const;
+
+		// Writes the sections and fills in the offsets and size of the header
+		static bool Write(const std::string& path, GraphFileHeader header, const std::vector<GraphFileNode>& nodes,
+			const std::vector<uint32_t>& connectionOffsets, const std::vector<int32_t>& connectionTargets, const std::vector<float>& connectionCosts);
+
+	private:
+		const char* m_pData = nullptr;
+		size_t m_Size = 0;
+
+		void* m_FileHandle = nullptr;
+		void* m_MappingHandle = nullptr;
+		int m_FileDescriptor = -1;
+
+		bool Validate() const;
+		bool IsSectionInFile(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t alignment) const;
+
+		GraphFile(const GraphFile&) = delete;
+		GraphFile& operator=(const GraphFile&) = delete;
+	};
+
+	//--- Node type traits ---
+	template<class T_NodeType>
+	struct GraphFileNodeTraits
+	{
+		static const GraphFileNodeType Type = GraphFileNodeType::Basic;
+		static void Write(const T_NodeType* pNode, GraphFileNode& record) {}
+		static T_NodeType* Create(const GraphFileNode& record) { return new T_NodeType(record.index); }
+	};
+
+	template<>
+	struct GraphFileNodeTraits<GraphNode2D>
+	{
+		static const GraphFileNodeType Type = GraphFileNodeType::Node2D;
+		static void Write(const GraphNode2D* pNode, GraphFileNode& record) {}
+		static GraphNode2D* Create(const GraphFileNode& record) { return new GraphNode2D(record.index, { record.x, record.y }); }
+	};
+
+	template<>
+	struct GraphFileNodeTraits<InfluenceNode>
+	{
+		static const GraphFileNodeType Type = GraphFileNodeType::Influence;
+		// Influence belongs to the InfluenceMap, not to the node, so only the position is stored
+		static void Write(const InfluenceNode* pNode, GraphFileNode& record) {}
+		static InfluenceNode* Create(const GraphFileNode& record) { return new InfluenceNode(record.index, { record.x, record.y }); }
+	};
+
+	template<>
+	struct GraphFileNodeTraits<GridTerrainNode>
+	{
+		static const GraphFileNodeType Type = GraphFileNodeType::Terrain;
+		static void Write(const GridTerrainNode* pNode, GraphFileNode& record) { record.extra = int32_t(pNode->GetTerrainType()); }
+		static GridTerrainNode* Create(const GraphFileNode& record)
+		{
+			auto pNode = new GridTerrainNode(record.index);
+			pNode->SetTerrainType(TerrainType(record.extra));
+			return pNode;
+		}
+	};
+
+	template<>
+	struct GraphFileNodeTraits<NavGraphNode>
+	{
+		static const GraphFileNodeType Type = GraphFileNodeType::NavGraph;
+		static void Write(const NavGraphNode* pNode, GraphFileNode& record) { record.extra = pNode->GetLineIndex(); }
+		static NavGraphNode* Create(const GraphFileNode& record) { return new NavGraphNode(record.index, record.extra, { record.x, record.y }); }
+	};
+
+	//--- Saving & loading ---
+	template<class T_NodeType, class T_ConnectionType>
+	bool WriteGraphFile(const std::string& path, const IGraph<T_NodeType, T_ConnectionType>& graph);
+	template<class T_NodeType, class T_ConnectionType>
+	bool WriteGraphFile(const std::string& path, const GridGraph<T_NodeType, T_ConnectionType>& graph);
+
+	// Rebuilds the nodes and connections of an (empty) graph from the file, in one edit transaction
+	// This copies, it is for code that needs an editable graph (influence maps, the graph editor)
+	// Grid searches don't need it, GridFileAStarKernel runs on the mapping itself
+	template<class T_NodeType, class T_ConnectionType>
+	bool LoadGraphFile(const GraphFile& file, IGraph<T_NodeType, T_ConnectionType>& graph);
+	template<class T_NodeType, class T_ConnectionType>
+	bool LoadGraphFile(const GraphFile& file, GridGraph<T_NodeType, T_ConnectionType>& graph);
+
+	// Level load of an (empty) grid: loads the file when it holds a grid with this layout,
+	// otherwise the grid is initialized and written to the file for the next time. True when it was loaded
+	template<class T_NodeType, class T_ConnectionType>
+	bool LoadOrInitializeGrid(const std::string& path, GridGraph<T_NodeType, T_ConnectionType>& graph,
+		int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally);
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool WriteGraphFile(const std::string& path, const IGraph<T_NodeType, T_ConnectionType>& graph, GraphFileHeader header)
+	{
+		using Traits = GraphFileNodeTraits<T_NodeType>;
+
+		header.nodeType = Traits::Type;
+		header.isDirectional = graph.IsDirectionalGraph() ? 1 : 0;
+		header.nrOfNodes = graph.GetNrOfNodes();
+
+		std::vector<GraphFileNode> nodes(graph.GetNrOfNodes());
+		std::vector<uint32_t> connectionOffsets(graph.GetNrOfNodes() + 1, 0);
+		std::vector<int32_t> connectionTargets{};
+		std::vector<float> connectionCosts{};
+
+		for (int idx = 0; idx < graph.GetNrOfNodes(); ++idx)
+		{
+			const T_NodeType* pNode = graph.GetNode(idx);
+
+			GraphFileNode& record = nodes[idx];
+			record = GraphFileNode{ pNode->GetIndex(), 0.f, 0.f, 0.f, 0 };
+			if (pNode->GetIndex() != invalid_node_index)
+			{
+				const Vector2 worldPos = graph.GetNodeWorldPos(idx);
+				record.x = worldPos.x;
+				record.y = worldPos.y;
+				Traits::Write(pNode, record);
+			}
+
+			connectionOffsets[idx] = uint32_t(connectionTargets.size());
+			for (auto pConnection : graph.GetAllConnections()[idx])
+			{
+				connectionTargets.push_back(pConnection->GetTo());
+				connectionCosts.push_back(pConnection->GetCost());
+			}
+		}
+		connectionOffsets[graph.GetNrOfNodes()] = uint32_t(connectionTargets.size());
+		header.nrOfConnections = int32_t(connectionTargets.size());
+
+		return GraphFile::Write(path, header, nodes, connectionOffsets, connectionTargets, connectionCosts);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool WriteGraphFile(const std::string& path, const IGraph<T_NodeType, T_ConnectionType>& graph)
+	{
+		GraphFileHeader header{};
+		header.layout = GraphFileLayout::Graph;
+
+		return WriteGraphFile(path, graph, header);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool WriteGraphFile(const std::string& path, const GridGraph<T_NodeType, T_ConnectionType>& graph)
+	{
+		GraphFileHeader header{};
+		header.layout = GraphFileLayout::Grid;
+		header.isConnectedDiagonally = graph.IsConnectedDiagonally() ? 1 : 0;
+		header.columns = graph.GetColumns();
+		header.rows = graph.GetRows();
+		header.cellSize = graph.GetCellSize();
+		header.costStraight = graph.GetDefaultCostStraight();
+		header.costDiagonal = graph.GetDefaultCostDiagonal();
+
+		return WriteGraphFile(path, static_cast<const IGraph<T_NodeType, T_ConnectionType>&>(graph), header);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool LoadGraphFile(const GraphFile& file, IGraph<T_NodeType, T_ConnectionType>& graph)
+	{
+		using Traits = GraphFileNodeTraits<T_NodeType>;
+
+		if (!file.IsOpen())
+			return false;
+
+		const GraphFileHeader& header = file.GetHeader();
+		if (header.nodeType != Traits::Type || (header.isDirectional != 0) != graph.IsDirectionalGraph())
+		{
+			printf("WARNING: Graph file doesn't match the type of the graph it is loaded into \n");
+			return false;
+		}
+
+		assert(graph.IsEmpty() && "<LoadGraphFile>: graph has to be empty");
+
+		graph.BeginEdit();
+
+		const GraphFileNode* pNodes = file.GetNodes();
+		for (int idx = 0; idx < header.nrOfNodes; ++idx)
+		{
+			// Removed nodes keep their slot, so the indices of the other nodes stay the same
+			GraphFileNode record = pNodes[idx];
+			const bool isRemoved = record.index == invalid_node_index;
+			record.index = idx;
+
+			graph.AddNode(Traits::Create(record));
+			if (isRemoved)
+				graph.RemoveNode(idx);
+		}
+
+		const GraphCSRView connections = file.GetConnections();
+		for (int from = 0; from < connections.nrOfNodes; ++from)
+		{
+			const int first = connections.GetFirstConnection(from);
+			const int last = first + connections.GetNrOfConnections(from);
+			for (int connectionIdx = first; connectionIdx < last; ++connectionIdx)
+			{
+				const int to = connections.GetTarget(connectionIdx);
+
+				// Undirected graphs add the opposite direction themselves
+				if (graph.IsUniqueConnection(from, to))
+					graph.AddConnection(new T_ConnectionType(from, to, connections.GetCost(connectionIdx)));
+			}
+		}
+
+		graph.EndEdit();
+		return true;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool LoadGraphFile(const GraphFile& file, GridGraph<T_NodeType, T_ConnectionType>& graph)
+	{
+		if (!file.IsOpen())
+			return false;
+
+		const GraphFileHeader& header = file.GetHeader();
+		if (header.layout != GraphFileLayout::Grid || header.columns * header.rows != header.nrOfNodes)
+		{
+			printf("WARNING: Graph file doesn't contain a grid \n");
+			return false;
+		}
+
+		graph.SetGridLayout(header.columns, header.rows, header.cellSize, header.isDirectional != 0,
+			header.isConnectedDiagonally != 0, header.costStraight, header.costDiagonal);
+
+		return LoadGraphFile(file, static_cast<IGraph<T_NodeType, T_ConnectionType>&>(graph));
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool LoadOrInitializeGrid(const std::string& path, GridGraph<T_NodeType, T_ConnectionType>& graph,
+		int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally)
+	{
+		if (GraphFile::Exists(path))
+		{
+			GraphFile file{};
+			if (file.Open(path))
+			{
+				const GraphFileHeader& header = file.GetHeader();
+				const bool hasLayout = header.layout == GraphFileLayout::Grid
+					&& header.columns == columns && header.rows == rows && header.cellSize == cellSize
+					&& (header.isDirectional != 0) == isDirectionalGraph && (header.isConnectedDiagonally != 0) == isConnectedDiagonally;
+
+				if (hasLayout && LoadGraphFile(file, graph))
+					return true;
+			}
+		}
+
+		// The file is closed again, so it can be overwritten
+		graph.InitializeGrid(columns, rows, cellSize, isDirectionalGraph, isConnectedDiagonally);
+		WriteGraphFile(path, graph);
+		return false;
+	}
+}
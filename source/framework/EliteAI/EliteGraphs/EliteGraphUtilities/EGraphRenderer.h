@@ -5,6 +5,7 @@
 #include "framework\EliteAI\EliteGraphs\EGraphConnectionTypes.h"
 #include "framework\EliteAI\EliteGraphs\EGridGraph.h"
 #include "framework\EliteAI\EliteGraphs\EGraph2D.h"
+#include "framework\EliteAI\EliteGraphs\EInfluenceMap.h"
 #include  <type_traits>
 
 namespace Elite 
@@ -21,6 +22,10 @@ namespace Elite
 		template<class T_NodeType, class T_ConnectionType>
 		void RenderGraph(GridGraph<T_NodeType, T_ConnectionType>* pGraph, bool renderNodes, bool renderNodeTxt, bool renderConnections, bool renderConnectionsCosts) const;
 
+		// Colors and influences are read from the node store of the map instead of from the nodes
+		template<class T_NodeType, class T_ConnectionType>
+		void RenderGraph(InfluenceMap<GridGraph<T_NodeType, T_ConnectionType>>* pGraph, bool renderNodes, bool renderNodeTxt, bool renderConnections, bool renderConnectionsCosts) const;
+
 		template<class T_NodeType, class T_ConnectionType>
 		void HighlightNodes(GridGraph<T_NodeType, T_ConnectionType>* pGraph, std::vector<T_NodeType*> path, Color col = HIGHLIGHTED_NODE_COLOR) const;
 
@@ -43,7 +48,7 @@ namespace Elite
 
 		template<class T_NodeType>
 		std::string GetNodeText(T_NodeType* pNode) const;
-		std::string GetNodeText(InfluenceNode* pNode) const;
+		std::string GetNodeText(float value) const;
 
 		template<class T_ConnectionType>
 		std::string GetConnectionText(T_ConnectionType* pConnection) const;
@@ -137,6 +142,38 @@ namespace Elite
 		}
 	}
 
+	template<class T_NodeType, class T_ConnectionType>
+	void GraphRenderer::RenderGraph(
+		InfluenceMap<GridGraph<T_NodeType, T_ConnectionType>>* pGraph,
+		bool renderNodes,
+		bool renderNodeTxt,
+		bool renderConnections,
+		bool renderConnectionsCosts) const
+	{
+		if (renderNodes)
+		{
+			const auto& store = pGraph->GetNodeStore();
+			const float cellSize{ float(pGraph->GetCellSize()) };
+			for (int idx = 0; idx < store.GetSize(); ++idx)
+			{
+				if (!store.IsValid(idx))
+					continue;
+
+				std::string nodeTxt{};
+				if (renderNodeTxt)
+					nodeTxt = GetNodeText(store.GetPayload(idx));
+
+				RenderRectNode(store.GetPosition(idx), nodeTxt, cellSize, store.GetColor(idx), 0.1f);
+			}
+		}
+
+		if (renderConnections)
+		{
+			GridGraph<T_NodeType, T_ConnectionType>* pGrid = pGraph;
+			RenderGraph(pGrid, false, false, true, renderConnectionsCosts);
+		}
+	}
+
 	template<class T_NodeType, class T_ConnectionType>
 	void GraphRenderer::HighlightNodes(GridGraph<T_NodeType, T_ConnectionType>* pGraph, std::vector<T_NodeType*> path, Color col /*= HIGHLIGHTED_NODE_COLOR*/) const
 	{
@@ -188,10 +225,10 @@ namespace Elite
 		return ss.str();
 	}
 
-	inline std::string GraphRenderer::GetNodeText(InfluenceNode* pNode) const
+	inline std::string GraphRenderer::GetNodeText(float value) const
 	{
 		std::stringstream ss;
-		ss << std::fixed << std::setprecision(m_FloatPrintPrecision) << pNode->GetInfluence();
+		ss << std::fixed << std::setprecision(m_FloatPrintPrecision) << value;
 		return ss.str();
 	}
 
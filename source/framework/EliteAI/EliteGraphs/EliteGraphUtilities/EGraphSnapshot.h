@@ -0,0 +1,83 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// EGraphSnapshot.h: Immutable copy of the adjacency and node positions of a graph, safe to search from other threads
+/*=============================================================================*/
+#pragma once
+
+#include "framework\EliteAI\EliteGraphs\EIGraph.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphFile.h"
+#include <memory>
+
+namespace Elite
+{
+	// The snapshot never changes after it is created, so any number of threads can read it while the graph itself keeps being edited.
+	// Node positions are the conceptual positions (GetNodePos), the same ones the heuristics of the graph algorithms use.
+	class GraphSnapshot final
+	{
+	public:
+		template<class T_NodeType, class T_ConnectionType>
+		static std::shared_ptr<const GraphSnapshot> Create(const IGraph<T_NodeType, T_ConnectionType>& graph);
+
+		int GetVersion() const { return m_Version; }
+		int GetNrOfNodes() const { return int(m_NodePositions.size()); }
+		bool IsNodeValid(int idx) const { return idx >= 0 && idx < GetNrOfNodes() && m_IsNodeActive[idx]; }
+		const Vector2& GetNodePos(int idx) const { return m_NodePositions[idx]; }
+
+		GraphCSRView GetConnections() const;
+
+	private:
+		GraphSnapshot() = default;
+
+		int m_Version = 0;
+		std::vector<Vector2> m_NodePositions;
+		std::vector<bool> m_IsNodeActive;
+
+		std::vector<uint32_t> m_ConnectionOffsets;
+		std::vector<int32_t> m_ConnectionTargets;
+		std::vector<float> m_ConnectionCosts;
+	};
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline std::shared_ptr<const GraphSnapshot> GraphSnapshot::Create(const IGraph<T_NodeType, T_ConnectionType>& graph)
+	{
+		std::shared_ptr<GraphSnapshot> pSnapshot{ new GraphSnapshot() };
+
+		const int nrOfNodes = graph.GetNrOfNodes();
+		pSnapshot->m_Version = graph.GetVersion();
+		pSnapshot->m_NodePositions.resize(nrOfNodes);
+		pSnapshot->m_IsNodeActive.resize(nrOfNodes, false);
+		pSnapshot->m_ConnectionOffsets.resize(nrOfNodes + 1, 0);
+
+		for (int idx = 0; idx < nrOfNodes; ++idx)
+		{
+			pSnapshot->m_ConnectionOffsets[idx] = uint32_t(pSnapshot->m_ConnectionTargets.size());
+
+			T_NodeType* pNode = graph.GetNode(idx);
+			if (pNode->GetIndex() == invalid_node_index)
+				continue;
+
+			pSnapshot->m_IsNodeActive[idx] = true;
+			pSnapshot->m_NodePositions[idx] = graph.GetNodePos(pNode);
+
+			for (auto pConnection : graph.GetNodeConnections(idx))
+			{
+				pSnapshot->m_ConnectionTargets.push_back(pConnection->GetTo());
+				pSnapshot->m_ConnectionCosts.push_back(pConnection->GetCost());
+			}
+		}
+		pSnapshot->m_ConnectionOffsets[nrOfNodes] = uint32_t(pSnapshot->m_ConnectionTargets.size());
+
+		return pSnapshot;
+	}
+
+	inline GraphCSRView GraphSnapshot::GetConnections() const
+	{
+		GraphCSRView view{};
+		view.nrOfNodes = GetNrOfNodes();
+		view.pOffsets = m_ConnectionOffsets.data();
+		view.pTargets = m_ConnectionTargets.data();
+		view.pCosts = m_ConnectionCosts.data();
+		return view;
+	}
+}
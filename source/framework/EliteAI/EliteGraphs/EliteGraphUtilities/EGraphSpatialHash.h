@@ -0,0 +1,201 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// EGraphSpatialHash.h: Uniform grid that buckets ids by the cells they cover, used for picking in 2D graphs
+/*=============================================================================*/
+#pragma once
+
+#include <unordered_map>
+
+namespace Elite
+{
+	template<typename T_Id>
+	class SpatialHash final
+	{
+	public:
+		explicit SpatialHash(float cellSize = 10.f) : m_CellSize(cellSize) {}
+
+		// An id is stored in every cell its bounds overlap, removing needs the same bounds it was inserted with
+		void Insert(const T_Id& id, const Vector2& min, const Vector2& max);
+		void Insert(const T_Id& id, const Vector2& pos) { Insert(id, pos, pos); }
+		void Remove(const T_Id& id, const Vector2& min, const Vector2& max);
+		void Remove(const T_Id& id, const Vector2& pos) { Remove(id, pos, pos); }
+
+		// A segment is only stored in the cells it crosses, so long segments cost cells proportional to their length
+		void InsertSegment(const T_Id& id, const Vector2& start, const Vector2& end);
+		void RemoveSegment(const T_Id& id, const Vector2& start, const Vector2& end);
+
+		void Clear() { m_Cells.clear(); }
+
+		// Visits every id stored in the cells overlapping the given bounds
+		// Ids that span several cells can be visited more than once, candidates still need an exact test
+		// Bounds larger than the hash itself (e.g. FLT_MAX as search distance) visit the stored cells instead of every cell in range
+		template<typename T_Visitor>
+		void Query(const Vector2& min, const Vector2& max, T_Visitor visitor) const;
+
+		// Changing the cell size empties the hash, everything has to be inserted again
+		void SetCellSize(float cellSize) { m_CellSize = cellSize; Clear(); }
+		float GetCellSize() const { return m_CellSize; }
+
+	private:
+		using CellKey = unsigned long long;
+
+		float m_CellSize;
+		std::unordered_map<CellKey, std::vector<T_Id>> m_Cells;
+
+		// Clamped, so huge coordinates can't overflow an int
+		static constexpr float m_MaxCellCoordinate{ float(1 << 30) };
+		int GetCellCoordinate(float value) const { return int(Clamp(floorf(value / m_CellSize), -m_MaxCellCoordinate, m_MaxCellCoordinate)); }
+		CellKey GetCellKey(int x, int y) const { return (CellKey(static_cast<unsigned int>(x)) << 32) | CellKey(static_cast<unsigned int>(y)); }
+		int GetCellX(CellKey key) const { return int(static_cast<unsigned int>(key >> 32)); }
+		int GetCellY(CellKey key) const { return int(static_cast<unsigned int>(key)); }
+
+		void InsertInCell(const T_Id& id, int x, int y) { m_Cells[GetCellKey(x, y)].push_back(id); }
+		void RemoveFromCell(const T_Id& id, int x, int y);
+
+		// Visits the cells from the cell of start to the cell of end, every step moves to a cell sharing a side
+		template<typename T_Visitor>
+		void VisitSegmentCells(const Vector2& start, const Vector2& end, T_Visitor visitor) const;
+	};
+
+	template<typename T_Id>
+	inline void SpatialHash<T_Id>::Insert(const T_Id& id, const Vector2& min, const Vector2& max)
+	{
+		const int maxX = GetCellCoordinate(max.x);
+		const int maxY = GetCellCoordinate(max.y);
+
+		for (int y = GetCellCoordinate(min.y); y <= maxY; ++y)
+		{
+			for (int x = GetCellCoordinate(min.x); x <= maxX; ++x)
+			{
+				InsertInCell(id, x, y);
+			}
+		}
+	}
+
+	template<typename T_Id>
+	inline void SpatialHash<T_Id>::Remove(const T_Id& id, const Vector2& min, const Vector2& max)
+	{
+		const int maxX = GetCellCoordinate(max.x);
+		const int maxY = GetCellCoordinate(max.y);
+
+		for (int y = GetCellCoordinate(min.y); y <= maxY; ++y)
+		{
+			for (int x = GetCellCoordinate(min.x); x <= maxX; ++x)
+			{
+				RemoveFromCell(id, x, y);
+			}
+		}
+	}
+
+	template<typename T_Id>
+	inline void SpatialHash<T_Id>::InsertSegment(const T_Id& id, const Vector2& start, const Vector2& end)
+	{
+		VisitSegmentCells(start, end, [this, &id](int x, int y) { InsertInCell(id, x, y); });
+	}
+
+	template<typename T_Id>
+	inline void SpatialHash<T_Id>::RemoveSegment(const T_Id& id, const Vector2& start, const Vector2& end)
+	{
+		VisitSegmentCells(start, end, [this, &id](int x, int y) { RemoveFromCell(id, x, y); });
+	}
+
+	template<typename T_Id>
+	inline void SpatialHash<T_Id>::RemoveFromCell(const T_Id& id, int x, int y)
+	{
+		auto cellIt = m_Cells.find(GetCellKey(x, y));
+		if (cellIt == m_Cells.end())
+			return;
+
+		auto& ids = cellIt->second;
+		auto idIt = std::find(ids.begin(), ids.end(), id);
+		if (idIt != ids.end())
+		{
+			*idIt = ids.back();
+			ids.pop_back();
+		}
+
+		if (ids.empty())
+			m_Cells.erase(cellIt);
+	}
+
+	template<typename T_Id>
+	template<typename T_Visitor>
+	inline void SpatialHash<T_Id>::VisitSegmentCells(const Vector2& start, const Vector2& end, T_Visitor visitor) const
+	{
+		// Amanatides & Woo: step to whichever cell border the segment reaches first
+		// Once one axis reached the cell of end, only the other one steps, so it always ends in that cell
+		int x = GetCellCoordinate(start.x);
+		int y = GetCellCoordinate(start.y);
+		const int endX = GetCellCoordinate(end.x);
+		const int endY = GetCellCoordinate(end.y);
+
+		const Vector2 direction{ end - start };
+		const int stepX = (endX > x) ? 1 : -1;
+		const int stepY = (endY > y) ? 1 : -1;
+
+		// Segment parameter at which the next vertical/horizontal cell border is crossed
+		const float inf = (std::numeric_limits<float>::max)();
+		float tMaxX = (endX != x) ? ((x + (stepX > 0 ? 1 : 0)) * m_CellSize - start.x) / direction.x : inf;
+		float tMaxY = (endY != y) ? ((y + (stepY > 0 ? 1 : 0)) * m_CellSize - start.y) / direction.y : inf;
+		const float tDeltaX = (endX != x) ? m_CellSize / abs(direction.x) : inf;
+		const float tDeltaY = (endY != y) ? m_CellSize / abs(direction.y) : inf;
+
+		visitor(x, y);
+		while (x != endX || y != endY)
+		{
+			if (y == endY || (x != endX && tMaxX < tMaxY))
+			{
+				x += stepX;
+				tMaxX += tDeltaX;
+			}
+			else
+			{
+				y += stepY;
+				tMaxY += tDeltaY;
+			}
+
+			visitor(x, y);
+		}
+	}
+
+	template<typename T_Id>
+	template<typename T_Visitor>
+	inline void SpatialHash<T_Id>::Query(const Vector2& min, const Vector2& max, T_Visitor visitor) const
+	{
+		const int minX = GetCellCoordinate(min.x);
+		const int minY = GetCellCoordinate(min.y);
+		const int maxX = GetCellCoordinate(max.x);
+		const int maxY = GetCellCoordinate(max.y);
+
+		// Counted in 64 bit, the range can hold more cells than an int can count
+		const long long nrOfCellsInRange = (static_cast<long long>(maxX) - minX + 1) * (static_cast<long long>(maxY) - minY + 1);
+		if (nrOfCellsInRange > static_cast<long long>(m_Cells.size()))
+		{
+			for (const auto& cell : m_Cells)
+			{
+				const int x = GetCellX(cell.first);
+				const int y = GetCellY(cell.first);
+				if (x < minX || x > maxX || y < minY || y > maxY)
+					continue;
+
+				for (const auto& id : cell.second)
+					visitor(id);
+			}
+			return;
+		}
+
+		for (int y = minY; y <= maxY; ++y)
+		{
+			for (int x = minX; x <= maxX; ++x)
+			{
+				auto cellIt = m_Cells.find(GetCellKey(x, y));
+				if (cellIt == m_Cells.end())
+					continue;
+
+				for (const auto& id : cellIt->second)
+					visitor(id);
+			}
+		}
+	}
+}
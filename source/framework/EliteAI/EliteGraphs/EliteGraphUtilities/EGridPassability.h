@@ -0,0 +1,117 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// EGridPassability.h: One bit per cell of a grid for the cells that can be walked through, with a line of sight test over the cells
+/*=============================================================================*/
+#pragma once
+
+#include "framework\EliteAI\EliteGraphs\EGridGraph.h"
+
+namespace Elite
+{
+	// Blocked cells are the ones without connections, the way the editor and the influence map block cells.
+	// The bits only keep the layout of the grid, so line of sight tests don't touch the nodes or connection lists.
+	class GridPassability final
+	{
+	public:
+		GridPassability() = default;
+
+		template<class T_NodeType, class T_ConnectionType>
+		void Build(const GridGraph<T_NodeType, T_ConnectionType>& grid);
+		// True when the bits were built on the current version of the grid
+		template<class T_NodeType, class T_ConnectionType>
+		bool IsUpToDate(const GridGraph<T_NodeType, T_ConnectionType>& grid) const { return m_GraphVersion == grid.GetVersion() && m_Columns * m_Rows == grid.GetNrOfNodes(); }
+
+		// Cells outside of the grid are blocked
+		bool IsPassable(int col, int row) const;
+		bool IsPassable(int idx) const { return (m_Bits[idx >> 6] >> (idx & 63)) & 1; }
+
+		// Walks every cell the segment between the cell centers touches (supercover), a segment through a corner needs both cells next to the corner
+		bool HasLineOfSight(int fromIdx, int toIdx) const;
+
+		int GetColumns() const { return m_Columns; }
+		int GetRows() const { return m_Rows; }
+		int GetGraphVersion() const { return m_GraphVersion; }
+
+	private:
+		int m_Columns = 0;
+		int m_Rows = 0;
+		int m_GraphVersion = -1;
+
+		// 64 cells per word, in index order
+		std::vector<uint64_t> m_Bits;
+	};
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void GridPassability::Build(const GridGraph<T_NodeType, T_ConnectionType>& grid)
+	{
+		m_Columns = grid.GetColumns();
+		m_Rows = grid.GetRows();
+		m_GraphVersion = grid.GetVersion();
+
+		const int nrOfCells{ grid.GetNrOfNodes() };
+		m_Bits.assign((nrOfCells + 63) / 64, 0);
+
+		for (int idx{}; idx < nrOfCells; ++idx)
+		{
+			if (grid.GetNode(idx)->GetIndex() != invalid_node_index && grid.GetNodeConnections(idx).empty() == false)
+				m_Bits[idx >> 6] |= uint64_t(1) << (idx & 63);
+		}
+	}
+
+	inline bool GridPassability::IsPassable(int col, int row) const
+	{
+		if (col < 0 || row < 0 || col >= m_Columns || row >= m_Rows)
+			return false;
+
+		return IsPassable(row * m_Columns + col);
+	}
+
+	inline bool GridPassability::HasLineOfSight(int fromIdx, int toIdx) const
+	{
+		int col{ fromIdx % m_Columns };
+		int row{ fromIdx / m_Columns };
+		const int toCol{ toIdx % m_Columns };
+		const int toRow{ toIdx / m_Columns };
+
+		const int colStep{ toCol > col ? 1 : -1 };
+		const int rowStep{ toRow > row ? 1 : -1 };
+		const int nrOfCols{ abs(toCol - col) };
+		const int nrOfRows{ abs(toRow - row) };
+
+		if (!IsPassable(col, row))
+			return false;
+
+		// The error tells which cell border the segment crosses first, in units of half a cell
+		int error{ nrOfCols - nrOfRows };
+		for (int nrOfSteps{ nrOfCols + nrOfRows }; nrOfSteps > 0; --nrOfSteps)
+		{
+			if (error > 0)
+			{
+				col += colStep;
+				error -= 2 * nrOfRows;
+			}
+			else if (error < 0)
+			{
+				row += rowStep;
+				error += 2 * nrOfCols;
+			}
+			else
+			{
+				// Exactly through the corner, both cells next to it get touched and the step counts for a column and a row
+				if (!IsPassable(col + colStep, row) || !IsPassable(col, row + rowStep))
+					return false;
+
+				col += colStep;
+				row += rowStep;
+				error += 2 * (nrOfCols - nrOfRows);
+				--nrOfSteps;
+			}
+
+			if (!IsPassable(col, row))
+				return false;
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,129 @@
+#include "stdafx.h"
+#include "EPathCache.h"
+
+using namespace Elite;
+
+bool Elite::PathCache::Find(int startIdx, int destinationIdx, Heuristic hFunction, int graphVersion, std::vector<int>& path)
+{
+	SetGraphVersion(graphVersion);
+	++m_Stats.nrOfLookups;
+
+	auto lookupIt = m_EntryLookup.find(GetKey(startIdx, destinationIdx, hFunction));
+	if (lookupIt != m_EntryLookup.end())
+	{
+		Touch(lookupIt->second);
+
+		path = lookupIt->second->path;
+		++m_Stats.nrOfHits;
+		m_Stats.timeSaved += lookupIt->second->searchTime;
+		return true;
+	}
+
+	// Look for the start on the cached paths towards the same destination, found with the same heuristic
+	auto pathNodeIt = m_PathNodeLookup.find(GetKey(startIdx, destinationIdx, hFunction));
+	if (pathNodeIt == m_PathNodeLookup.end())
+		return false;
+
+	// The most recently added path through the start
+	const PathNode& pathNode = pathNodeIt->second.back();
+	const std::vector<int>& cachedPath = pathNode.entryIt->path;
+	Touch(pathNode.entryIt);
+
+	path.assign(cachedPath.begin() + pathNode.position, cachedPath.end());
+	++m_Stats.nrOfSuffixHits;
+	m_Stats.timeSaved += pathNode.entryIt->searchTime * float(path.size()) / float(cachedPath.size());
+	return true;
+}
+
+void Elite::PathCache::Insert(int startIdx, int destinationIdx, Heuristic hFunction, int graphVersion, const std::vector<int>& path, float searchTime)
+{
+	// A path that was solved on an older version of the graph might not be valid anymore
+	if (graphVersion < m_GraphVersion)
+		return;
+
+	SetGraphVersion(graphVersion);
+	if (m_Capacity == 0)
+		return;
+
+	assert((path.empty() || (path.front() == startIdx && path.back() == destinationIdx)) && "<PathCache::Insert>: path doesn't match its start and destination");
+
+	const EntryKey key = GetKey(startIdx, destinationIdx, hFunction);
+	auto lookupIt = m_EntryLookup.find(key);
+	if (lookupIt != m_EntryLookup.end())
+	{
+		// Same query solved again, keep the newest result
+		RemovePathNodes(lookupIt->second);
+		lookupIt->second->path = path;
+		lookupIt->second->searchTime = searchTime;
+		AddPathNodes(lookupIt->second);
+		Touch(lookupIt->second);
+		return;
+	}
+
+	while (m_Entries.size() >= m_Capacity)
+		Evict();
+
+	m_Entries.push_front(Entry{ startIdx, destinationIdx, hFunction, path, searchTime });
+	m_EntryLookup[key] = m_Entries.begin();
+	AddPathNodes(m_Entries.begin());
+}
+
+void Elite::PathCache::Clear()
+{
+	m_Entries.clear();
+	m_EntryLookup.clear();
+	m_PathNodeLookup.clear();
+}
+
+void Elite::PathCache::SetCapacity(size_t capacity)
+{
+	m_Capacity = capacity;
+	while (m_Entries.size() > m_Capacity)
+		Evict();
+}
+
+void Elite::PathCache::SetGraphVersion(int graphVersion)
+{
+	if (graphVersion == m_GraphVersion)
+		return;
+
+	m_Stats.nrOfInvalidations += int(m_Entries.size());
+	m_GraphVersion = graphVersion;
+	Clear();
+}
+
+void Elite::PathCache::Evict()
+{
+	// Least recently used entry is at the back
+	auto entryIt = std::prev(m_Entries.end());
+
+	m_EntryLookup.erase(GetKey(entryIt->startIdx, entryIt->destinationIdx, entryIt->heuristicFunction));
+	RemovePathNodes(entryIt);
+
+	m_Entries.erase(entryIt);
+	++m_Stats.nrOfEvictions;
+}
+
+void Elite::PathCache::AddPathNodes(EntryList::iterator entryIt)
+{
+	for (size_t position = 0; position < entryIt->path.size(); ++position)
+	{
+		const EntryKey key = GetKey(entryIt->path[position], entryIt->destinationIdx, entryIt->heuristicFunction);
+		m_PathNodeLookup[key].push_back(PathNode{ entryIt, int(position) });
+	}
+}
+
+void Elite::PathCache::RemovePathNodes(EntryList::iterator entryIt)
+{
+	for (int nodeIdx : entryIt->path)
+	{
+		auto pathNodeIt = m_PathNodeLookup.find(GetKey(nodeIdx, entryIt->destinationIdx, entryIt->heuristicFunction));
+		if (pathNodeIt == m_PathNodeLookup.end())
+			continue;
+
+		auto& pathNodes = pathNodeIt->second;
+		pathNodes.erase(std::remove_if(pathNodes.begin(), pathNodes.end(), [entryIt](const PathNode& pathNode) { return pathNode.entryIt == entryIt; }), pathNodes.end());
+		if (pathNodes.empty())
+			m_PathNodeLookup.erase(pathNodeIt);
+	}
+}
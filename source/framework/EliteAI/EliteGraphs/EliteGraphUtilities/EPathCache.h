@@ -0,0 +1,99 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// EPathCache.h: LRU cache of solved paths for one graph, keyed by start, destination, heuristic and graph version
+/*=============================================================================*/
+#pragma once
+
+#include "framework/EliteAI/EliteNavigation/ENavigation.h"
+#include <list>
+#include <unordered_map>
+
+namespace Elite
+{
+	struct PathCacheStats
+	{
+		int nrOfLookups = 0;
+		int nrOfHits = 0; // same start and destination
+		int nrOfSuffixHits = 0; // start lies on a cached path towards the same destination
+		int nrOfEvictions = 0;
+		int nrOfInvalidations = 0; // entries dropped because the graph version changed
+		float timeSaved = 0.f; // in ms, search time of the cached paths (the part that was reused for suffix hits)
+
+		float GetHitRate() const { return nrOfLookups > 0 ? float(nrOfHits + nrOfSuffixHits) / nrOfLookups : 0.f; }
+	};
+
+	// Paths are stored as node indices, so the cache doesn't depend on the node type.
+	// Every path of a shortest path is a shortest path itself, so the part of a cached path after the start can answer a new query towards the same destination.
+	// A lookup or insert with another graph version than the cached entries drops all of them, a cache only serves one graph.
+	// The heuristic is part of the key: an inadmissible heuristic finds other (longer) paths, so paths are only reused for the heuristic that found them.
+	class PathCache final
+	{
+	public:
+		explicit PathCache(size_t capacity = 256) : m_Capacity(capacity) {}
+
+		// Fills the node indices from start to destination and returns true on a hit
+		bool Find(int startIdx, int destinationIdx, Heuristic hFunction, int graphVersion, std::vector<int>& path);
+
+		// Paths have to start at startIdx and end at destinationIdx (or be empty when there is no path), paths of an older graph version are ignored
+		// The search time is only used to count the time saved by later hits
+		void Insert(int startIdx, int destinationIdx, Heuristic hFunction, int graphVersion, const std::vector<int>& path, float searchTime = 0.f);
+
+		void Clear();
+		void SetCapacity(size_t capacity);
+
+		size_t GetCapacity() const { return m_Capacity; }
+		size_t GetSize() const { return m_Entries.size(); }
+		const PathCacheStats& GetStats() const { return m_Stats; }
+		void ResetStats() { m_Stats = PathCacheStats{}; }
+
+	private:
+		struct Entry
+		{
+			int startIdx;
+			int destinationIdx;
+			Heuristic heuristicFunction;
+			std::vector<int> path;
+			float searchTime;
+		};
+		using EntryList = std::list<Entry>;
+
+		struct EntryKey
+		{
+			uint64_t nodes; // start and destination
+			Heuristic heuristicFunction;
+
+			bool operator==(const EntryKey& other) const { return nodes == other.nodes && heuristicFunction == other.heuristicFunction; }
+		};
+		struct EntryKeyHash
+		{
+			size_t operator()(const EntryKey& key) const { return std::hash<uint64_t>()(key.nodes) ^ (std::hash<Heuristic>()(key.heuristicFunction) << 1); }
+		};
+
+		static EntryKey GetKey(int startIdx, int destinationIdx, Heuristic hFunction) { return EntryKey{ (uint64_t(uint32_t(startIdx)) << 32) | uint32_t(destinationIdx), hFunction }; }
+
+		void SetGraphVersion(int graphVersion);
+		void Touch(EntryList::iterator entryIt) { m_Entries.splice(m_Entries.begin(), m_Entries, entryIt); }
+		void Evict();
+		void AddPathNodes(EntryList::iterator entryIt);
+		void RemovePathNodes(EntryList::iterator entryIt);
+
+		size_t m_Capacity;
+		int m_GraphVersion = -1;
+
+		// Most recently used first
+		EntryList m_Entries;
+		std::unordered_map<EntryKey, EntryList::iterator, EntryKeyHash> m_EntryLookup;
+
+		// Every node of every cached path, keyed like an entry with the node as start: the entries that pass through it and where
+		// A shortest path visits a node only once, so a suffix lookup is one hash lookup
+		struct PathNode
+		{
+			EntryList::iterator entryIt;
+			int position;
+		};
+		std::unordered_map<EntryKey, std::vector<PathNode>, EntryKeyHash> m_PathNodeLookup;
+
+		PathCacheStats m_Stats{};
+	};
+}
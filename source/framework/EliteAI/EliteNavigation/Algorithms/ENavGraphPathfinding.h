@@ -3,15 +3,85 @@
 #include <iostream>
 #include "framework/EliteMath/EMath.h"
 #include "framework\EliteAI\EliteGraphs\ENavGraph.h"
+#include "framework\EliteAI\EliteGraphs\EOverlayGraph.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStar.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStarKernel.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EBFS.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\ELandmarks.h"
 
 namespace Elite
 {
+	// Searches a NavGraph with the NavGraphAStarKernel, the snapshot of the graph is kept until the graph changes
+	class NavGraphAStar final
+	{
+	public:
+		NavGraphAStar() = default;
+
+		NavGraphAStar(const NavGraphAStar&) = delete;
+		NavGraphAStar& operator=(const NavGraphAStar&) = delete;
+
+		// Between two nodes of the graph
+		bool FindPath(const NavGraph* pNavGraph, int startIdx, int goalIdx, std::vector<int>& path)
+		{
+			Update(pNavGraph);
+			m_Overlay.Clear();
+			return m_Kernel.FindPath(startIdx, goalIdx, path);
+		}
+
+		// Between two positions, connected to the given nodes (e.g. the nodes of the triangle they are in)
+		// The path starts with the index of the start position and ends with the index of the end position, both only exist in this search
+		bool FindPath(const NavGraph* pNavGraph, const Vector2& startPos, const std::vector<int>& startNodes, const Vector2& endPos, const std::vector<int>& endNodes, std::vector<int>& path)
+		{
+			Update(pNavGraph);
+			m_Overlay.Clear();
+
+			const int startIdx{ m_Overlay.AddNode(GetConnections(startPos, startNodes)) };
+			m_Kernel.GetHeuristic().SetNodePos(startIdx, startPos);
+			const int endIdx{ m_Overlay.AddNode(GetConnections(endPos, endNodes)) };
+			m_Kernel.GetHeuristic().SetNodePos(endIdx, endPos);
+
+			return m_Kernel.FindPath(startIdx, endIdx, path);
+		}
+
+		int GetNrOfExpandedNodes() const { return m_Kernel.GetNrOfExpandedNodes(); }
+
+	private:
+		void Update(const NavGraph* pNavGraph)
+		{
+			if (m_pNavGraph == pNavGraph && m_pSnapshot != nullptr && m_pSnapshot->GetVersion() == pNavGraph->GetVersion())
+				return;
+
+			m_pNavGraph = pNavGraph;
+			m_pSnapshot = GraphSnapshot::Create(*pNavGraph);
+			m_Neighbors = CSRNeighbors{ m_pSnapshot->GetConnections() };
+			m_Overlay.SetBase(&m_Neighbors);
+			m_Kernel.GetHeuristic() = PositionHeuristic<EuclideanDistance>{ *m_pSnapshot };
+		}
+
+		std::vector<std::pair<int, float>> GetConnections(const Vector2& pos, const std::vector<int>& nodes) const
+		{
+			std::vector<std::pair<int, float>> connections{};
+			for (const int nodeIdx : nodes)
+				connections.push_back({ nodeIdx, Distance(pos, m_pSnapshot->GetNodePos(nodeIdx)) });
+			return connections;
+		}
+
+		const NavGraph* m_pNavGraph = nullptr;
+		std::shared_ptr<const GraphSnapshot> m_pSnapshot{};
+		CSRNeighbors m_Neighbors{};
+		OverlayNeighbors<CSRNeighbors> m_Overlay{ &m_Neighbors };
+		NavGraphAStarKernel m_Kernel{ &m_Overlay, PositionHeuristic<EuclideanDistance>{} };
+	};
+
 	class NavMeshPathfinding
 	{
 	public:
-		static std::vector<Vector2> FindPath(Vector2 startPos, Vector2 endPos, NavGraph* pNavGraph, std::vector<Vector2>& debugNodePositions, std::vector<Portal>& debugPortals)
+		// pLandmarks is optional, when given its tables are brought up to date and the runtime AStar uses them on top of the distance heuristic
+		// pStartTriangleHint is optional, the start triangle is searched from there (e.g. the triangle the agent is tracked in)
+		// A start or end position off the mesh (e.g. in the margin around a collider) snaps to the closest node within maxSnapDistance
+		// pSearch is optional, it keeps the snapshot of the graph for the next queries, otherwise one is made for this query
+		static std::vector<Vector2> FindPath(Vector2 startPos, Vector2 endPos, NavGraph* pNavGraph, std::vector<Vector2>& debugNodePositions, std::vector<Portal>& debugPortals,
+			LandmarkHeuristic<NavGraphNode, GraphConnection2D>* pLandmarks = nullptr, const Triangle* pStartTriangleHint = nullptr, float maxSnapDistance = 0.f, NavGraphAStar* pSearch = nullptr)
 		{
 			//Create the path to return
 			std::vector<Vector2> finalPath{};
@@ -19,8 +89,8 @@ namespace Elite
 			//Get the start and endTriangle
 			Elite::Polygon* pNavMeshPolygon { pNavGraph->GetNavMeshPolygon() };
 
-			const Triangle* pStartTriangle{ pNavMeshPolygon->GetTriangleFromPosition(startPos) };
-			const Triangle* pEndTriangle{ pNavMeshPolygon->GetTriangleFromPosition(endPos) };
+			const Triangle* pStartTriangle{ GetTriangleOrSnap(startPos, pNavGraph, pStartTriangleHint, maxSnapDistance) };
+			const Triangle* pEndTriangle{ GetTriangleOrSnap(endPos, pNavGraph, nullptr, maxSnapDistance) };
 
 			//We have valid start/end triangles and they are not the same
 			const bool trianglesDontExist{ pStartTriangle == nullptr || pEndTriangle == nullptr };
@@ -31,45 +101,65 @@ namespace Elite
 			}
 			
 			//=> Start looking for a path
-			//Copy the graph
-			auto clonedGraph{ pNavGraph->Clone() };
-			
-			//Create extra node for the Start Node (Agent's position
-			NavGraphNode* pStartNode = new NavGraphNode{ clonedGraph->GetNextFreeNodeIndex(),-1,startPos };
-			clonedGraph->AddNode(pStartNode);
-			
-			std::vector<int> nodeIdxVector{};
+			//The start and end node are connected to the nodes on the lines of their triangle
+			const std::vector<int> startNodes{ GetTriangleNodes(pStartTriangle, pNavGraph) };
+			const std::vector<int> endNodes{ GetTriangleNodes(pEndTriangle, pNavGraph) };
 
-			// Loop over lineIdx to get all the available graphNodes
-			for (const auto& lineIdx : pStartTriangle->metaData.IndexLines)
+			//Only their positions are used for the portals, the nodes in between are the nodes of the graph
+			NavGraphNode startNode{ invalid_node_index, -1, startPos };
+			NavGraphNode endNode{ invalid_node_index, -1, endPos };
+
+			// Store nodes in vector for the portals
+			std::vector<NavGraphNode*> nodeVector{};
+
+			if (pLandmarks)
 			{
-				int nodeIdx{ pNavGraph->GetNodeIdxFromLineIdx(lineIdx) };
-				if (nodeIdx != invalid_node_index)
+				nodeVector = FindNodePathWithLandmarks(pNavGraph, startNode, startNodes, endNode, endNodes, pLandmarks);
+			}
+			else
+			{
+				//Run the kernel on the snapshot of the graph
+				NavGraphAStar localSearch{};
+				NavGraphAStar& search{ pSearch ? *pSearch : localSearch };
+
+				std::vector<int> path{};
+				if (search.FindPath(pNavGraph, startPos, startNodes, endPos, endNodes, path))
 				{
-					nodeIdxVector.push_back(nodeIdx);
+					nodeVector.push_back(&startNode);
+					for (size_t i{ 1 }; i + 1 < path.size(); ++i)
+						nodeVector.push_back(pNavGraph->GetNode(path[i]));
+					nodeVector.push_back(&endNode);
 				}
 			}
 
-			// Create connections from startNode to graphNodes
-			for (const int index : nodeIdxVector)
+			if (nodeVector.empty())
+				return {};
+
+			for (const auto& node : nodeVector)
 			{
-				GraphConnection2D* pNewGraphConnection = new GraphConnection2D{ pStartNode->GetIndex(),index };
+				finalPath.push_back(node->GetPosition());
+			}
 
-				// Set cost to distance between nodes
-				pNewGraphConnection->SetCost(abs(Distance(pStartNode->GetPosition(), clonedGraph->GetNode(index)->GetPosition())));
+			//OPTIONAL BUT ADVICED: Debug Visualisation
+			debugNodePositions = finalPath;
 
-				clonedGraph->AddConnection(pNewGraphConnection);
-			}
+			//Run optimiser on new graph, MAKE SURE the A star path is working properly before starting this section and uncommenting this!!!
+			auto portals = SSFA::FindPortals(nodeVector, pNavMeshPolygon);
+			finalPath = SSFA::OptimizePortals(portals);
 
+			//OPTIONAL BUT ADVICED: Debug Visualisation
+			debugPortals = portals;
 
-			//Create extra node for the endNode
-			NavGraphNode* pEndNode = new NavGraphNode{ clonedGraph->GetNextFreeNodeIndex(),-1,endPos };
-			clonedGraph->AddNode(pEndNode);
+			return finalPath;
+		}
 
-			nodeIdxVector.clear();
+	private:
+		static std::vector<int> GetTriangleNodes(const Triangle* pTriangle, const NavGraph* pNavGraph)
+		{
+			std::vector<int> nodeIdxVector{};
 
 			// Loop over lineIdx to get all the available graphNodes
-			for (const auto& lineIdx : pEndTriangle->metaData.IndexLines)
+			for (const auto& lineIdx : pTriangle->metaData.IndexLines)
 			{
 				int nodeIdx{ pNavGraph->GetNodeIdxFromLineIdx(lineIdx) };
 				if (nodeIdx != invalid_node_index)
@@ -78,42 +168,82 @@ namespace Elite
 				}
 			}
 
-			// Create connections from endNode to graphNodes
-			for (const int index : nodeIdxVector)
+			return nodeIdxVector;
+		}
+
+		// The landmark tables are made for the runtime AStar, it runs on the graph with the start and end node layered on top
+		static std::vector<NavGraphNode*> FindNodePathWithLandmarks(NavGraph* pNavGraph, NavGraphNode& startNode, const std::vector<int>& startNodes, NavGraphNode& endNode, const std::vector<int>& endNodes,
+			LandmarkHeuristic<NavGraphNode, GraphConnection2D>* pLandmarks)
+		{
+			//Layer the start and end node on top of the graph, instead of copying it
+			OverlayGraph<NavGraphNode, GraphConnection2D> overlayGraph{ pNavGraph };
+
+			NavGraphNode* pStartNode = new NavGraphNode{ overlayGraph.GetNextFreeNodeIndex(),-1,startNode.GetPosition() };
+			overlayGraph.AddNode(pStartNode);
+			for (const int index : startNodes)
+			{
+				GraphConnection2D* pNewGraphConnection = new GraphConnection2D{ pStartNode->GetIndex(),index };
+
+				// Set cost to distance between nodes
+				pNewGraphConnection->SetCost(abs(Distance(pStartNode->GetPosition(), overlayGraph.GetNode(index)->GetPosition())));
+
+				overlayGraph.AddConnection(pNewGraphConnection);
+			}
+
+			NavGraphNode* pEndNode = new NavGraphNode{ overlayGraph.GetNextFreeNodeIndex(),-1,endNode.GetPosition() };
+			overlayGraph.AddNode(pEndNode);
+			for (const int index : endNodes)
 			{
 				GraphConnection2D* pNewGraphConnection = new GraphConnection2D{ pEndNode->GetIndex(),index };
 
 				// Set cost to distance between nodes
-				pNewGraphConnection->SetCost(abs(Distance(pEndNode->GetPosition(), clonedGraph->GetNode(index)->GetPosition())));
+				pNewGraphConnection->SetCost(abs(Distance(pEndNode->GetPosition(), overlayGraph.GetNode(index)->GetPosition())));
 
-				clonedGraph->AddConnection(pNewGraphConnection);
+				overlayGraph.AddConnection(pNewGraphConnection);
 			}
-			
+
 			//Run A star on new graph
 			const Elite::Heuristic heuristic{ HeuristicFunctions::Chebyshev };
-			auto pathFinder = AStar<NavGraphNode, GraphConnection2D>(clonedGraph.get(), heuristic);
-			
-			// Store nodes in vector for the portals
-			std::vector<NavGraphNode*> nodeVector{};
+			auto pathFinder = AStar<NavGraphNode, GraphConnection2D, OverlayGraph<NavGraphNode, GraphConnection2D>>(&overlayGraph, heuristic);
 
-			const auto AStarPath = pathFinder.FindPath(pStartNode, pEndNode);
-			for (const auto& node : AStarPath)
+			//The start and end node only exist in the overlay, the landmark tables reach them through the nodes of their triangle
+			pLandmarks->Update();
+			for (const NavGraphNode* pNode : { pStartNode, pEndNode })
 			{
-				finalPath.push_back(node->GetPosition());
-				nodeVector.push_back(node);
+				std::vector<std::pair<int, float>> connections{};
+				for (const auto pConnection : overlayGraph.GetNodeConnections(pNode->GetIndex()))
+					connections.push_back({ pConnection->GetTo(), pConnection->GetCost() });
+				pLandmarks->SetVirtualNode(pNode->GetIndex(), connections);
 			}
+			pathFinder.SetNodeHeuristic(pLandmarks->GetNodeHeuristic());
 
-			//OPTIONAL BUT ADVICED: Debug Visualisation
-			debugNodePositions = finalPath;
-
-			//Run optimiser on new graph, MAKE SURE the A star path is working properly before starting this section and uncommenting this!!!
-			auto portals = SSFA::FindPortals(nodeVector, pNavMeshPolygon);
-			finalPath = SSFA::OptimizePortals(portals);
+			auto nodePath = pathFinder.FindPath(pStartNode, pEndNode);
+			pLandmarks->ClearVirtualNodes();
 
-			//OPTIONAL BUT ADVICED: Debug Visualisation
-			debugPortals = portals;
+			//The overlay nodes are deleted with the overlay, the caller's nodes take their place
+			if (nodePath.empty() == false)
+			{
+				nodePath.front() = &startNode;
+				nodePath.back() = &endNode;
+			}
+			return nodePath;
+		}
 
-			return finalPath;
+		// The node sits in the middle of a line between two triangles, so it lies on the mesh, pos is moved onto it
+		static const Triangle* GetTriangleOrSnap(Vector2& pos, NavGraph* pNavGraph, const Triangle* pHint, float maxSnapDistance)
+		{
+			const Polygon* pNavMeshPolygon{ pNavGraph->GetNavMeshPolygon() };
+			const Triangle* pTriangle{ pNavMeshPolygon->GetTriangleFromPosition(pos, pHint) };
+			if (pTriangle != nullptr || maxSnapDistance <= 0.f)
+				return pTriangle;
+
+			const int closestNodeIdx{ pNavGraph->GetClosestNodeIdx(pos, maxSnapDistance) };
+			if (closestNodeIdx == invalid_node_index)
+				return nullptr;
+
+			pos = pNavGraph->GetNode(closestNodeIdx)->GetPosition();
+			const auto lineTriangles{ pNavMeshPolygon->GetTrianglesFromLineIndex(pNavGraph->GetLineIdxFromNodeIdx(closestNodeIdx)) };
+			return lineTriangles.empty() ? nullptr : lineTriangles[0];
 		}
 	};
 }
@@ -3,6 +3,7 @@
 #include <vector>
 #include "framework/EliteGeometry/EGeometry2DTypes.h"
 #include "framework/EliteAI/EliteGraphs/EGraphNodeTypes.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphUtilities/EGridPassability.h"
 
 namespace Elite
 {
@@ -34,14 +35,14 @@ namespace Elite
 
 			vPortals.push_back(Portal(Line(nodePath[0]->GetPosition(), nodePath[0]->GetPosition())));
 
-			std::vector<Line*> lines = navMeshPolygon->GetLines();
+			const std::vector<Line>& lines = navMeshPolygon->GetLines();
 
 			//For each node received, get its corresponding line
 			for (size_t nodeIdx = 1; nodeIdx < nodePath.size() - 1; ++nodeIdx)
 			{
 				//Local variables
 				NavGraphNode* pNode = nodePath[nodeIdx]; //Store node, except last node, because this is our target node!
-				Line* pLine = lines[pNode->GetLineIndex()];
+				const Line* pLine = &lines[pNode->GetLineIndex()];
 
 				//Redetermine it's "orientation" based on the required path (left-right vs right-left) - p1 should be right point
 				Vector2 centerLine = (pLine->p1 + pLine->p2) / 2.0f;
@@ -162,4 +163,84 @@ namespace Elite
 		SSFA() {};
 		~SSFA() {};
 	};
+
+	//Grid counterpart of the funnel: skips the waypoints of a grid path (AStar, BFS, ...) that can be seen from an earlier waypoint
+	class GridStringPulling final
+	{
+	public:
+		//Positions in nodePath of the waypoints to keep, the first and last node are always kept
+		//Greedy: from every kept waypoint the search gallops ahead (1, 2, 4, ... nodes) while there is line of sight,
+		//then halves the gap to the first node out of sight, so a path of n nodes needs O(log n) line of sight tests per kept waypoint
+		template<class T_NodeType>
+		static std::vector<int> FindWaypoints(const std::vector<T_NodeType*>& nodePath, const GridPassability& passability)
+		{
+			std::vector<int> vWaypoints = {};
+			const int amtNodes{ static_cast<int>(nodePath.size()) };
+			if (amtNodes == 0)
+				return vWaypoints;
+
+			int anchor{ 0 };
+			vWaypoints.push_back(anchor);
+
+			while (anchor < amtNodes - 1)
+			{
+				const int anchorNodeIdx{ nodePath[anchor]->GetIndex() };
+
+				//The next node is always reachable, double the step until the line of sight breaks or the end is passed
+				int visible{ anchor + 1 };
+				int hidden{ amtNodes };
+				for (int step{ 2 }; anchor + step < amtNodes; step *= 2)
+				{
+					if (passability.HasLineOfSight(anchorNodeIdx, nodePath[anchor + step]->GetIndex()))
+					{
+						visible = anchor + step;
+					}
+					else
+					{
+						hidden = anchor + step;
+						break;
+					}
+				}
+
+				//The end of the path wasn't tested when the last step overshot it
+				if (hidden == amtNodes && visible != amtNodes - 1)
+				{
+					if (passability.HasLineOfSight(anchorNodeIdx, nodePath[amtNodes - 1]->GetIndex()))
+						visible = amtNodes - 1;
+					else
+						hidden = amtNodes - 1;
+				}
+
+				//Narrow down between the last node in sight and the first one out of sight
+				while (hidden - visible > 1)
+				{
+					const int middle{ visible + (hidden - visible) / 2 };
+					if (passability.HasLineOfSight(anchorNodeIdx, nodePath[middle]->GetIndex()))
+						visible = middle;
+					else
+						hidden = middle;
+				}
+
+				anchor = visible;
+				vWaypoints.push_back(anchor);
+			}
+
+			return vWaypoints;
+		}
+
+		//World positions (cell centers) of the waypoints that are kept
+		template<class T_NodeType, class T_ConnectionType>
+		static std::vector<Vector2> OptimizePath(const std::vector<T_NodeType*>& nodePath, const GridGraph<T_NodeType, T_ConnectionType>& grid, const GridPassability& passability)
+		{
+			std::vector<Vector2> vPath = {};
+			for (int waypoint : FindWaypoints(nodePath, passability))
+				vPath.push_back(grid.GetNodeWorldPos(nodePath[waypoint]->GetIndex()));
+
+			return vPath;
+		}
+
+	private:
+		GridStringPulling() {};
+		~GridStringPulling() {};
+	};
 }
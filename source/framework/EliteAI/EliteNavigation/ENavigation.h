@@ -12,6 +12,8 @@
 namespace Elite
 {
 	typedef float(*Heuristic)(float, float);
+	//Heuristic on node indices (nodeIdx, goalIdx), for heuristics that are precomputed per node instead of derived from positions
+	typedef std::function<float(int, int)> NodeHeuristic;
 }
 
 /* --- UTILITIES --- */
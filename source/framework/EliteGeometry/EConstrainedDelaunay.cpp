@@ -0,0 +1,665 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+// Authors: Matthieu Delaere
+/*=============================================================================*/
+// EConstrainedDelaunay.cpp: Implementation of the constrained Delaunay triangulation.
+/*=============================================================================*/
+#include "stdafx.h"
+#include "EConstrainedDelaunay.h"
+
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+
+namespace
+{
+	//Position on a Hilbert curve through a 65536 x 65536 grid, points close on the curve are close in the plane
+	unsigned long long GetHilbertIndex(unsigned int x, unsigned int y)
+	{
+		unsigned long long d = 0;
+		for (unsigned int s = 1u << 15; s > 0; s >>= 1)
+		{
+			const unsigned int rx = (x & s) > 0 ? 1 : 0;
+			const unsigned int ry = (y & s) > 0 ? 1 : 0;
+			d += static_cast<unsigned long long>(s) * s * ((3 * rx) ^ ry);
+
+			//Rotate the quadrant
+			if (ry == 0)
+			{
+				if (rx == 1)
+				{
+					x = 0xFFFF - x;
+					y = 0xFFFF - y;
+				}
+				std::swap(x, y);
+			}
+		}
+		return d;
+	}
+
+	//Twice the signed area of abc, positive when counter clockwise. Differences are taken in double, so float input stays (nearly) exact
+	double GetOrientation(const Elite::Vector2& a, const Elite::Vector2& b, const Elite::Vector2& c)
+	{
+		return (static_cast<double>(b.x) - a.x) * (static_cast<double>(c.y) - a.y)
+			- (static_cast<double>(b.y) - a.y) * (static_cast<double>(c.x) - a.x);
+	}
+
+	//Key of a position, -0 and 0 end up the same
+	unsigned long long GetPositionKey(const Elite::Vector2& p)
+	{
+		const float x = p.x + 0.f;
+		const float y = p.y + 0.f;
+		unsigned int xBits, yBits;
+		memcpy(&xBits, &x, sizeof(float));
+		memcpy(&yBits, &y, sizeof(float));
+		return (static_cast<unsigned long long>(xBits) << 32) | yBits;
+	}
+}
+
+#pragma region Triangulation
+bool Elite::ConstrainedDelaunay::Triangulate(const std::vector<std::vector<Vector2>>& rings)
+{
+	m_Vertices.clear();
+	m_TriangleVertices.clear();
+	m_TriangleNeighbours.clear();
+	m_TriangleConstraints.clear();
+	m_VertexTriangles.clear();
+	m_Result.clear();
+
+	//Merge the points shared by rings (or repeated in a ring) into one vertex
+	std::unordered_map<unsigned long long, int> vertexIndices;
+	std::vector<std::vector<int>> ringIndices;
+	for (const auto& ring : rings)
+	{
+		std::vector<int> indices;
+		for (const auto& p : ring)
+		{
+			const auto result = vertexIndices.insert({ GetPositionKey(p), static_cast<int>(m_Vertices.size()) });
+			if (result.second)
+				m_Vertices.push_back(p);
+
+			const auto idx = result.first->second;
+			if (indices.empty() || indices.back() != idx)
+				indices.push_back(idx);
+		}
+		while (indices.size() > 1 && indices.front() == indices.back())
+			indices.pop_back();
+
+		if (indices.size() >= 3)
+			ringIndices.push_back(indices);
+	}
+
+	const auto nrOfPoints = static_cast<int>(m_Vertices.size());
+	if (ringIndices.empty())
+		return false;
+
+	//Bounds of the points
+	auto boundsMin = m_Vertices[0];
+	auto boundsMax = m_Vertices[0];
+	for (const auto& p : m_Vertices)
+	{
+		boundsMin = Vector2(min(boundsMin.x, p.x), min(boundsMin.y, p.y));
+		boundsMax = Vector2(max(boundsMax.x, p.x), max(boundsMax.y, p.y));
+	}
+	const auto center = (boundsMin + boundsMax) / 2.f;
+	const auto size = max(max(boundsMax.x - boundsMin.x, boundsMax.y - boundsMin.y), 1.f);
+
+	//Super triangle that contains all points, its triangles get removed at the end
+	m_Vertices.push_back(center + Vector2(-20.f * size, -10.f * size));
+	m_Vertices.push_back(center + Vector2(20.f * size, -10.f * size));
+	m_Vertices.push_back(center + Vector2(0.f, 20.f * size));
+	m_VertexTriangles.assign(m_Vertices.size(), -1);
+	AddTriangle(nrOfPoints, nrOfPoints + 1, nrOfPoints + 2);
+
+	//Insert the points along a Hilbert curve, so the walk to the next point is short
+	std::vector<std::pair<unsigned long long, int>> insertionOrder;
+	insertionOrder.reserve(nrOfPoints);
+	const auto scale = 65535.f / size;
+	for (auto i = 0; i < nrOfPoints; ++i)
+	{
+		const auto x = static_cast<unsigned int>((m_Vertices[i].x - boundsMin.x) * scale);
+		const auto y = static_cast<unsigned int>((m_Vertices[i].y - boundsMin.y) * scale);
+		insertionOrder.push_back({ GetHilbertIndex(min(x, 0xFFFFu), min(y, 0xFFFFu)), i });
+	}
+	std::sort(insertionOrder.begin(), insertionOrder.end());
+
+	auto hint = 0;
+	for (const auto& entry : insertionOrder)
+	{
+		InsertPoint(entry.second, hint);
+		if (m_VertexTriangles[entry.second] != -1)
+			hint = m_VertexTriangles[entry.second];
+	}
+
+	//Force the edges of the rings into the triangulation
+	for (const auto& ring : ringIndices)
+	{
+		for (size_t i = 0; i < ring.size(); ++i)
+		{
+			if (!InsertConstraint(ring[i], ring[(i + 1) % ring.size()]))
+			{
+				m_Result.clear();
+				return false;
+			}
+		}
+	}
+
+	KeepInnerTriangles(nrOfPoints);
+	return true;
+}
+#pragma endregion //Triangulation
+//----------------------------------------------------------
+#pragma region Helpers
+double Elite::ConstrainedDelaunay::Orientation(int a, int b, int c) const
+{ return GetOrientation(m_Vertices[a], m_Vertices[b], m_Vertices[c]); }
+
+double Elite::ConstrainedDelaunay::Orientation(int a, int b, const Vector2& p) const
+{ return GetOrientation(m_Vertices[a], m_Vertices[b], p); }
+
+bool Elite::ConstrainedDelaunay::IsInCircumcircle(int t, int v) const
+{
+	//Determinant of the points relative to v, the triangle is counter clockwise
+	const auto& d = m_Vertices[v];
+	double rows[3][3];
+	for (auto i = 0; i < 3; ++i)
+	{
+		const auto& p = m_Vertices[m_TriangleVertices[t][i]];
+		const double dx = static_cast<double>(p.x) - d.x;
+		const double dy = static_cast<double>(p.y) - d.y;
+		rows[i][0] = dx;
+		rows[i][1] = dy;
+		rows[i][2] = dx * dx + dy * dy;
+	}
+
+	const auto det = rows[0][2] * (rows[1][0] * rows[2][1] - rows[2][0] * rows[1][1])
+		+ rows[1][2] * (rows[2][0] * rows[0][1] - rows[0][0] * rows[2][1])
+		+ rows[2][2] * (rows[0][0] * rows[1][1] - rows[1][0] * rows[0][1]);
+	return det > 0.0; //Points on the circle stay, so flipping always ends
+}
+
+int Elite::ConstrainedDelaunay::AddTriangle(int a, int b, int c)
+{
+	const auto t = static_cast<int>(m_TriangleVertices.size());
+	m_TriangleVertices.push_back({ { a, b, c } });
+	m_TriangleNeighbours.push_back({ { -1, -1, -1 } });
+	m_TriangleConstraints.push_back(0);
+	m_VertexTriangles[a] = t;
+	m_VertexTriangles[b] = t;
+	m_VertexTriangles[c] = t;
+	return t;
+}
+
+void Elite::ConstrainedDelaunay::ReplaceNeighbour(int t, int oldNeighbour, int newNeighbour)
+{
+	if (t == -1)
+		return;
+
+	for (auto& neighbour : m_TriangleNeighbours[t])
+	{
+		if (neighbour == oldNeighbour)
+		{
+			neighbour = newNeighbour;
+			return;
+		}
+	}
+}
+
+int Elite::ConstrainedDelaunay::GetNeighbourEdge(int t, int neighbour) const
+{
+	for (auto i = 0; i < 3; ++i)
+	{
+		if (m_TriangleNeighbours[t][i] == neighbour)
+			return i;
+	}
+	return -1;
+}
+
+void Elite::ConstrainedDelaunay::SetConstrained(int t, int edge, bool isConstrained)
+{
+	if (isConstrained)
+		m_TriangleConstraints[t] |= 1 << edge;
+	else
+		m_TriangleConstraints[t] &= ~(1 << edge);
+}
+
+bool Elite::ConstrainedDelaunay::FindEdge(int from, int to, int& t, int& edge) const
+{
+	//Turn around the from vertex, both ways when the fan is open (on the super triangle)
+	const auto start = m_VertexTriangles[from];
+	for (auto direction = 0; direction < 2; ++direction)
+	{
+		auto current = start;
+		do
+		{
+			const auto& vertices = m_TriangleVertices[current];
+			const auto i = vertices[0] == from ? 0 : (vertices[1] == from ? 1 : 2);
+			if (vertices[(i + 1) % 3] == to)
+			{
+				t = current;
+				edge = i;
+				return true;
+			}
+			if (vertices[(i + 2) % 3] == to)
+			{
+				t = current;
+				edge = (i + 2) % 3;
+				return true;
+			}
+			current = m_TriangleNeighbours[current][direction == 0 ? (i + 2) % 3 : i];
+		} while (current != -1 && current != start);
+
+		if (current == start)
+			break;
+	}
+	return false;
+}
+#pragma endregion //Helpers
+//----------------------------------------------------------
+#pragma region PointInsertion
+int Elite::ConstrainedDelaunay::Locate(const Vector2& p, int t) const
+{
+	//Straight walk, ends in a Delaunay triangulation. The first edge to test changes every step to break ties
+	const auto maxNrOfSteps = static_cast<int>(m_TriangleVertices.size()) + 3;
+	for (auto step = 0; step < maxNrOfSteps; ++step)
+	{
+		auto next = -1;
+		for (auto k = 0; k < 3 && next == -1; ++k)
+		{
+			const auto i = (k + step) % 3;
+			const auto& vertices = m_TriangleVertices[t];
+			if (Orientation(vertices[i], vertices[(i + 1) % 3], p) < 0.0)
+				next = m_TriangleNeighbours[t][i];
+		}
+
+		if (next == -1)
+			return t;
+		t = next;
+	}
+	return t;
+}
+
+void Elite::ConstrainedDelaunay::InsertPoint(int v, int t)
+{
+	const auto& p = m_Vertices[v];
+	t = Locate(p, t);
+
+	//On an edge the two triangles next to it get split
+	auto nrOfEdgesOn = 0;
+	auto edgeOn = -1;
+	for (auto i = 0; i < 3; ++i)
+	{
+		if (Orientation(m_TriangleVertices[t][i], m_TriangleVertices[t][(i + 1) % 3], p) == 0.0)
+		{
+			++nrOfEdgesOn;
+			edgeOn = i;
+		}
+	}
+
+	//Coincides with a vertex
+	if (nrOfEdgesOn > 1)
+		return;
+
+	std::vector<std::pair<int, int>> edgeStack;
+	if (nrOfEdgesOn == 1)
+		SplitEdge(v, t, edgeOn, edgeStack);
+	else
+		SplitTriangle(v, t, edgeStack);
+
+	Legalize(v, edgeStack);
+}
+
+void Elite::ConstrainedDelaunay::SplitTriangle(int v, int t, std::vector<std::pair<int, int>>& edgeStack)
+{
+	//abc becomes abv, bcv and cav
+	const auto vertices = m_TriangleVertices[t];
+	const auto neighbours = m_TriangleNeighbours[t];
+	const auto constraints = m_TriangleConstraints[t];
+
+	const auto t1 = AddTriangle(vertices[1], vertices[2], v);
+	const auto t2 = AddTriangle(vertices[2], vertices[0], v);
+	m_TriangleVertices[t] = { { vertices[0], vertices[1], v } };
+	m_VertexTriangles[vertices[0]] = t;
+	m_VertexTriangles[v] = t;
+
+	m_TriangleNeighbours[t] = { { neighbours[0], t1, t2 } };
+	m_TriangleNeighbours[t1] = { { neighbours[1], t2, t } };
+	m_TriangleNeighbours[t2] = { { neighbours[2], t, t1 } };
+	ReplaceNeighbour(neighbours[1], t, t1);
+	ReplaceNeighbour(neighbours[2], t, t2);
+
+	m_TriangleConstraints[t] = constraints & 1;
+	m_TriangleConstraints[t1] = (constraints >> 1) & 1;
+	m_TriangleConstraints[t2] = (constraints >> 2) & 1;
+
+	edgeStack.push_back({ t, 0 });
+	edgeStack.push_back({ t1, 0 });
+	edgeStack.push_back({ t2, 0 });
+}
+
+void Elite::ConstrainedDelaunay::SplitEdge(int v, int t, int edge, std::vector<std::pair<int, int>>& edgeStack)
+{
+	//Triangle abc and its neighbour bad across ab become cav, bcv, adv and dbv
+	const auto a = m_TriangleVertices[t][edge];
+	const auto b = m_TriangleVertices[t][(edge + 1) % 3];
+	const auto c = m_TriangleVertices[t][(edge + 2) % 3];
+	const auto tBC = m_TriangleNeighbours[t][(edge + 1) % 3];
+	const auto tCA = m_TriangleNeighbours[t][(edge + 2) % 3];
+	const unsigned char isAB = IsConstrained(t, edge);
+	const unsigned char isBC = IsConstrained(t, (edge + 1) % 3);
+	const unsigned char isCA = IsConstrained(t, (edge + 2) % 3);
+
+	const auto u = m_TriangleNeighbours[t][edge];
+	const auto t1 = AddTriangle(b, c, v);
+	m_TriangleVertices[t] = { { c, a, v } };
+	m_VertexTriangles[a] = t;
+	m_VertexTriangles[c] = t;
+	m_VertexTriangles[v] = t;
+	m_TriangleConstraints[t] = isCA | (isAB << 1);
+	m_TriangleConstraints[t1] = isBC | (isAB << 2);
+	ReplaceNeighbour(tBC, t, t1);
+	edgeStack.push_back({ t, 0 });
+	edgeStack.push_back({ t1, 0 });
+
+	auto u1 = -1;
+	if (u != -1)
+	{
+		const auto f = GetNeighbourEdge(u, t);
+		const auto d = m_TriangleVertices[u][(f + 2) % 3];
+		const auto uAD = m_TriangleNeighbours[u][(f + 1) % 3];
+		const auto uDB = m_TriangleNeighbours[u][(f + 2) % 3];
+		const unsigned char isAD = IsConstrained(u, (f + 1) % 3);
+		const unsigned char isDB = IsConstrained(u, (f + 2) % 3);
+
+		u1 = AddTriangle(d, b, v);
+		m_TriangleVertices[u] = { { a, d, v } };
+		m_VertexTriangles[d] = u;
+		m_TriangleNeighbours[u] = { { uAD, u1, t } };
+		m_TriangleNeighbours[u1] = { { uDB, t1, u } };
+		m_TriangleConstraints[u] = isAD | (isAB << 2);
+		m_TriangleConstraints[u1] = isDB | (isAB << 1);
+		ReplaceNeighbour(uDB, u, u1);
+		edgeStack.push_back({ u, 0 });
+		edgeStack.push_back({ u1, 0 });
+	}
+
+	m_TriangleNeighbours[t] = { { tCA, u, t1 } };
+	m_TriangleNeighbours[t1] = { { tBC, t, u1 } };
+}
+
+void Elite::ConstrainedDelaunay::Flip(int t, int edge)
+{
+	//Triangle abc and its neighbour bad across ab become cad and dbc
+	const auto a = m_TriangleVertices[t][edge];
+	const auto b = m_TriangleVertices[t][(edge + 1) % 3];
+	const auto c = m_TriangleVertices[t][(edge + 2) % 3];
+	const auto u = m_TriangleNeighbours[t][edge];
+	const auto f = GetNeighbourEdge(u, t);
+	const auto d = m_TriangleVertices[u][(f + 2) % 3];
+
+	const auto tBC = m_TriangleNeighbours[t][(edge + 1) % 3];
+	const auto tCA = m_TriangleNeighbours[t][(edge + 2) % 3];
+	const auto uAD = m_TriangleNeighbours[u][(f + 1) % 3];
+	const auto uDB = m_TriangleNeighbours[u][(f + 2) % 3];
+	const unsigned char isBC = IsConstrained(t, (edge + 1) % 3);
+	const unsigned char isCA = IsConstrained(t, (edge + 2) % 3);
+	const unsigned char isAD = IsConstrained(u, (f + 1) % 3);
+	const unsigned char isDB = IsConstrained(u, (f + 2) % 3);
+
+	m_TriangleVertices[t] = { { c, a, d } };
+	m_TriangleNeighbours[t] = { { tCA, uAD, u } };
+	m_TriangleConstraints[t] = isCA | (isAD << 1);
+
+	m_TriangleVertices[u] = { { d, b, c } };
+	m_TriangleNeighbours[u] = { { uDB, tBC, t } };
+	m_TriangleConstraints[u] = isDB | (isBC << 1);
+
+	ReplaceNeighbour(uAD, u, t);
+	ReplaceNeighbour(tBC, t, u);
+
+	m_VertexTriangles[a] = t;
+	m_VertexTriangles[c] = t;
+	m_VertexTriangles[b] = u;
+	m_VertexTriangles[d] = u;
+}
+
+void Elite::ConstrainedDelaunay::Legalize(int v, std::vector<std::pair<int, int>>& edgeStack)
+{
+	//Every edge on the stack lies opposite of v
+	while (!edgeStack.empty())
+	{
+		const auto t = edgeStack.back().first;
+		const auto edge = edgeStack.back().second;
+		edgeStack.pop_back();
+
+		const auto u = m_TriangleNeighbours[t][edge];
+		if (u == -1 || IsConstrained(t, edge))
+			continue;
+
+		const auto d = m_TriangleVertices[u][(GetNeighbourEdge(u, t) + 2) % 3];
+		if (!IsInCircumcircle(t, d))
+			continue;
+
+		//v ends up in both triangles, opposite of their edges towards d
+		Flip(t, edge);
+		edgeStack.push_back({ t, 1 });
+		edgeStack.push_back({ u, 0 });
+	}
+}
+#pragma endregion //PointInsertion
+//----------------------------------------------------------
+#pragma region Constraints
+bool Elite::ConstrainedDelaunay::InsertConstraint(int a, int b)
+{
+	//Vertices on the segment split it up, every piece gets inserted on its own
+	if (m_VertexTriangles[a] == -1 || m_VertexTriangles[b] == -1)
+		return false;
+
+	std::vector<std::pair<int, int>> crossedEdges;
+	while (a != b)
+	{
+		auto end = b;
+		crossedEdges.clear();
+		if (!FindCrossedEdges(a, b, crossedEdges, end))
+			return false;
+
+		//Flip the crossed edges until none of them crosses anymore (Sloan). A flip is only possible in a convex quad, the others wait
+		std::deque<std::pair<int, int>> edgeQueue(crossedEdges.begin(), crossedEdges.end());
+		std::vector<std::pair<int, int>> newEdges;
+		const auto maxNrOfTries = 64 * (edgeQueue.size() + 1) * (edgeQueue.size() + 1);
+		for (size_t nrOfTries = 0; !edgeQueue.empty(); ++nrOfTries)
+		{
+			if (nrOfTries > maxNrOfTries)
+				return false;
+
+			const auto x = edgeQueue.front().first;
+			const auto y = edgeQueue.front().second;
+			edgeQueue.pop_front();
+
+			int t, edge;
+			if (!FindEdge(x, y, t, edge))
+				return false;
+
+			const auto u = m_TriangleNeighbours[t][edge];
+			const auto c = m_TriangleVertices[t][(edge + 2) % 3];
+			const auto d = m_TriangleVertices[u][(GetNeighbourEdge(u, t) + 2) % 3];
+			const auto sideX = Orientation(c, d, x);
+			const auto sideY = Orientation(c, d, y);
+			if (!((sideX < 0.0 && sideY > 0.0) || (sideX > 0.0 && sideY < 0.0)))
+			{
+				edgeQueue.push_back({ x, y });
+				continue;
+			}
+
+			Flip(t, edge);
+
+			const auto sideC = Orientation(a, end, c);
+			const auto sideD = Orientation(a, end, d);
+			if ((sideC < 0.0 && sideD > 0.0) || (sideC > 0.0 && sideD < 0.0))
+				edgeQueue.push_back({ c, d });
+			else
+				newEdges.push_back({ c, d });
+		}
+
+		MarkConstraint(a, end);
+
+		//The new edges (apart from the constraint) get flipped back into Delaunay edges where they can
+		while (!newEdges.empty())
+		{
+			const auto x = newEdges.back().first;
+			const auto y = newEdges.back().second;
+			newEdges.pop_back();
+
+			int t, edge;
+			if (!FindEdge(x, y, t, edge) || IsConstrained(t, edge))
+				continue;
+
+			const auto u = m_TriangleNeighbours[t][edge];
+			if (u == -1)
+				continue;
+
+			const auto p = m_TriangleVertices[t][edge];
+			const auto q = m_TriangleVertices[t][(edge + 1) % 3];
+			const auto c = m_TriangleVertices[t][(edge + 2) % 3];
+			const auto d = m_TriangleVertices[u][(GetNeighbourEdge(u, t) + 2) % 3];
+			if (!IsInCircumcircle(t, d))
+				continue;
+
+			Flip(t, edge);
+			newEdges.push_back({ c, p });
+			newEdges.push_back({ p, d });
+			newEdges.push_back({ d, q });
+			newEdges.push_back({ q, c });
+		}
+
+		a = end;
+	}
+	return true;
+}
+
+bool Elite::ConstrainedDelaunay::FindCrossedEdges(int a, int b, std::vector<std::pair<int, int>>& crossedEdges, int& end) const
+{
+	const auto& pA = m_Vertices[a];
+	const auto& pB = m_Vertices[b];
+
+	//Find the triangle around a the segment leaves through, turning around a
+	auto t = -1;
+	auto edge = -1;
+	const auto start = m_VertexTriangles[a];
+	auto current = start;
+	do
+	{
+		const auto& vertices = m_TriangleVertices[current];
+		const auto i = vertices[0] == a ? 0 : (vertices[1] == a ? 1 : 2);
+		const auto x = vertices[(i + 1) % 3];
+		const auto y = vertices[(i + 2) % 3];
+
+		//The edge already exists, or stops at a vertex on the segment
+		for (const auto v : { x, y })
+		{
+			if (v == b)
+			{
+				end = b;
+				return true;
+			}
+			if (Orientation(a, b, v) == 0.0 && Dot(m_Vertices[v] - pA, pB - pA) > 0.f)
+			{
+				end = v;
+				return true;
+			}
+		}
+
+		if (Orientation(a, b, x) < 0.0 && Orientation(a, b, y) > 0.0)
+		{
+			t = current;
+			edge = (i + 1) % 3;
+			break;
+		}
+
+		current = m_TriangleNeighbours[current][(i + 2) % 3];
+	} while (current != -1 && current != start);
+
+	if (t == -1)
+		return false;
+
+	//Walk along the segment, the first vertex of every crossed edge lies right of it
+	for (;;)
+	{
+		//Crossing another constraint, the rings overlap
+		if (IsConstrained(t, edge))
+			return false;
+
+		crossedEdges.push_back({ m_TriangleVertices[t][edge], m_TriangleVertices[t][(edge + 1) % 3] });
+
+		const auto u = m_TriangleNeighbours[t][edge];
+		if (u == -1)
+			return false;
+
+		const auto f = GetNeighbourEdge(u, t);
+		const auto w = m_TriangleVertices[u][(f + 2) % 3];
+		const auto side = Orientation(a, b, w);
+		if (w == b || side == 0.0)
+		{
+			end = w;
+			return true;
+		}
+
+		t = u;
+		edge = side > 0.0 ? (f + 1) % 3 : (f + 2) % 3;
+	}
+}
+
+void Elite::ConstrainedDelaunay::MarkConstraint(int a, int b)
+{
+	int t, edge;
+	if (!FindEdge(a, b, t, edge))
+		return;
+
+	SetConstrained(t, edge, true);
+	const auto u = m_TriangleNeighbours[t][edge];
+	if (u != -1)
+		SetConstrained(u, GetNeighbourEdge(u, t), true);
+}
+
+void Elite::ConstrainedDelaunay::KeepInnerTriangles(int nrOfPoints)
+{
+	//Flood fill from the super triangle, every constraint crossed is one ring deeper. Odd depths are inside
+	std::vector<int> depths(m_TriangleVertices.size(), -1);
+	std::vector<int> layer{ m_VertexTriangles[nrOfPoints] };
+	std::vector<int> nextLayer;
+	std::vector<int> stack;
+	for (auto depth = 0; !layer.empty(); ++depth)
+	{
+		stack = layer;
+		nextLayer.clear();
+		while (!stack.empty())
+		{
+			const auto t = stack.back();
+			stack.pop_back();
+			if (depths[t] != -1)
+				continue;
+
+			depths[t] = depth;
+			for (auto i = 0; i < 3; ++i)
+			{
+				const auto u = m_TriangleNeighbours[t][i];
+				if (u == -1 || depths[u] != -1)
+					continue;
+
+				if (IsConstrained(t, i))
+					nextLayer.push_back(u);
+				else
+					stack.push_back(u);
+			}
+		}
+		std::swap(layer, nextLayer);
+	}
+
+	for (size_t t = 0; t < m_TriangleVertices.size(); ++t)
+	{
+		const auto& vertices = m_TriangleVertices[t];
+		const auto isSuper = vertices[0] >= nrOfPoints || vertices[1] >= nrOfPoints || vertices[2] >= nrOfPoints;
+		if (!isSuper && depths[t] % 2 == 1)
+			m_Result.push_back(vertices);
+	}
+}
+#pragma endregion //Constraints
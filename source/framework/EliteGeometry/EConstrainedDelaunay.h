@@ -0,0 +1,69 @@
+/*=============================================================================*/
+// Copyright 2021-2022 Elite Engine
+// Authors: Matthieu Delaere
+/*=============================================================================*/
+// EConstrainedDelaunay.h: Constrained Delaunay triangulation of a polygon with holes.
+/*=============================================================================*/
+#ifndef ELITE_GEOMETRY_CONSTRAINED_DELAUNAY
+#define ELITE_GEOMETRY_CONSTRAINED_DELAUNAY
+
+#include <array>
+
+namespace Elite
+{
+	//Incremental Delaunay triangulation: the points are inserted in Hilbert order, so every point is found
+	//by walking a few triangles from the previous one, which keeps the whole insertion close to O(n log n).
+	//The edges of the rings are forced in afterwards by flipping the edges they cross (Sloan), and only the
+	//triangles that are inside an odd number of rings are kept. Holes and islands in holes need no winding.
+	class ConstrainedDelaunay final
+	{
+	public:
+		//=== Functions ===
+		//Every ring is a closed loop of points, the first point is not repeated at the end.
+		//Returns false when rings cross each other, nothing is triangulated then.
+		bool Triangulate(const std::vector<std::vector<Vector2>>& rings);
+
+		//Duplicate points of the rings are merged into one vertex
+		const std::vector<Vector2>& GetVertices() const { return m_Vertices; }
+		//Vertex indices of the triangles inside the rings, counter clockwise
+		const std::vector<std::array<int, 3>>& GetTriangles() const { return m_Result; }
+
+	private:
+		//=== Datamembers ===
+		//Edge i of a triangle goes from vertex i to vertex i + 1, the neighbour and constraint flag with the same index lie across it
+		std::vector<Vector2> m_Vertices;
+		std::vector<std::array<int, 3>> m_TriangleVertices;
+		std::vector<std::array<int, 3>> m_TriangleNeighbours;
+		std::vector<unsigned char> m_TriangleConstraints; //One bit per edge
+		std::vector<int> m_VertexTriangles; //A triangle every vertex is part of
+		std::vector<std::array<int, 3>> m_Result;
+
+		//=== Functions ===
+		double Orientation(int a, int b, int c) const;
+		double Orientation(int a, int b, const Vector2& p) const;
+		bool IsInCircumcircle(int t, int v) const;
+
+		int AddTriangle(int a, int b, int c);
+		void ReplaceNeighbour(int t, int oldNeighbour, int newNeighbour);
+		int GetNeighbourEdge(int t, int neighbour) const;
+		bool IsConstrained(int t, int edge) const { return (m_TriangleConstraints[t] >> edge) & 1; }
+		void SetConstrained(int t, int edge, bool isConstrained);
+		bool FindEdge(int from, int to, int& t, int& edge) const;
+
+		//Point insertion
+		int Locate(const Vector2& p, int t) const;
+		void InsertPoint(int v, int t);
+		void SplitTriangle(int v, int t, std::vector<std::pair<int, int>>& edgeStack);
+		void SplitEdge(int v, int t, int edge, std::vector<std::pair<int, int>>& edgeStack);
+		void Flip(int t, int edge);
+		void Legalize(int v, std::vector<std::pair<int, int>>& edgeStack);
+
+		//Constraints
+		bool InsertConstraint(int a, int b);
+		bool FindCrossedEdges(int a, int b, std::vector<std::pair<int, int>>& crossedEdges, int& end) const;
+		void MarkConstraint(int a, int b);
+
+		void KeepInnerTriangles(int nrOfPoints);
+	};
+}
+#endif
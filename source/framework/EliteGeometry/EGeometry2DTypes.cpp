@@ -8,6 +8,40 @@
 //#include "EGeometry.h"
 #include "EGeometry2DTypes.h"
 #include "EGeometry2DUtilities.h"
+#include "EConstrainedDelaunay.h"
+
+#include <unordered_map>
+
+namespace
+{
+	//Positions closer than this share a vertex id when the line matrix is generated
+	const double g_VertexQuantisation = 1.0e-4;
+
+	std::pair<long long, long long> GetQuantisedPosition(const Elite::Vector2& p)
+	{
+		return { llround(p.x / g_VertexQuantisation), llround(p.y / g_VertexQuantisation) };
+	}
+
+	struct QuantisedPositionHash
+	{
+		size_t operator()(const std::pair<long long, long long>& p) const
+		{
+			const auto h = std::hash<long long>()(p.first);
+			return h ^ (std::hash<long long>()(p.second) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2));
+		}
+	};
+
+	//Same key for both directions of an edge
+	unsigned long long GetEdgeKey(int a, int b)
+	{
+		return (static_cast<unsigned long long>(min(a, b)) << 32) | static_cast<unsigned int>(max(a, b));
+	}
+
+	double GetTriangleArea(const Elite::Vector2& a, const Elite::Vector2& b, const Elite::Vector2& c)
+	{
+		return std::abs((static_cast<double>(b.x) - a.x) * (static_cast<double>(c.y) - a.y) - (static_cast<double>(b.y) - a.y) * (static_cast<double>(c.x) - a.x)) / 2.0;
+	}
+}
 
 #pragma region Polygon
 #pragma region Constructors
@@ -34,8 +68,7 @@ Elite::Polygon::Polygon(const std::vector<Vector2>& outerShape, const std::vecto
 	//For each child, add child
 	for (const auto i : innerShapes)
 	{
-		const auto polygon = new Polygon(i);
-		AddChild(*polygon);
+		AddChild(Polygon(i));
 	}
 }
 
@@ -44,18 +77,6 @@ Elite::Polygon::Polygon(const Vector2* vertices, int count)
 	for (auto i = 0; i < count; ++i)
 		m_vPoints.push_back(vertices[i]);
 }
-
-Elite::Polygon::~Polygon()
-{
-	m_vPoints.clear();
-	m_vChildren.clear();
-	for (auto t : m_vpTriangles)
-		SAFE_DELETE(t);
-	m_vpTriangles.clear();
-	for (auto l : m_vpLines)
-		SAFE_DELETE(l);
-	m_vpLines.clear();
-}
 #pragma endregion //Constructors
 //----------------------------------------------------------
 #pragma region ChildFunctionality
@@ -102,11 +123,11 @@ const std::list<Elite::Vector2>& Elite::Polygon::GetPoints() const
 const std::vector<Elite::Polygon >& Elite::Polygon::GetChildren() const
 { return m_vChildren; }
 
-const std::vector<Elite::Triangle*>& Elite::Polygon::GetTriangles() const
-{ return m_vpTriangles; }
+const std::vector<Elite::Triangle>& Elite::Polygon::GetTriangles() const
+{ return m_vTriangles; }
 
-const std::vector<Elite::Line*>& Elite::Polygon::GetLines() const
-{ return m_vpLines; }
+const std::vector<Elite::Line>& Elite::Polygon::GetLines() const
+{ return m_vLines; }
 #pragma endregion //MemberAccess
 //----------------------------------------------------------
 #pragma region GettersInformation
@@ -164,13 +185,23 @@ bool Elite::Polygon::OverlappingYAxis(const Polygon& poly) const
 	return bottomOverlap || collinearOverlap || topOverlap;
 }
 
-std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTriangles(const Triangle* t) const
+std::vector<const Elite::Triangle*> Elite::Polygon::GetAdjacentTriangles(const Triangle* t) const
 {
+	std::vector<const Triangle*> adjTriangles;
+
+#ifdef USE_TRIANGLE_METADATA
+	//The neighbours are stored in the metadata when the lines get generated
+	for (const int neighbourIdx : t->metaData.IndexNeighbours)
+	{
+		if (neighbourIdx != -1)
+			adjTriangles.push_back(&m_vTriangles[neighbourIdx]);
+	}
+#else
 	//For this triangle, go over all triangles and look if any of it's edges matches the edges of a triangle,
 	//in other words, two points overlap. If two points match, it's an adjacent triangle
-	std::vector<Triangle*> adjTriangles;
-	for (auto ct : m_vpTriangles)
+	for (const auto& triangle : m_vTriangles)
 	{
+		const auto ct = &triangle;
 		if (t == ct) //If same triangle, ignore
 			continue;
 
@@ -187,37 +218,41 @@ std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTriangles(const Triangl
 		if (matchingVerts == 2)
 			adjTriangles.push_back(ct);
 	}
+#endif
 	return adjTriangles;
 }
 
-std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTrianglesOnLine(const Triangle* t, const Line& l) const
+std::vector<const Elite::Triangle*> Elite::Polygon::GetAdjacentTrianglesOnLine(const Triangle* t, const Line& l) const
 {
 	//For this triangle, go over all triangles and look if it's edges matches the given line.
 	//WARNING: this only works when metadata has been enabled!
-	std::vector<Triangle*> adjTriangles;
+	std::vector<const Triangle*> adjTriangles;
 
 #ifdef USE_TRIANGLE_METADATA
-	//Start by getting index of line in matrix
+	//Start by getting index of line in matrix, the lines of the triangle itself are checked first
 	auto lRev = Line(l.p2, l.p1);
-	const auto it = std::find_if(m_vpLines.begin(), m_vpLines.end(), [&](const Line* rl)
-	{ return (*rl == l || *rl == lRev); });
-	if (it == m_vpLines.end())
+	int lineIndex = -1;
+	for (const int i : t->metaData.IndexLines)
 	{
-		std::cout << "WARNING: line not found!" << std::endl;
-		return adjTriangles;
+		if (i != -1 && (m_vLines[i] == l || m_vLines[i] == lRev))
+			lineIndex = i;
 	}
-	const int lineIndex = it - m_vpLines.begin();
 
-	//Go over all the triangles and compare lines
-	for (auto ct : m_vpTriangles)
+	if (lineIndex == -1)
 	{
-		if (t == ct) //If same triangle, ignore
-			continue;
+		const auto it = std::find_if(m_vLines.begin(), m_vLines.end(), [&](const Line& rl)
+		{ return (rl == l || rl == lRev); });
+		//A line that isn't part of the triangulation has no triangles on it
+		if (it == m_vLines.end())
+			return adjTriangles;
+		lineIndex = it - m_vLines.begin();
+	}
 
-		if (ct->metaData.IndexLines[0] == lineIndex
-			|| ct->metaData.IndexLines[1] == lineIndex
-			|| ct->metaData.IndexLines[2] == lineIndex)
-			adjTriangles.push_back(ct);
+	//Take the triangles on both sides of the line
+	for (const int triangleIdx : m_vLineTriangles[lineIndex])
+	{
+		if (triangleIdx != -1 && &m_vTriangles[triangleIdx] != t) //If same triangle, ignore
+			adjTriangles.push_back(&m_vTriangles[triangleIdx]);
 	}
 #endif
 	return adjTriangles;
@@ -226,110 +261,99 @@ std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTrianglesOnLine(const T
 
 const Elite::Triangle* Elite::Polygon::GetTriangleFromPosition(const Vector2& position, bool onLineAllowed /*= false*/) const
 {
-	for (size_t i = 0; i < m_vpTriangles.size(); i++)
+	if (m_vBins.empty())
+		return nullptr;
+
+	for (const auto triangleIdx : m_vBins[GetBinIndex(position)])
 	{
-		if (PointInTriangle(position, m_vpTriangles[i]->p1, m_vpTriangles[i]->p2, m_vpTriangles[i]->p3, onLineAllowed))
-			return m_vpTriangles[i];
+		const auto& t = m_vTriangles[triangleIdx];
+		if (PointInTriangle(position, t.p1, t.p2, t.p3, onLineAllowed))
+			return &t;
 	}
 	return nullptr;
 }
 
+const Elite::Triangle* Elite::Polygon::GetTriangleFromPosition(const Vector2& position, const Triangle* pHint, bool onLineAllowed /*= false*/) const
+{
+#ifdef USE_TRIANGLE_METADATA
+	//Walk towards the position, every step crosses the line the position is furthest behind
+	const auto maxNrOfSteps = 32;
+	const auto isCurrentTriangle = !m_vTriangles.empty()
+		&& std::greater_equal<const Triangle*>()(pHint, m_vTriangles.data()) && std::less<const Triangle*>()(pHint, m_vTriangles.data() + m_vTriangles.size());
+	auto t = isCurrentTriangle ? pHint : nullptr;
+	auto previousIdx = -1;
+	for (auto step = 0; t != nullptr && step < maxNrOfSteps; ++step)
+	{
+		if (PointInTriangle(position, t->p1, t->p2, t->p3, onLineAllowed))
+			return t;
+
+		//Triangles can be wound both ways
+		const auto winding = Cross(t->p2 - t->p1, t->p3 - t->p1) < 0.f ? -1.f : 1.f;
+		const Vector2 points[3] = { t->p1, t->p2, t->p3 };
+
+		auto nextIdx = -1;
+		auto mostBehind = 0.f;
+		for (auto i = 0; i < 3; ++i)
+		{
+			const auto neighbourIdx = t->metaData.IndexNeighbours[i];
+			if (neighbourIdx == -1 || neighbourIdx == previousIdx) //Don't go back, that is how walks end up in a cycle
+				continue;
+
+			const auto& a = points[i];
+			const auto& b = points[(i + 1) % 3];
+			const auto side = Cross(b - a, position - a) * winding;
+			if (side < mostBehind)
+			{
+				mostBehind = side;
+				nextIdx = neighbourIdx;
+			}
+		}
+
+		//Outside of the mesh (or only back), let the bins decide
+		if (nextIdx == -1)
+			break;
+
+		previousIdx = t->metaData.Index;
+		t = &m_vTriangles[nextIdx];
+	}
+#endif
+	return GetTriangleFromPosition(position, onLineAllowed);
+}
+
 #ifdef USE_TRIANGLE_METADATA
 const std::vector<const Elite::Triangle*> Elite::Polygon::GetTrianglesFromLineIndex(unsigned int lineIndex) const
 {
 	std::vector<const Triangle*> vpFoundTriangles = {};
-	for (auto pT : m_vpTriangles)
+	for (const int triangleIdx : GetTriangleIndicesFromLineIndex(lineIndex))
 	{
-		if (pT->metaData.IndexLines[0] == lineIndex ||
-			pT->metaData.IndexLines[1] == lineIndex ||
-			pT->metaData.IndexLines[2] == lineIndex)
-		{
-			vpFoundTriangles.push_back(pT);
-		}
+		if (triangleIdx != -1)
+			vpFoundTriangles.push_back(&m_vTriangles[triangleIdx]);
 	}
 	return vpFoundTriangles;
 }
+
+const std::array<int, 2>& Elite::Polygon::GetTriangleIndicesFromLineIndex(unsigned int lineIndex) const
+{
+	assert(lineIndex < m_vLineTriangles.size() && "<Polygon::GetTriangleIndicesFromLineIndex>: line index out of range");
+	return m_vLineTriangles[lineIndex];
+}
 #endif
 
 
 #pragma endregion //GettersInformation
 //----------------------------------------------------------
 #pragma region TriangulationFunctions
-const std::vector<Elite::Triangle*>& Elite::Polygon::Triangulate()
+const std::vector<Elite::Triangle>& Elite::Polygon::Triangulate()
 {
 	//Check winding
 	OrientateWithChildren(Winding::CCW);
 
-	//TODO: CHECK FOR OVERLAPPING POLYGONS AND MERGE WHEN REQUIRED
-	for (auto child : m_vChildren)
-	{
-		//Check for overlap, if so merge, create new child and remove old ones!
-		//FILL IN FUNCTIONS!
-	}
-
-	//Sort the children. Start by sorting from top to bottom (verices are what matters, not the "center" pos of the polygon!)
-	std::sort(m_vChildren.begin(), m_vChildren.end(),
-		[](const Polygon& p1, const Polygon& p2)
-	{ return p1.GetPosVertMaxYPos() > p2.GetPosVertMaxYPos(); });
-
-	//Copy children as backup after sort
-	const auto children = m_vChildren;
-	
-	//THEN, we check two elements, if the don't overlap horizontally you don't do anything, else you swap them based on right most object
-	for (auto i = 0; i < static_cast<int>(m_vChildren.size()) - 1; ++i)
-	{
-		if (m_vChildren[i].OverlappingYAxis(m_vChildren[i + 1]))
-		{
-			//Swap if i.y < i+1.y
-			if (m_vChildren[i].GetPosVertMaxXPos() < m_vChildren[i + 1].GetPosVertMaxXPos())
-			{
-				const auto temp = m_vChildren[i];
-				m_vChildren[i] = m_vChildren[i + 1];
-				m_vChildren[i + 1] = temp;
-			}
-		}
-	}
-
-	//First split polygon
-	while (m_vChildren.size() != 0)
-		Split();
-
 	//Triangle list - Clear first (if already containing triangles)
-	for (auto t : m_vpTriangles)
-		SAFE_DELETE(t);
-	m_vpTriangles.clear();
-
-	std::list<Vector2> copyPoints;
-	copyPoints.assign(m_vPoints.begin(), m_vPoints.end()); //Copy
-
-	//For each ear, remove ear and push verts, recheck earness (including convexness obviously :-))!
-	while (copyPoints.size() > 3)
-	{
-		list<Vector2>::const_iterator earListIt = copyPoints.end();
-		for (auto it = copyPoints.begin(); it != copyPoints.end(); ++it)
-		{
-			if (earListIt != copyPoints.end())
-				break;
-			if (IsConvexInPolygon(copyPoints, it) && IsEar(copyPoints, it))
-				earListIt = it;
-		}
+	m_vTriangles.clear();
 
-		//Push triangle
-		Vector2 current, prev, next;
-		GetTriangle(copyPoints, earListIt, current, prev, next);
-		Triangle* t = new Triangle(prev, current, next);
-		m_vpTriangles.push_back(t);
-
-		//Remove current from pointslist
-		const auto currentIt = std::find(copyPoints.begin(), copyPoints.end(), current);
-		copyPoints.erase(currentIt); //remove
-	}
-	//Add the remaining 3 vertices to the triangulated polygon
-	std::vector<Vector2> tempCopy;
-	for (const auto p : copyPoints)
-		tempCopy.push_back(p);
-	Triangle* lastTriangle = new Triangle(tempCopy[0], tempCopy[1], tempCopy[2]);
-	m_vpTriangles.push_back(lastTriangle);
+	//Constrained Delaunay triangulation, ear clipping when children overlap (their edges cross)
+	if (!TriangulateConstrainedDelaunay())
+		TriangulateEarClipping();
 
 	//Flag as triangulated for later use
 	m_isTriangulated = true; 
@@ -337,11 +361,32 @@ const std::vector<Elite::Triangle*>& Elite::Polygon::Triangulate()
 #ifdef USE_TRIANGLE_METADATA
 	GenerateLineMatrix();
 #endif
+	GenerateTriangleBins();
 
-	m_vChildren = children;
-	return m_vpTriangles;
+	return m_vTriangles;
+}
+
+#ifdef USE_TRIANGLE_METADATA
+bool Elite::Polygon::AddChildToTriangulation(const Polygon& p, TriangulationChange& change)
+{
+	if (!RetriangulateAroundChild(p, false, change))
+		return false;
+
+	AddChild(p);
+	return true;
 }
 
+bool Elite::Polygon::RemoveChildFromTriangulation(const Polygon& p, TriangulationChange& change)
+{
+	if (std::find(m_vChildren.begin(), m_vChildren.end(), p) == m_vChildren.end()
+		|| !RetriangulateAroundChild(p, true, change))
+		return false;
+
+	RemoveChild(p);
+	return true;
+}
+#endif
+
 void Elite::Polygon::OrientateWithChildren(Winding winding)
 {
 	//Based on the orientation given rewind these points if necessary, change winding of children
@@ -440,52 +485,576 @@ bool Elite::Polygon::IsEar(const list<Vector2>& l, const list<Vector2>::const_it
 void Elite::Polygon::GenerateLineMatrix()
 {
 #ifdef USE_TRIANGLE_METADATA
+	//Lines of a previous triangulation are outdated
+	m_vLines.clear();
+	m_vLineTriangles.clear();
+	m_vFreeLines.clear();
+	m_vLines.reserve(m_vTriangles.size() * 2 + 1);
+	m_vLineTriangles.reserve(m_vTriangles.size() * 2 + 1);
+
+	//Every position gets a quantised vertex id, a line is then found through the ids of its end points
+	//with one hash lookup instead of being compared to every line that is already in the matrix
+	std::unordered_map<std::pair<long long, long long>, int, QuantisedPositionHash> vertexIds;
+	std::unordered_map<unsigned long long, int> lineIndices;
+	vertexIds.reserve(m_vTriangles.size());
+	lineIndices.reserve(m_vTriangles.size() * 2);
+
 	//Go over all the triangles
-	for (auto t : m_vpTriangles)
+	for (auto triangleIdx = 0; triangleIdx < static_cast<int>(m_vTriangles.size()); ++triangleIdx)
 	{
+		auto& t = m_vTriangles[triangleIdx];
+		t.metaData = {};
+		t.metaData.Index = triangleIdx;
+
+		const Vector2* points[3] = { &t.p1, &t.p2, &t.p3 };
+		int ids[3];
+		for (auto i = 0; i < 3; ++i)
+			ids[i] = vertexIds.insert({ GetQuantisedPosition(*points[i]), static_cast<int>(vertexIds.size()) }).first->second;
+
 		//Go over all the lines of the triangle, search if they are already in the matrix
 		//If not add them and store it's index in the triangles meta data
-		const Line l1{ t->p1, t->p2 };
-		const Line l1rev{ t->p2, t->p1 };
-		const Line l2{ t->p2, t->p3 };
-		const Line l2rev{ t->p3, t->p2 };
-		const Line l3{ t->p3, t->p1 };
-		const Line l3rev{ t->p1, t->p3 };
-		for (auto i = 0; i < static_cast<int>(m_vpLines.size()); ++i)
+		for (auto i = 0; i < 3; ++i)
 		{
-			const auto l = m_vpLines[i];
-			if (*l == l1 || *l == l1rev)
-				t->metaData.IndexLines[0] = i;
-			if (*l == l2 || *l == l2rev)
-				t->metaData.IndexLines[1] = i;
-			if (*l == l3 || *l == l3rev)
-				t->metaData.IndexLines[2] = i;
+			const auto a = ids[i];
+			const auto b = ids[(i + 1) % 3];
+			const auto result = lineIndices.insert({ GetEdgeKey(a, b), static_cast<int>(m_vLines.size()) });
+			if (result.second) //Not found, add to matrix
+			{
+				m_vLines.push_back(Line(*points[i], *points[(i + 1) % 3], result.first->second));
+				m_vLineTriangles.push_back({ { -1, -1 } });
+			}
+			t.metaData.IndexLines[i] = result.first->second;
 		}
-		//Not found, add to matrix
-		if (t->metaData.IndexLines[0] == -1)
+
+		//Register the triangle on its lines, a line that already has a triangle links both as neighbours
+		for (auto i = 0; i < 3; ++i)
 		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p1, t->p2, index));
-			t->metaData.IndexLines[0] = index;
+			auto& lineTriangles = m_vLineTriangles[t.metaData.IndexLines[i]];
+			if (lineTriangles[0] == -1)
+			{
+				lineTriangles[0] = triangleIdx;
+			}
+			else if (lineTriangles[1] == -1)
+			{
+				lineTriangles[1] = triangleIdx;
+
+				auto& neighbour = m_vTriangles[lineTriangles[0]];
+				t.metaData.IndexNeighbours[i] = neighbour.metaData.Index;
+				for (auto j = 0; j < 3; ++j)
+				{
+					if (neighbour.metaData.IndexLines[j] == t.metaData.IndexLines[i])
+						neighbour.metaData.IndexNeighbours[j] = triangleIdx;
+				}
+			}
+			else
+			{
+				//Overlapping or duplicate triangles, the line only links the first two
+				assert(false && "<Polygon::GenerateLineMatrix>: line shared by more than two triangles");
+			}
 		}
-		if (t->metaData.IndexLines[1] == -1)
+	}
+#endif
+}
+
+void Elite::Polygon::GenerateTriangleBins()
+{
+	m_vBins.clear();
+	if (m_vTriangles.empty())
+		return;
+
+	//Bounds of all triangles
+	auto boundsMin = Vector2((std::numeric_limits<float>::max)(), (std::numeric_limits<float>::max)());
+	auto boundsMax = Vector2(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+	for (const auto& t : m_vTriangles)
+	{
+		for (const auto& p : { t.p1, t.p2, t.p3 })
 		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p2, t->p3, index));
-			t->metaData.IndexLines[1] = index;
+			boundsMin = Vector2(min(boundsMin.x, p.x), min(boundsMin.y, p.y));
+			boundsMax = Vector2(max(boundsMax.x, p.x), max(boundsMax.y, p.y));
 		}
-		if (t->metaData.IndexLines[2] == -1)
+	}
+
+	//Square bins, about one per triangle
+	const auto maxNrOfBinsPerAxis = 256;
+	const auto size = boundsMax - boundsMin;
+	m_BinsOrigin = boundsMin;
+	m_BinSize = max(sqrtf(size.x * size.y / static_cast<float>(m_vTriangles.size())), FLT_EPSILON);
+	m_BinSize = max(m_BinSize, max(size.x, size.y) / maxNrOfBinsPerAxis);
+	m_NrOfBinColumns = min(static_cast<int>(size.x / m_BinSize) + 1, maxNrOfBinsPerAxis);
+	m_NrOfBinRows = min(static_cast<int>(size.y / m_BinSize) + 1, maxNrOfBinsPerAxis);
+
+	m_vBins.assign(m_NrOfBinColumns * m_NrOfBinRows, {});
+	for (auto triangleIdx = 0; triangleIdx < static_cast<int>(m_vTriangles.size()); ++triangleIdx)
+		AddTriangleToBins(triangleIdx);
+}
+
+int Elite::Polygon::GetBinIndex(const Vector2& position) const
+{
+	//Positions outside of the bounds end up in the bins on the border
+	const auto col = static_cast<int>(Clamp((position.x - m_BinsOrigin.x) / m_BinSize, 0.f, static_cast<float>(m_NrOfBinColumns - 1)));
+	const auto row = static_cast<int>(Clamp((position.y - m_BinsOrigin.y) / m_BinSize, 0.f, static_cast<float>(m_NrOfBinRows - 1)));
+	return row * m_NrOfBinColumns + col;
+}
+
+std::array<int, 4> Elite::Polygon::GetBinRange(const Triangle& t) const
+{
+	const auto minBinIdx = GetBinIndex(Vector2(min(t.p1.x, min(t.p2.x, t.p3.x)), min(t.p1.y, min(t.p2.y, t.p3.y))));
+	const auto maxBinIdx = GetBinIndex(Vector2(max(t.p1.x, max(t.p2.x, t.p3.x)), max(t.p1.y, max(t.p2.y, t.p3.y))));
+	return { { minBinIdx % m_NrOfBinColumns, minBinIdx / m_NrOfBinColumns, maxBinIdx % m_NrOfBinColumns, maxBinIdx / m_NrOfBinColumns } };
+}
+
+void Elite::Polygon::AddTriangleToBins(int triangleIdx)
+{
+	const auto range = GetBinRange(m_vTriangles[triangleIdx]);
+	for (auto row = range[1]; row <= range[3]; ++row)
+		for (auto col = range[0]; col <= range[2]; ++col)
+			m_vBins[row * m_NrOfBinColumns + col].push_back(triangleIdx);
+}
+
+void Elite::Polygon::RemoveTriangleFromBins(int triangleIdx)
+{
+	//Has to happen before the triangle itself changes, its bounds decide the bins
+	const auto range = GetBinRange(m_vTriangles[triangleIdx]);
+	for (auto row = range[1]; row <= range[3]; ++row)
+	{
+		for (auto col = range[0]; col <= range[2]; ++col)
 		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p3, t->p1, index));
-			t->metaData.IndexLines[2] = index;
+			auto& bin = m_vBins[row * m_NrOfBinColumns + col];
+			const auto it = std::find(bin.begin(), bin.end(), triangleIdx);
+			if (it != bin.end())
+			{
+				*it = bin.back();
+				bin.pop_back();
+			}
 		}
 	}
-#endif
 }
 #pragma endregion //PrivateGeneralFunctions
 //----------------------------------------------------------
 #pragma region PrivateTriangulationFunctions
+bool Elite::Polygon::TriangulateConstrainedDelaunay()
+{
+	//The rings of this polygon and all of its children (and theirs), the triangulation decides what is inside by itself
+	std::vector<std::vector<Vector2>> rings;
+	std::vector<const Polygon*> polygons{ this };
+	while (!polygons.empty())
+	{
+		const auto polygon = polygons.back();
+		polygons.pop_back();
+
+		rings.push_back(std::vector<Vector2>(polygon->m_vPoints.begin(), polygon->m_vPoints.end()));
+		for (const auto& child : polygon->m_vChildren)
+			polygons.push_back(&child);
+	}
+
+	ConstrainedDelaunay triangulation{};
+	if (!triangulation.Triangulate(rings))
+		return false;
+
+	const auto& vertices = triangulation.GetVertices();
+	m_vTriangles.reserve(triangulation.GetTriangles().size());
+	for (const auto& t : triangulation.GetTriangles())
+		m_vTriangles.push_back(Triangle(vertices[t[0]], vertices[t[1]], vertices[t[2]]));
+	return true;
+}
+
+#ifdef USE_TRIANGLE_METADATA
+bool Elite::Polygon::RetriangulateAroundChild(const Polygon& p, bool isRemoved, TriangulationChange& change)
+{
+	change = {};
+	if (m_vBins.empty() || p.m_vPoints.size() < 3)
+		return false;
+
+	//1. Region: the triangles whose bounds overlap the bounds of the child. A triangle outside of the region can't touch
+	//the child, so the child can only reach the border of the region where that border is an edge of the mesh.
+	const auto childMin = Vector2(p.GetPosVertMinXPos(), p.GetPosVertMinYPos());
+	const auto childMax = Vector2(p.GetPosVertMaxXPos(), p.GetPosVertMaxYPos());
+	const auto minBinIdx = GetBinIndex(childMin);
+	const auto maxBinIdx = GetBinIndex(childMax);
+	std::vector<int> region;
+	for (auto row = minBinIdx / m_NrOfBinColumns; row <= maxBinIdx / m_NrOfBinColumns; ++row)
+	{
+		for (auto col = minBinIdx % m_NrOfBinColumns; col <= maxBinIdx % m_NrOfBinColumns; ++col)
+		{
+			for (const auto triangleIdx : m_vBins[row * m_NrOfBinColumns + col])
+			{
+				const auto& t = m_vTriangles[triangleIdx];
+				if (min(t.p1.x, min(t.p2.x, t.p3.x)) <= childMax.x && max(t.p1.x, max(t.p2.x, t.p3.x)) >= childMin.x
+					&& min(t.p1.y, min(t.p2.y, t.p3.y)) <= childMax.y && max(t.p1.y, max(t.p2.y, t.p3.y)) >= childMin.y)
+					region.push_back(triangleIdx);
+			}
+		}
+	}
+	std::sort(region.begin(), region.end());
+	region.erase(std::unique(region.begin(), region.end()), region.end());
+	if (region.empty())
+		return false;
+
+	const auto isInRegion = [&region](int triangleIdx) { return std::binary_search(region.begin(), region.end(), triangleIdx); };
+
+	//Vertex ids like in GenerateLineMatrix
+	std::unordered_map<std::pair<long long, long long>, int, QuantisedPositionHash> vertexIds;
+	std::vector<Vector2> vertices;
+	const auto getVertexId = [&](const Vector2& v)
+	{
+		const auto result = vertexIds.insert({ GetQuantisedPosition(v), static_cast<int>(vertices.size()) });
+		if (result.second)
+			vertices.push_back(v);
+		return result.first->second;
+	};
+
+	//2. Border of the region, its lines stay. When the child is removed its edges are left out, so its hole gets filled
+	//Projected in double, DistanceSquarePointToLine loses too much precision on short edges
+	const auto childSize = max(childMax.x - childMin.x, childMax.y - childMin.y);
+	const auto onChildDistanceSquared = Square(1.0e-4 * max(childSize, 1.f));
+	const auto isOnChild = [&](const Vector2& v)
+	{
+		for (auto it = p.m_vPoints.begin(); it != p.m_vPoints.end(); ++it)
+		{
+			const auto next = std::next(it) == p.m_vPoints.end() ? p.m_vPoints.begin() : std::next(it);
+			const double edgeX = next->x - static_cast<double>(it->x), edgeY = next->y - static_cast<double>(it->y);
+			const double toX = v.x - static_cast<double>(it->x), toY = v.y - static_cast<double>(it->y);
+			const auto edgeLengthSquared = edgeX * edgeX + edgeY * edgeY;
+			const auto t = edgeLengthSquared > 0.0 ? Clamp((toX * edgeX + toY * edgeY) / edgeLengthSquared, 0.0, 1.0) : 0.0;
+			if (Square(toX - t * edgeX) + Square(toY - t * edgeY) <= onChildDistanceSquared)
+				return true;
+		}
+		return false;
+	};
+
+	std::vector<std::array<int, 2>> borderEdges; //Vertex ids
+	std::vector<int> borderLines;
+	auto regionArea = 0.0;
+	for (const auto triangleIdx : region)
+	{
+		const auto& t = m_vTriangles[triangleIdx];
+		regionArea += GetTriangleArea(t.p1, t.p2, t.p3);
+
+		const Vector2 points[3] = { t.p1, t.p2, t.p3 };
+		for (auto i = 0; i < 3; ++i)
+		{
+			const auto neighbourIdx = t.metaData.IndexNeighbours[i];
+			if (isInRegion(neighbourIdx))
+				continue;
+
+			const auto& a = points[i];
+			const auto& b = points[(i + 1) % 3];
+			if (isRemoved && neighbourIdx == -1 && isOnChild((a + b) / 2.f))
+				continue;
+
+			borderEdges.push_back({ { getVertexId(a), getVertexId(b) } });
+			borderLines.push_back(t.metaData.IndexLines[i]);
+		}
+	}
+
+	//3. Chain the border into rings, every vertex has an even number of border edges so every walk ends where it started
+	std::vector<std::vector<int>> vertexEdges(vertices.size());
+	for (auto edgeIdx = 0; edgeIdx < static_cast<int>(borderEdges.size()); ++edgeIdx)
+	{
+		vertexEdges[borderEdges[edgeIdx][0]].push_back(edgeIdx);
+		vertexEdges[borderEdges[edgeIdx][1]].push_back(edgeIdx);
+	}
+
+	std::vector<std::vector<Vector2>> rings;
+	std::vector<bool> isEdgeUsed(borderEdges.size(), false);
+	for (auto startEdgeIdx = 0; startEdgeIdx < static_cast<int>(borderEdges.size()); ++startEdgeIdx)
+	{
+		if (isEdgeUsed[startEdgeIdx])
+			continue;
+
+		std::vector<Vector2> ring;
+		auto vertexIdx = borderEdges[startEdgeIdx][0];
+		for (auto edgeIdx = startEdgeIdx; edgeIdx != -1;)
+		{
+			isEdgeUsed[edgeIdx] = true;
+			ring.push_back(vertices[vertexIdx]);
+			vertexIdx = borderEdges[edgeIdx][0] == vertexIdx ? borderEdges[edgeIdx][1] : borderEdges[edgeIdx][0];
+
+			edgeIdx = -1;
+			for (const auto nextEdgeIdx : vertexEdges[vertexIdx])
+			{
+				if (!isEdgeUsed[nextEdgeIdx])
+				{
+					edgeIdx = nextEdgeIdx;
+					break;
+				}
+			}
+		}
+		rings.push_back(ring);
+	}
+
+	if (!isRemoved)
+		rings.push_back(std::vector<Vector2>(p.m_vPoints.begin(), p.m_vPoints.end()));
+
+	//4. Triangulate the region. When the child crosses the border of the mesh or another child the edges cross,
+	//when it lies in a hole (or around one) the area doesn't add up
+	ConstrainedDelaunay triangulation{};
+	if (!triangulation.Triangulate(rings))
+		return false;
+
+	auto childArea = 0.0;
+	for (auto it = p.m_vPoints.begin(); it != p.m_vPoints.end(); ++it)
+	{
+		const auto next = std::next(it) == p.m_vPoints.end() ? p.m_vPoints.begin() : std::next(it);
+		childArea += (static_cast<double>(it->x) * next->y - static_cast<double>(next->x) * it->y) / 2.0;
+	}
+	childArea = abs(childArea);
+
+	const auto& cdtVertices = triangulation.GetVertices();
+	const auto& cdtTriangles = triangulation.GetTriangles();
+	auto newArea = 0.0;
+	for (const auto& t : cdtTriangles)
+		newArea += GetTriangleArea(cdtVertices[t[0]], cdtVertices[t[1]], cdtVertices[t[2]]);
+
+	const auto expectedArea = isRemoved ? regionArea + childArea : regionArea - childArea;
+	if (abs(newArea - expectedArea) > 1.0e-4 * (regionArea + childArea))
+		return false;
+
+	//5. Lines of the new triangles, the border edges have to come back exactly once (they aren't split)
+	const auto nrOfBorderEdges = static_cast<int>(borderEdges.size());
+	std::unordered_map<unsigned long long, int> edgeLines; //Border edge, or new line after the border edges
+	edgeLines.reserve(cdtTriangles.size() * 2);
+	for (auto edgeIdx = 0; edgeIdx < nrOfBorderEdges; ++edgeIdx)
+		edgeLines.insert({ GetEdgeKey(borderEdges[edgeIdx][0], borderEdges[edgeIdx][1]), edgeIdx });
+
+	std::vector<int> borderEdgeUses(nrOfBorderEdges, 0);
+	std::vector<std::array<int, 2>> newLineVertices;
+	std::vector<std::array<int, 3>> newTriangleLines;
+	newTriangleLines.reserve(cdtTriangles.size());
+	for (const auto& t : cdtTriangles)
+	{
+		const int ids[3] = { getVertexId(cdtVertices[t[0]]), getVertexId(cdtVertices[t[1]]), getVertexId(cdtVertices[t[2]]) };
+		std::array<int, 3> lines;
+		for (auto i = 0; i < 3; ++i)
+		{
+			const auto result = edgeLines.insert({ GetEdgeKey(ids[i], ids[(i + 1) % 3]), nrOfBorderEdges + static_cast<int>(newLineVertices.size()) });
+			if (result.second)
+				newLineVertices.push_back({ { ids[i], ids[(i + 1) % 3] } });
+			else if (result.first->second < nrOfBorderEdges)
+				++borderEdgeUses[result.first->second];
+			lines[i] = result.first->second;
+		}
+		newTriangleLines.push_back(lines);
+	}
+
+	if (std::find_if(borderEdgeUses.begin(), borderEdgeUses.end(), [](int uses) { return uses != 1; }) != borderEdgeUses.end())
+		return false;
+
+	//6. Replace the region. Lines that were only inside of it are freed, the border lines lose their triangle inside of it
+	std::vector<int> keptLines = borderLines;
+	std::sort(keptLines.begin(), keptLines.end());
+	for (const auto triangleIdx : region)
+	{
+		const auto& lines = m_vTriangles[triangleIdx].metaData.IndexLines;
+		change.removedTriangles.push_back(lines);
+		for (const auto lineIdx : lines)
+		{
+			if (!std::binary_search(keptLines.begin(), keptLines.end(), lineIdx))
+				change.removedLines.push_back(lineIdx);
+		}
+		RemoveTriangleFromBins(triangleIdx);
+	}
+	std::sort(change.removedLines.begin(), change.removedLines.end());
+	change.removedLines.erase(std::unique(change.removedLines.begin(), change.removedLines.end()), change.removedLines.end());
+
+	for (const auto lineIdx : change.removedLines)
+	{
+		m_vLines[lineIdx] = Line();
+		m_vLineTriangles[lineIdx] = { { -1, -1 } };
+		m_vFreeLines.push_back(lineIdx);
+	}
+
+	for (const auto lineIdx : borderLines)
+	{
+		auto& lineTriangles = m_vLineTriangles[lineIdx];
+		if (isInRegion(lineTriangles[0]))
+			lineTriangles[0] = lineTriangles[1];
+		lineTriangles[1] = -1;
+	}
+
+	//New lines take the free slots first
+	std::vector<int> lineIndices = borderLines;
+	for (const auto& edge : newLineVertices)
+	{
+		auto lineIdx = static_cast<int>(m_vLines.size());
+		if (!m_vFreeLines.empty())
+		{
+			lineIdx = m_vFreeLines.back();
+			m_vFreeLines.pop_back();
+		}
+		else
+		{
+			m_vLines.push_back(Line());
+			m_vLineTriangles.push_back({ { -1, -1 } });
+		}
+
+		m_vLines[lineIdx] = Line(vertices[edge[0]], vertices[edge[1]], lineIdx);
+		change.addedLines.push_back(lineIdx);
+		lineIndices.push_back(lineIdx);
+	}
+
+	//New triangles take the slots of the region first
+	std::vector<int> newTriangles;
+	newTriangles.reserve(cdtTriangles.size());
+	for (size_t i = 0; i < cdtTriangles.size(); ++i)
+	{
+		const auto triangleIdx = i < region.size() ? region[i] : static_cast<int>(m_vTriangles.size());
+		if (i >= region.size())
+			m_vTriangles.push_back(Triangle());
+
+		const auto& vertexIndices = cdtTriangles[i];
+		auto& t = m_vTriangles[triangleIdx];
+		t = Triangle(cdtVertices[vertexIndices[0]], cdtVertices[vertexIndices[1]], cdtVertices[vertexIndices[2]]);
+		t.metaData.Index = triangleIdx;
+		for (auto j = 0; j < 3; ++j)
+		{
+			const auto lineIdx = lineIndices[newTriangleLines[i][j]];
+			t.metaData.IndexLines[j] = lineIdx;
+
+			auto& lineTriangles = m_vLineTriangles[lineIdx];
+			assert(lineTriangles[1] == -1 && "<Polygon::RetriangulateAroundChild>: line shared by more than two triangles");
+			(lineTriangles[0] == -1 ? lineTriangles[0] : lineTriangles[1]) = triangleIdx;
+		}
+		newTriangles.push_back(triangleIdx);
+	}
+
+	for (const auto triangleIdx : newTriangles)
+	{
+		auto& t = m_vTriangles[triangleIdx];
+		for (auto i = 0; i < 3; ++i)
+		{
+			const auto lineIdx = t.metaData.IndexLines[i];
+			const auto& lineTriangles = m_vLineTriangles[lineIdx];
+			const auto neighbourIdx = lineTriangles[0] == triangleIdx ? lineTriangles[1] : lineTriangles[0];
+			t.metaData.IndexNeighbours[i] = neighbourIdx;
+			if (neighbourIdx == -1)
+				continue;
+
+			auto& neighbour = m_vTriangles[neighbourIdx].metaData;
+			for (auto j = 0; j < 3; ++j)
+			{
+				if (neighbour.IndexLines[j] == lineIdx)
+					neighbour.IndexNeighbours[j] = triangleIdx;
+			}
+		}
+		AddTriangleToBins(triangleIdx);
+		change.addedTriangles.push_back(t.metaData.IndexLines);
+	}
+
+	//Fewer triangles than before, the last triangles move into the slots that are left over
+	for (auto i = static_cast<int>(region.size()) - 1; i >= static_cast<int>(cdtTriangles.size()); --i)
+	{
+		const auto triangleIdx = region[i];
+		const auto lastIdx = static_cast<int>(m_vTriangles.size()) - 1;
+		if (triangleIdx != lastIdx)
+		{
+			RemoveTriangleFromBins(lastIdx);
+			auto& t = m_vTriangles[triangleIdx];
+			t = m_vTriangles[lastIdx];
+			t.metaData.Index = triangleIdx;
+			for (auto j = 0; j < 3; ++j)
+			{
+				for (auto& lineTriangle : m_vLineTriangles[t.metaData.IndexLines[j]])
+				{
+					if (lineTriangle == lastIdx)
+						lineTriangle = triangleIdx;
+				}
+
+				const auto neighbourIdx = t.metaData.IndexNeighbours[j];
+				if (neighbourIdx == -1)
+					continue;
+
+				for (auto& neighbourNeighbourIdx : m_vTriangles[neighbourIdx].metaData.IndexNeighbours)
+				{
+					if (neighbourNeighbourIdx == lastIdx)
+						neighbourNeighbourIdx = triangleIdx;
+				}
+			}
+			AddTriangleToBins(triangleIdx);
+		}
+		m_vTriangles.pop_back();
+	}
+
+	return true;
+}
+#endif
+
+void Elite::Polygon::TriangulateEarClipping()
+{
+	//TODO: CHECK FOR OVERLAPPING POLYGONS AND MERGE WHEN REQUIRED
+	for (auto child : m_vChildren)
+	{
+		//Check for overlap, if so merge, create new child and remove old ones!
+		//FILL IN FUNCTIONS!
+	}
+
+	//Sort the children. Start by sorting from top to bottom (verices are what matters, not the "center" pos of the polygon!)
+	std::sort(m_vChildren.begin(), m_vChildren.end(),
+		[](const Polygon& p1, const Polygon& p2)
+	{ return p1.GetPosVertMaxYPos() > p2.GetPosVertMaxYPos(); });
+
+	//Copy children as backup after sort
+	const auto children = m_vChildren;
+	
+	//THEN, we check two elements, if the don't overlap horizontally you don't do anything, else you swap them based on right most object
+	for (auto i = 0; i < static_cast<int>(m_vChildren.size()) - 1; ++i)
+	{
+		if (m_vChildren[i].OverlappingYAxis(m_vChildren[i + 1]))
+		{
+			//Swap if i.y < i+1.y
+			if (m_vChildren[i].GetPosVertMaxXPos() < m_vChildren[i + 1].GetPosVertMaxXPos())
+			{
+				const auto temp = m_vChildren[i];
+				m_vChildren[i] = m_vChildren[i + 1];
+				m_vChildren[i + 1] = temp;
+			}
+		}
+	}
+
+	//First split polygon
+	while (m_vChildren.size() != 0)
+		Split();
+
+	std::list<Vector2> copyPoints;
+	copyPoints.assign(m_vPoints.begin(), m_vPoints.end()); //Copy
+
+	//For each ear, remove ear and push verts, recheck earness (including convexness obviously :-))!
+	while (copyPoints.size() > 3)
+	{
+		list<Vector2>::const_iterator earListIt = copyPoints.end();
+		for (auto it = copyPoints.begin(); it != copyPoints.end(); ++it)
+		{
+			if (earListIt != copyPoints.end())
+				break;
+			if (IsConvexInPolygon(copyPoints, it) && IsEar(copyPoints, it))
+				earListIt = it;
+		}
+
+		//No ear left (e.g. overlapping children), keep what has been triangulated so far
+		if (earListIt == copyPoints.end())
+			break;
+
+		//Push triangle
+		Vector2 current, prev, next;
+		GetTriangle(copyPoints, earListIt, current, prev, next);
+		m_vTriangles.push_back(Triangle(prev, current, next));
+
+		//Remove current from pointslist
+		const auto currentIt = std::find(copyPoints.begin(), copyPoints.end(), current);
+		copyPoints.erase(currentIt); //remove
+	}
+	//Add the remaining 3 vertices to the triangulated polygon
+	if (copyPoints.size() == 3)
+	{
+		std::vector<Vector2> tempCopy;
+		for (const auto p : copyPoints)
+			tempCopy.push_back(p);
+		m_vTriangles.push_back(Triangle(tempCopy[0], tempCopy[1], tempCopy[2]));
+	}
+
+	m_vChildren = children;
+}
+
 void Elite::Polygon::FindMutualVisibleVertices(const Polygon& outer, const Polygon& inner, Vector2& pOuter, Vector2& pInner)
 {
 	//1. Find vertex with the biggest x value of the inner polygon AND biggest x value of outer polygon (used for size ray)
@@ -45,7 +45,9 @@ namespace Elite
 	//Triangle MetaData is used for optimized intersecting and shared edges calculations
 	struct TriangleMetaData final
 	{
+		int Index = -1; //Index in the triangles of the polygon
 		std::array<int, 3> IndexLines{ {-1, -1, -1} };
+		std::array<int, 3> IndexNeighbours{ {-1, -1, -1} }; //Triangle on the other side of each line, -1 on the border of the mesh
 	};
 
 	struct Triangle final
@@ -77,6 +79,17 @@ namespace Elite
 	};
 #pragma endregion //Triangle
 
+#pragma region TriangulationChange
+	//What a local retriangulation changed, so structures built on the lines (e.g. a NavGraph) can be patched instead of rebuilt
+	struct TriangulationChange final
+	{
+		std::vector<int> removedLines; //Their slots get reused by the added lines
+		std::vector<int> addedLines;
+		std::vector<std::array<int, 3>> removedTriangles; //Lines of the triangles that were replaced
+		std::vector<std::array<int, 3>> addedTriangles; //Lines of the triangles that replaced them
+	};
+#pragma endregion //TriangulationChange
+
 #pragma region Polygon
 	class Polygon final
 	{
@@ -87,7 +100,6 @@ namespace Elite
 		explicit Polygon(const std::vector<Vector2>& vertices);
 		explicit Polygon(const std::vector<Vector2>& outerShape, const std::vector<std::vector<Vector2>> &innerShapes);
 		explicit Polygon(const Vector2* vertices, int count);
-		~Polygon();
 
 		//=== Functions ===
 		//Child functionality
@@ -103,8 +115,8 @@ namespace Elite
 		int GetAmountVertices() const;
 		const std::list<Vector2>& GetPoints() const;
 		const std::vector<Polygon>& GetChildren() const;
-		const std::vector<Triangle*>& GetTriangles() const;
-		const std::vector<Line*>& GetLines() const;
+		const std::vector<Triangle>& GetTriangles() const;
+		const std::vector<Line>& GetLines() const;
 
 		//Getters information
 		float GetPosVertMaxXPos() const;
@@ -113,18 +125,30 @@ namespace Elite
 		float GetPosVertMinYPos() const;
 		bool OverlappingXAxis(const Polygon& poly) const;
 		bool OverlappingYAxis(const Polygon& poly) const;
-		std::vector<Triangle*> GetAdjacentTriangles(const Triangle* t) const;
-		std::vector<Triangle*> GetAdjacentTrianglesOnLine(const Triangle* t, const Line& l) const;
+		std::vector<const Triangle*> GetAdjacentTriangles(const Triangle* t) const;
+		std::vector<const Triangle*> GetAdjacentTrianglesOnLine(const Triangle* t, const Line& l) const;
 
+		//Only tests the triangles binned around the position
 		const Triangle* GetTriangleFromPosition(const Vector2& position, bool onLineAllowed = false) const;
+		//Walks from the hint (e.g. the triangle an agent was in last frame) over the neighbours, falls back on the bins when the walk gets lost.
+		//A hint that isn't a triangle of the current triangulation is ignored
+		const Triangle* GetTriangleFromPosition(const Vector2& position, const Triangle* pHint, bool onLineAllowed = false) const;
 #ifdef USE_TRIANGLE_METADATA
 		const std::vector<const Triangle*> GetTrianglesFromLineIndex(unsigned int lineIndex) const;
+		//Indices of the (at most two) triangles that share the line, -1 for a missing side
+		const std::array<int, 2>& GetTriangleIndicesFromLineIndex(unsigned int lineIndex) const;
 #endif
 
 
 
 		//Triangulation functions
-		const std::vector<Triangle*>& Triangulate();
+		const std::vector<Triangle>& Triangulate();
+#ifdef USE_TRIANGLE_METADATA
+		//Only the triangles around the child get retriangulated. The child has to lie inside of this polygon without touching its border
+		//or the other children, otherwise false is returned and nothing changes. Lines keep their index, triangles can move.
+		bool AddChildToTriangulation(const Polygon& p, TriangulationChange& change);
+		bool RemoveChildFromTriangulation(const Polygon& p, TriangulationChange& change);
+#endif
 		void OrientateWithChildren(Winding winding);
 		void ExpandShape(float amount);
 
@@ -136,18 +160,37 @@ namespace Elite
 		//=== Datamembers ===
 		std::vector<Polygon> m_vChildren; //Inner shapes of this polygon
 		std::list<Vector2> m_vPoints; //Points that define this polygon
-		std::vector<Triangle*> m_vpTriangles; //Triangles create for this polygon, used for rendering
-		std::vector<Line*> m_vpLines; //Lines constructing this polygon!
+		std::vector<Triangle> m_vTriangles; //Triangles create for this polygon, used for rendering
+		std::vector<Line> m_vLines; //Lines constructing this polygon!
+		std::vector<std::array<int, 2>> m_vLineTriangles; //Triangles on both sides of each line, filled with the lines
+		std::vector<int> m_vFreeLines; //Lines removed by a local retriangulation, {-1, -1} in m_vLineTriangles
 		bool m_isTriangulated = false;
 
+		//Uniform grid over the triangles, every bin lists the triangles whose bounding box overlaps it
+		Vector2 m_BinsOrigin = {};
+		float m_BinSize = 1.f;
+		int m_NrOfBinColumns = 0;
+		int m_NrOfBinRows = 0;
+		std::vector<std::vector<int>> m_vBins;
+
 		//=== Functions ===
 		//Private General Functions
 		void GetTriangle(const std::list<Vector2>& l, const std::list<Vector2>::const_iterator p, Vector2& currentTip, Vector2& previous, Vector2& next) const;
 		bool IsConvexInPolygon(const std::list<Vector2>& l, const std::list<Vector2>::const_iterator p) const;
 		bool IsEar(const std::list<Vector2>& l, const std::list<Vector2>::const_iterator p) const;
 		void GenerateLineMatrix();
+		void GenerateTriangleBins();
+		int GetBinIndex(const Vector2& position) const;
+		std::array<int, 4> GetBinRange(const Triangle& t) const; //Min column, min row, max column, max row
+		void AddTriangleToBins(int triangleIdx);
+		void RemoveTriangleFromBins(int triangleIdx);
 
 		//Private Triangulation Functions
+		bool TriangulateConstrainedDelaunay();
+		void TriangulateEarClipping();
+#ifdef USE_TRIANGLE_METADATA
+		bool RetriangulateAroundChild(const Polygon& p, bool isRemoved, TriangulationChange& change);
+#endif
 		void FindMutualVisibleVertices(const Polygon& outer, const Polygon& inner, Vector2& pOuter, Vector2& pInner);
 		void Split();
 	};
@@ -200,22 +200,20 @@ void SDLDebugRenderer2D::DrawSolidPolygon(Elite::Polygon* polygon, const Color&
 	points.assign(polygon->GetPoints().begin(), polygon->GetPoints().end());
 
 	//Triangulation
-	std::vector<Elite::Triangle*> triangles;
-	if (triangulate || (!triangulate && !polygon->IsTriangulated())) //Triangulate if requested OR when necessary!
-		triangles = polygon->Triangulate();
-	else
-		triangles = polygon->GetTriangles();
+	//Triangulate if requested OR when necessary!
+	const std::vector<Elite::Triangle>& triangles = triangulate || (!triangulate && !polygon->IsTriangulated())
+		? polygon->Triangulate() : polygon->GetTriangles();
 
 	//Duplicate code because of possible triangulation with children -> cannot call DrawSolidPolygon directly (like Box2D)
 	//Else we would have "double triangulation"!! 
 	for (auto i = 0; i < static_cast<int>(triangles.size()); ++i)
 	{
-		m_vTriangles.push_back(Vertex(triangles[i]->p1, depth, fillColor));
-		m_vTriangles.push_back(Vertex(triangles[i]->p2, depth, fillColor));
-		m_vTriangles.push_back(Vertex(triangles[i]->p3, depth, fillColor));
+		m_vTriangles.push_back(Vertex(triangles[i].p1, depth, fillColor));
+		m_vTriangles.push_back(Vertex(triangles[i].p2, depth, fillColor));
+		m_vTriangles.push_back(Vertex(triangles[i].p3, depth, fillColor));
 
 		//TEST
-		Elite::Vector2 pos = Elite::Vector2(triangles[i]->p1 + triangles[i]->p2 + triangles[i]->p3) / 3.0f;
+		Elite::Vector2 pos = Elite::Vector2(triangles[i].p1 + triangles[i].p2 + triangles[i].p3) / 3.0f;
 		DrawPoint(pos, 2, Color(0, 1, 0, 1));
 	}
 
@@ -240,12 +238,12 @@ void SDLDebugRenderer2D::DrawSolidPolygon(Elite::Polygon* polygon, const Color&
 	{
 		for (auto i = 0; i < static_cast<int>(triangles.size()); ++i)
 		{
-			m_vLines.push_back(Vertex(triangles[i]->p1, depth, wireFrameColor));
-			m_vLines.push_back(Vertex(triangles[i]->p2, depth, wireFrameColor));
-			m_vLines.push_back(Vertex(triangles[i]->p2, depth, wireFrameColor));
-			m_vLines.push_back(Vertex(triangles[i]->p3, depth, wireFrameColor));
-			m_vLines.push_back(Vertex(triangles[i]->p3, depth, wireFrameColor));
-			m_vLines.push_back(Vertex(triangles[i]->p1, depth, wireFrameColor));
+			m_vLines.push_back(Vertex(triangles[i].p1, depth, wireFrameColor));
+			m_vLines.push_back(Vertex(triangles[i].p2, depth, wireFrameColor));
+			m_vLines.push_back(Vertex(triangles[i].p2, depth, wireFrameColor));
+			m_vLines.push_back(Vertex(triangles[i].p3, depth, wireFrameColor));
+			m_vLines.push_back(Vertex(triangles[i].p3, depth, wireFrameColor));
+			m_vLines.push_back(Vertex(triangles[i].p1, depth, wireFrameColor));
 		}
 	}
 }
@@ -264,16 +262,15 @@ void SDLDebugRenderer2D::DrawSolidPolygon(const Elite::Vector2* points, int coun
 
 	if (triangluate)
 	{
-		auto verts = std::vector<Elite::Triangle*>();
 		Elite::Polygon polygon(points, count);
-		verts = polygon.Triangulate();
+		const auto& verts = polygon.Triangulate();
 
 		//Draw Triangles
 		for (auto i = 0; i < static_cast<int>(verts.size()); ++i)
 		{
-			m_vTriangles.push_back(Vertex(verts[i]->p1, depth, fillColor));
-			m_vTriangles.push_back(Vertex(verts[i]->p2, depth, fillColor));
-			m_vTriangles.push_back(Vertex(verts[i]->p3, depth, fillColor));
+			m_vTriangles.push_back(Vertex(verts[i].p1, depth, fillColor));
+			m_vTriangles.push_back(Vertex(verts[i].p2, depth, fillColor));
+			m_vTriangles.push_back(Vertex(verts[i].p3, depth, fillColor));
 		}
 	}
 	else
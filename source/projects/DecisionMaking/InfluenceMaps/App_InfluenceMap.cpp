@@ -11,9 +11,10 @@ using namespace Elite;
 //Destructor
 App_InfluenceMap::~App_InfluenceMap()
 {
-	SAFE_DELETE(m_pInfluenceGrid);
-
+	// The agents and their planners use the grid, so they go first
 	SAFE_DELETE(m_pInfluenceChasing);
+
+	SAFE_DELETE(m_pInfluenceGrid);
 }
 
 //Functions
@@ -33,7 +34,7 @@ void App_InfluenceMap::Start()
 	DEBUGRENDERER2D->GetActiveCamera()->SetMoveLocked(false);
 
 	m_pInfluenceGrid = new InfluenceMap<InfluenceGrid>(false);
-	m_pInfluenceGrid->InitializeGrid(cellAmount, cellAmount, cellSize, false, true);
+	Elite::LoadOrInitializeGrid(INFLUENCE_GRID_FILE, *m_pInfluenceGrid, cellAmount, cellAmount, cellSize, false, true);
 	m_pInfluenceGrid->InitializeBuffer();
 
 	m_GraphRenderer.SetNumberPrintPrecision(0);
@@ -108,6 +109,21 @@ void App_InfluenceMap::UpdateUI()
 	ImGui::Checkbox("Render as graph", &m_RenderAsGraph);
 	ImGui::Checkbox("Render agents", &m_RenderAgents);
 
+	bool useAnyAnglePaths{ m_pInfluenceChasing->GetUseAnyAnglePaths() };
+	if (ImGui::Checkbox("Any-angle paths (async A*)", &useAnyAnglePaths))
+		m_pInfluenceChasing->SetUseAnyAnglePaths(useAnyAnglePaths);
+
+	if (useAnyAnglePaths)
+	{
+		const Elite::PathCacheStats stats{ m_pInfluenceChasing->GetPathCacheStats() };
+		ImGui::Indent();
+		ImGui::Text("Cache hits: %d", stats.nrOfHits);
+		ImGui::Text("Suffix hits: %d", stats.nrOfSuffixHits);
+		ImGui::Text("Hit rate: %.2f", stats.GetHitRate());
+		ImGui::Text("Time saved: %.3f ms", stats.timeSaved);
+		ImGui::Unindent();
+	}
+
 	//Get influence map data
 	auto maxHeat = m_pInfluenceChasing->GetMaxHeat();
 	auto maxAmountOfHeatedCells = m_pInfluenceChasing->GetMaxAmountOfHeatedCells();
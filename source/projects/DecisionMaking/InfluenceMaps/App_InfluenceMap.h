@@ -11,6 +11,7 @@
 #include "framework\EliteAI\EliteGraphs\EGraph2D.h"
 #include "framework\EliteAI\EliteGraphs\EGridGraph.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphEditor.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphFile.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphRenderer.h"
 
 class NavigationColliderElement;
@@ -40,6 +41,7 @@ public:
 
 private:
 	Elite::InfluenceMap<InfluenceGrid>* m_pInfluenceGrid = nullptr;
+	const std::string INFLUENCE_GRID_FILE = "InfluenceMap.graph"; //Grid of the level, written on the first start
 	Elite::GraphEditor m_GridEditor{};
 	Elite::GraphRenderer m_GraphRenderer{};
 
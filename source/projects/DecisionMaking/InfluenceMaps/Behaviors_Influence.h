@@ -92,13 +92,13 @@ namespace Influence_Conditions
 		Elite::InfluenceNode* pAgentNode{ pInfluenceGrid->GetNodeAtWorldPos(pAgent->GetPosition()) };
 		
 		Elite::InfluenceNode* pLowestInfluenceNode{ pAgentNode };
-		float lowestInfluence{ pAgentNode->GetInfluence() };
+		float lowestInfluence{ pInfluenceGrid->GetInfluence(pAgentNode->GetIndex()) };
 
 		// Go through all nodes connected with agentNode
 		for (const auto& currentConnection : pInfluenceGrid->GetNodeConnections(pAgentNode))
 		{
 			Elite::InfluenceNode* pNextNode{ pInfluenceGrid->GetNode(currentConnection->GetTo()) };
-			const float nextNodeInfluence{ pNextNode->GetInfluence() };
+			const float nextNodeInfluence{ pInfluenceGrid->GetInfluence(pNextNode->GetIndex()) };
 
 			// If nodeInfluence lower then lowest influence, this nodeInfluence is the new lowest one
 			if (nextNodeInfluence < lowestInfluence)
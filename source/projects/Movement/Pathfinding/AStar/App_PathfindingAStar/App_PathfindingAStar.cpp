@@ -5,12 +5,27 @@
 #include "App_PathfindingAStar.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAstar.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EBFS.h"
+#include "projects/Movement/SteeringBehaviors/SteeringAgent.h"
+#include "projects/Movement/SteeringBehaviors/Steering/SteeringBehaviors.h"
+#include <chrono>
 
 using namespace Elite;
 
 //Destructor
 App_PathfindingAStar::~App_PathfindingAStar()
 {
+	for (auto pAgent : m_FlowFieldAgents)
+		SAFE_DELETE(pAgent);
+	SAFE_DELETE(m_pFlowFieldFollow);
+	SAFE_DELETE(m_pJumpPointSearch);
+	SAFE_DELETE(m_pThetaStar);
+	SAFE_DELETE(m_pKernelAStar);
+	SAFE_DELETE(m_pCooperativePathfinder);
+	SAFE_DELETE(m_pLandmarks);
+	SAFE_DELETE(m_pAStarScheduler);
+	SAFE_DELETE(m_pFlowFieldCache);
+	SAFE_DELETE(m_pPathRequestService);
+	SAFE_DELETE(m_pHierarchicalPathfinder);
 	SAFE_DELETE(m_pGridGraph);
 	SAFE_DELETE(m_pGraphRenderer);
 	SAFE_DELETE(m_pGraphEditor);
@@ -21,6 +36,8 @@ void App_PathfindingAStar::Start()
 {
 	m_pGraphEditor = new GraphEditor();
 	m_pGraphRenderer = new GraphRenderer();
+	m_pPathRequestService = new PathRequestService();
+	m_pFlowFieldFollow = new FlowFieldFollow();
 	//Set Camera
 	DEBUGRENDERER2D->GetActiveCamera()->SetZoom(39.0f);
 	DEBUGRENDERER2D->GetActiveCamera()->SetCenter(Elite::Vector2(73.0f, 35.0f));
@@ -66,6 +83,48 @@ void App_PathfindingAStar::Update(float deltaTime)
 	{
 		CalculatePath();
 	}
+
+	//FLOW FIELD, only rebuilt when the end node or the grid changed
+	const bool needsFlowField{ (m_DrawFlowField || m_UseFlowFieldAgents) && endPathIdx != invalid_node_index };
+	m_pFlowField = needsFlowField ? m_pFlowFieldCache->GetFlowField(endPathIdx) : nullptr;
+
+	//PICK UP ASYNCHRONOUS PATH
+	m_pPathRequestService->Update();
+	if (m_pPathRequestService->TakePath(m_PathRequest, m_pGridGraph, m_vPath))
+	{
+		m_PathRequest = invalid_path_request;
+		std::cout << "New Path Calculated" << std::endl;
+	}
+
+	//CONTINUE TIME-SLICED SEARCH
+	m_pAStarScheduler->Update();
+	if (m_pAStarScheduler->TakePath(m_SearchHandle, m_vPath))
+	{
+		m_SearchHandle = invalid_search_handle;
+		std::cout << "New Path Calculated" << std::endl;
+	}
+	else if (m_SearchHandle != invalid_search_handle)
+	{
+		m_vPath = m_pAStarScheduler->GetPartialPath(m_SearchHandle);
+	}
+
+	//COOPERATIVE AGENTS
+	UpdateCooperativeAgents(deltaTime);
+
+	//FLOW FIELD AGENTS
+	UpdateFlowFieldAgents(deltaTime);
+
+	//STRING PULLING
+	m_vPulledPath.clear();
+	if (m_UseStringPulling)
+	{
+		if (!m_Passability.IsUpToDate(*m_pGridGraph))
+			m_Passability.Build(*m_pGridGraph);
+
+		const auto startTime = std::chrono::steady_clock::now();
+		m_vPulledPath = GridStringPulling::OptimizePath(m_vPath, *m_pGridGraph, m_Passability);
+		m_StringPullingTime = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+	}
 }
 
 void App_PathfindingAStar::Render(float deltaTime) const
@@ -86,12 +145,54 @@ void App_PathfindingAStar::Render(float deltaTime) const
 		m_pGraphRenderer->HighlightNodes(m_pGridGraph, { m_pGridGraph->GetNode(endPathIdx) }, END_NODE_COLOR);
 	}
 
+	//Render flow field directions
+	if (m_DrawFlowField && m_pFlowField)
+	{
+		for (int idx{}; idx < m_pFlowField->GetNrOfCells(); ++idx)
+		{
+			if (m_pFlowField->GetNextCellIdx(idx) != invalid_node_index)
+				DEBUGRENDERER2D->DrawDirection(m_pGridGraph->GetNodeWorldPos(idx), m_pFlowField->GetDirection(idx), m_SizeCell / 2.f, { 0.f, 0.6f, 1.f });
+		}
+	}
+
 	//render path below if applicable
 	if (m_vPath.size() > 0)
 	{
 		m_pGraphRenderer->HighlightNodes(m_pGridGraph, m_vPath);
 	}
 
+	//render cooperative agents between the cell they are in and the cell they move to
+	if (m_UseCooperativeAgents)
+	{
+		const float stepProgress{ m_CooperativeStepTimer / COOPERATIVE_STEP_TIME };
+		for (size_t i{}; i < m_CooperativeAgents.size(); ++i)
+		{
+			const int agentId{ m_CooperativeAgents[i] };
+			const Color agentColor{ float(i % 3) / 2.f, float(i % 4) / 3.f, 1.f - float(i % 5) / 4.f };
+
+			const std::vector<int> plannedCells{ m_pCooperativePathfinder->GetPlannedCells(agentId) };
+			for (size_t cell{ 1 }; cell < plannedCells.size(); ++cell)
+				DEBUGRENDERER2D->DrawSegment(m_pGridGraph->GetNodeWorldPos(plannedCells[cell - 1]), m_pGridGraph->GetNodeWorldPos(plannedCells[cell]), agentColor, -0.2f);
+
+			const Vector2 cellPos{ m_pGridGraph->GetNodeWorldPos(m_pCooperativePathfinder->GetCell(agentId)) };
+			const Vector2 nextCellPos{ m_pGridGraph->GetNodeWorldPos(m_pCooperativePathfinder->GetNextCell(agentId)) };
+			DEBUGRENDERER2D->DrawSolidCircle(cellPos + (nextCellPos - cellPos) * stepProgress, m_SizeCell / 3.f, { 1.f, 0.f }, agentColor, -0.3f);
+			DEBUGRENDERER2D->DrawCircle(m_pGridGraph->GetNodeWorldPos(m_pCooperativePathfinder->GetGoal(agentId)), m_SizeCell / 4.f, agentColor, -0.3f);
+		}
+	}
+
+	//render the crowd following the flow field
+	for (auto pAgent : m_FlowFieldAgents)
+	{
+		pAgent->Render(deltaTime);
+	}
+
+	//render string pulled path on top
+	for (size_t i{ 1 }; i < m_vPulledPath.size(); ++i)
+	{
+		DEBUGRENDERER2D->DrawSegment(m_vPulledPath[i - 1], m_vPulledPath[i], { 1.f, 1.f, 0.f }, -0.2f);
+	}
+
 }
 
 void App_PathfindingAStar::MakeGridGraph()
@@ -103,10 +204,24 @@ void App_PathfindingAStar::MakeGridGraph()
 	m_pGridGraph->GetNode(66)->SetTerrainType(TerrainType::Water);
 	m_pGridGraph->GetNode(67)->SetTerrainType(TerrainType::Water);
 	m_pGridGraph->GetNode(47)->SetTerrainType(TerrainType::Water);
+	m_pGridGraph->BeginEdit();
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(86);
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(66);
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(67);
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(47);
+	m_pGridGraph->EndEdit();
+
+	//The abstraction is built on the first query and repaired through the graph's change listener afterwards
+	m_pHierarchicalPathfinder = new HierarchicalPathfinder<GridTerrainNode, GraphConnection>(m_pGridGraph, m_pHeuristicFunction, CLUSTER_SIZE);
+	m_pHierarchicalPathfinder->SetValidateAgainstAStar(m_ValidateHierarchicalPaths);
+
+	m_pFlowFieldCache = new FlowFieldCache<GridTerrainNode, GraphConnection>(m_pGridGraph);
+	m_pLandmarks = new LandmarkHeuristic<GridTerrainNode, GraphConnection>(m_pGridGraph);
+	m_pAStarScheduler = new AStarScheduler<GridTerrainNode, GraphConnection>(m_pGridGraph, m_pHeuristicFunction, m_ExpansionsPerFrame);
+	m_pCooperativePathfinder = new CooperativePathfinder<GridTerrainNode, GraphConnection>(m_pGridGraph);
+	m_pJumpPointSearch = new JumpPointSearch<GridTerrainNode, GraphConnection>(m_pGridGraph, m_pHeuristicFunction);
+	m_pKernelAStar = new GridGraphAStar<GridTerrainNode, GraphConnection>(m_pGridGraph);
+	m_pThetaStar = new ThetaStar<GridTerrainNode, GraphConnection>(m_pGridGraph, m_UseLazyThetaStar);
 }
 
 void App_PathfindingAStar::UpdateImGui()
@@ -162,6 +277,25 @@ void App_PathfindingAStar::UpdateImGui()
 		ImGui::Checkbox("NodeNumbers", &m_DebugSettings.DrawNodeNumbers);
 		ImGui::Checkbox("Connections", &m_DebugSettings.DrawConnections);
 		ImGui::Checkbox("Connections Costs", &m_DebugSettings.DrawConnectionCosts);
+		ImGui::Checkbox("Flow Field", &m_DrawFlowField);
+		ImGui::Checkbox("Cooperative Agents", &m_UseCooperativeAgents);
+		ImGui::Checkbox("Flow Field Agents", &m_UseFlowFieldAgents);
+		if (m_UseCooperativeAgents)
+		{
+			ImGui::Indent();
+			ImGui::Text("Replans: %d", m_pCooperativePathfinder->GetNrOfReplansLastStep());
+			ImGui::Text("Expansions: %d", m_pCooperativePathfinder->GetNrOfExpansionsLastStep());
+			ImGui::Text("Reservations: %d", m_pCooperativePathfinder->GetReservationTable().GetNrOfReservations());
+			ImGui::Unindent();
+		}
+		ImGui::Checkbox("String Pulling", &m_UseStringPulling);
+		if (m_UseStringPulling)
+		{
+			ImGui::Indent();
+			ImGui::Text("Waypoints: %d/%d", int(m_vPulledPath.size()), int(m_vPath.size()));
+			ImGui::Text("%.2f us", m_StringPullingTime);
+			ImGui::Unindent();
+		}
 		if (ImGui::Combo("", &m_SelectedHeuristic, "Manhattan\0Euclidean\0SqrtEuclidean\0Octile\0Chebyshev", 4))
 		{
 			switch (m_SelectedHeuristic)
@@ -188,6 +322,109 @@ void App_PathfindingAStar::UpdateImGui()
 		}
 		ImGui::Spacing();
 
+		if (ImGui::Checkbox("Hierarchical (HPA*)", &m_UseHierarchicalPathfinding))
+		{
+			CalculatePath();
+		}
+		if (ImGui::Checkbox("Asynchronous A*", &m_UseAsyncRequests))
+		{
+			CalculatePath();
+		}
+		if (ImGui::Checkbox("Landmarks (ALT)", &m_UseLandmarks))
+		{
+			CalculatePath();
+		}
+		if (ImGui::Checkbox("Time-sliced A*", &m_UseTimeSlicing))
+		{
+			CalculatePath();
+		}
+		if (ImGui::Checkbox("Jump Point Search", &m_UseJumpPointSearch))
+		{
+			CalculatePath();
+		}
+		if (ImGui::Checkbox("Theta*", &m_UseThetaStar))
+		{
+			CalculatePath();
+		}
+		if (m_UseThetaStar && ImGui::Checkbox("Lazy", &m_UseLazyThetaStar))
+		{
+			m_pThetaStar->SetLazy(m_UseLazyThetaStar);
+			CalculatePath();
+		}
+		if (m_UseTimeSlicing && ImGui::SliderInt("Expansions", &m_ExpansionsPerFrame, 1, 100))
+		{
+			m_pAStarScheduler->SetExpansionsPerFrame(m_ExpansionsPerFrame);
+		}
+
+		if (!m_UseHierarchicalPathfinding && !m_UseAsyncRequests && !m_UseTimeSlicing)
+		{
+			ImGui::Indent();
+			ImGui::Text("Expanded nodes: %d", m_NrOfExpandedNodes);
+			if (m_UseLandmarks)
+				ImGui::Text("Tables: %d bytes", int(m_pLandmarks->GetTableSize()));
+			if (m_UseJumpPointSearch && !m_pJumpPointSearch->IsGridSupported())
+				ImGui::Text("JPS: grid not uniform, used A*");
+			if (m_UseThetaStar)
+				ImGui::Text("Sight checks: %d", m_pThetaStar->GetNrOfLineOfSightChecks());
+			ImGui::Unindent();
+		}
+
+		if (m_UseAsyncRequests)
+		{
+			const PathCacheStats stats = m_pPathRequestService->GetPathCacheStats(m_pGridGraph);
+			ImGui::Indent();
+			ImGui::Text("Cache hits: %d", stats.nrOfHits);
+			ImGui::Text("Suffix hits: %d", stats.nrOfSuffixHits);
+			ImGui::Text("Hit rate: %.2f", stats.GetHitRate());
+			ImGui::Text("Time saved: %.3f ms", stats.timeSaved);
+			ImGui::Unindent();
+		}
+
+		if (m_UseHierarchicalPathfinding)
+		{
+			const HierarchicalPathStats& stats = m_pHierarchicalPathfinder->GetStats();
+			ImGui::Indent();
+			ImGui::Text("Clusters: %d", stats.nrOfClusters);
+			ImGui::Text("Abstract nodes: %d", stats.nrOfAbstractNodes);
+			ImGui::Text("Abstract edges: %d", stats.nrOfAbstractEdges);
+			ImGui::Text("Repaired clusters: %d", stats.nrOfRepairedClusters);
+			ImGui::Text("Path cost: %.2f", stats.pathCost);
+			if (ImGui::Checkbox("Validate against A*", &m_ValidateHierarchicalPaths))
+			{
+				m_pHierarchicalPathfinder->SetValidateAgainstAStar(m_ValidateHierarchicalPaths);
+				CalculatePath();
+			}
+			if (m_ValidateHierarchicalPaths)
+			{
+				ImGui::Text("A* cost: %.2f", stats.optimalCost);
+				ImGui::Text("Suboptimality: %.3f", stats.suboptimality);
+				ImGui::Text("Worst: %.3f", stats.worstSuboptimality);
+			}
+			ImGui::Unindent();
+		}
+		ImGui::Spacing();
+
+		if (ImGui::Button("Benchmark A*"))
+		{
+			RunBenchmark();
+		}
+		if (m_BenchmarkKernelTime > 0.f)
+		{
+			ImGui::Indent();
+			ImGui::Text("Queries: %d", NR_OF_BENCHMARK_QUERIES);
+			ImGui::Text("Runtime: %.3f ms", m_BenchmarkRuntimeTime);
+			ImGui::Text("Kernel: %.3f ms", m_BenchmarkKernelTime);
+			ImGui::Text("Speedup: %.2fx", m_BenchmarkRuntimeTime / m_BenchmarkKernelTime);
+			if (m_BenchmarkFileTime > 0.f)
+			{
+				ImGui::Text("File open: %.3f ms", m_BenchmarkFileOpenTime);
+				ImGui::Text("Kernel on file: %.3f ms", m_BenchmarkFileTime);
+			}
+			ImGui::Text("Mismatches: %d", m_NrOfBenchmarkMismatches);
+			ImGui::Unindent();
+		}
+		ImGui::Spacing();
+
 		//End
 		ImGui::PopAllowKeyboardFocus();
 		ImGui::End();
@@ -203,6 +440,12 @@ void App_PathfindingAStar::CalculatePath()
 		&& endPathIdx != invalid_node_index
 		&& startPathIdx != endPathIdx)
 	{
+		//A newer request replaces the one that is still being solved
+		m_pPathRequestService->Cancel(m_PathRequest);
+		m_PathRequest = invalid_path_request;
+		m_pAStarScheduler->Cancel(m_SearchHandle);
+		m_SearchHandle = invalid_search_handle;
+
 		////BFS Pathfinding
 		//auto pathfinder = BFS<GridTerrainNode, GraphConnection>(m_pGridGraph);
 		//auto startNode = m_pGridGraph->GetNode(startPathIdx);
@@ -210,18 +453,244 @@ void App_PathfindingAStar::CalculatePath()
 
 		//m_vPath = pathfinder.FindPath(startNode, endNode);
 
-		// A* Pathfinding
-		auto pathFinder = AStar<GridTerrainNode, GraphConnection>(m_pGridGraph,m_pHeuristicFunction);
 		auto startNode = m_pGridGraph->GetNode(startPathIdx);
 		auto endNode = m_pGridGraph->GetNode(endPathIdx);
 
-		m_vPath = pathFinder.FindPath(startNode, endNode);
+		if (m_UseHierarchicalPathfinding)
+		{
+			// HPA* Pathfinding
+			m_pHierarchicalPathfinder->SetHeuristic(m_pHeuristicFunction);
+			m_vPath = m_pHierarchicalPathfinder->FindPath(startNode, endNode);
+		}
+		else if (m_UseAsyncRequests)
+		{
+			// Asynchronous A* Pathfinding, the old path stays visible until the new one is picked up
+			m_PathRequest = m_pPathRequestService->RequestPath(m_pGridGraph, startNode, endNode, m_pHeuristicFunction);
+			return;
+		}
+		else if (m_UseTimeSlicing)
+		{
+			// Time-sliced A* Pathfinding, the partial path is shown while Update continues the search
+			m_pAStarScheduler->SetHeuristic(m_pHeuristicFunction);
+			m_pAStarScheduler->SetNodeHeuristic(m_UseLandmarks ? m_pLandmarks->GetNodeHeuristic() : NodeHeuristic{});
+			if (m_UseLandmarks)
+				m_pLandmarks->Update();
+			m_SearchHandle = m_pAStarScheduler->RequestPath(startNode, endNode);
+			return;
+		}
+		else if (m_UseThetaStar)
+		{
+			// Theta* Pathfinding
+			m_vPath = m_pThetaStar->FindPath(startNode, endNode);
+			m_NrOfExpandedNodes = m_pThetaStar->GetNrOfExpandedNodes();
+		}
+		else if (m_UseJumpPointSearch)
+		{
+			// Jump Point Search Pathfinding
+			m_pJumpPointSearch->SetHeuristic(m_pHeuristicFunction);
+			m_vPath = m_pJumpPointSearch->FindPath(startNode, endNode);
+			m_NrOfExpandedNodes = m_pJumpPointSearch->GetNrOfExpandedNodes();
+		}
+		else
+		{
+			// A* Pathfinding
+			auto pathFinder = AStar<GridTerrainNode, GraphConnection>(m_pGridGraph,m_pHeuristicFunction);
+			if (m_UseLandmarks)
+			{
+				m_pLandmarks->Update();
+				pathFinder.SetNodeHeuristic(m_pLandmarks->GetNodeHeuristic());
+			}
+			m_vPath = pathFinder.FindPath(startNode, endNode);
+			m_NrOfExpandedNodes = pathFinder.GetNrOfExpandedNodes();
+		}
 		
 		std::cout << "New Path Calculated" << std::endl;
 	}
 	else
 	{
 		std::cout << "No valid start and end node..." << std::endl;
+		m_pPathRequestService->Cancel(m_PathRequest);
+		m_PathRequest = invalid_path_request;
+		m_pAStarScheduler->Cancel(m_SearchHandle);
+		m_SearchHandle = invalid_search_handle;
 		m_vPath.clear();
 	}
 }
+
+void App_PathfindingAStar::RunBenchmark()
+{
+	//The stencil only has to be rebuilt after the grid was edited, not during the timing
+	m_pKernelAStar->Update();
+
+	auto runtimeAStar = AStar<GridTerrainNode, GraphConnection>(m_pGridGraph, HeuristicFunctions::Octile);
+
+	//Same queries for both
+	const int nrOfNodes{ m_pGridGraph->GetNrOfNodes() };
+	std::vector<std::pair<int, int>> queries{};
+	queries.reserve(NR_OF_BENCHMARK_QUERIES);
+	for (int i{}; i < NR_OF_BENCHMARK_QUERIES; ++i)
+		queries.push_back({ Elite::randomInt(nrOfNodes), Elite::randomInt(nrOfNodes) });
+
+	std::vector<std::vector<GridTerrainNode*>> runtimePaths{};
+	runtimePaths.reserve(queries.size());
+	auto startTime = std::chrono::steady_clock::now();
+	for (const auto& query : queries)
+		runtimePaths.push_back(runtimeAStar.FindPath(m_pGridGraph->GetNode(query.first), m_pGridGraph->GetNode(query.second)));
+	m_BenchmarkRuntimeTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	std::vector<std::vector<GridTerrainNode*>> kernelPaths{};
+	kernelPaths.reserve(queries.size());
+	startTime = std::chrono::steady_clock::now();
+	for (const auto& query : queries)
+		kernelPaths.push_back(m_pKernelAStar->FindPath(m_pGridGraph->GetNode(query.first), m_pGridGraph->GetNode(query.second)));
+	m_BenchmarkKernelTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	//The same queries on the mapped file, without building a graph or a stencil from it
+	std::vector<std::vector<int>> filePaths{};
+	m_BenchmarkFileOpenTime = 0.f;
+	m_BenchmarkFileTime = 0.f;
+	if (WriteGraphFile(BENCHMARK_GRAPH_FILE, *m_pGridGraph))
+	{
+		GraphFile graphFile{};
+		startTime = std::chrono::steady_clock::now();
+		const bool isOpen{ graphFile.Open(BENCHMARK_GRAPH_FILE) };
+		m_BenchmarkFileOpenTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+		if (isOpen)
+		{
+			const CSRNeighbors fileNeighbors{ graphFile.GetConnections() };
+			auto fileAStar = GridFileAStarKernel(&fileNeighbors, GridHeuristic<OctileDistance>(graphFile.GetHeader().columns));
+
+			filePaths.resize(queries.size());
+			startTime = std::chrono::steady_clock::now();
+			for (size_t i{}; i < queries.size(); ++i)
+				fileAStar.FindPath(queries[i].first, queries[i].second, filePaths[i]);
+			m_BenchmarkFileTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		}
+	}
+
+	//Ties can be broken differently, so only the costs have to match
+	auto getPathCost = [this](const std::vector<int>& path)
+	{
+		float cost{};
+		for (size_t i{ 1 }; i < path.size(); ++i)
+			cost += m_pGridGraph->GetConnection(path[i - 1], path[i])->GetCost();
+		return cost;
+	};
+
+	auto getIndices = [](const std::vector<GridTerrainNode*>& path)
+	{
+		std::vector<int> indices{};
+		for (GridTerrainNode* pNode : path)
+			indices.push_back(pNode->GetIndex());
+		return indices;
+	};
+
+	m_NrOfBenchmarkMismatches = 0;
+	for (size_t i{}; i < queries.size(); ++i)
+	{
+		const std::vector<int> runtimePath{ getIndices(runtimePaths[i]) };
+		const std::vector<int> kernelPath{ getIndices(kernelPaths[i]) };
+
+		if (runtimePath.empty() != kernelPath.empty() || abs(getPathCost(runtimePath) - getPathCost(kernelPath)) > 0.001f)
+			++m_NrOfBenchmarkMismatches;
+		if (!filePaths.empty() && (runtimePath.empty() != filePaths[i].empty() || abs(getPathCost(runtimePath) - getPathCost(filePaths[i])) > 0.001f))
+			++m_NrOfBenchmarkMismatches;
+	}
+}
+
+void App_PathfindingAStar::UpdateCooperativeAgents(float deltaTime)
+{
+	if (!m_UseCooperativeAgents)
+	{
+		for (int agentId : m_CooperativeAgents)
+			m_pCooperativePathfinder->RemoveAgent(agentId);
+		m_CooperativeAgents.clear();
+		return;
+	}
+
+	//Spawn on free cells, the pathfinder keeps them apart from then on
+	if (m_CooperativeAgents.empty())
+	{
+		for (int i{}; i < NR_OF_COOPERATIVE_AGENTS; ++i)
+		{
+			const int cellIdx{ GetRandomFreeCell() };
+			if (cellIdx != invalid_node_index)
+				m_CooperativeAgents.push_back(m_pCooperativePathfinder->AddAgent(cellIdx));
+		}
+		m_CooperativeStepTimer = 0.f;
+	}
+
+	m_CooperativeStepTimer += deltaTime;
+	while (m_CooperativeStepTimer >= COOPERATIVE_STEP_TIME)
+	{
+		m_CooperativeStepTimer -= COOPERATIVE_STEP_TIME;
+
+		for (int agentId : m_CooperativeAgents)
+		{
+			if (m_pCooperativePathfinder->HasReachedGoal(agentId))
+			{
+				const int goalIdx{ GetRandomFreeCell() };
+				if (goalIdx != invalid_node_index)
+					m_pCooperativePathfinder->SetGoal(agentId, goalIdx);
+			}
+		}
+
+		m_pCooperativePathfinder->Step();
+	}
+}
+
+void App_PathfindingAStar::UpdateFlowFieldAgents(float deltaTime)
+{
+	if (!m_UseFlowFieldAgents)
+	{
+		for (auto pAgent : m_FlowFieldAgents)
+			SAFE_DELETE(pAgent);
+		m_FlowFieldAgents.clear();
+		return;
+	}
+
+	//Spawn on free cells, from then on they only sample the field
+	if (m_FlowFieldAgents.empty())
+	{
+		for (int i{}; i < NR_OF_FLOW_FIELD_AGENTS; ++i)
+		{
+			const int cellIdx{ GetRandomFreeCell() };
+			if (cellIdx == invalid_node_index)
+				continue;
+
+			auto pAgent = new SteeringAgent(m_SizeCell / 5.f);
+			pAgent->SetPosition(m_pGridGraph->GetNodeWorldPos(cellIdx));
+			pAgent->SetSteeringBehavior(m_pFlowFieldFollow);
+			pAgent->SetMaxLinearSpeed(FLOW_FIELD_AGENT_SPEED);
+			pAgent->SetAutoOrient(true);
+			pAgent->SetMass(0.1f);
+			m_FlowFieldAgents.push_back(pAgent);
+		}
+	}
+
+	//Without an end node the field is empty and the agents stand still
+	m_pFlowFieldFollow->SetFlowField(m_pFlowField);
+	for (auto pAgent : m_FlowFieldAgents)
+	{
+		pAgent->Update(deltaTime);
+	}
+}
+
+int App_PathfindingAStar::GetRandomFreeCell() const
+{
+	//Cells without connections are walls or water, cells with an agent on them are taken
+	for (int attempt{}; attempt < 100; ++attempt)
+	{
+		const int cellIdx{ Elite::randomInt(m_pGridGraph->GetNrOfNodes()) };
+		if (m_pGridGraph->GetNodeConnections(cellIdx).empty())
+			continue;
+
+		const bool isTaken{ std::any_of(m_CooperativeAgents.begin(), m_CooperativeAgents.end(),
+			[this, cellIdx](int agentId) { return m_pCooperativePathfinder->GetCell(agentId) == cellIdx; }) };
+		if (!isTaken)
+			return cellIdx;
+	}
+
+	return invalid_node_index;
+}
@@ -8,6 +8,19 @@
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphEditor.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphRenderer.h"
 #include "framework\EliteAI\EliteNavigation\ENavigation.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EHierarchicalPathfinding.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EPathRequestService.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EFlowField.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\ELandmarks.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStarScheduler.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStarKernel.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EJumpPointSearch.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EThetaStar.h"
+#include "framework\EliteAI\EliteNavigation\Algorithms\EPathSmoothing.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\ECooperativePathfinding.h"
+
+class SteeringAgent;
+class FlowFieldFollow;
 
 
 //-----------------------------------------------------------------
@@ -50,6 +63,74 @@ private:
 	int endPathIdx = invalid_node_index;
 	std::vector<Elite::GridTerrainNode*> m_vPath;
 
+	//Hierarchical pathfinding (HPA*), can be validated against A* to show the suboptimality (an extra full search per query)
+	static const int CLUSTER_SIZE = 5;
+	bool m_UseHierarchicalPathfinding = false;
+	bool m_ValidateHierarchicalPaths = false;
+	Elite::HierarchicalPathfinder<Elite::GridTerrainNode, Elite::GraphConnection>* m_pHierarchicalPathfinder{ nullptr };
+
+	//Asynchronous requests, A* runs on a worker thread and the path is picked up in Update
+	bool m_UseAsyncRequests = false;
+	Elite::PathRequestService* m_pPathRequestService{ nullptr };
+	Elite::PathRequestHandle m_PathRequest = Elite::invalid_path_request;
+
+	//Time-sliced A*, the search only gets a number of expansions per frame and shows its partial path until it is done
+	bool m_UseTimeSlicing = false;
+	int m_ExpansionsPerFrame = 5;
+	Elite::AStarScheduler<Elite::GridTerrainNode, Elite::GraphConnection>* m_pAStarScheduler{ nullptr };
+	Elite::AStarSearchHandle m_SearchHandle = Elite::invalid_search_handle;
+
+	//Flow field towards the end node, shared by everything heading there
+	bool m_DrawFlowField = false;
+	Elite::FlowFieldCache<Elite::GridTerrainNode, Elite::GraphConnection>* m_pFlowFieldCache{ nullptr };
+	const Elite::FlowField* m_pFlowField{ nullptr };
+
+	//Landmark (ALT) heuristic on top of the selected heuristic, the tables are rebuilt after the grid changed
+	bool m_UseLandmarks = false;
+	Elite::LandmarkHeuristic<Elite::GridTerrainNode, Elite::GraphConnection>* m_pLandmarks{ nullptr };
+	int m_NrOfExpandedNodes = 0;
+
+	//Jump Point Search, grids with terrain costs are searched with A* instead
+	bool m_UseJumpPointSearch = false;
+	Elite::JumpPointSearch<Elite::GridTerrainNode, Elite::GraphConnection>* m_pJumpPointSearch{ nullptr };
+
+	//Any-angle paths with (Lazy) Theta*, only the turning points, terrain costs are not taken into account
+	bool m_UseThetaStar = false;
+	bool m_UseLazyThetaStar = true;
+	Elite::ThetaStar<Elite::GridTerrainNode, Elite::GraphConnection>* m_pThetaStar{ nullptr };
+
+	//String pulling of the grid path, redone every frame to show how cheap it is
+	bool m_UseStringPulling = false;
+	Elite::GridPassability m_Passability{};
+	std::vector<Elite::Vector2> m_vPulledPath{};
+	float m_StringPullingTime = 0.f;
+
+	//Benchmark of the runtime A* (octile heuristic) against the compile-time specialised kernel on random queries
+	//The kernel also searches the grid saved to a graph file, straight on the memory mapped adjacency
+	static const int NR_OF_BENCHMARK_QUERIES = 1000;
+	const std::string BENCHMARK_GRAPH_FILE = "AStarBenchmark.graph";
+	Elite::GridGraphAStar<Elite::GridTerrainNode, Elite::GraphConnection>* m_pKernelAStar{ nullptr };
+	float m_BenchmarkRuntimeTime = 0.f;
+	float m_BenchmarkKernelTime = 0.f;
+	float m_BenchmarkFileOpenTime = 0.f;
+	float m_BenchmarkFileTime = 0.f;
+	int m_NrOfBenchmarkMismatches = 0;
+
+	//Cooperative agents (WHCA*), they move a cell per step around each other's reservations and get a new goal when they reach theirs
+	static const int NR_OF_COOPERATIVE_AGENTS = 12;
+	const float COOPERATIVE_STEP_TIME = 0.25f;
+	bool m_UseCooperativeAgents = false;
+	Elite::CooperativePathfinder<Elite::GridTerrainNode, Elite::GraphConnection>* m_pCooperativePathfinder{ nullptr };
+	std::vector<int> m_CooperativeAgents{};
+	float m_CooperativeStepTimer = 0.f;
+
+	//Crowd following the flow field towards the end node, every agent samples the same field instead of searching a path
+	static const int NR_OF_FLOW_FIELD_AGENTS = 20;
+	const float FLOW_FIELD_AGENT_SPEED = 25.f;
+	bool m_UseFlowFieldAgents = false;
+	FlowFieldFollow* m_pFlowFieldFollow{ nullptr };
+	std::vector<SteeringAgent*> m_FlowFieldAgents{};
+
 	//Editor and Visualisation
 	Elite::GraphEditor* m_pGraphEditor{ nullptr};
 	Elite::GraphRenderer* m_pGraphRenderer{ nullptr };
@@ -65,6 +146,10 @@ private:
 	void MakeGridGraph();
 	void UpdateImGui();
 	void CalculatePath();
+	void RunBenchmark();
+	void UpdateCooperativeAgents(float deltaTime);
+	void UpdateFlowFieldAgents(float deltaTime);
+	int GetRandomFreeCell() const;
 
 	//C++ make the class non-copyable
 	App_PathfindingAStar(const App_PathfindingAStar&) = delete;
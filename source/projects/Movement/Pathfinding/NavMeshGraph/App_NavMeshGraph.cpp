@@ -12,12 +12,17 @@ using namespace Elite;
 
 #include "framework\EliteAI\EliteNavigation\Algorithms\ENavGraphPathfinding.h"
 
+//Defines
+#define NR_OF_BENCHMARK_MOVES 100
+#define NR_OF_BENCHMARK_QUERIES 1000
+
 //Statics
 bool App_NavMeshGraph::sShowPolygon = true;
 bool App_NavMeshGraph::sShowGraph = false;
 bool App_NavMeshGraph::sDrawPortals = false;
 bool App_NavMeshGraph::sDrawFinalPath = true;
 bool App_NavMeshGraph::sDrawNonOptimisedPath = false;
+bool App_NavMeshGraph::sUseLandmarks = false;
 
 //Destructor
 App_NavMeshGraph::~App_NavMeshGraph()
@@ -26,6 +31,8 @@ App_NavMeshGraph::~App_NavMeshGraph()
 		SAFE_DELETE(pNC);
 	m_vNavigationColliders.clear();
 
+	SAFE_DELETE(m_pLandmarks);
+	SAFE_DELETE(m_pNavGraphSearch);
 	SAFE_DELETE(m_pNavGraph);
 	SAFE_DELETE(m_pSeekBehavior);
 	SAFE_DELETE(m_pArriveBehavior);
@@ -50,7 +57,9 @@ void App_NavMeshGraph::Start()
 	std::list<Elite::Vector2> baseBox
 	{ { -60, 30 },{ -60, -30 },{ 60, -30 },{ 60, 30 } };
 
-	m_pNavGraph = new Elite::NavGraph(Elite::Polygon(baseBox), m_AgentRadius);
+	m_pNavGraph = new Elite::NavGraph(Elite::Polygon(baseBox), m_AgentRadius, NAVMESH_GRAPH_FILE);
+	m_pLandmarks = new Elite::LandmarkHeuristic<Elite::NavGraphNode, Elite::GraphConnection2D>(m_pNavGraph);
+	m_pNavGraphSearch = new Elite::NavGraphAStar();
 
 	//----------- AGENT ------------
 	m_pSeekBehavior = new Seek();
@@ -68,13 +77,24 @@ void App_NavMeshGraph::Start()
 
 void App_NavMeshGraph::Update(float deltaTime)
 {
+	//Track the triangle the agent is in, it only moves a little every frame
+	m_pAgentTriangle = m_pNavGraph->GetNavMeshPolygon()->GetTriangleFromPosition(m_pAgent->GetPosition(), m_pAgentTriangle);
+
 	//Update target/path based on input
 	if (INPUTMANAGER->IsMouseButtonUp(InputMouseButton::eMiddle))
 	{
 		auto mouseData = INPUTMANAGER->GetMouseData(Elite::InputType::eMouseButton, Elite::InputMouseButton::eMiddle);
 		Elite::Vector2 mouseTarget = DEBUGRENDERER2D->GetActiveCamera()->ConvertScreenToWorld(
 			Elite::Vector2((float)mouseData.X, (float)mouseData.Y));
-		m_vPath = NavMeshPathfinding::FindPath(m_pAgent->GetPosition(), mouseTarget, m_pNavGraph, m_DebugNodePositions, m_Portals);
+		m_vPath = NavMeshPathfinding::FindPath(m_pAgent->GetPosition(), mouseTarget, m_pNavGraph, m_DebugNodePositions, m_Portals, sUseLandmarks ? m_pLandmarks : nullptr, m_pAgentTriangle, m_MaxSnapDistance, m_pNavGraphSearch);
+	}
+
+	//Place or move the obstacle
+	if (INPUTMANAGER->IsMouseButtonUp(InputMouseButton::eRight))
+	{
+		auto mouseData = INPUTMANAGER->GetMouseData(Elite::InputType::eMouseButton, Elite::InputMouseButton::eRight);
+		PlaceObstacle(DEBUGRENDERER2D->GetActiveCamera()->ConvertScreenToWorld(
+			Elite::Vector2((float)mouseData.X, (float)mouseData.Y)));
 	}
 
 	//Check if a path exist and move to the following point
@@ -160,6 +180,160 @@ void App_NavMeshGraph::Render(float deltaTime) const
 
 }
 
+void App_NavMeshGraph::PlaceObstacle(const Elite::Vector2& position)
+{
+	const float halfSize{ m_ObstacleSize / 2.f };
+	const std::vector<Elite::Vector2> box
+	{ { position.x - halfSize, position.y + halfSize },{ position.x - halfSize, position.y - halfSize },
+	{ position.x + halfSize, position.y - halfSize },{ position.x + halfSize, position.y + halfSize } };
+
+	bool hasChanged{};
+	if (m_ObstacleId == invalid_obstacle_id)
+	{
+		m_ObstacleId = m_pNavGraph->AddObstacle(Elite::Polygon(box));
+		hasChanged = m_ObstacleId != invalid_obstacle_id;
+	}
+	else
+	{
+		hasChanged = m_pNavGraph->MoveObstacle(m_ObstacleId, Elite::Polygon(box));
+	}
+
+	m_IsObstacleRefused = !hasChanged;
+	if (!hasChanged)
+		return;
+
+	//The triangles were changed, the path may run through the obstacle now
+	m_pAgentTriangle = nullptr;
+	m_vPath.clear();
+	m_Portals.clear();
+	m_DebugNodePositions.clear();
+}
+
+void App_NavMeshGraph::RemoveObstacle()
+{
+	if (!m_pNavGraph->RemoveObstacle(m_ObstacleId))
+		return;
+
+	m_ObstacleId = invalid_obstacle_id;
+	m_IsObstacleRefused = false;
+	m_pAgentTriangle = nullptr;
+	m_vPath.clear();
+	m_Portals.clear();
+	m_DebugNodePositions.clear();
+}
+
+void App_NavMeshGraph::RunObstacleBenchmark()
+{
+	m_BenchmarkNrOfTriangles.clear();
+	m_BenchmarkRebuildTimes.clear();
+	m_BenchmarkMoveTimes.clear();
+	m_BenchmarkLargeMoveTimes.clear();
+	m_BenchmarkAddRemoveTimes.clear();
+
+	for (int scale{ 1 }; scale <= 4; scale *= 2)
+	{
+		//The level around a grid of small holes, the level itself is left free so the colliders don't overlap the holes
+		const float halfWidth{ 60.f * scale };
+		const float halfHeight{ 30.f * scale };
+		Elite::Polygon contour{ std::vector<Elite::Vector2>{ { -halfWidth, halfHeight },{ -halfWidth, -halfHeight },{ halfWidth, -halfHeight },{ halfWidth, halfHeight } } };
+		for (float x{ -halfWidth + 5.f }; x < halfWidth - 5.f; x += 10.f)
+		{
+			for (float y{ -halfHeight + 5.f }; y < halfHeight - 5.f; y += 10.f)
+			{
+				if (abs(x) < 65.f && abs(y) < 35.f)
+					continue;
+
+				contour.AddChild(Elite::Polygon(std::vector<Elite::Vector2>{ { x - 1.f, y + 1.f },{ x - 1.f, y - 1.f },{ x + 1.f, y - 1.f },{ x + 1.f, y + 1.f } }));
+			}
+		}
+
+		auto startTime = std::chrono::steady_clock::now();
+		Elite::NavGraph navGraph{ contour, m_AgentRadius };
+		m_BenchmarkRebuildTimes.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+		m_BenchmarkNrOfTriangles.push_back(int(navGraph.GetNavMeshPolygon()->GetTriangles().size()));
+
+		//Same obstacle on every scale, in two free spots on opposite sides of the level
+		auto getBox = [](const Elite::Vector2& center) { return Elite::Polygon(std::vector<Elite::Vector2>{ { center.x - 2.f, center.y + 2.f },{ center.x - 2.f, center.y - 2.f },{ center.x + 2.f, center.y - 2.f },{ center.x + 2.f, center.y + 2.f } }); };
+		const Elite::Vector2 nearSpot{ -50.f, -20.f };
+		const Elite::Vector2 farSpot{ 50.f, 24.f };
+
+		//Moved back and forth a little, the old and new shape share their triangles
+		const int obstacleId{ navGraph.AddObstacle(getBox(nearSpot)) };
+		startTime = std::chrono::steady_clock::now();
+		for (int i{}; i < NR_OF_BENCHMARK_MOVES; ++i)
+			navGraph.MoveObstacle(obstacleId, getBox(nearSpot + Elite::Vector2{ float(i % 2), 0.f }));
+		m_BenchmarkMoveTimes.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count() / NR_OF_BENCHMARK_MOVES);
+
+		//Moved across the level, both spots get retriangulated
+		startTime = std::chrono::steady_clock::now();
+		for (int i{}; i < NR_OF_BENCHMARK_MOVES; ++i)
+			navGraph.MoveObstacle(obstacleId, getBox(i % 2 == 0 ? farSpot : nearSpot));
+		m_BenchmarkLargeMoveTimes.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count() / NR_OF_BENCHMARK_MOVES);
+
+		//Added and removed again, per pair
+		navGraph.RemoveObstacle(obstacleId);
+		startTime = std::chrono::steady_clock::now();
+		for (int i{}; i < NR_OF_BENCHMARK_MOVES; ++i)
+			navGraph.RemoveObstacle(navGraph.AddObstacle(getBox(nearSpot)));
+		m_BenchmarkAddRemoveTimes.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count() / NR_OF_BENCHMARK_MOVES);
+	}
+}
+
+void App_NavMeshGraph::RunPathBenchmark()
+{
+	auto runtimeAStar = AStar<NavGraphNode, GraphConnection2D>(m_pNavGraph, HeuristicFunctions::Euclidean);
+
+	//Same queries for both, between nodes that weren't removed by an obstacle
+	std::vector<int> activeNodes{};
+	for (int idx{}; idx < m_pNavGraph->GetNrOfNodes(); ++idx)
+	{
+		if (m_pNavGraph->IsNodeValid(idx))
+			activeNodes.push_back(idx);
+	}
+	if (activeNodes.empty())
+		return;
+
+	std::vector<std::pair<int, int>> queries{};
+	queries.reserve(NR_OF_BENCHMARK_QUERIES);
+	for (int i{}; i < NR_OF_BENCHMARK_QUERIES; ++i)
+		queries.push_back({ activeNodes[Elite::randomInt(int(activeNodes.size()))], activeNodes[Elite::randomInt(int(activeNodes.size()))] });
+
+	std::vector<std::vector<NavGraphNode*>> runtimePaths{};
+	runtimePaths.reserve(queries.size());
+	auto startTime = std::chrono::steady_clock::now();
+	for (const auto& query : queries)
+		runtimePaths.push_back(runtimeAStar.FindPath(m_pNavGraph->GetNode(query.first), m_pNavGraph->GetNode(query.second)));
+	m_BenchmarkRuntimeTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	//The snapshot is made before the timing, like it is kept between the queries of the app
+	std::vector<std::vector<int>> kernelPaths(queries.size());
+	m_pNavGraphSearch->FindPath(m_pNavGraph, queries[0].first, queries[0].first, kernelPaths[0]);
+	startTime = std::chrono::steady_clock::now();
+	for (size_t i{}; i < queries.size(); ++i)
+		m_pNavGraphSearch->FindPath(m_pNavGraph, queries[i].first, queries[i].second, kernelPaths[i]);
+	m_BenchmarkKernelTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	//Ties can be broken differently, so only the costs have to match
+	auto getPathCost = [this](const std::vector<int>& path)
+	{
+		float cost{};
+		for (size_t i{ 1 }; i < path.size(); ++i)
+			cost += m_pNavGraph->GetConnection(path[i - 1], path[i])->GetCost();
+		return cost;
+	};
+
+	m_NrOfBenchmarkMismatches = 0;
+	for (size_t i{}; i < queries.size(); ++i)
+	{
+		std::vector<int> runtimePath{};
+		for (NavGraphNode* pNode : runtimePaths[i])
+			runtimePath.push_back(pNode->GetIndex());
+
+		if (runtimePath.empty() != kernelPaths[i].empty() || abs(getPathCost(runtimePath) - getPathCost(kernelPaths[i])) > 0.001f)
+			++m_NrOfBenchmarkMismatches;
+	}
+}
+
 void App_NavMeshGraph::UpdateImGui()
 {
 	//------- UI --------
@@ -180,6 +354,8 @@ void App_NavMeshGraph::UpdateImGui()
 		//Elements
 		ImGui::Text("CONTROLS");
 		ImGui::Indent();
+		ImGui::Text("MMB: target");
+		ImGui::Text("RMB: obstacle");
 		ImGui::Unindent();
 
 		ImGui::Spacing();
@@ -203,6 +379,7 @@ void App_NavMeshGraph::UpdateImGui()
 		ImGui::Checkbox("Show Portals", &sDrawPortals);
 		ImGui::Checkbox("Show Path Nodes", &sDrawNonOptimisedPath);
 		ImGui::Checkbox("Show Final Path", &sDrawFinalPath);
+		ImGui::Checkbox("Landmarks (ALT)", &sUseLandmarks);
 		ImGui::Spacing();
 		ImGui::Spacing();
 
@@ -210,6 +387,48 @@ void App_NavMeshGraph::UpdateImGui()
 		{
 			m_pAgent->SetMaxLinearSpeed(m_AgentSpeed);
 		}
+		ImGui::SliderFloat("Obstacle", &m_ObstacleSize, 1.0f, 20.0f);
+		if (m_IsObstacleRefused)
+			ImGui::Text("Doesn't fit there");
+		if (ImGui::Button("Remove Obstacle"))
+		{
+			RemoveObstacle();
+		}
+		ImGui::Spacing();
+
+		if (ImGui::Button("Benchmark Obstacles"))
+		{
+			RunObstacleBenchmark();
+		}
+		if (!m_BenchmarkMoveTimes.empty())
+		{
+			ImGui::Indent();
+			for (size_t i{}; i < m_BenchmarkMoveTimes.size(); ++i)
+			{
+				ImGui::Text("%d tris", m_BenchmarkNrOfTriangles[i]);
+				ImGui::Text(" Rebuild: %.3f ms", m_BenchmarkRebuildTimes[i]);
+				ImGui::Text(" Move: %.3f ms", m_BenchmarkMoveTimes[i]);
+				ImGui::Text(" Far move: %.3f ms", m_BenchmarkLargeMoveTimes[i]);
+				ImGui::Text(" Add+remove: %.3f ms", m_BenchmarkAddRemoveTimes[i]);
+			}
+			ImGui::Unindent();
+		}
+		ImGui::Spacing();
+
+		if (ImGui::Button("Benchmark A*"))
+		{
+			RunPathBenchmark();
+		}
+		if (m_BenchmarkKernelTime > 0.f)
+		{
+			ImGui::Indent();
+			ImGui::Text("Queries: %d", NR_OF_BENCHMARK_QUERIES);
+			ImGui::Text("Runtime: %.3f ms", m_BenchmarkRuntimeTime);
+			ImGui::Text("Kernel: %.3f ms", m_BenchmarkKernelTime);
+			ImGui::Text("Speedup: %.2fx", m_BenchmarkRuntimeTime / m_BenchmarkKernelTime);
+			ImGui::Text("Mismatches: %d", m_NrOfBenchmarkMismatches);
+			ImGui::Unindent();
+		}
 		
 		//End
 		ImGui::PopAllowKeyboardFocus();
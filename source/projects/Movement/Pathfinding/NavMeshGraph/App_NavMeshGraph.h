@@ -17,6 +17,11 @@ class Arrive;
 namespace Elite
 {
 	class NavGraph;
+	struct Triangle;
+	class NavGraphNode;
+	class GraphConnection2D;
+	class NavGraphAStar;
+	template<class T_NodeType, class T_ConnectionType> class LandmarkHeuristic;
 }
 //-----------------------------------------------------------------
 // Application
@@ -42,15 +47,25 @@ private:
 	TargetData m_Target = {};
 	float m_AgentRadius = 1.0f;
 	float m_AgentSpeed = 16.0f;
+	float m_MaxSnapDistance = 10.0f; //Targets (and agent positions) off the navmesh snap to the closest node within this distance
+	const Elite::Triangle* m_pAgentTriangle = nullptr; //Tracked every frame by walking from the previous one
+
+	// --Obstacle--
+	int m_ObstacleId = -1; //invalid_obstacle_id until placed with the right mouse button, moved on every next click
+	float m_ObstacleSize = 6.0f;
+	bool m_IsObstacleRefused = false; //The last click didn't fit an obstacle, shown until the next one
 
 	// --Level--
 	std::vector<NavigationColliderElement*> m_vNavigationColliders = {};
+	const std::string NAVMESH_GRAPH_FILE = "NavMeshGraph.graph"; //Nav graph of the level, rebuilt when the level changed
 
 	// --Pathfinder--
 	std::vector<Elite::Vector2> m_vPath;
 
 	// --Graph--
 	Elite::NavGraph* m_pNavGraph = nullptr;
+	Elite::LandmarkHeuristic<Elite::NavGraphNode, Elite::GraphConnection2D>* m_pLandmarks = nullptr;
+	Elite::NavGraphAStar* m_pNavGraphSearch = nullptr; //Keeps the snapshot of the graph between queries
 	Elite::GraphRenderer m_GraphRenderer{};
 
 	// --Debug drawing information--
@@ -61,7 +76,24 @@ private:
 	static bool sDrawPortals;
 	static bool sDrawFinalPath;
 	static bool sDrawNonOptimisedPath;
+	static bool sUseLandmarks;
+
+	// --Benchmark--
+	//Full rebuild against changing one obstacle (a small move, a move across the level, adding and removing it), on worlds that grow in size
+	std::vector<int> m_BenchmarkNrOfTriangles;
+	std::vector<float> m_BenchmarkRebuildTimes;
+	std::vector<float> m_BenchmarkMoveTimes;
+	std::vector<float> m_BenchmarkLargeMoveTimes;
+	std::vector<float> m_BenchmarkAddRemoveTimes;
+	//Runtime A* against the NavGraph kernel, on random node pairs of the level
+	float m_BenchmarkRuntimeTime = 0.f;
+	float m_BenchmarkKernelTime = 0.f;
+	int m_NrOfBenchmarkMismatches = 0;
 
+	void PlaceObstacle(const Elite::Vector2& position);
+	void RemoveObstacle();
+	void RunObstacleBenchmark();
+	void RunPathBenchmark();
 	void UpdateImGui();
 private:
 	//C++ make the class non-copyable
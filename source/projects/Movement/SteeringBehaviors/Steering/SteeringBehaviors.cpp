@@ -6,6 +6,7 @@
 #include "../SteeringAgent.h"
 #include "../Obstacle.h"
 #include "framework\EliteMath\EMatrix2x3.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EFlowField.h"
 
 //SEEK
 //****
@@ -74,6 +75,41 @@ SteeringOutput Arrive::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 	return steering;
 }
 
+//FLOWFIELDFOLLOW
+//****
+SteeringOutput FlowFieldFollow::CalculateSteering(float deltaT, SteeringAgent* pAgent)
+{
+	SteeringOutput steering = {};
+
+	//Stand still outside of the field or when the goal can't be reached from here
+	if (m_pFlowField == nullptr || !m_pFlowField->IsReachable(pAgent->GetPosition()))
+		return steering;
+
+	const Elite::Vector2 waypoint{ m_pFlowField->GetNextWaypoint(pAgent->GetPosition()) };
+	steering.LinearVelocity = waypoint - pAgent->GetPosition();
+
+	if (m_pFlowField->IsGoalCell(pAgent->GetPosition()))
+	{
+		//Same as Arrive, slow down towards the center of the goal cell
+		const float slowRadius = 15.f;
+		const float distance{ steering.LinearVelocity.MagnitudeSquared() };
+		steering.LinearVelocity.Normalize();
+		steering.LinearVelocity *= pAgent->GetMaxLinearSpeed() * std::min(distance / (slowRadius * slowRadius), 1.f);
+	}
+	else
+	{
+		steering.LinearVelocity.Normalize();
+		steering.LinearVelocity *= pAgent->GetMaxLinearSpeed();
+	}
+
+	if (pAgent->CanRenderBehavior())
+	{
+		DEBUGRENDERER2D->DrawDirection(pAgent->GetPosition(), steering.LinearVelocity, 5, { 0,1,0 });
+	}
+
+	return steering;
+}
+
 //FACE
 //****
 SteeringOutput Face::CalculateSteering(float deltaT, SteeringAgent* pAgent)
@@ -13,6 +13,10 @@
 #include "../SteeringHelpers.h"
 class SteeringAgent;
 class Obstacle;
+namespace Elite
+{
+	class FlowField;
+}
 
 #pragma region **ISTEERINGBEHAVIOR** (BASE)
 class ISteeringBehavior
@@ -74,6 +78,23 @@ public:
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
 };
 
+///////////////////////////////////////
+//FLOWFIELDFOLLOW
+//****
+class FlowFieldFollow : public ISteeringBehavior
+{
+public:
+	FlowFieldFollow() = default;
+	virtual ~FlowFieldFollow() = default;
+
+	//FlowFieldFollow Behaviour, seeks the next cell of the field and arrives in the goal cell
+	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void SetFlowField(const Elite::FlowField* pFlowField) { m_pFlowField = pFlowField; }
+
+private:
+	const Elite::FlowField* m_pFlowField = nullptr;
+};
+
 ///////////////////////////////////////
 //FACE
 //****